@@ -0,0 +1,84 @@
+/*
+ * flowgraph.c - Build the control flow graph of a list of instructions.
+ *
+ * Every instruction becomes a node whose info is the AS_instr itself, and
+ * nodes are made in instruction order, so a node's key is the position of
+ * its instruction in the list.
+ */
+
+#include <stdio.h>
+#include "util.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "absyn.h"
+#include "assem.h"
+#include "frame.h"
+#include "graph.h"
+#include "flowgraph.h"
+#include "table.h"
+
+Temp_tempList FG_def(G_node n) {
+  AS_instr i = G_nodeInfo(n);
+  switch (i->kind) {
+  case I_OPER:
+    return i->u.OPER.dst;
+  case I_MOVE:
+    return i->u.MOVE.dst;
+  case I_LABEL:
+    return NULL;
+  }
+  assert(0);
+  return NULL;
+}
+
+Temp_tempList FG_use(G_node n) {
+  AS_instr i = G_nodeInfo(n);
+  switch (i->kind) {
+  case I_OPER:
+    return i->u.OPER.src;
+  case I_MOVE:
+    return i->u.MOVE.src;
+  case I_LABEL:
+    return NULL;
+  }
+  assert(0);
+  return NULL;
+}
+
+bool FG_isMove(G_node n) {
+  AS_instr i = G_nodeInfo(n);
+  return i->kind == I_MOVE;
+}
+
+G_graph FG_AssemFlowGraph(AS_instrList il) {
+  G_graph g = G_Graph();
+  TAB_table labels = TAB_empty();
+  AS_instrList p;
+  int key;
+
+  /* One node per instruction; remember where each label is. */
+  for (p = il; p; p = p->tail) {
+    G_node n = G_Node(g, p->head);
+    if (p->head->kind == I_LABEL)
+      TAB_enter(labels, p->head->u.LABEL.label, n);
+  }
+
+  /* An instruction with jump targets only goes to those targets (a
+   * conditional jump lists its fall-through label too); anything else
+   * falls through to the next instruction. */
+  for (p = il, key = 0; p; p = p->tail, key++) {
+    G_node n = G_nodeWithKey(g, key);
+    if (p->head->kind == I_OPER && p->head->u.OPER.jumps) {
+      Temp_labelList l;
+      for (l = p->head->u.OPER.jumps->labels; l; l = l->tail) {
+        G_node target = TAB_look(labels, l->head);
+        if (target)
+          G_addEdge(n, target);
+      }
+    } else if (p->tail)
+      G_addEdge(n, G_nodeWithKey(g, key + 1));
+  }
+  G_pack(g);
+  return g;
+}
@@ -1,10 +1,24 @@
 /*
  * graph.c - Functions to manipulate and create control flow and
  *           interference graphs.
+ *
+ * Nodes are numbered densely in the order they are made. Each node keeps
+ * its successors and predecessors as arrays of node keys, which grow while
+ * the graph is being built. G_pack moves all of them into two contiguous
+ * arrays (compressed sparse rows) once the graph has settled, and
+ * G_useMatrix adds a bit matrix so that G_goesTo is a single bit test.
+ *
+ * The G_nodeList results of G_succ, G_pred and G_adj are built from the
+ * arrays on demand and cached until the node's edges change. Everything is
+ * allocated in the graph arena, so arrays that are outgrown are left there.
  */
 
 #include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "temp.h"
 #include "tree.h"
@@ -15,37 +29,65 @@
 #include "errormsg.h"
 #include "table.h"
 
+#define WORD_BITS (8 * sizeof(unsigned long))
+
+typedef struct {
+  int *keys;
+  int count;
+  int capacity; /* 0 while "keys" points into the packed arrays */
+} edgeArray;
+
 struct G_graph_ {
   int nodecount;
   G_nodeList mynodes, mylast;
+  G_node *nodes; /* indexed by key */
+  int nodeCapacity;
+  unsigned long *matrix; /* bit (from, to) is set for every edge, or NULL */
+  int rowWords, matrixNodes;
 };
 
 struct G_node_ {
   G_graph mygraph;
   int mykey;
-  G_nodeList succs;
-  G_nodeList preds;
+  edgeArray succs;
+  edgeArray preds;
+  G_nodeList succList, predList, adjList; /* caches, NULL when stale */
   void *info;
 };
 
+/* Like realloc, but for arrays that may live inside another allocation. */
+static void *growArray(void *old, int used, int capacity, int size) {
+  void *p = AR_alloc(AR_graph, capacity * size);
+  if (used)
+    memcpy(p, old, used * size);
+  return p;
+}
+
 G_graph G_Graph(void) {
-  G_graph g = (G_graph)checked_malloc(sizeof *g);
+  G_graph g = (G_graph)AR_alloc(AR_graph, sizeof *g);
   g->nodecount = 0;
   g->mynodes = NULL;
   g->mylast = NULL;
+  g->nodes = NULL;
+  g->nodeCapacity = 0;
+  g->matrix = NULL;
+  g->rowWords = 0;
+  g->matrixNodes = 0;
   return g;
 }
 
 G_nodeList G_NodeList(G_node head, G_nodeList tail) {
-  G_nodeList n = (G_nodeList)checked_malloc(sizeof *n);
+  G_nodeList n = (G_nodeList)AR_alloc(AR_graph, sizeof *n);
   n->head = head;
   n->tail = tail;
   return n;
 }
 
+static void resizeMatrix(G_graph g);
+
 /* generic creation of G_node */
 G_node G_Node(G_graph g, void *info) {
-  G_node n = (G_node)checked_malloc(sizeof *n);
+  G_node n = (G_node)AR_alloc(AR_graph, sizeof *n);
   G_nodeList p = G_NodeList(n, NULL);
   assert(g);
   n->mygraph = g;
@@ -56,9 +98,20 @@ G_node G_Node(G_graph g, void *info) {
   else
     g->mylast = g->mylast->tail = p;
 
-  n->succs = NULL;
-  n->preds = NULL;
+  if (n->mykey == g->nodeCapacity) {
+    g->nodeCapacity = g->nodeCapacity ? 2 * g->nodeCapacity : 64;
+    g->nodes = growArray(g->nodes, n->mykey, g->nodeCapacity, sizeof(G_node));
+  }
+  n->succs.keys = n->preds.keys = NULL;
+  n->succs.count = n->preds.count = 0;
+  n->succs.capacity = n->preds.capacity = 0;
+  n->succList = n->predList = n->adjList = NULL;
   n->info = info;
+
+  /* resizeMatrix reads the edges of every node, this one included. */
+  g->nodes[n->mykey] = n;
+  if (g->matrix && g->nodecount > g->matrixNodes)
+    resizeMatrix(g);
   return n;
 }
 
@@ -67,6 +120,21 @@ G_nodeList G_nodes(G_graph g) {
   return g->mynodes;
 }
 
+int G_nodeCount(G_graph g) {
+  assert(g);
+  return g->nodecount;
+}
+
+int G_key(G_node n) {
+  assert(n);
+  return n->mykey;
+}
+
+G_node G_nodeWithKey(G_graph g, int key) {
+  assert(g && key >= 0 && key < g->nodecount);
+  return g->nodes[key];
+}
+
 /* return true if a is in l list */
 bool G_inNodeList(G_node a, G_nodeList l) {
   G_nodeList p;
@@ -76,28 +144,122 @@ bool G_inNodeList(G_node a, G_nodeList l) {
   return FALSE;
 }
 
+/* Bit matrix of edges */
+
+static unsigned long *matrixWord(G_graph g, int from, int to) {
+  return &g->matrix[(size_t)from * g->rowWords + to / WORD_BITS];
+}
+
+static unsigned long matrixBit(int to) { return 1UL << (to % WORD_BITS); }
+
+static void resizeMatrix(G_graph g) {
+  int i, j, nodes = g->matrixNodes ? g->matrixNodes : 64;
+  size_t words, bytes;
+  while (nodes < g->nodecount)
+    nodes *= 2;
+  g->matrixNodes = nodes;
+  g->rowWords = (nodes + WORD_BITS - 1) / WORD_BITS;
+  words = (size_t)nodes * g->rowWords;
+  bytes = words * sizeof(unsigned long);
+  assert(bytes <= INT_MAX); /* the most AR_alloc hands out at once */
+  g->matrix = AR_alloc(AR_graph, (int)bytes);
+  memset(g->matrix, 0, bytes);
+  for (i = 0; i < g->nodecount; i++) {
+    G_node n = g->nodes[i];
+    for (j = 0; j < n->succs.count; j++)
+      *matrixWord(g, i, n->succs.keys[j]) |= matrixBit(n->succs.keys[j]);
+  }
+}
+
+void G_useMatrix(G_graph g) {
+  assert(g);
+  if (!g->matrix)
+    resizeMatrix(g);
+}
+
+/* Edge arrays */
+
+static void edgesChanged(G_node n) {
+  n->succList = n->predList = n->adjList = NULL;
+}
+
+static void append(edgeArray *a, int key) {
+  if (a->count == a->capacity || a->capacity == 0) {
+    int capacity = a->count < 4 ? 4 : 2 * a->count;
+    a->keys = growArray(a->keys, a->count, capacity, sizeof(int));
+    a->capacity = capacity;
+  }
+  a->keys[a->count++] = key;
+}
+
+static void removeKey(edgeArray *a, int key) {
+  int i;
+  for (i = 0; i < a->count; i++)
+    if (a->keys[i] == key) {
+      memmove(&a->keys[i], &a->keys[i + 1], (a->count - i - 1) * sizeof(int));
+      a->count--;
+      return;
+    }
+  assert(0);
+}
+
+static bool hasKey(edgeArray *a, int key) {
+  int i;
+  for (i = 0; i < a->count; i++)
+    if (a->keys[i] == key)
+      return TRUE;
+  return FALSE;
+}
+
 void G_addEdge(G_node from, G_node to) {
+  G_graph g;
   assert(from);
   assert(to);
   assert(from->mygraph == to->mygraph);
   if (G_goesTo(from, to))
     return;
-  to->preds = G_NodeList(from, to->preds);
-  from->succs = G_NodeList(to, from->succs);
-}
-
-static G_nodeList delete (G_node a, G_nodeList l) {
-  assert(a && l);
-  if (a == l->head)
-    return l->tail;
-  else
-    return G_NodeList(l->head, delete (a, l->tail));
+  g = from->mygraph;
+  append(&from->succs, to->mykey);
+  append(&to->preds, from->mykey);
+  if (g->matrix)
+    *matrixWord(g, from->mykey, to->mykey) |= matrixBit(to->mykey);
+  edgesChanged(from);
+  edgesChanged(to);
 }
 
 void G_rmEdge(G_node from, G_node to) {
+  G_graph g;
   assert(from && to);
-  to->preds = delete (from, to->preds);
-  from->succs = delete (to, from->succs);
+  g = from->mygraph;
+  removeKey(&to->preds, from->mykey);
+  removeKey(&from->succs, to->mykey);
+  if (g->matrix)
+    *matrixWord(g, from->mykey, to->mykey) &= ~matrixBit(to->mykey);
+  edgesChanged(from);
+  edgesChanged(to);
+}
+
+static int *packArray(edgeArray *a, int *next) {
+  if (a->count)
+    memcpy(next, a->keys, a->count * sizeof(int));
+  a->keys = next;
+  a->capacity = 0;
+  return next + a->count;
+}
+
+void G_pack(G_graph g) {
+  int i, total = 0;
+  int *next;
+  assert(g);
+  for (i = 0; i < g->nodecount; i++)
+    total += G_degree(g->nodes[i]);
+  next = AR_alloc(AR_graph, (total ? total : 1) * sizeof(int));
+  /* All successor arrays first, so a forward walk over the whole graph
+   * reads one contiguous run of memory. */
+  for (i = 0; i < g->nodecount; i++)
+    next = packArray(&g->nodes[i]->succs, next);
+  for (i = 0; i < g->nodecount; i++)
+    next = packArray(&g->nodes[i]->preds, next);
 }
 
 /**
@@ -106,60 +268,73 @@ void G_rmEdge(G_node from, G_node to) {
 void G_show(FILE *out, G_nodeList p, void showInfo(void *)) {
   for (; p != NULL; p = p->tail) {
     G_node n = p->head;
-    G_nodeList q;
+    int i;
     assert(n);
     if (showInfo)
       showInfo(n->info);
     fprintf(out, " (%d): ", n->mykey);
-    for (q = G_succ(n); q != NULL; q = q->tail)
-      fprintf(out, "%d ", q->head->mykey);
+    for (i = 0; i < n->succs.count; i++)
+      fprintf(out, "%d ", n->succs.keys[i]);
     fprintf(out, "\n");
   }
 }
 
-G_nodeList G_succ(G_node n) {
-  assert(n);
-  return n->succs;
+const int *G_succKeys(G_node n, int *count) {
+  assert(n && count);
+  *count = n->succs.count;
+  return n->succs.keys;
 }
 
-G_nodeList G_pred(G_node n) {
-  assert(n);
-  return n->preds;
+const int *G_predKeys(G_node n, int *count) {
+  assert(n && count);
+  *count = n->preds.count;
+  return n->preds.keys;
 }
 
-bool G_goesTo(G_node from, G_node n) { return G_inNodeList(n, G_succ(from)); }
-
-/* return length of predecessor list for node n */
-static int inDegree(G_node n) {
-  int deg = 0;
-  G_nodeList p;
-  for (p = G_pred(n); p != NULL; p = p->tail)
-    deg++;
-  return deg;
+static G_nodeList toList(G_graph g, edgeArray *a, G_nodeList tail) {
+  G_nodeList l = tail;
+  int i;
+  for (i = a->count - 1; i >= 0; i--)
+    l = G_NodeList(g->nodes[a->keys[i]], l);
+  return l;
 }
 
-/* return length of successor list for node n */
-static int outDegree(G_node n) {
-  int deg = 0;
-  G_nodeList p;
-  for (p = G_succ(n); p != NULL; p = p->tail)
-    deg++;
-  return deg;
+G_nodeList G_succ(G_node n) {
+  assert(n);
+  if (!n->succList && n->succs.count)
+    n->succList = toList(n->mygraph, &n->succs, NULL);
+  return n->succList;
 }
 
-int G_degree(G_node n) { return inDegree(n) + outDegree(n); }
+G_nodeList G_pred(G_node n) {
+  assert(n);
+  if (!n->predList && n->preds.count)
+    n->predList = toList(n->mygraph, &n->preds, NULL);
+  return n->predList;
+}
 
-/* put list b at the back of list a and return the concatenated list */
-static G_nodeList cat(G_nodeList a, G_nodeList b) {
-  if (a == NULL)
-    return b;
+bool G_goesTo(G_node from, G_node n) {
+  G_graph g = from->mygraph;
+  if (g->matrix)
+    return (*matrixWord(g, from->mykey, n->mykey) & matrixBit(n->mykey)) != 0;
+  /* Scan whichever side is shorter. */
+  if (from->succs.count <= n->preds.count)
+    return hasKey(&from->succs, n->mykey);
   else
-    return G_NodeList(a->head, cat(a->tail, b));
+    return hasKey(&n->preds, from->mykey);
 }
 
+int G_degree(G_node n) { return n->succs.count + n->preds.count; }
+
 /* create the adjacency list for node n by combining the successor and
  * predecessor lists of node n */
-G_nodeList G_adj(G_node n) { return cat(G_succ(n), G_pred(n)); }
+G_nodeList G_adj(G_node n) {
+  assert(n);
+  if (!n->adjList && G_degree(n))
+    n->adjList = toList(n->mygraph, &n->succs,
+                        toList(n->mygraph, &n->preds, NULL));
+  return n->adjList;
+}
 
 void *G_nodeInfo(G_node n) { return n->info; }
 
@@ -51,6 +51,26 @@ int G_degree(G_node n);
 /* Get all the successors and predecessors of "n" */
 G_nodeList G_adj(G_node n);
 
+/* Nodes are numbered densely, in the order they were made:
+    the keys of the nodes of "g" are 0 .. G_nodeCount(g)-1 */
+int G_nodeCount(G_graph g);
+int G_key(G_node n);
+G_node G_nodeWithKey(G_graph g, int key);
+
+/* Get the keys of the successors (predecessors) of "n" as an array of
+    "*count" elements, without building a list. The array is only valid
+    until the next change to the edges of "n" or to G_pack */
+const int *G_succKeys(G_node n, int *count);
+const int *G_predKeys(G_node n, int *count);
+
+/* Move the edges of every node of "g" into contiguous storage. Call it
+    once the graph is built; edges may still be changed afterwards */
+void G_pack(G_graph g);
+
+/* Keep a bit matrix of the edges of "g", so that G_goesTo takes constant
+    time. It costs G_nodeCount(g)^2 bits */
+void G_useMatrix(G_graph g);
+
 /* Get the "info" associated with node "n" */
 void *G_nodeInfo(G_node n);
 
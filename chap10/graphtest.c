@@ -0,0 +1,133 @@
+/*
+ * graphtest.c - Check the edges of graphs against a plain adjacency table.
+ *
+ * Each check builds a graph, adds edges that a seeded generator picks and
+ * removes some again, and then compares G_goesTo, G_succ, G_pred and
+ * G_degree for every pair of nodes with what the table says. The graph
+ * arena is filled with garbage and reset before each check, the way it is
+ * left by the function compiled before, so that a field the graph reads
+ * before it sets it shows up. It prints what failed and exits non-zero,
+ * or prints nothing.
+ *
+ * Build it from a directory holding the chap7, chap9 and chap10 sources:
+ *
+ *   cc -O2 -o graphtest graphtest.c graph.c temp.c table.c symbol.c
+ *     arena.c context.c util.c -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "temp.h"
+#include "graph.h"
+
+#define MAX_NODES 200
+
+static unsigned long seed = 1;
+static int failures;
+
+static int randInt(int n) {
+  seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+  return (int)((seed >> 33) % (unsigned long)n);
+}
+
+/* Leave garbage where the next graph's nodes will be allocated. */
+static void dirtyArena(void) {
+  int i;
+  for (i = 0; i < 64; i++)
+    memset(AR_alloc(AR_graph, 4096), 0x11, 4096);
+  AR_reset(AR_graph);
+}
+
+static int length(G_nodeList l) {
+  int n = 0;
+  for (; l; l = l->tail)
+    n++;
+  return n;
+}
+
+static void fail(const char *check, const char *what, int from, int to) {
+  fprintf(stderr, "graphtest: %s: %s wrong for %d -> %d\n", check, what, from,
+          to);
+  failures++;
+}
+
+/* Compare "g" with "edges", the adjacency table of its first "n" nodes. */
+static void compare(const char *check, G_graph g, G_node *nodes,
+                    bool edges[][MAX_NODES], int n) {
+  int i, j;
+  for (i = 0; i < n; i++) {
+    int succs = 0, preds = 0;
+    for (j = 0; j < n; j++) {
+      if (G_goesTo(nodes[i], nodes[j]) != edges[i][j])
+        fail(check, "G_goesTo", i, j);
+      if (G_inNodeList(nodes[j], G_succ(nodes[i])) != edges[i][j])
+        fail(check, "G_succ", i, j);
+      if (G_inNodeList(nodes[i], G_pred(nodes[j])) != edges[i][j])
+        fail(check, "G_pred", i, j);
+      succs += edges[i][j];
+      preds += edges[j][i];
+    }
+    if (length(G_succ(nodes[i])) != succs)
+      fail(check, "number of successors", i, i);
+    if (length(G_pred(nodes[i])) != preds)
+      fail(check, "number of predecessors", i, i);
+    if (G_degree(nodes[i]) != succs + preds)
+      fail(check, "G_degree", i, i);
+    if (length(G_adj(nodes[i])) != succs + preds)
+      fail(check, "G_adj", i, i);
+  }
+  if (G_nodeCount(g) != n)
+    fail(check, "G_nodeCount", n, n);
+}
+
+/* Add "n" nodes and random edges to a graph, with the bit matrix from the
+ * start if "matrixFirst", and compare it with the table at each step. */
+static void check(const char *name, int n, bool matrixFirst) {
+  static bool edges[MAX_NODES][MAX_NODES];
+  G_node nodes[MAX_NODES];
+  G_graph g;
+  int i, k;
+
+  dirtyArena();
+  memset(edges, 0, sizeof(edges));
+  g = G_Graph();
+  if (matrixFirst)
+    G_useMatrix(g);
+  for (i = 0; i < n; i++) {
+    nodes[i] = G_Node(g, NULL);
+    /* Edges to and from the nodes so far, so the matrix is copied when it
+     * grows. */
+    for (k = 0; k < 3; k++) {
+      int from = randInt(i + 1), to = randInt(i + 1);
+      G_addEdge(nodes[from], nodes[to]);
+      edges[from][to] = TRUE;
+    }
+  }
+  compare(name, g, nodes, edges, n);
+
+  if (!matrixFirst)
+    G_useMatrix(g);
+  for (k = 0; k < n; k++) {
+    int from = randInt(n), to = randInt(n);
+    if (edges[from][to]) {
+      G_rmEdge(nodes[from], nodes[to]);
+      edges[from][to] = FALSE;
+    }
+  }
+  compare(name, g, nodes, edges, n);
+
+  G_pack(g);
+  compare(name, g, nodes, edges, n);
+}
+
+int main(void) {
+  check("small graph with the matrix first", 50, TRUE);
+  /* A matrix made for 64 nodes has to grow. */
+  check("large graph with the matrix first", MAX_NODES, TRUE);
+  check("large graph with the matrix last", MAX_NODES, FALSE);
+  return failures != 0;
+}
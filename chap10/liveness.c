@@ -0,0 +1,478 @@
+/*
+ * liveness.c - Liveness analysis with bit vectors over basic blocks.
+ *
+ * The equations are solved for basic blocks rather than single
+ * instructions: each block gets the set of temps it uses before defining
+ * them and the set it defines, and a worklist seeded in postorder (so that
+ * a block is usually visited after its successors) iterates
+ *
+ *   out[b] = union of in[s] over the successors s of b
+ *   in[b]  = use[b] | (out[b] & ~def[b])
+ *
+ * until nothing changes. Sets for single instructions are recovered from
+ * out[b] by walking the block backwards when they are asked for.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "absyn.h"
+#include "assem.h"
+#include "frame.h"
+#include "graph.h"
+#include "flowgraph.h"
+#include "liveness.h"
+
+#define WORD_BITS (8 * sizeof(unsigned long))
+
+struct Live_info_ {
+  G_graph flow;
+  int words;
+  int tempCount; /* temps made before the analysis */
+  int blockCount;
+  int *blockOf;    /* block of each flow node, by key */
+  int *indexOf;    /* position of each flow node in its block */
+  int *blockNodes; /* keys of the nodes of each block, block after block */
+  int *blockStart; /* where each block starts in blockNodes; one extra */
+  Live_set in, out, use, def; /* blockCount sets each */
+  Temp_temp *temps;           /* indexed by temp number */
+  /* Per-instruction live-out sets of the last block asked about. */
+  int cachedBlock;
+  Live_set cache;
+};
+
+static Live_set newSets(Live_info l, int count) {
+  int bytes = count * l->words * sizeof(unsigned long);
+  Live_set s = AR_alloc(AR_liveness, bytes);
+  memset(s, 0, bytes);
+  return s;
+}
+
+static Live_set blockSet(Live_info l, Live_set sets, int b) {
+  return sets + (size_t)b * l->words;
+}
+
+/* Set kernels. These are plain loops over words, written so that the
+ * compiler can vectorize them. */
+
+static void setCopy(Live_set restrict dst, const unsigned long *restrict src,
+                    int words) {
+  int i;
+  for (i = 0; i < words; i++)
+    dst[i] = src[i];
+}
+
+static void setUnion(Live_set restrict dst, const unsigned long *restrict src,
+                     int words) {
+  int i;
+  for (i = 0; i < words; i++)
+    dst[i] |= src[i];
+}
+
+/* in = use | (out & ~def); tell if "in" changed. */
+static bool setTransfer(Live_set restrict in, const unsigned long *restrict use,
+                        const unsigned long *restrict out,
+                        const unsigned long *restrict def, int words) {
+  unsigned long changed = 0;
+  int i;
+  for (i = 0; i < words; i++) {
+    unsigned long v = use[i] | (out[i] & ~def[i]);
+    changed |= v ^ in[i];
+    in[i] = v;
+  }
+  return changed != 0;
+}
+
+static void setAdd(Live_set s, int num) {
+  s[num / WORD_BITS] |= 1UL << (num % WORD_BITS);
+}
+
+static void setRemove(Live_set s, int num) {
+  s[num / WORD_BITS] &= ~(1UL << (num % WORD_BITS));
+}
+
+bool Live_contains(Live_info l, Live_set s, Temp_temp t) {
+  int num = Temp_num(t);
+  if (num >= l->tempCount)
+    return FALSE;
+  return (s[num / WORD_BITS] >> (num % WORD_BITS)) & 1;
+}
+
+/* Step backwards over one instruction: live = (live - def) | use. */
+static void stepBack(Live_set live, G_node n) {
+  Temp_tempList p;
+  for (p = FG_def(n); p; p = p->tail)
+    setRemove(live, Temp_num(p->head));
+  for (p = FG_use(n); p; p = p->tail)
+    setAdd(live, Temp_num(p->head));
+}
+
+static void noteTemps(Live_info l, Temp_tempList p) {
+  for (; p; p = p->tail)
+    l->temps[Temp_num(p->head)] = p->head;
+}
+
+/* Basic blocks */
+
+static bool isLeader(Live_info l, G_node n) {
+  int predCount, succCount;
+  const int *preds = G_predKeys(n, &predCount);
+  if (G_key(n) == 0 || predCount != 1 || preds[0] == G_key(n))
+    return TRUE;
+  G_succKeys(G_nodeWithKey(l->flow, preds[0]), &succCount);
+  return succCount != 1;
+}
+
+static void findBlocks(Live_info l) {
+  int count = G_nodeCount(l->flow), key, next = 0, b;
+  l->blockOf = AR_alloc(AR_liveness, count * sizeof(int));
+  l->indexOf = AR_alloc(AR_liveness, count * sizeof(int));
+  l->blockNodes = AR_alloc(AR_liveness, count * sizeof(int));
+  l->blockStart = AR_alloc(AR_liveness, (count + 1) * sizeof(int));
+  for (key = 0; key < count; key++)
+    l->blockOf[key] = -1;
+  l->blockCount = 0;
+  /* Leaders start blocks. The second round picks up cycles of non-leaders
+   * that can't be reached from any leader. */
+  for (b = 0; b < 2; b++)
+    for (key = 0; key < count; key++) {
+      G_node n = G_nodeWithKey(l->flow, key);
+      int index = 0;
+      if (l->blockOf[key] >= 0 || (b == 0 && !isLeader(l, n)))
+        continue;
+      l->blockStart[l->blockCount] = next;
+      for (;;) {
+        int succCount;
+        const int *succs;
+        l->blockOf[G_key(n)] = l->blockCount;
+        l->indexOf[G_key(n)] = index++;
+        l->blockNodes[next++] = G_key(n);
+        succs = G_succKeys(n, &succCount);
+        if (succCount != 1 || l->blockOf[succs[0]] >= 0)
+          break;
+        n = G_nodeWithKey(l->flow, succs[0]);
+        if (isLeader(l, n))
+          break;
+      }
+      l->blockCount++;
+    }
+  l->blockStart[l->blockCount] = next;
+}
+
+static int blockLast(Live_info l, int b) {
+  return l->blockNodes[l->blockStart[b + 1] - 1];
+}
+
+/* Blocks in postorder of a depth-first walk from the entry, followed by
+ * any blocks the walk didn't reach. */
+static int *postorder(Live_info l) {
+  int *order = AR_alloc(AR_liveness, l->blockCount * sizeof(int));
+  int *stack = AR_alloc(AR_liveness, l->blockCount * sizeof(int));
+  int *nextSucc = AR_alloc(AR_liveness, l->blockCount * sizeof(int));
+  bool *seen = AR_alloc(AR_liveness, l->blockCount * sizeof(bool));
+  int done = 0, root;
+  memset(seen, 0, l->blockCount * sizeof(bool));
+  for (root = 0; root < l->blockCount; root++) {
+    int top = 0;
+    if (seen[root])
+      continue;
+    seen[root] = TRUE;
+    nextSucc[root] = 0;
+    stack[top++] = root;
+    while (top > 0) {
+      int b = stack[top - 1], succCount;
+      const int *succs =
+          G_succKeys(G_nodeWithKey(l->flow, blockLast(l, b)), &succCount);
+      if (nextSucc[b] < succCount) {
+        int s = l->blockOf[succs[nextSucc[b]++]];
+        if (!seen[s]) {
+          seen[s] = TRUE;
+          nextSucc[s] = 0;
+          stack[top++] = s;
+        }
+      } else {
+        order[done++] = b;
+        top--;
+      }
+    }
+  }
+  return order;
+}
+
+static void solve(Live_info l) {
+  int *order = postorder(l);
+  int *queue = AR_alloc(AR_liveness, (l->blockCount + 1) * sizeof(int));
+  bool *queued = AR_alloc(AR_liveness, l->blockCount * sizeof(bool));
+  int head = 0, tail = 0, size = l->blockCount + 1, i;
+  for (i = 0; i < l->blockCount; i++) {
+    queue[tail++] = order[i];
+    queued[order[i]] = TRUE;
+  }
+  while (head != tail) {
+    int b = queue[head], succCount, predCount;
+    Live_set out = blockSet(l, l->out, b);
+    G_node first = G_nodeWithKey(l->flow, l->blockNodes[l->blockStart[b]]);
+    const int *succs, *preds;
+    head = (head + 1) % size;
+    queued[b] = FALSE;
+    succs = G_succKeys(G_nodeWithKey(l->flow, blockLast(l, b)), &succCount);
+    memset(out, 0, l->words * sizeof(unsigned long));
+    for (i = 0; i < succCount; i++)
+      setUnion(out, blockSet(l, l->in, l->blockOf[succs[i]]), l->words);
+    if (!setTransfer(blockSet(l, l->in, b), blockSet(l, l->use, b), out,
+                     blockSet(l, l->def, b), l->words))
+      continue;
+    preds = G_predKeys(first, &predCount);
+    for (i = 0; i < predCount; i++) {
+      int p = l->blockOf[preds[i]];
+      if (!queued[p]) {
+        queued[p] = TRUE;
+        queue[tail] = p;
+        tail = (tail + 1) % size;
+      }
+    }
+  }
+}
+
+Live_info Live_analyze(G_graph flow) {
+  Live_info l = AR_alloc(AR_liveness, sizeof(*l));
+  int b, maxLength = 0;
+  l->flow = flow;
+  l->tempCount = Temp_count();
+  l->words = (l->tempCount + WORD_BITS - 1) / WORD_BITS;
+  l->temps = AR_alloc(AR_liveness, l->tempCount * sizeof(Temp_temp));
+  memset(l->temps, 0, l->tempCount * sizeof(Temp_temp));
+  findBlocks(l);
+  l->in = newSets(l, l->blockCount);
+  l->out = newSets(l, l->blockCount);
+  l->use = newSets(l, l->blockCount);
+  l->def = newSets(l, l->blockCount);
+
+  /* Walk each block backwards: a use is upward exposed unless a later
+   * step back over a definition of the same temp removes it. */
+  for (b = 0; b < l->blockCount; b++) {
+    Live_set use = blockSet(l, l->use, b), def = blockSet(l, l->def, b);
+    int i, length = l->blockStart[b + 1] - l->blockStart[b];
+    for (i = l->blockStart[b + 1] - 1; i >= l->blockStart[b]; i--) {
+      G_node n = G_nodeWithKey(flow, l->blockNodes[i]);
+      Temp_tempList p;
+      noteTemps(l, FG_def(n));
+      noteTemps(l, FG_use(n));
+      for (p = FG_def(n); p; p = p->tail)
+        setAdd(def, Temp_num(p->head));
+      stepBack(use, n);
+    }
+    if (length > maxLength)
+      maxLength = length;
+  }
+  solve(l);
+  l->cachedBlock = -1;
+  l->cache = newSets(l, maxLength);
+  return l;
+}
+
+int Live_setWords(Live_info l) { return l->words; }
+
+static Live_set cachedOut(Live_info l, int b, int index) {
+  if (l->cachedBlock != b) {
+    int i, length = l->blockStart[b + 1] - l->blockStart[b];
+    Live_set live = blockSet(l, l->cache, length - 1);
+    setCopy(live, blockSet(l, l->out, b), l->words);
+    for (i = length - 1; i > 0; i--) {
+      Live_set before = blockSet(l, l->cache, i - 1);
+      setCopy(before, blockSet(l, l->cache, i), l->words);
+      stepBack(before,
+               G_nodeWithKey(l->flow, l->blockNodes[l->blockStart[b] + i]));
+    }
+    l->cachedBlock = b;
+  }
+  return blockSet(l, l->cache, index);
+}
+
+Live_set Live_out(Live_info l, G_node n) {
+  int key = G_key(n);
+  return cachedOut(l, l->blockOf[key], l->indexOf[key]);
+}
+
+Live_set Live_in(Live_info l, G_node n) {
+  int key = G_key(n), b = l->blockOf[key];
+  /* Inside a block, what is live into an instruction is what is live out
+   * of the one before it. */
+  if (l->indexOf[key] == 0)
+    return blockSet(l, l->in, b);
+  return cachedOut(l, b, l->indexOf[key] - 1);
+}
+
+Temp_temp Live_temp(Live_info l, int num) {
+  assert(num >= 0 && num < l->tempCount);
+  return l->temps[num];
+}
+
+Temp_tempList Live_list(Live_info l, Live_set s) {
+  Temp_tempList list = NULL;
+  int w;
+  for (w = l->words - 1; w >= 0; w--) {
+    int bit;
+    if (!s[w])
+      continue;
+    for (bit = WORD_BITS - 1; bit >= 0; bit--)
+      if ((s[w] >> bit) & 1)
+        list = Temp_TempList(l->temps[w * WORD_BITS + bit], list);
+  }
+  return list;
+}
+
+/* Interference graph */
+
+static unsigned long *pairWord(Live_graph g, int a, int b, unsigned long *bit) {
+  size_t index;
+  if (a < b) {
+    int t = a;
+    a = b;
+    b = t;
+  }
+  index = (size_t)a * (a - 1) / 2 + b;
+  *bit = 1UL << (index % WORD_BITS);
+  return &g->matrix[index / WORD_BITS];
+}
+
+bool Live_interferes(Live_graph g, int a, int b) {
+  unsigned long bit;
+  if (a == b)
+    return FALSE;
+  return (*pairWord(g, a, b, &bit) & bit) != 0;
+}
+
+/* Append "x" to an array that grows in the liveness arena. */
+static void push(int **array, int *count, int *capacity, int x) {
+  if (*count == *capacity) {
+    int *old = *array;
+    *capacity = *capacity ? 2 * *capacity : 4;
+    *array = AR_alloc(AR_liveness, *capacity * sizeof(int));
+    if (*count)
+      memcpy(*array, old, *count * sizeof(int));
+  }
+  (*array)[(*count)++] = x;
+}
+
+void Live_addEdge(Live_graph g, int a, int b) {
+  unsigned long bit, *word;
+  if (a == b)
+    return;
+  word = pairWord(g, a, b, &bit);
+  if (*word & bit)
+    return;
+  *word |= bit;
+  if (!g->precolored[a])
+    push(&g->adj[a], &g->degree[a], &g->adjCapacity[a], b);
+  if (!g->precolored[b])
+    push(&g->adj[b], &g->degree[b], &g->adjCapacity[b], a);
+}
+
+int Live_node(Live_graph g, Temp_temp t) {
+  int num = Temp_num(t);
+  return num < g->tempCount ? g->nodeOf[num] : -1;
+}
+
+static int *zeroedInts(int count) {
+  int *p = AR_alloc(AR_liveness, count * sizeof(int));
+  memset(p, 0, count * sizeof(int));
+  return p;
+}
+
+static Live_graph newGraph(Live_info l, Temp_map precolored) {
+  Live_graph g = AR_alloc(AR_liveness, sizeof(*g));
+  int num, n = 0;
+  size_t words;
+  g->tempCount = l->tempCount;
+  g->nodeOf = AR_alloc(AR_liveness, l->tempCount * sizeof(int));
+  for (num = 0; num < l->tempCount; num++)
+    g->nodeOf[num] = l->temps[num] ? n++ : -1;
+  g->nodeCount = n;
+  g->temps = AR_alloc(AR_liveness, n * sizeof(Temp_temp));
+  g->precolored = AR_alloc(AR_liveness, n * sizeof(bool));
+  for (num = 0; num < l->tempCount; num++)
+    if (l->temps[num]) {
+      Temp_temp t = l->temps[num];
+      g->temps[g->nodeOf[num]] = t;
+      g->precolored[g->nodeOf[num]] =
+          precolored && Temp_look(precolored, t) != NULL;
+    }
+  g->degree = zeroedInts(n);
+  g->adjCapacity = zeroedInts(n);
+  g->adj = AR_alloc(AR_liveness, n * sizeof(int *));
+  memset(g->adj, 0, n * sizeof(int *));
+  words = ((size_t)n * (n - 1) / 2 + WORD_BITS - 1) / WORD_BITS + 1;
+  g->matrix = AR_alloc(AR_liveness, words * sizeof(unsigned long));
+  memset(g->matrix, 0, words * sizeof(unsigned long));
+  g->moveCount = 0;
+  g->moves = NULL;
+  g->nodeMoveCount = zeroedInts(n);
+  g->nodeMoveCapacity = zeroedInts(n);
+  g->nodeMoves = AR_alloc(AR_liveness, n * sizeof(int *));
+  memset(g->nodeMoves, 0, n * sizeof(int *));
+  return g;
+}
+
+static void addMove(Live_graph g, int src, int dst, int *capacity) {
+  if (g->moveCount == *capacity) {
+    Live_move *old = g->moves;
+    *capacity = *capacity ? 2 * *capacity : 16;
+    g->moves = AR_alloc(AR_liveness, *capacity * sizeof(Live_move));
+    if (old)
+      memcpy(g->moves, old, g->moveCount * sizeof(Live_move));
+  }
+  g->moves[g->moveCount].src = src;
+  g->moves[g->moveCount].dst = dst;
+  push(&g->nodeMoves[src], &g->nodeMoveCount[src], &g->nodeMoveCapacity[src],
+       g->moveCount);
+  push(&g->nodeMoves[dst], &g->nodeMoveCount[dst], &g->nodeMoveCapacity[dst],
+       g->moveCount);
+  g->moveCount++;
+}
+
+/* Make node "d" interfere with every temp in "live". */
+static void interfereWithLive(Live_graph g, Live_set live, int words, int d) {
+  int w;
+  for (w = 0; w < words; w++) {
+    unsigned long bits = live[w];
+    while (bits) {
+      int num = w * WORD_BITS + __builtin_ctzl(bits);
+      bits &= bits - 1;
+      Live_addEdge(g, d, g->nodeOf[num]);
+    }
+  }
+}
+
+Live_graph Live_interference(Live_info l, Temp_map precolored) {
+  Live_graph g = newGraph(l, precolored);
+  Live_set live = newSets(l, 1);
+  int b, i, moveCapacity = 0;
+  for (b = 0; b < l->blockCount; b++) {
+    setCopy(live, blockSet(l, l->out, b), l->words);
+    for (i = l->blockStart[b + 1] - 1; i >= l->blockStart[b]; i--) {
+      G_node n = G_nodeWithKey(l->flow, l->blockNodes[i]);
+      Temp_tempList defs = FG_def(n), uses = FG_use(n), p;
+      if (FG_isMove(n) && defs && uses && !defs->tail && !uses->tail) {
+        int src = Live_node(g, uses->head), dst = Live_node(g, defs->head);
+        /* The source and destination of a move may share a register, so
+         * the source doesn't count as live across the move. */
+        setRemove(live, Temp_num(uses->head));
+        if (src != dst)
+          addMove(g, src, dst, &moveCapacity);
+      }
+      /* Definitions interfere with each other and with everything live
+       * after the instruction, even if they are never used themselves. */
+      for (p = defs; p; p = p->tail)
+        setAdd(live, Temp_num(p->head));
+      for (p = defs; p; p = p->tail)
+        interfereWithLive(g, live, l->words, Live_node(g, p->head));
+      stepBack(live, n);
+    }
+  }
+  return g;
+}
@@ -0,0 +1,72 @@
+/*
+ * liveness.h - Liveness analysis over the flow graph of an instruction list.
+ *
+ * Sets of temps are bit vectors of Live_setWords words, in which temp t
+ * is bit Temp_num(t).
+ */
+
+typedef unsigned long *Live_set;
+typedef struct Live_info_ *Live_info;
+
+/* Solve the liveness equations for "flow", a graph made by
+ *  FG_AssemFlowGraph. */
+Live_info Live_analyze(G_graph flow);
+
+int Live_setWords(Live_info l);
+
+/* Get the temps live on entry to, or on exit from, the instruction at flow
+ *  node "n". Per-instruction sets are worked out for a whole basic block
+ *  the first time one of its nodes is asked about, and the result is only
+ *  valid until a node of another block is asked about. */
+Live_set Live_in(Live_info l, G_node n);
+Live_set Live_out(Live_info l, G_node n);
+
+/* Tell if "t" is in "s". Temps made after Live_analyze never are */
+bool Live_contains(Live_info l, Live_set s, Temp_temp t);
+
+/* Get the temp whose number is "num", if the flow graph mentions it */
+Temp_temp Live_temp(Live_info l, int num);
+
+/* Make a list of the temps in "s" */
+Temp_tempList Live_list(Live_info l, Live_set s);
+
+/* Interference graph. Node i stands for temp temps[i]; the nodes are the
+ *  temps mentioned by the function. Membership tests go through a
+ *  triangular bit matrix and iteration through per-node adjacency arrays.
+ *  As in George and Appel's allocator, precolored nodes have no adjacency
+ *  array and no degree: they interfere with too much to be worth one. */
+typedef struct {
+  int src, dst; /* nodes of the interference graph */
+} Live_move;
+
+typedef struct Live_graph_ *Live_graph;
+struct Live_graph_ {
+  int nodeCount;
+  Temp_temp *temps;
+  bool *precolored;
+  int *degree;
+  int **adj;
+  int *adjCapacity;
+  unsigned long *matrix; /* bit a*(a-1)/2+b is set when a > b interfere */
+  int moveCount;         /* moves between two different temps */
+  Live_move *moves;
+  int **nodeMoves; /* indexes into "moves" of the moves of each node */
+  int *nodeMoveCount, *nodeMoveCapacity;
+  int *nodeOf; /* node of each temp number, or -1 */
+  int tempCount;
+};
+
+/* Build the interference graph of the function analysed by "l" in one
+ *  backward sweep over its blocks. Temps that have a name in "precolored"
+ *  (which may be NULL) are machine registers. A move does not make its
+ *  source and destination interfere; moves are recorded separately. */
+Live_graph Live_interference(Live_info l, Temp_map precolored);
+
+/* Get the node of "t", or -1 if "t" isn't in the graph */
+int Live_node(Live_graph g, Temp_temp t);
+
+/* Tell if nodes "a" and "b" interfere */
+bool Live_interferes(Live_graph g, int a, int b);
+
+/* Make nodes "a" and "b" interfere */
+void Live_addEdge(Live_graph g, int a, int b);
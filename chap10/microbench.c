@@ -0,0 +1,390 @@
+/*
+ * microbench.c - Time the data structures every phase is built on.
+ *
+ * Each benchmark works one structure the way the compiler does: interning
+ * names and looking them up again, entering and looking up bindings in
+ * tables with scopes opened and closed around them, making temps and
+ * looking their names up through layered maps, and adding and querying
+ * the edges of large graphs. The inputs come from a seeded generator, so
+ * they are the same on every run; each benchmark is repeated and the
+ * least and the median time per operation are printed, and written to a
+ * file as JSON with -o, so that two builds of the structures can be set
+ * side by side.
+ *
+ *   microbench [-scale n] [-repeat n] [-seed n] [-o file] [name ...]
+ *
+ * With names, only the benchmarks whose names begin with one of them run.
+ *
+ * Build it from a directory holding the chap7, chap9 and chap10 sources:
+ *
+ *   cc -O2 -o microbench microbench.c graph.c temp.c table.c symbol.c
+ *     arena.c context.c util.c -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "table.h"
+#include "temp.h"
+#include "graph.h"
+
+static unsigned long seed = 1;
+static int scale = 1;
+static double elapsed; /* nanoseconds between start and stop */
+static struct timespec started;
+
+static int randInt(int n) {
+  seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+  return (int)((seed >> 33) % n);
+}
+
+/* Only the time between start and stop counts; making the inputs and
+ * checking the outputs does not. */
+static void start(void) { clock_gettime(CLOCK_MONOTONIC, &started); }
+
+static void stop(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  elapsed += (t.tv_sec - started.tv_sec) * 1e9 + (t.tv_nsec - started.tv_nsec);
+}
+
+/* Names like those of a program: short, with shared prefixes. "round"
+ * makes them differ from the names of other rounds. */
+static string *makeNames(int count, int round) {
+  static const char *stems[] = {"i", "n", "tmp", "count", "node", "list",
+                                "printint", "row", "diag", "x"};
+  string *names = checked_malloc(count * sizeof(string));
+  int i;
+  for (i = 0; i < count; i++) {
+    char buf[40];
+    sprintf(buf, "%s%d_%d", stems[randInt(10)], i, round);
+    names[i] = String(buf);
+  }
+  return names;
+}
+
+static void freeNames(string *names, int count) {
+  int i;
+  for (i = 0; i < count; i++)
+    free(names[i]);
+  free(names);
+}
+
+/* Each benchmark is run once per round, and returns the operations it
+ * timed. */
+static int round_;
+
+static long symbolIntern(void) {
+  int i, n = 100000 * scale;
+  string *names = makeNames(n, round_);
+  start();
+  for (i = 0; i < n; i++)
+    S_Symbol(names[i]);
+  stop();
+  freeNames(names, n);
+  return n;
+}
+
+static long symbolLookup(void) {
+  int i, n = 100000 * scale, lookups = 10 * n;
+  string *names, *again;
+  unsigned long saved = seed;
+  names = makeNames(n, -1);
+  for (i = 0; i < n; i++)
+    S_Symbol(names[i]);
+  seed = saved;
+  again = makeNames(n, -1); /* equal strings at other addresses */
+  start();
+  for (i = 0; i < lookups; i++)
+    S_Symbol(again[i % n]);
+  stop();
+  freeNames(names, n);
+  freeNames(again, n);
+  return lookups;
+}
+
+static long symbolSlice(void) {
+  int i, n = 100000 * scale, lookups = 10 * n, *offsets, *lengths;
+  string *names = makeNames(n, -1);
+  char *text;
+  size_t size = 0;
+  FILE *out = open_memstream(&text, &size);
+  offsets = checked_malloc(n * sizeof(int));
+  lengths = checked_malloc(n * sizeof(int));
+  for (i = 0; i < n; i++) {
+    offsets[i] = ftell(out);
+    lengths[i] = strlen(names[i]);
+    fprintf(out, "%s ", names[i]);
+  }
+  fclose(out);
+  start();
+  for (i = 0; i < lookups; i++)
+    S_SymbolSlice(text + offsets[i % n], lengths[i % n]);
+  stop();
+  free(text);
+  free(offsets);
+  free(lengths);
+  freeNames(names, n);
+  return lookups;
+}
+
+static long tableEnterLook(void) {
+  int i, n = 200000 * scale, *keys = checked_malloc(n * sizeof(int));
+  TAB_table t;
+  AR_reset(AR_table);
+  start();
+  t = TAB_empty();
+  for (i = 0; i < n; i++)
+    TAB_enter(t, &keys[i], &keys[i]);
+  for (i = 0; i < n; i++)
+    if (TAB_look(t, &keys[randInt(n)]) == NULL)
+      abort();
+  stop();
+  free(keys);
+  return 2L * n;
+}
+
+/* Scopes opened and closed as the lets and functions of a program are:
+ * a few bindings each, some shadowing, most lookups finding an outer
+ * binding. */
+static long tableScopes(void) {
+  enum { POOL = 1024, DEPTH = 8 };
+  int i, j, depth = 0, rounds = 50000 * scale;
+  long ops = 0;
+  S_symbol pool[POOL];
+  S_table t;
+  for (i = 0; i < POOL; i++) {
+    char buf[20];
+    sprintf(buf, "v%d", i);
+    pool[i] = S_Symbol(buf);
+  }
+  AR_reset(AR_table);
+  t = S_empty();
+  for (i = 0; i < POOL; i++)
+    S_enter(t, pool[i], pool[i]);
+  start();
+  for (i = 0; i < rounds; i++) {
+    if (depth < DEPTH && (depth == 0 || randInt(2))) {
+      S_beginScope(t);
+      depth++;
+      for (j = randInt(8); j >= 0; j--, ops++)
+        S_enter(t, pool[randInt(POOL)], pool);
+    } else {
+      S_endScope(t);
+      depth--;
+    }
+    for (j = 0; j < 16; j++, ops++)
+      if (!S_look(t, pool[randInt(POOL)]))
+        abort();
+    ops++;
+  }
+  for (; depth > 0; depth--)
+    S_endScope(t);
+  stop();
+  return ops;
+}
+
+static long tempNew(void) {
+  int i, n = 1000000 * scale;
+  AR_reset(AR_temp);
+  Temp_reset();
+  start();
+  for (i = 0; i < n; i++)
+    Temp_newtemp();
+  stop();
+  return n;
+}
+
+/* The maps of the register allocator: the machine registers at the
+ * bottom, the names of the temps above them and the coloring on top. */
+static long tempLayeredLook(void) {
+  enum { LAYERS = 4 };
+  int i, n = 100000 * scale, lookups = 10 * n;
+  Temp_temp *temps = checked_malloc(n * sizeof(Temp_temp));
+  Temp_map maps[LAYERS], m = NULL;
+  AR_reset(AR_temp);
+  Temp_reset();
+  for (i = 0; i < LAYERS; i++)
+    maps[i] = Temp_empty();
+  for (i = 0; i < n; i++) {
+    temps[i] = Temp_newtemp();
+    /* a tenth of the temps go unnamed */
+    if (randInt(10))
+      Temp_enter(maps[i < 8 ? 0 : 1 + randInt(LAYERS - 1)], temps[i], "r");
+  }
+  for (i = 0; i < LAYERS; i++)
+    m = Temp_layerMap(maps[i], m);
+  start();
+  for (i = 0; i < lookups; i++)
+    Temp_look(m, temps[randInt(n)]);
+  stop();
+  free(temps);
+  return lookups;
+}
+
+static G_graph randomGraph(int nodes, int edges, bool timed) {
+  G_graph g;
+  G_node *n = checked_malloc(nodes * sizeof(G_node));
+  int i;
+  AR_reset(AR_graph);
+  g = G_Graph();
+  for (i = 0; i < nodes; i++)
+    n[i] = G_Node(g, NULL);
+  if (timed)
+    start();
+  for (i = 0; i < edges; i++)
+    G_addEdge(n[randInt(nodes)], n[randInt(nodes)]);
+  if (timed)
+    stop();
+  free(n);
+  return g;
+}
+
+static long graphAddEdge(void) {
+  int edges = 200000 * scale;
+  randomGraph(20000 * scale, edges, TRUE);
+  return edges;
+}
+
+static long graphSucc(void) {
+  int i, nodes = 20000 * scale, passes = 10;
+  long walked = 0;
+  G_graph g = randomGraph(nodes, 10 * nodes, FALSE);
+  start();
+  for (i = 0; i < passes; i++) {
+    G_nodeList p, s;
+    for (p = G_nodes(g); p; p = p->tail)
+      for (s = G_succ(p->head); s; s = s->tail)
+        walked++;
+  }
+  stop();
+  if (walked == 0)
+    abort();
+  return (long)passes * nodes;
+}
+
+static long goesTo(bool matrix) {
+  int i, nodes = 5000 * scale, queries = 1000000 * scale, found = 0;
+  G_graph g = randomGraph(nodes, 20 * nodes, FALSE);
+  if (matrix)
+    G_useMatrix(g);
+  start();
+  for (i = 0; i < queries; i++)
+    found += G_goesTo(G_nodeWithKey(g, randInt(nodes)),
+                      G_nodeWithKey(g, randInt(nodes)));
+  stop();
+  if (found < 0)
+    abort();
+  return queries;
+}
+
+static long graphGoesTo(void) { return goesTo(FALSE); }
+
+static long graphGoesToMatrix(void) { return goesTo(TRUE); }
+
+static struct {
+  string name;
+  long (*run)(void);
+} benchmarks[] = {
+    {"symbol.intern", symbolIntern},
+    {"symbol.lookup", symbolLookup},
+    {"symbol.slice", symbolSlice},
+    {"table.enterLook", tableEnterLook},
+    {"table.scopes", tableScopes},
+    {"temp.newtemp", tempNew},
+    {"temp.layeredLook", tempLayeredLook},
+    {"graph.addEdge", graphAddEdge},
+    {"graph.succ", graphSucc},
+    {"graph.goesTo", graphGoesTo},
+    {"graph.goesToMatrix", graphGoesToMatrix},
+};
+
+static int compareDoubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return x < y ? -1 : x > y;
+}
+
+static bool chosen(string name, int argc, string *argv) {
+  int i;
+  if (argc == 0)
+    return TRUE;
+  for (i = 0; i < argc; i++)
+    if (!strncmp(name, argv[i], strlen(argv[i])))
+      return TRUE;
+  return FALSE;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: microbench [-scale n] [-repeat n] [-seed n] "
+                  "[-o file] [name ...]\n");
+  exit(1);
+}
+
+int main(int argc, string *argv) {
+  int i, k, repeat = 5, count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+  unsigned long firstSeed;
+  string fname = NULL;
+  FILE *json = NULL;
+  bool first = TRUE;
+  for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if (i + 1 == argc)
+      usage();
+    if (!strcmp(argv[i], "-scale"))
+      scale = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-repeat"))
+      repeat = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-seed"))
+      seed = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "-o"))
+      fname = argv[++i];
+    else
+      usage();
+  }
+  if (scale < 1 || repeat < 1)
+    usage();
+  if (fname && !(json = fopen(fname, "w"))) {
+    perror(fname);
+    return 1;
+  }
+  firstSeed = seed;
+  if (json)
+    fprintf(json, "{\"seed\": %lu, \"scale\": %d, \"repeat\": %d, "
+                  "\"benchmarks\": [",
+            firstSeed, scale, repeat);
+  printf("%-20s %12s %12s %12s\n", "benchmark", "operations", "min ns/op",
+         "median ns/op");
+  for (k = 0; k < count; k++) {
+    double *times;
+    long ops = 0;
+    if (!chosen(benchmarks[k].name, argc - i, argv + i))
+      continue;
+    times = checked_malloc(repeat * sizeof(double));
+    /* Every benchmark starts from the same seed, so that the inputs of one
+     * do not depend on which others ran. */
+    seed = firstSeed;
+    for (round_ = 0; round_ < repeat; round_++) {
+      elapsed = 0;
+      ops = benchmarks[k].run();
+      times[round_] = elapsed / ops;
+    }
+    qsort(times, repeat, sizeof(double), compareDoubles);
+    printf("%-20s %12ld %12.2f %12.2f\n", benchmarks[k].name, ops, times[0],
+           times[repeat / 2]);
+    if (json)
+      fprintf(json, "%s\n  {\"name\": \"%s\", \"operations\": %ld, "
+                    "\"min_ns\": %.3f, \"median_ns\": %.3f}",
+              first ? "" : ",", benchmarks[k].name, ops, times[0],
+              times[repeat / 2]);
+    first = FALSE;
+    free(times);
+  }
+  if (json) {
+    fprintf(json, "\n]}\n");
+    fclose(json);
+  }
+  return 0;
+}
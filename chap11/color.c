@@ -0,0 +1,408 @@
+/*
+ * color.c - Graph coloring by iterated register coalescing, after George
+ *           and Appel.
+ *
+ * Every node of the interference graph is on exactly one of the node lists
+ * below, and every move on exactly one of the move lists. The lists are
+ * doubly linked through arrays indexed by node or by move, and each element
+ * records the list it is on, so both moving an element to another list and
+ * asking which list it is on take constant time.
+ */
+
+#include <stdio.h>
+#include <limits.h>
+#include <string.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "absyn.h"
+#include "assem.h"
+#include "frame.h"
+#include "graph.h"
+#include "liveness.h"
+#include "color.h"
+
+#define WORD_BITS (8 * sizeof(unsigned long))
+#define INFINITE_DEGREE (INT_MAX / 2)
+
+enum {
+  N_precolored,
+  N_simplify, /* low degree and not move related */
+  N_freeze,   /* low degree and move related */
+  N_spill,    /* high degree */
+  N_select,   /* removed from the graph, waiting for a color */
+  N_coalesced,
+  N_colored,
+  N_spilled,
+  N_numLists
+};
+
+enum {
+  M_worklist, /* might be coalesced */
+  M_active,   /* not ready to be coalesced yet */
+  M_coalesced,
+  M_constrained, /* source and destination interfere, or can't be merged */
+  M_frozen,      /* no longer considered for coalescing */
+  M_numLists
+};
+
+typedef struct {
+  int head[N_numLists];
+  int *next, *prev; /* -1 at the ends */
+  int *on;          /* list each element is on */
+} listSet;
+
+typedef struct colorState_ *colorState;
+struct colorState_ {
+  Live_graph g;
+  int K;
+  listSet nodes, moves;
+  int *degree; /* current degree, INFINITE_DEGREE for precolored nodes */
+  int *alias;  /* node a coalesced node was merged into */
+  int *color;  /* index into regs, or -1 */
+  int **moveList, *moveCount, *moveCapacity; /* moves of each node */
+  int *mark, stamp; /* to count each neighbour once in briggsTest */
+  const double *spillCost;
+};
+
+static int *newInts(int count) {
+  return AR_alloc(AR_regalloc, (count ? count : 1) * sizeof(int));
+}
+
+static void initLists(listSet *s, int count) {
+  int i;
+  for (i = 0; i < N_numLists; i++)
+    s->head[i] = -1;
+  s->next = newInts(count);
+  s->prev = newInts(count);
+  s->on = newInts(count);
+}
+
+static void push(listSet *s, int list, int x) {
+  s->on[x] = list;
+  s->prev[x] = -1;
+  s->next[x] = s->head[list];
+  if (s->head[list] >= 0)
+    s->prev[s->head[list]] = x;
+  s->head[list] = x;
+}
+
+static void moveTo(listSet *s, int x, int list) {
+  if (s->prev[x] >= 0)
+    s->next[s->prev[x]] = s->next[x];
+  else
+    s->head[s->on[x]] = s->next[x];
+  if (s->next[x] >= 0)
+    s->prev[s->next[x]] = s->prev[x];
+  push(s, list, x);
+}
+
+static bool isPrecolored(colorState s, int n) {
+  return s->nodes.on[n] == N_precolored;
+}
+
+/* Precolored nodes outside "regs", such as the frame and stack pointers,
+ * have no color. Nothing may be merged into them: the instructions that
+ * define the merged temp would then change the register itself. */
+static bool isReserved(colorState s, int n) {
+  return isPrecolored(s, n) && s->color[n] < 0;
+}
+
+/* Nodes that are still in the graph */
+static bool isPresent(colorState s, int n) {
+  return s->nodes.on[n] != N_select && s->nodes.on[n] != N_coalesced;
+}
+
+static bool isLive(colorState s, int m) {
+  return s->moves.on[m] == M_worklist || s->moves.on[m] == M_active;
+}
+
+static bool moveRelated(colorState s, int n) {
+  int i;
+  for (i = 0; i < s->moveCount[n]; i++)
+    if (isLive(s, s->moveList[n][i]))
+      return TRUE;
+  return FALSE;
+}
+
+static int getAlias(colorState s, int n) {
+  while (s->nodes.on[n] == N_coalesced)
+    n = s->alias[n];
+  return n;
+}
+
+static void enableMoves(colorState s, int n) {
+  int i;
+  for (i = 0; i < s->moveCount[n]; i++)
+    if (s->moves.on[s->moveList[n][i]] == M_active)
+      moveTo(&s->moves, s->moveList[n][i], M_worklist);
+}
+
+static void decrementDegree(colorState s, int m) {
+  int i, d = s->degree[m]--;
+  if (d != s->K || s->nodes.on[m] != N_spill)
+    return;
+  enableMoves(s, m);
+  for (i = 0; i < s->g->degree[m]; i++)
+    if (isPresent(s, s->g->adj[m][i]))
+      enableMoves(s, s->g->adj[m][i]);
+  moveTo(&s->nodes, m, moveRelated(s, m) ? N_freeze : N_simplify);
+}
+
+static void addEdge(colorState s, int u, int v) {
+  if (u == v || Live_interferes(s->g, u, v))
+    return;
+  Live_addEdge(s->g, u, v);
+  if (!isPrecolored(s, u))
+    s->degree[u]++;
+  if (!isPrecolored(s, v))
+    s->degree[v]++;
+}
+
+static void addWorkList(colorState s, int u) {
+  if (s->nodes.on[u] == N_freeze && !moveRelated(s, u) && s->degree[u] < s->K)
+    moveTo(&s->nodes, u, N_simplify);
+}
+
+/* George: "v" may be merged into the precolored "u" if each neighbour of
+ * "v" is insignificant, precolored, or already a neighbour of "u". */
+static bool georgeTest(colorState s, int u, int v) {
+  int i;
+  for (i = 0; i < s->g->degree[v]; i++) {
+    int t = s->g->adj[v][i];
+    if (isPresent(s, t) && s->degree[t] >= s->K && !isPrecolored(s, t) &&
+        !Live_interferes(s->g, t, u))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/* Briggs: "u" and "v" may be merged if the result has fewer than K
+ * neighbours of significant degree. */
+static bool briggsTest(colorState s, int u, int v) {
+  int pass, i, k = 0;
+  s->stamp++;
+  for (pass = 0; pass < 2; pass++) {
+    int n = pass ? v : u;
+    for (i = 0; i < s->g->degree[n]; i++) {
+      int t = s->g->adj[n][i];
+      if (!isPresent(s, t) || s->mark[t] == s->stamp)
+        continue;
+      s->mark[t] = s->stamp;
+      if (s->degree[t] >= s->K && ++k >= s->K)
+        return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+static void combine(colorState s, int u, int v) {
+  int i;
+  moveTo(&s->nodes, v, N_coalesced);
+  s->alias[v] = u;
+  for (i = 0; i < s->moveCount[v]; i++) {
+    if (s->moveCount[u] == s->moveCapacity[u]) {
+      int *old = s->moveList[u];
+      s->moveCapacity[u] = 2 * s->moveCapacity[u] + 4;
+      s->moveList[u] = newInts(s->moveCapacity[u]);
+      if (s->moveCount[u])
+        memcpy(s->moveList[u], old, s->moveCount[u] * sizeof(int));
+    }
+    s->moveList[u][s->moveCount[u]++] = s->moveList[v][i];
+  }
+  enableMoves(s, v);
+  for (i = 0; i < s->g->degree[v]; i++) {
+    int t = s->g->adj[v][i];
+    if (!isPresent(s, t))
+      continue;
+    addEdge(s, t, u);
+    decrementDegree(s, t);
+  }
+  if (s->degree[u] >= s->K && s->nodes.on[u] == N_freeze)
+    moveTo(&s->nodes, u, N_spill);
+}
+
+static void simplify(colorState s) {
+  int i, n = s->nodes.head[N_simplify];
+  moveTo(&s->nodes, n, N_select);
+  for (i = 0; i < s->g->degree[n]; i++)
+    if (isPresent(s, s->g->adj[n][i]))
+      decrementDegree(s, s->g->adj[n][i]);
+}
+
+static void coalesce(colorState s) {
+  int m = s->moves.head[M_worklist];
+  int x = getAlias(s, s->g->moves[m].src), y = getAlias(s, s->g->moves[m].dst);
+  int u = x, v = y;
+  if (isPrecolored(s, y)) {
+    u = y;
+    v = x;
+  }
+  if (u == v) {
+    moveTo(&s->moves, m, M_coalesced);
+    addWorkList(s, u);
+  } else if (isPrecolored(s, v) || isReserved(s, u) ||
+             Live_interferes(s->g, u, v)) {
+    moveTo(&s->moves, m, M_constrained);
+    addWorkList(s, u);
+    addWorkList(s, v);
+  } else if (isPrecolored(s, u) ? georgeTest(s, u, v) : briggsTest(s, u, v)) {
+    moveTo(&s->moves, m, M_coalesced);
+    combine(s, u, v);
+    addWorkList(s, u);
+  } else
+    moveTo(&s->moves, m, M_active);
+}
+
+static void freezeMoves(colorState s, int u) {
+  int i;
+  for (i = 0; i < s->moveCount[u]; i++) {
+    int m = s->moveList[u][i], x, y, v;
+    if (!isLive(s, m))
+      continue;
+    x = getAlias(s, s->g->moves[m].src);
+    y = getAlias(s, s->g->moves[m].dst);
+    v = y == getAlias(s, u) ? x : y;
+    moveTo(&s->moves, m, M_frozen);
+    addWorkList(s, v);
+  }
+}
+
+static void freeze(colorState s) {
+  int u = s->nodes.head[N_freeze];
+  moveTo(&s->nodes, u, N_simplify);
+  freezeMoves(s, u);
+}
+
+static void selectSpill(colorState s) {
+  int n, best = s->nodes.head[N_spill];
+  double bestCost = s->spillCost[best] / s->degree[best];
+  for (n = s->nodes.next[best]; n >= 0; n = s->nodes.next[n]) {
+    double cost = s->spillCost[n] / s->degree[n];
+    if (cost < bestCost) {
+      best = n;
+      bestCost = cost;
+    }
+  }
+  moveTo(&s->nodes, best, N_simplify);
+  freezeMoves(s, best);
+}
+
+static void assignColors(colorState s) {
+  unsigned long all = s->K == WORD_BITS ? ~0UL : (1UL << s->K) - 1;
+  int n;
+  while ((n = s->nodes.head[N_select]) >= 0) {
+    unsigned long ok = all;
+    int i;
+    for (i = 0; i < s->g->degree[n]; i++) {
+      int a = getAlias(s, s->g->adj[n][i]);
+      if (s->nodes.on[a] == N_colored || isPrecolored(s, a))
+        if (s->color[a] >= 0)
+          ok &= ~(1UL << s->color[a]);
+    }
+    if (ok) {
+      moveTo(&s->nodes, n, N_colored);
+      s->color[n] = __builtin_ctzl(ok);
+    } else
+      moveTo(&s->nodes, n, N_spilled);
+  }
+}
+
+static colorState newState(Live_graph g, Temp_tempList regs,
+                           const double *spillCost) {
+  colorState s = AR_alloc(AR_regalloc, sizeof(*s));
+  int n = g->nodeCount, i;
+  Temp_tempList p;
+  s->g = g;
+  s->spillCost = spillCost;
+  for (s->K = 0, p = regs; p; p = p->tail)
+    s->K++;
+  assert(s->K > 0 && s->K <= (int)WORD_BITS);
+  initLists(&s->nodes, n);
+  initLists(&s->moves, g->moveCount);
+  s->degree = newInts(n);
+  s->alias = newInts(n);
+  s->color = newInts(n);
+  s->mark = newInts(n);
+  s->stamp = 0;
+  s->moveList = AR_alloc(AR_regalloc, (n ? n : 1) * sizeof(int *));
+  s->moveCount = newInts(n);
+  s->moveCapacity = newInts(n);
+  for (i = 0; i < n; i++) {
+    /* Merging lists grow a copy, so the graph's own lists stay intact. */
+    s->moveList[i] = g->nodeMoves[i];
+    s->moveCount[i] = s->moveCapacity[i] = g->nodeMoveCount[i];
+    s->mark[i] = 0;
+    s->color[i] = -1;
+  }
+  for (i = g->moveCount - 1; i >= 0; i--)
+    push(&s->moves, M_worklist, i);
+  return s;
+}
+
+static void makeWorklist(colorState s, Temp_tempList regs) {
+  int n;
+  for (n = s->g->nodeCount - 1; n >= 0; n--) {
+    if (s->g->precolored[n]) {
+      Temp_tempList p;
+      int c = 0;
+      for (p = regs; p && p->head != s->g->temps[n]; p = p->tail)
+        c++;
+      s->color[n] = p ? c : -1;
+      s->degree[n] = INFINITE_DEGREE;
+      push(&s->nodes, N_precolored, n);
+    } else {
+      s->degree[n] = s->g->degree[n];
+      if (s->degree[n] >= s->K)
+        push(&s->nodes, N_spill, n);
+      else if (moveRelated(s, n))
+        push(&s->nodes, N_freeze, n);
+      else
+        push(&s->nodes, N_simplify, n);
+    }
+  }
+}
+
+struct COL_result COL_color(Live_graph ig, Temp_map initial,
+                            Temp_tempList regs, const double *spillCost) {
+  struct COL_result ret;
+  colorState s = newState(ig, regs, spillCost);
+  Temp_temp *regOf = AR_alloc(AR_regalloc, s->K * sizeof(Temp_temp));
+  Temp_map coloring = Temp_empty();
+  Temp_tempList p;
+  int n, c;
+
+  makeWorklist(s, regs);
+  for (;;)
+    if (s->nodes.head[N_simplify] >= 0)
+      simplify(s);
+    else if (s->moves.head[M_worklist] >= 0)
+      coalesce(s);
+    else if (s->nodes.head[N_freeze] >= 0)
+      freeze(s);
+    else if (s->nodes.head[N_spill] >= 0)
+      selectSpill(s);
+    else
+      break;
+  assignColors(s);
+
+  for (c = 0, p = regs; p; p = p->tail)
+    regOf[c++] = p->head;
+  ret.spills = NULL;
+  for (n = 0; n < ig->nodeCount; n++) {
+    int a = getAlias(s, n);
+    if (isPrecolored(s, n))
+      continue;
+    if (s->nodes.on[a] == N_spilled)
+      ret.spills = Temp_TempList(ig->temps[n], ret.spills);
+    else if (isPrecolored(s, a))
+      Temp_enter(coloring, ig->temps[n], Temp_look(initial, ig->temps[a]));
+    else
+      Temp_enter(coloring, ig->temps[n],
+                 Temp_look(initial, regOf[s->color[a]]));
+  }
+  ret.coloring = Temp_layerMap(coloring, initial);
+  return ret;
+}
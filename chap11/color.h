@@ -7,4 +7,11 @@ struct COL_result {
   Temp_map coloring;
   Temp_tempList spills;
 };
-struct COL_result COL_color(G_graph ig, Temp_map initial, Temp_tempList regs);
+
+/* Color "ig" with the registers in "regs" by iterated register coalescing.
+ *  "initial" names the precolored temps. "spillCost" gives, for each node
+ *  of "ig", how much it costs to keep that node in memory; the node with
+ *  the lowest cost per interference is spilled first. The coloring covers
+ *  every temp of the graph that isn't in "spills", layered over "initial". */
+struct COL_result COL_color(Live_graph ig, Temp_map initial,
+                            Temp_tempList regs, const double *spillCost);
@@ -0,0 +1,259 @@
+/*
+ * linscan.c - Linear scan register allocation, after Poletto and Sarkar.
+ *
+ * Positions are the keys of the flow graph, that is the order of the
+ * instructions as the trace scheduler left them. A temp's interval runs
+ * from the first to the last position where it is mentioned or live. It
+ * is enough to look at live sets where control doesn't just fall through
+ * from one position to the next: anywhere else, a live temp is covered by
+ * a mention before and after it, or by one of those live sets.
+ *
+ * Machine registers keep their exact positions instead: a register is busy
+ * wherever it is mentioned or live out, and a temp can only have it if it
+ * is free along the whole interval.
+ */
+
+#include <stdio.h>
+#include <limits.h>
+#include <string.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "absyn.h"
+#include "assem.h"
+#include "frame.h"
+#include "graph.h"
+#include "flowgraph.h"
+#include "liveness.h"
+#include "color.h"
+#include "table.h"
+#include "linscan.h"
+
+#define WORD_BITS (8 * sizeof(unsigned long))
+
+typedef struct {
+  int start, end; /* end is -1 for temps the function doesn't mention */
+  int reg;        /* index into regs, or -1 */
+  int hint;       /* register a move ties the temp to, or -1 */
+} interval;
+
+typedef struct scanState_ *scanState;
+struct scanState_ {
+  Live_info live;
+  int K, positions, tempCount;
+  Temp_temp *regOf;  /* the temp of each register */
+  int *regIndex;     /* index of each temp in regs, or -1 */
+  bool *precolored;  /* by temp number */
+  interval *iv;      /* by temp number */
+  int *busy;         /* K rows: busy positions of a register up to each one */
+  int active[64];    /* temps holding a register, by increasing end */
+  int activeCount;
+};
+
+static void extend(scanState s, int num, int pos) {
+  interval *v = &s->iv[num];
+  if (pos < v->start)
+    v->start = pos;
+  if (pos > v->end)
+    v->end = pos;
+}
+
+static void extendList(scanState s, Temp_tempList p, int pos) {
+  for (; p; p = p->tail)
+    extend(s, Temp_num(p->head), pos);
+}
+
+static void extendSet(scanState s, Live_set set, int pos) {
+  int w, words = Live_setWords(s->live);
+  for (w = 0; w < words; w++) {
+    unsigned long bits = set[w];
+    while (bits) {
+      extend(s, w * WORD_BITS + __builtin_ctzl(bits), pos);
+      bits &= bits - 1;
+    }
+  }
+}
+
+/* Registers mentioned in "p", as a mask of register indexes */
+static unsigned long regMask(scanState s, Temp_tempList p) {
+  unsigned long mask = 0;
+  for (; p; p = p->tail) {
+    int num = Temp_num(p->head);
+    if (num < s->tempCount && s->regIndex[num] >= 0)
+      mask |= 1UL << s->regIndex[num];
+  }
+  return mask;
+}
+
+static void noteHint(scanState s, G_node n) {
+  Temp_tempList d = FG_def(n), u = FG_use(n);
+  int dst, src;
+  if (!FG_isMove(n) || !d || !u || d->tail || u->tail)
+    return;
+  dst = Temp_num(d->head);
+  src = Temp_num(u->head);
+  if (s->regIndex[src] >= 0 && s->regIndex[dst] < 0)
+    s->iv[dst].hint = s->regIndex[src];
+  else if (s->regIndex[dst] >= 0 && s->regIndex[src] < 0)
+    s->iv[src].hint = s->regIndex[dst];
+}
+
+static void buildIntervals(scanState s, G_graph flow) {
+  int pos, c;
+  for (pos = 0; pos < s->positions; pos++) {
+    G_node n = G_nodeWithKey(flow, pos);
+    int predCount, succCount, i;
+    const int *preds = G_predKeys(n, &predCount);
+    const int *succs = G_succKeys(n, &succCount);
+    unsigned long busy;
+    extendList(s, FG_def(n), pos);
+    extendList(s, FG_use(n), pos);
+    if (predCount != 1 || preds[0] != pos - 1)
+      extendSet(s, Live_in(s->live, n), pos);
+    for (i = 0; i < succCount; i++)
+      if (succs[i] != pos + 1)
+        extendSet(s, Live_in(s->live, G_nodeWithKey(flow, succs[i])), pos);
+    noteHint(s, n);
+
+    busy = regMask(s, FG_def(n)) | regMask(s, FG_use(n));
+    for (c = 0; c < s->K; c++)
+      if (Live_contains(s->live, Live_out(s->live, n), s->regOf[c]))
+        busy |= 1UL << c;
+    for (c = 0; c < s->K; c++) {
+      int *row = s->busy + (size_t)c * (s->positions + 1);
+      row[pos + 1] = row[pos] + ((busy >> c) & 1);
+    }
+  }
+}
+
+/* Tell if register "c" is free from "start" to "end" */
+static bool regFree(scanState s, int c, int start, int end) {
+  int *row = s->busy + (size_t)c * (s->positions + 1);
+  return row[end + 1] == row[start];
+}
+
+static void activate(scanState s, int num) {
+  int i = s->activeCount++;
+  while (i > 0 && s->iv[s->active[i - 1]].end > s->iv[num].end) {
+    s->active[i] = s->active[i - 1];
+    i--;
+  }
+  s->active[i] = num;
+}
+
+static void deactivate(scanState s, int i) {
+  s->activeCount--;
+  memmove(&s->active[i], &s->active[i + 1],
+          (s->activeCount - i) * sizeof(int));
+}
+
+/* Sort the temps that need a register by the start of their interval. */
+static int *byStart(scanState s, int *count) {
+  int *first = AR_alloc(AR_regalloc, (s->positions + 1) * sizeof(int));
+  int *order, num, pos;
+  memset(first, 0, (s->positions + 1) * sizeof(int));
+  *count = 0;
+  for (num = 0; num < s->tempCount; num++)
+    if (s->iv[num].end >= 0 && !s->precolored[num]) {
+      first[s->iv[num].start + 1]++;
+      (*count)++;
+    }
+  for (pos = 0; pos < s->positions; pos++)
+    first[pos + 1] += first[pos];
+  order = AR_alloc(AR_regalloc, (*count ? *count : 1) * sizeof(int));
+  for (num = 0; num < s->tempCount; num++)
+    if (s->iv[num].end >= 0 && !s->precolored[num])
+      order[first[s->iv[num].start]++] = num;
+  return order;
+}
+
+struct COL_result LS_allocate(G_graph flow, Live_info live, Temp_map initial,
+                              Temp_tempList regs, TAB_table unspillable) {
+  struct COL_result ret;
+  scanState s = AR_alloc(AR_regalloc, sizeof(*s));
+  Temp_map coloring = Temp_empty();
+  Temp_tempList p;
+  unsigned long freeRegs;
+  int num, c, count, i, *order;
+
+  s->live = live;
+  s->positions = G_nodeCount(flow);
+  s->tempCount = Temp_count();
+  for (s->K = 0, p = regs; p; p = p->tail)
+    s->K++;
+  assert(s->K > 0 && s->K <= (int)WORD_BITS);
+  s->regOf = AR_alloc(AR_regalloc, s->K * sizeof(Temp_temp));
+  s->regIndex = AR_alloc(AR_regalloc, s->tempCount * sizeof(int));
+  s->iv = AR_alloc(AR_regalloc, s->tempCount * sizeof(interval));
+  for (num = 0; num < s->tempCount; num++) {
+    s->regIndex[num] = -1;
+    s->iv[num].start = INT_MAX;
+    s->iv[num].end = -1;
+    s->iv[num].reg = s->iv[num].hint = -1;
+  }
+  for (c = 0, p = regs; p; p = p->tail, c++) {
+    s->regOf[c] = p->head;
+    s->regIndex[Temp_num(p->head)] = c;
+  }
+  s->busy = AR_alloc(AR_regalloc,
+                     (size_t)s->K * (s->positions + 1) * sizeof(int));
+  for (c = 0; c < s->K; c++)
+    s->busy[(size_t)c * (s->positions + 1)] = 0;
+  buildIntervals(s, flow);
+  s->precolored = AR_alloc(AR_regalloc, s->tempCount * sizeof(bool));
+  for (num = 0; num < s->tempCount; num++)
+    s->precolored[num] =
+        s->iv[num].end >= 0 && Temp_look(initial, Live_temp(live, num));
+
+  order = byStart(s, &count);
+  s->activeCount = 0;
+  freeRegs = s->K == WORD_BITS ? ~0UL : (1UL << s->K) - 1;
+  ret.spills = NULL;
+  for (i = 0; i < count; i++) {
+    interval *cur = &s->iv[order[i]];
+    unsigned long ok = 0;
+    /* Expire the intervals that ended before this one starts. */
+    while (s->activeCount > 0 && s->iv[s->active[0]].end < cur->start) {
+      freeRegs |= 1UL << s->iv[s->active[0]].reg;
+      deactivate(s, 0);
+    }
+    for (c = 0; c < s->K; c++)
+      if (((freeRegs >> c) & 1) && regFree(s, c, cur->start, cur->end))
+        ok |= 1UL << c;
+    if (ok) {
+      cur->reg = cur->hint >= 0 && ((ok >> cur->hint) & 1)
+                     ? cur->hint
+                     : __builtin_ctzl(ok);
+      freeRegs &= ~(1UL << cur->reg);
+      activate(s, order[i]);
+      continue;
+    }
+    /* No register: spill whichever of this interval and the active ones
+     * that could give it their register ends last. */
+    for (c = s->activeCount - 1; c >= 0; c--) {
+      int other = s->active[c];
+      if (regFree(s, s->iv[other].reg, cur->start, cur->end) &&
+          !TAB_look(unspillable, Live_temp(live, other)))
+        break;
+    }
+    if (c >= 0 && (s->iv[s->active[c]].end > cur->end ||
+                   TAB_look(unspillable, Live_temp(live, order[i])))) {
+      int other = s->active[c];
+      cur->reg = s->iv[other].reg;
+      s->iv[other].reg = -1;
+      ret.spills = Temp_TempList(Live_temp(live, other), ret.spills);
+      deactivate(s, c);
+      activate(s, order[i]);
+    } else
+      ret.spills = Temp_TempList(Live_temp(live, order[i]), ret.spills);
+  }
+
+  for (num = 0; num < s->tempCount; num++)
+    if (s->iv[num].reg >= 0)
+      Temp_enter(coloring, Live_temp(live, num),
+                 Temp_look(initial, s->regOf[s->iv[num].reg]));
+  ret.coloring = Temp_layerMap(coloring, initial);
+  return ret;
+}
@@ -0,0 +1,13 @@
+/*
+ * linscan.h - Linear scan register allocation, for when compile time
+ *             matters more than the quality of the code.
+ */
+
+/* Assign the registers in "regs" to the temps of the function analysed by
+ *  "live", in the instruction order of "flow". Each temp gets one interval,
+ *  from the first to the last instruction at which it is live, and never
+ *  shares a register with a temp whose interval overlaps it. Temps in
+ *  "unspillable" are only spilled when nothing else can be. The result has
+ *  the same meaning as that of COL_color. */
+struct COL_result LS_allocate(G_graph flow, Live_info live, Temp_map initial,
+                              Temp_tempList regs, TAB_table unspillable);
@@ -0,0 +1,176 @@
+/*
+ * rabench.c - Compare the coloring and linear scan register allocators.
+ *
+ * There is no instruction selector yet, so the functions allocated here
+ * are made up: straight-line arithmetic and moves over a pool of temps,
+ * calls that clobber %eax and %ecx, forward branches and one loop around
+ * the whole body. The same function is allocated by both allocators at a
+ * range of sizes, and the time taken, the temps spilled and the length of
+ * the resulting code are printed for each.
+ *
+ * Build it with the rest of the back end, from a directory holding the
+ * chap7, chap9, chap10 and chap11 sources:
+ *
+ *   cc -O2 -o rabench rabench.c regalloc.c color.c linscan.c liveness.c
+ *     flowgraph.c graph.c assem.c x86frame.c temp.c table.c symbol.c
+ *     tree.c arena.c context.c util.c -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "absyn.h"
+#include "assem.h"
+#include "frame.h"
+#include "regalloc.h"
+
+static unsigned long seed;
+
+static int randInt(int n) {
+  seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+  return (int)((seed >> 33) % n);
+}
+
+static AS_instrList *emit(AS_instrList *last, AS_instr i) {
+  *last = AS_InstrList(i, NULL);
+  return &(*last)->tail;
+}
+
+static Temp_tempList L(Temp_temp a, Temp_tempList tail) {
+  return Temp_TempList(a, tail);
+}
+
+/* A function of about "size" instructions, with "pool" temps live across
+ * its loop. */
+static AS_instrList makeFunction(int size, int pool) {
+  Temp_temp *t = checked_malloc(pool * sizeof(Temp_temp));
+  Temp_temp counter = Temp_newtemp();
+  Temp_label top = Temp_newlabel(), *pending;
+  AS_instrList il = NULL, *last = &il;
+  int i, pendingCount = 0;
+  pending = checked_malloc(size * sizeof(Temp_label));
+  for (i = 0; i < pool; i++) {
+    t[i] = Temp_newtemp();
+    last = emit(last, AS_Oper("movl $1, `d0\n", L(t[i], NULL), NULL, NULL));
+  }
+  last = emit(last, AS_Oper("movl $3, `d0\n", L(counter, NULL), NULL, NULL));
+  last = emit(last, AS_Label("top:\n", top));
+  for (i = 0; i < size; i++) {
+    Temp_temp a = t[randInt(pool)], b = t[randInt(pool)];
+    Temp_temp fresh = Temp_newtemp();
+    switch (randInt(12)) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+      last = emit(last, AS_Oper("addl `s1, `d0\n", L(a, NULL),
+                                L(a, L(b, NULL)), NULL));
+      break;
+    case 4:
+    case 5:
+      /* A short-lived temp, as expression trees produce. */
+      last = emit(last, AS_Move("movl `s0, `d0\n", L(fresh, NULL),
+                                L(a, NULL)));
+      last = emit(last, AS_Oper("addl `s1, `d0\n", L(fresh, NULL),
+                                L(fresh, L(b, NULL)), NULL));
+      last = emit(last, AS_Move("movl `s0, `d0\n", L(b, NULL),
+                                L(fresh, NULL)));
+      break;
+    case 6:
+    case 7:
+      last = emit(last, AS_Move("movl `s0, `d0\n", L(a, NULL),
+                                L(b, NULL)));
+      break;
+    case 8:
+    case 9:
+      last = emit(last, AS_Move("movl `s0, `d0\n", L(F_RV(), NULL),
+                                L(a, NULL)));
+      last = emit(last, AS_Oper("call f\n",
+                                L(F_RV(), L(F_registers()->tail->tail->head,
+                                            NULL)),
+                                L(F_RV(), NULL), NULL));
+      last = emit(last, AS_Move("movl `s0, `d0\n", L(b, NULL),
+                                L(F_RV(), NULL)));
+      break;
+    case 10: {
+      Temp_label fall = Temp_newlabel();
+      pending[pendingCount] = Temp_newlabel();
+      last = emit(last,
+                  AS_Oper("cmpl $0, `s0\njne `j0\n", NULL, L(a, NULL),
+                          AS_Targets(Temp_LabelList(
+                              pending[pendingCount],
+                              Temp_LabelList(fall, NULL)))));
+      last = emit(last, AS_Label("fall:\n", fall));
+      pendingCount++;
+      break;
+    }
+    default:
+      if (pendingCount > 0)
+        last = emit(last, AS_Label("target:\n", pending[--pendingCount]));
+      break;
+    }
+  }
+  while (pendingCount > 0)
+    last = emit(last, AS_Label("target:\n", pending[--pendingCount]));
+  last = emit(last, AS_Oper("decl `d0\n", L(counter, NULL),
+                            L(counter, NULL), NULL));
+  {
+    Temp_label done = Temp_newlabel();
+    last = emit(last,
+                AS_Oper("jne `j0\n", NULL, L(counter, NULL),
+                        AS_Targets(Temp_LabelList(
+                            top, Temp_LabelList(done, NULL)))));
+    last = emit(last, AS_Label("done:\n", done));
+  }
+  for (i = 0; i < pool; i++)
+    last = emit(last, AS_Oper("pushl `s0\n", NULL, L(t[i], NULL), NULL));
+  free(t);
+  free(pending);
+  return il;
+}
+
+static int length(AS_instrList il) {
+  int n = 0;
+  for (; il; il = il->tail)
+    n++;
+  return n;
+}
+
+static void run(int size, int pool, bool linear) {
+  struct RA_result r;
+  AS_instrList il;
+  F_frame f;
+  clock_t start;
+  int before;
+  AR_resetAll();
+  Temp_reset();
+  F_reset();
+  seed = size;
+  f = F_newFrame(Temp_newlabel(), NULL);
+  il = makeFunction(size, pool);
+  before = length(il);
+  RA_setLinearScan(linear);
+  start = clock();
+  r = RA_regAlloc(f, il);
+  printf("%-8s %8d %6d %10.2f %8d %10d\n", linear ? "linear" : "color",
+         before, pool, 1000.0 * (clock() - start) / CLOCKS_PER_SEC, r.spills,
+         length(r.il));
+}
+
+int main(int argc, char **argv) {
+  int size, max = argc > 1 ? atoi(argv[1]) : 32000;
+  printf("%-8s %8s %6s %10s %8s %10s\n", "alloc", "instrs", "pool", "ms",
+         "spills", "result");
+  for (size = 1000; size <= max; size *= 2) {
+    run(size, 4, FALSE);
+    run(size, 4, TRUE);
+    run(size, size / 50, FALSE);
+    run(size, size / 50, TRUE);
+  }
+  return 0;
+}
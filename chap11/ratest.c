@@ -0,0 +1,95 @@
+/*
+ * ratest.c - Check both register allocators on functions that trip them.
+ *
+ * Each case is a short function, made up as in rabench.c, with the temps
+ * whose register it checks. Both the coloring and the linear scan
+ * allocator run on each, and a temp must end up in one of the registers
+ * F_registers gives out: the frame and stack pointers are never handed
+ * to a temp, even one that is a copy of them. It prints what failed and
+ * exits non-zero, or prints nothing.
+ *
+ * Build it with the rest of the back end, from a directory holding the
+ * chap7, chap9, chap10 and chap11 sources:
+ *
+ *   cc -O2 -o ratest ratest.c regalloc.c color.c linscan.c liveness.c
+ *     flowgraph.c graph.c assem.c x86frame.c temp.c table.c symbol.c
+ *     tree.c arena.c context.c util.c -pthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "absyn.h"
+#include "assem.h"
+#include "frame.h"
+#include "regalloc.h"
+
+static int failures;
+
+static AS_instrList *emit(AS_instrList *last, AS_instr i) {
+  *last = AS_InstrList(i, NULL);
+  return &(*last)->tail;
+}
+
+static Temp_tempList L(Temp_temp a, Temp_tempList tail) {
+  return Temp_TempList(a, tail);
+}
+
+/* An address computed from "base", as a field access is:
+ *
+ *   movl base, t; addl $8, t; movl (t), x; pushl x
+ *
+ * "t" must not be merged into "base": the add would change it. */
+static AS_instrList offsetFrom(Temp_temp base, Temp_temp t) {
+  Temp_temp x = Temp_newtemp();
+  AS_instrList il = NULL, *last = &il;
+  last = emit(last, AS_Move("movl `s0, `d0\n", L(t, NULL), L(base, NULL)));
+  last = emit(last, AS_Oper("addl $8, `d0\n", L(t, NULL), L(t, NULL), NULL));
+  last = emit(last, AS_Oper("movl (`s0), `d0\n", L(x, NULL), L(t, NULL),
+                            NULL));
+  emit(last, AS_Oper("pushl `s0\n", NULL, L(x, NULL), NULL));
+  return il;
+}
+
+/* Whether "t" was given one of the registers the allocators hand out */
+static bool allocatable(Temp_map coloring, Temp_temp t) {
+  string name = Temp_look(coloring, t);
+  Temp_tempList r;
+  if (!name)
+    return FALSE;
+  for (r = F_registers(); r; r = r->tail)
+    if (!strcmp(name, Temp_look(F_tempMap(), r->head)))
+      return TRUE;
+  return FALSE;
+}
+
+/* Allocate a function made by "make" with each allocator, and check the
+ * register of the temp it is given. */
+static void check(const char *name,
+                  AS_instrList (*make)(Temp_temp, Temp_temp), Temp_temp base) {
+  int linear;
+  for (linear = 0; linear < 2; linear++) {
+    Temp_temp t = Temp_newtemp();
+    struct RA_result r;
+    RA_setLinearScan(linear);
+    r = RA_regAlloc(F_newFrame(Temp_newlabel(), NULL), make(base, t));
+    if (!allocatable(r.coloring, t)) {
+      string got = Temp_look(r.coloring, t);
+      fprintf(stderr, "ratest: %s (%s): temp given %s\n", name,
+              linear ? "linear scan" : "coloring", got ? got : "nothing");
+      failures++;
+    }
+  }
+}
+
+int main(void) {
+  check("offset from %ebp", offsetFrom, F_FP());
+  check("offset from %esp", offsetFrom, F_SP());
+  check("offset from %eax", offsetFrom, F_RV());
+  return failures != 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * regalloc.c - Register allocation: build the interference graph, color it,
+ *              and if some temps don't get a register, keep them in the
+ *              frame and start over.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "absyn.h"
+#include "assem.h"
+#include "frame.h"
+#include "graph.h"
+#include "flowgraph.h"
+#include "liveness.h"
+#include "color.h"
+#include "table.h"
+#include "linscan.h"
+#include "regalloc.h"
+
+/* Each thread allocates the way it was last told to. */
+static __thread bool linearScan = FALSE;
+
+void RA_setLinearScan(bool enabled) { linearScan = enabled; }
+
+/* Spill cost of each node: how often its temp is mentioned. Temps made by
+ * an earlier rewrite only live from a load to its use or from a definition
+ * to its store; spilling them again would gain nothing. */
+static double *spillCosts(Live_graph ig, AS_instrList il, TAB_table fresh) {
+  double *cost = AR_alloc(AR_regalloc, (ig->nodeCount + 1) * sizeof(double));
+  int n;
+  for (n = 0; n < ig->nodeCount; n++)
+    cost[n] = TAB_look(fresh, ig->temps[n]) ? HUGE_VAL : 0;
+  for (; il; il = il->tail) {
+    Temp_tempList lists[2], p;
+    int i;
+    if (il->head->kind == I_OPER) {
+      lists[0] = il->head->u.OPER.dst;
+      lists[1] = il->head->u.OPER.src;
+    } else if (il->head->kind == I_MOVE) {
+      lists[0] = il->head->u.MOVE.dst;
+      lists[1] = il->head->u.MOVE.src;
+    } else
+      continue;
+    for (i = 0; i < 2; i++)
+      for (p = lists[i]; p; p = p->tail)
+        cost[Live_node(ig, p->head)] += 1;
+  }
+  return cost;
+}
+
+/* The fresh temp that stands for "t" in the instruction being rewritten:
+ * "olds" and "news" pair up the temps replaced so far. */
+static Temp_temp standIn(Temp_temp t, Temp_tempList olds, Temp_tempList news) {
+  for (; olds; olds = olds->tail, news = news->tail)
+    if (olds->head == t)
+      return news->head;
+  return NULL;
+}
+
+static Temp_tempList replace(Temp_tempList l, Temp_tempList olds,
+                             Temp_tempList news) {
+  Temp_temp t;
+  if (!l)
+    return NULL;
+  t = standIn(l->head, olds, news);
+  return Temp_TempList(t ? t : l->head, replace(l->tail, olds, news));
+}
+
+/* Give each spilled temp a slot in the frame, and rewrite every instruction
+ * that mentions one: a fresh temp is loaded from the slot before the
+ * instruction and/or stored to it afterwards. */
+static AS_instrList rewrite(F_frame f, AS_instrList il, Temp_tempList spills,
+                            TAB_table fresh) {
+  TAB_table slots = TAB_empty();
+  AS_instrList result = NULL, *last = &result;
+  Temp_tempList p;
+  for (p = spills; p; p = p->tail)
+    TAB_enter(slots, p->head, F_allocLocal(f, TRUE));
+
+  for (; il; il = il->tail) {
+    AS_instr i = il->head;
+    Temp_tempList *dst, *src, olds = NULL, news = NULL;
+    AS_instrList stores = NULL;
+    char buf[80];
+    if (i->kind == I_LABEL) {
+      *last = AS_InstrList(i, NULL);
+      last = &(*last)->tail;
+      continue;
+    }
+    i = i->kind == I_OPER ? AS_Oper(i->u.OPER.assem, i->u.OPER.dst,
+                                    i->u.OPER.src, i->u.OPER.jumps)
+                          : AS_Move(i->u.MOVE.assem, i->u.MOVE.dst,
+                                    i->u.MOVE.src);
+    dst = i->kind == I_OPER ? &i->u.OPER.dst : &i->u.MOVE.dst;
+    src = i->kind == I_OPER ? &i->u.OPER.src : &i->u.MOVE.src;
+    for (p = *src; p; p = p->tail) {
+      F_access slot = TAB_look(slots, p->head);
+      Temp_temp t;
+      if (!slot || standIn(p->head, olds, news))
+        continue;
+      t = Temp_newtemp();
+      TAB_enter(fresh, t, t);
+      olds = Temp_TempList(p->head, olds);
+      news = Temp_TempList(t, news);
+      sprintf(buf, "movl %d(`s0), `d0\n", F_frameOffset(slot));
+      *last = AS_InstrList(AS_Oper(String(buf), Temp_TempList(t, NULL),
+                                   Temp_TempList(F_FP(), NULL), NULL),
+                           NULL);
+      last = &(*last)->tail;
+    }
+    for (p = *dst; p; p = p->tail) {
+      F_access slot = TAB_look(slots, p->head);
+      Temp_temp t;
+      if (!slot)
+        continue;
+      t = standIn(p->head, olds, news);
+      if (!t) {
+        t = Temp_newtemp();
+        TAB_enter(fresh, t, t);
+        olds = Temp_TempList(p->head, olds);
+        news = Temp_TempList(t, news);
+      }
+      sprintf(buf, "movl `s0, %d(`s1)\n", F_frameOffset(slot));
+      stores = AS_InstrList(
+          AS_Oper(String(buf), NULL,
+                  Temp_TempList(t, Temp_TempList(F_FP(), NULL)), NULL),
+          stores);
+    }
+    if (olds) {
+      *src = replace(*src, olds, news);
+      *dst = replace(*dst, olds, news);
+    }
+    *last = AS_InstrList(i, stores);
+    while (*last)
+      last = &(*last)->tail;
+  }
+  return result;
+}
+
+/* Moves whose source and destination got the same register do nothing. */
+static AS_instrList removeMoves(AS_instrList il, Temp_map coloring) {
+  AS_instrList result = NULL, *last = &result;
+  for (; il; il = il->tail) {
+    AS_instr i = il->head;
+    if (i->kind == I_MOVE && i->u.MOVE.dst && i->u.MOVE.src &&
+        !i->u.MOVE.dst->tail && !i->u.MOVE.src->tail &&
+        !strcmp(Temp_look(coloring, i->u.MOVE.dst->head),
+                Temp_look(coloring, i->u.MOVE.src->head)))
+      continue;
+    *last = AS_InstrList(i, NULL);
+    last = &(*last)->tail;
+  }
+  return result;
+}
+
+struct RA_result RA_regAlloc(F_frame f, AS_instrList il) {
+  struct RA_result ret;
+  TAB_table fresh = TAB_empty();
+  ret.spills = 0;
+  for (;;) {
+    G_graph flow = FG_AssemFlowGraph(il);
+    Live_info live = Live_analyze(flow);
+    struct COL_result col;
+    Temp_tempList p;
+    if (linearScan)
+      col = LS_allocate(flow, live, F_tempMap(), F_registers(), fresh);
+    else {
+      Live_graph ig = Live_interference(live, F_tempMap());
+      col = COL_color(ig, F_tempMap(), F_registers(),
+                      spillCosts(ig, il, fresh));
+    }
+    AR_phaseDone(AR_graph);
+    AR_phaseDone(AR_liveness);
+    AR_phaseDone(AR_regalloc);
+    if (!col.spills) {
+      ret.coloring = col.coloring;
+      ret.il = removeMoves(il, col.coloring);
+      return ret;
+    }
+    for (p = col.spills; p; p = p->tail)
+      ret.spills++;
+    il = rewrite(f, il, col.spills, fresh);
+  }
+}
@@ -2,5 +2,11 @@
 struct RA_result {
   Temp_map coloring;
   AS_instrList il;
+  int spills; /* temps that had to be kept in the frame */
 };
 struct RA_result RA_regAlloc(F_frame f, AS_instrList il);
+
+/* Allocate by linear scan instead of graph coloring: faster to run, but
+ *  more spills and fewer moves coalesced. This holds for the calling thread
+ *  only. */
+void RA_setLinearScan(bool enabled);
@@ -0,0 +1,373 @@
+/*
+ * cgen.c - Write a translated program out as C.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "util.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "frame.h"
+#include "canon.h"
+#include "table.h"
+#include "cgen.h"
+
+#define STACK_WORDS (1 << 22) /* of the frame stack: 16 MB */
+
+/* The library of runtime.c, with the types it has there: a pointer is
+ * marked "p", an int "i" and no result "v". */
+static const struct {
+  string name;
+  string result;
+  string args; /* a letter for each */
+  string decl; /* as runtime.c has it */
+} library[] = {
+    {"initArray", "p", "ii", "int *initArray(int size, int init);"},
+    {"allocRecord", "p", "i", "int *allocRecord(int size);"},
+    {"stringEqual", "i", "pp",
+     "int stringEqual(struct string *s, struct string *t);"},
+    {"print", "v", "p", "void print(struct string *s);"},
+    {"flush", "v", "", "void flush(void);"},
+    {"ord", "i", "p", "int ord(struct string *s);"},
+    {"chr", "p", "i", "struct string *chr(int i);"},
+    {"size", "i", "p", "int size(struct string *s);"},
+    {"substring", "p", "pii",
+     "struct string *substring(struct string *s, int first, int n);"},
+    {"concat", "p", "pp",
+     "struct string *concat(struct string *a, struct string *b);"},
+    {"not", "i", "i", "int not(int i);"},
+    {"getchar", "p", "", "struct string *getchar(void);"},
+    {"exit", "v", "i", NULL}, /* stdlib's */
+};
+
+#define LIBRARY_SIZE (sizeof(library) / sizeof(library[0]))
+
+static int libraryIndex(Temp_label name) {
+  size_t i;
+  for (i = 0; i < LIBRARY_SIZE; i++)
+    if (!strcmp(Temp_labelstring(name), library[i].name))
+      return i;
+  return -1;
+}
+
+static void cString(FILE *out, const char *s, int length) {
+  int i;
+  fputc('"', out);
+  for (i = 0; i < length; i++) {
+    unsigned char c = s[i];
+    if (c == '"' || c == '\\')
+      fprintf(out, "\\%c", c);
+    else if (c >= ' ' && c < 127 && c != '?') /* no trigraphs */
+      fputc(c, out);
+    else
+      fprintf(out, "\\%03o", c);
+  }
+  fputc('"', out);
+}
+
+static void temp(FILE *out, Temp_temp t) {
+  if (t == F_FP())
+    fprintf(out, "fp");
+  else if (t == F_RV())
+    fprintf(out, "rv");
+  else
+    fprintf(out, "t%d", Temp_num(t));
+}
+
+static void expression(FILE *out, T_exp e);
+
+static void arguments(FILE *out, T_expList args, string kinds) {
+  int i;
+  for (i = 0; args; args = args->tail, i++) {
+    if (i)
+      fprintf(out, ", ");
+    if (kinds && kinds[i] == 'p') {
+      fprintf(out, "(void *)(uintptr_t)(uint32_t)");
+      expression(out, args->head);
+    } else
+      expression(out, args->head);
+  }
+}
+
+static void call(FILE *out, T_exp e) {
+  Temp_label name = e->u.CALL.fun->u.NAME;
+  int i = libraryIndex(name);
+  if (i < 0) {
+    fprintf(out, "%s(", Temp_labelstring(name));
+    arguments(out, e->u.CALL.args, NULL);
+    fprintf(out, ")");
+    return;
+  }
+  if (library[i].result[0] == 'p')
+    fprintf(out, "(int32_t)(uintptr_t)");
+  else if (library[i].result[0] == 'v')
+    fprintf(out, "(");
+  fprintf(out, "%s(", library[i].name);
+  arguments(out, e->u.CALL.args, library[i].args);
+  fprintf(out, library[i].result[0] == 'v' ? "), 0)" : ")");
+}
+
+static void expression(FILE *out, T_exp e) {
+  switch (e->kind) {
+  case T_CONST:
+    if (e->u.CONST == INT32_MIN)
+      fprintf(out, "(-2147483647 - 1)");
+    else
+      fprintf(out, "%d", e->u.CONST);
+    break;
+  case T_NAME:
+    fprintf(out, "(int32_t)(uintptr_t)&%s", Temp_labelstring(e->u.NAME));
+    break;
+  case T_TEMP:
+    temp(out, e->u.TEMP);
+    break;
+  case T_MEM:
+    fprintf(out, "M(");
+    expression(out, e->u.MEM);
+    fprintf(out, ")");
+    break;
+  case T_BINOP: {
+    // Wrapping, as the machine does, and not what C leaves undefined
+    static const string ops[] = {"WRAP(+, ", "WRAP(-, ", "WRAP(*, ",
+                                 "tiger_div(", "AND(",    "OR(",
+                                 "SHL(",      "SHR(",     "SAR(",
+                                 "XOR("};
+    fprintf(out, "%s", ops[e->u.BINOP.op]);
+    expression(out, e->u.BINOP.left);
+    fprintf(out, ", ");
+    expression(out, e->u.BINOP.right);
+    fprintf(out, ")");
+    break;
+  }
+  case T_CALL:
+    call(out, e);
+    break;
+  case T_ESEQ:
+    assert(0); /* canon leaves none */
+  }
+}
+
+static void statement(FILE *out, T_stm s, T_stm next) {
+  static const string relops[] = {"==", "!=", "<", ">", "<=", ">="};
+  switch (s->kind) {
+  case T_LABEL:
+    fprintf(out, "%s:;\n", Temp_labelstring(s->u.LABEL));
+    return;
+  case T_JUMP:
+    if (next && next->kind == T_LABEL &&
+        next->u.LABEL == s->u.JUMP.exp->u.NAME)
+      return;
+    fprintf(out, "  goto %s;\n", Temp_labelstring(s->u.JUMP.exp->u.NAME));
+    return;
+  case T_CJUMP:
+    fprintf(out, "  if (");
+    if (s->u.CJUMP.op >= T_ult) {
+      static const string unsignedOps[] = {"<", "<=", ">", ">="};
+      fprintf(out, "(uint32_t)");
+      expression(out, s->u.CJUMP.left);
+      fprintf(out, " %s (uint32_t)", unsignedOps[s->u.CJUMP.op - T_ult]);
+    } else {
+      expression(out, s->u.CJUMP.left);
+      fprintf(out, " %s ", relops[s->u.CJUMP.op]);
+    }
+    expression(out, s->u.CJUMP.right);
+    fprintf(out, ")\n    goto %s;\n", Temp_labelstring(s->u.CJUMP.true));
+    if (!next || next->kind != T_LABEL || next->u.LABEL != s->u.CJUMP.false)
+      fprintf(out, "  goto %s;\n", Temp_labelstring(s->u.CJUMP.false));
+    return;
+  case T_MOVE:
+    fprintf(out, "  ");
+    expression(out, s->u.MOVE.dst);
+    fprintf(out, " = ");
+    expression(out, s->u.MOVE.src);
+    fprintf(out, ";\n");
+    return;
+  case T_EXP:
+    fprintf(out, "  (void)");
+    expression(out, s->u.EXP);
+    fprintf(out, ";\n");
+    return;
+  case T_SEQ:
+    assert(0); /* canon leaves none */
+  }
+}
+
+typedef struct {
+  TAB_table seen;
+  Temp_tempList temps; /* the locals, bar fp and rv */
+} locals;
+
+static void noteExp(locals *l, T_exp e) {
+  T_expList a;
+  switch (e->kind) {
+  case T_BINOP:
+    noteExp(l, e->u.BINOP.left);
+    noteExp(l, e->u.BINOP.right);
+    break;
+  case T_MEM:
+    noteExp(l, e->u.MEM);
+    break;
+  case T_TEMP:
+    if (e->u.TEMP != F_FP() && e->u.TEMP != F_RV() &&
+        !TAB_look(l->seen, e->u.TEMP)) {
+      TAB_enter(l->seen, e->u.TEMP, e->u.TEMP);
+      l->temps = Temp_TempList(e->u.TEMP, l->temps);
+    }
+    break;
+  case T_CALL:
+    for (a = e->u.CALL.args; a; a = a->tail)
+      noteExp(l, a->head);
+    break;
+  default:
+    break;
+  }
+}
+
+static Temp_tempList localsOf(F_frame frame, T_stmList stms) {
+  F_accessList a;
+  locals l;
+  l.seen = TAB_empty();
+  l.temps = NULL;
+  for (a = F_formals(frame); a; a = a->tail)
+    if (F_accessTemp(a->head))
+      noteExp(&l, T_Temp(F_accessTemp(a->head)));
+  for (; stms; stms = stms->tail) {
+    T_stm s = stms->head;
+    if (s->kind == T_MOVE) {
+      noteExp(&l, s->u.MOVE.dst);
+      noteExp(&l, s->u.MOVE.src);
+    } else if (s->kind == T_EXP)
+      noteExp(&l, s->u.EXP);
+    else if (s->kind == T_CJUMP) {
+      noteExp(&l, s->u.CJUMP.left);
+      noteExp(&l, s->u.CJUMP.right);
+    }
+  }
+  return l.temps;
+}
+
+static int formalCount(F_frame frame) {
+  F_accessList a;
+  int n = 0;
+  for (a = F_formals(frame); a; a = a->tail)
+    n++;
+  return n;
+}
+
+/* The struct of the frame: its locals below the frame pointer, from
+ * the last made up, then the two words of the return address and the
+ * saved frame pointer, at which it points, then the formals. */
+static void frameStruct(FILE *out, F_frame frame) {
+  string name = Temp_labelstring(F_name(frame));
+  int n = F_localCount(frame);
+  fprintf(out, "struct %s_frame {\n", name);
+  if (n)
+    fprintf(out, "  int32_t locals[%d];\n", n);
+  fprintf(out, "  int32_t saved[2];\n");
+  fprintf(out, "  int32_t formals[%d];\n};\n", formalCount(frame));
+}
+
+static void signature(FILE *out, F_frame frame) {
+  int i, n = formalCount(frame);
+  fprintf(out, "int32_t %s(", Temp_labelstring(F_name(frame)));
+  for (i = 0; i < n; i++)
+    fprintf(out, "%sint32_t a%d", i ? ", " : "", i);
+  fprintf(out, ")");
+}
+
+static void function(FILE *out, F_frame frame, T_stm body) {
+  string name = Temp_labelstring(F_name(frame));
+  T_stmList stms = C_traceSchedule(C_basicBlocks(C_linearize(body)));
+  Temp_tempList t;
+  F_accessList a;
+  int i;
+  signature(out, frame);
+  fprintf(out, " {\n  struct %s_frame *frame =\n"
+               "      (struct %s_frame *)(tiger_sp -= FRAME(%s));\n",
+          name, name, name);
+  fprintf(out, "  int32_t fp = (int32_t)(uintptr_t)frame->saved, rv = 0;\n");
+  for (t = localsOf(frame, stms); t; t = t->tail)
+    fprintf(out, "  int32_t t%d;\n", Temp_num(t->head));
+  fprintf(out, "  if (tiger_sp < tiger_stack)\n    tiger_overflow();\n");
+  for (a = F_formals(frame), i = 0; a; a = a->tail, i++)
+    if (F_accessTemp(a->head)) {
+      fprintf(out, "  ");
+      temp(out, F_accessTemp(a->head));
+      fprintf(out, " = a%d;\n", i);
+    } else
+      fprintf(out, "  frame->formals[%d] = a%d;\n", i, i);
+  for (; stms; stms = stms->tail)
+    statement(out, stms->head, stms->tail ? stms->tail->head : NULL);
+  fprintf(out, "  tiger_sp += FRAME(%s);\n  return rv;\n}\n\n", name);
+}
+
+static const char *prelude =
+    "#define getchar stdio_getchar\n"
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <stdint.h>\n"
+    "#undef getchar\n"
+    "\n"
+    "struct string;\n"
+    "%s"
+    "\n"
+    "#define M(a) (*(int32_t *)(uintptr_t)(uint32_t)(a))\n"
+    "#define WRAP(op, a, b) ((int32_t)((uint32_t)(a) op (uint32_t)(b)))\n"
+    "#define AND(a, b) ((a) & (b))\n"
+    "#define OR(a, b) ((a) | (b))\n"
+    "#define XOR(a, b) ((a) ^ (b))\n"
+    "#define SHL(a, b) ((int32_t)((uint32_t)(a) << ((b) & 31)))\n"
+    "#define SHR(a, b) ((int32_t)((uint32_t)(a) >> ((b) & 31)))\n"
+    "#define SAR(a, b) ((a) >> ((b) & 31))\n"
+    "#define FRAME(f) (sizeof(struct f##_frame) / sizeof(int32_t))\n"
+    "\n"
+    "static int32_t tiger_div(int32_t a, int32_t b) {\n"
+    "  return b == -1 ? WRAP(-, 0, a) : a / b;\n"
+    "}\n"
+    "\n"
+    "static int32_t tiger_stack[%d], *tiger_sp = tiger_stack + %d;\n"
+    "\n"
+    "static void tiger_overflow(void) {\n"
+    "  fflush(stdout);\n"
+    "  fprintf(stderr, \"stack overflow\\n\");\n"
+    "  exit(1);\n"
+    "}\n\n";
+
+void CG_program(FILE *out, F_fragList frags) {
+  F_fragList f;
+  size_t i;
+  char *declarations = NULL;
+  size_t size = 0;
+  FILE *d = open_memstream(&declarations, &size);
+  for (i = 0; i < LIBRARY_SIZE; i++)
+    if (library[i].decl)
+      fprintf(d, "%s\n", library[i].decl);
+  fclose(d);
+  fprintf(out, "/* Made by tiger (cgen.c); build it with runtime.c */\n");
+  fprintf(out, prelude, declarations, STACK_WORDS, STACK_WORDS);
+  free(declarations);
+
+  for (f = frags; f; f = f->tail)
+    if (f->head->kind == F_stringFrag) {
+      string s = f->head->u.string.str;
+      int length = strlen(s);
+      fprintf(out, "static struct {\n  int32_t length;\n"
+                   "  unsigned char chars[%d];\n} %s = {%d, ",
+              length + 1, Temp_labelstring(f->head->u.string.label), length);
+      cString(out, s, length);
+      fprintf(out, "};\n");
+    }
+  fprintf(out, "\n");
+  for (f = frags; f; f = f->tail)
+    if (f->head->kind == F_procFrag) {
+      frameStruct(out, f->head->u.proc.frame);
+      signature(out, f->head->u.proc.frame);
+      fprintf(out, ";\n\n");
+    }
+  for (f = frags; f; f = f->tail)
+    if (f->head->kind == F_procFrag)
+      function(out, f->head->u.proc.frame, f->head->u.proc.body);
+}
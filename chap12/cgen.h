@@ -0,0 +1,19 @@
+/*
+ * cgen.h - Write a translated program out as C.
+ *
+ * Each procedure fragment is put through canon and becomes a C function
+ * named after its label: its temps are locals, its statements assignments
+ * and gotos, and its frame a struct laid out as x86frame.c lays out the
+ * frame, with the static link as the first formal. Frames are kept on a
+ * stack of their own, since escaping variables and static links are
+ * reached through the addresses the trees compute. String fragments are
+ * static data shaped as runtime.c's strings, and the library is called
+ * there, so the output is built with runtime.c by the system C compiler.
+ *
+ * A Tiger word holds an address, so the program must keep its data
+ * below 4 GB: on a 64-bit host it is linked -no-pie, and runtime.c
+ * allocates there too.
+ */
+
+/* Write the fragments of a program to "out" as one C translation unit */
+void CG_program(FILE *out, F_fragList frags);
@@ -0,0 +1,505 @@
+/*
+ * jit.c - Translate the bytecode of vm.c to x86-64 code, and run it.
+ *
+ * Each instruction becomes a few native ones, in a buffer that is then
+ * made executable. The registers stay where the bytecode has them, in
+ * the window of the running function, which %rbx points to; the memory
+ * of the machine is at %r12, the machine itself at %r13, and %r14 holds
+ * its stack pointer. A call of a Tiger function is a native call: the
+ * caller makes the frame and moves the window up past its own, and the
+ * callee restores the stack pointer as it returns. The library is called
+ * through a C function that reads the operands from the bytecode.
+ *
+ * The code runs on a stack of its own, large enough for the deepest
+ * recursion the stack of the machine allows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <sys/mman.h>
+#include "util.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "frame.h"
+#include "table.h"
+#include "vm.h"
+#include "machine.h"
+
+#if defined(__x86_64__)
+
+#define NATIVE_STACK (64u << 20) /* 8 bytes a call, and room for C */
+
+/* Registers, by their number in the encoding */
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI };
+
+/* Where a rel32 goes once the code is all there */
+typedef struct {
+  int at;     /* the byte after it */
+  int target; /* an offset into the bytecode, or one of the stubs */
+} fixup;
+
+enum { STUB_OVERFLOW = -1, STUB_DIVISION = -2 };
+
+typedef struct {
+  VM_program p;
+  unsigned char *bytes;
+  int size, capacity;
+  int *native; /* the native offset of each instruction of the bytecode */
+  fixup *fixups;
+  int fixupCount, fixupCapacity;
+  int overflow, division; /* the stubs */
+} jit;
+
+static void byte(jit *j, int b) {
+  if (j->size == j->capacity) {
+    unsigned char *bytes;
+    j->capacity = j->capacity ? 2 * j->capacity : 4096;
+    bytes = checked_malloc(j->capacity);
+    if (j->size)
+      memcpy(bytes, j->bytes, j->size);
+    free(j->bytes);
+    j->bytes = bytes;
+  }
+  j->bytes[j->size++] = b;
+}
+
+static void bytes(jit *j, int n, const unsigned char *b) {
+  while (n--)
+    byte(j, *b++);
+}
+
+static void word(jit *j, int32_t w) {
+  uint32_t u = w;
+  byte(j, u);
+  byte(j, u >> 8);
+  byte(j, u >> 16);
+  byte(j, u >> 24);
+}
+
+static void quad(jit *j, const void *pointer) {
+  uint64_t u = (uintptr_t)pointer;
+  word(j, u);
+  word(j, u >> 32);
+}
+
+/* A rel32 to "target", filled in once all the code is there */
+static void relative(jit *j, int target) {
+  if (j->fixupCount == j->fixupCapacity) {
+    fixup *fixups;
+    j->fixupCapacity = j->fixupCapacity ? 2 * j->fixupCapacity : 256;
+    fixups = checked_malloc(j->fixupCapacity * sizeof(fixup));
+    if (j->fixupCount)
+      memcpy(fixups, j->fixups, j->fixupCount * sizeof(fixup));
+    free(j->fixups);
+    j->fixups = fixups;
+  }
+  word(j, 0);
+  j->fixups[j->fixupCount].at = j->size;
+  j->fixups[j->fixupCount++].target = target;
+}
+
+/* "op" between register "reg" and bytecode register "r", at %rbx + 4r */
+static void window(jit *j, int op, int reg, int r) {
+  if (op > 0xff)
+    byte(j, op >> 8);
+  byte(j, op & 0xff);
+  byte(j, 0x80 | reg << 3 | RBX);
+  word(j, 4 * r);
+}
+
+#define LOAD 0x8b  /* mov reg, r */
+#define STORE 0x89 /* mov r, reg */
+#define ADD 0x03
+#define SUB 0x2b
+#define AND 0x23
+#define OR 0x0b
+#define XOR 0x33
+#define CMP 0x3b
+#define IMUL 0x0faf
+
+/* Condition codes of jcc, in the order of T_relOp */
+static const unsigned char conditions[] = {0x84, 0x85, 0x8c, 0x8f, 0x8e,
+                                           0x8d, 0x82, 0x86, 0x87, 0x83};
+
+static void jump(jit *j, int target) {
+  byte(j, 0xe9);
+  relative(j, target);
+}
+
+static void branch(jit *j, T_relOp op, int target) {
+  byte(j, 0x0f);
+  byte(j, conditions[op]);
+  relative(j, target);
+}
+
+/* Call the C function "f", with the stack aligned as it expects */
+static void callC(jit *j, const void *f) {
+  static const unsigned char align[] = {
+      0x49, 0x89, 0xe7,        /* mov %rsp, %r15 */
+      0x48, 0x83, 0xe4, 0xf0}; /* and $-16, %rsp */
+  static const unsigned char call[] = {
+      0xff, 0xd0,        /* call *%rax */
+      0x4c, 0x89, 0xfc}; /* mov %r15, %rsp */
+  bytes(j, sizeof(align), align);
+  byte(j, 0x48); /* mov $f, %rax */
+  byte(j, 0xb8);
+  quad(j, f);
+  bytes(j, sizeof(call), call);
+}
+
+/* %rdi = the machine */
+static void machineArgument(jit *j) {
+  static const unsigned char code[] = {0x4c, 0x89, 0xef}; /* mov %r13, %rdi */
+  bytes(j, sizeof(code), code);
+}
+
+/* Operands are read from the bytecode, so each call is one C call. */
+static void library(VM_machine *m, int32_t *registers, const int32_t *pc) {
+  int32_t args[3];
+  int i;
+  for (i = 0; i < pc[3]; i++)
+    args[i] = registers[pc[4 + i]];
+  registers[pc[2]] = VM_library(m, pc[1], args);
+}
+
+static void stub(jit *j, const char *message) {
+  machineArgument(j);
+  byte(j, 0x48); /* mov $message, %rsi */
+  byte(j, 0xbe);
+  quad(j, message);
+  callC(j, (void *)VM_error);
+}
+
+/* Translate the instruction at "pc", of function "f" */
+static void translate(jit *j, VM_function *f, const int32_t *pc) {
+  VM_program p = j->p;
+  switch ((VM_opcode)pc[0]) {
+  case OP_MOVI:
+    byte(j, 0xc7); /* movl $k, r */
+    byte(j, 0x80 | RBX);
+    word(j, 4 * pc[1]);
+    word(j, pc[2]);
+    break;
+  case OP_MOV:
+    window(j, LOAD, RAX, pc[2]);
+    window(j, STORE, RAX, pc[1]);
+    break;
+  case OP_ADD:
+  case OP_SUB:
+  case OP_MUL:
+  case OP_AND:
+  case OP_OR:
+  case OP_XOR: {
+    static const int ops[] = {[OP_ADD] = ADD, [OP_SUB] = SUB,
+                              [OP_MUL] = IMUL, [OP_AND] = AND,
+                              [OP_OR] = OR,   [OP_XOR] = XOR};
+    window(j, LOAD, RAX, pc[2]);
+    window(j, ops[pc[0]], RAX, pc[3]);
+    window(j, STORE, RAX, pc[1]);
+    break;
+  }
+  case OP_DIV: {
+    static const unsigned char divide[] = {
+        0x83, 0xf9, 0xff, /* cmp $-1, %ecx */
+        0x75, 0x04,       /* jne 1f */
+        0xf7, 0xd8,       /* neg %eax: the least integer stays put */
+        0xeb, 0x03,       /* jmp 2f */
+        0x99,             /* 1: cltd */
+        0xf7, 0xf9};      /* idiv %ecx; 2: */
+    window(j, LOAD, RCX, pc[3]);
+    byte(j, 0x85); /* test %ecx, %ecx */
+    byte(j, 0xc9);
+    branch(j, T_eq, STUB_DIVISION);
+    window(j, LOAD, RAX, pc[2]);
+    bytes(j, sizeof(divide), divide);
+    window(j, STORE, RAX, pc[1]);
+    break;
+  }
+  case OP_SHL:
+  case OP_SHR:
+  case OP_SAR:
+    window(j, LOAD, RCX, pc[3]);
+    window(j, LOAD, RAX, pc[2]);
+    byte(j, 0xd3); /* shl, shr or sar %cl, %eax */
+    byte(j, pc[0] == OP_SHL ? 0xe0 : pc[0] == OP_SHR ? 0xe8 : 0xf8);
+    window(j, STORE, RAX, pc[1]);
+    break;
+  case OP_ADDI:
+    window(j, LOAD, RAX, pc[2]);
+    byte(j, 0x05); /* add $k, %eax */
+    word(j, pc[3]);
+    window(j, STORE, RAX, pc[1]);
+    break;
+  case OP_MULI:
+    window(j, 0x69, RAX, pc[2]); /* imul $k, r, %eax */
+    word(j, pc[3]);
+    window(j, STORE, RAX, pc[1]);
+    break;
+  case OP_DIVI:
+    window(j, LOAD, RAX, pc[2]);
+    if (pc[3] == -1) {
+      byte(j, 0xf7); /* neg %eax */
+      byte(j, 0xd8);
+    } else {
+      byte(j, 0xb9); /* mov $k, %ecx */
+      word(j, pc[3]);
+      byte(j, 0x99); /* cltd */
+      byte(j, 0xf7); /* idiv %ecx */
+      byte(j, 0xf9);
+    }
+    window(j, STORE, RAX, pc[1]);
+    break;
+  case OP_LOAD: {
+    /* mov (%r12,%rax), %eax */
+    static const unsigned char load[] = {0x41, 0x8b, 0x04, 0x04};
+    window(j, LOAD, RAX, pc[2]);
+    byte(j, 0x05); /* add $k, %eax, which clears the upper half */
+    word(j, pc[3]);
+    bytes(j, sizeof(load), load);
+    window(j, STORE, RAX, pc[1]);
+    break;
+  }
+  case OP_STORE: {
+    /* mov %ecx, (%r12,%rax) */
+    static const unsigned char store[] = {0x41, 0x89, 0x0c, 0x04};
+    window(j, LOAD, RAX, pc[1]);
+    byte(j, 0x05); /* add $k, %eax */
+    word(j, pc[2]);
+    window(j, LOAD, RCX, pc[3]);
+    bytes(j, sizeof(store), store);
+    break;
+  }
+  case OP_JMP:
+    jump(j, pc[1]);
+    break;
+  case OP_BEQ:
+  case OP_BNE:
+  case OP_BLT:
+  case OP_BGT:
+  case OP_BLE:
+  case OP_BGE:
+  case OP_BULT:
+  case OP_BULE:
+  case OP_BUGT:
+  case OP_BUGE:
+    window(j, LOAD, RAX, pc[1]);
+    window(j, CMP, RAX, pc[2]);
+    branch(j, pc[0] - OP_BEQ, pc[3]);
+    break;
+  case OP_BEQI:
+  case OP_BNEI:
+  case OP_BLTI:
+  case OP_BGTI:
+  case OP_BLEI:
+  case OP_BGEI:
+    window(j, 0x81, 7, pc[1]); /* cmpl $k, r */
+    word(j, pc[2]);
+    branch(j, pc[0] - OP_BEQI, pc[3]);
+    break;
+  case OP_CALL: {
+    /* cmp registersEnd(%r13), %rax */
+    static const unsigned char checkWindow[] = {0x49, 0x3b, 0x85};
+    /* mov %r14d, %ecx */
+    static const unsigned char framePointer[] = {0x44, 0x89, 0xf1};
+    /* mov %ecx, %eax */
+    static const unsigned char checkStack[] = {0x89, 0xc8};
+    /* mov %eax, k(%r12,%rcx) */
+    static const unsigned char inFrame[] = {0x41, 0x89, 0x84, 0x0c};
+    VM_function *g = &p->functions[pc[1]];
+    int own = f->registers, n = pc[3], i;
+    byte(j, 0x48); /* lea 4(own + g's)(%rbx), %rax */
+    window(j, 0x8d, RAX, own + g->registers);
+    bytes(j, sizeof(checkWindow), checkWindow);
+    word(j, offsetof(VM_machine, registersEnd));
+    branch(j, T_ugt, STUB_OVERFLOW);
+    bytes(j, sizeof(framePointer), framePointer);
+    byte(j, 0x81); /* sub $(8 + 4n), %ecx */
+    byte(j, 0xe9);
+    word(j, 8 + 4 * n);
+    bytes(j, sizeof(checkStack), checkStack);
+    byte(j, 0x2d); /* sub $frameSize, %eax */
+    word(j, g->frameSize);
+    byte(j, 0x3d); /* cmp $limit, %eax */
+    word(j, MEMORY_SIZE - STACK_SIZE);
+    branch(j, T_ult, STUB_OVERFLOW);
+    for (i = 0; i < n; i++) {
+      window(j, LOAD, RAX, pc[4 + i]);
+      if (g->formals[i] >= 0) {
+        bytes(j, sizeof(inFrame), inFrame);
+        word(j, g->formals[i]);
+      } else
+        window(j, STORE, RAX, own + ~g->formals[i]);
+    }
+    window(j, STORE, RCX, own); /* the frame pointer of g */
+    byte(j, 0x48);              /* add $4own, %rbx */
+    byte(j, 0x81);
+    byte(j, 0xc3);
+    word(j, 4 * own);
+    byte(j, 0xe8); /* call g */
+    relative(j, g->entry);
+    byte(j, 0x48); /* sub $4own, %rbx */
+    byte(j, 0x81);
+    byte(j, 0xeb);
+    word(j, 4 * own);
+    window(j, STORE, RAX, pc[2]);
+    break;
+  }
+  case OP_LIB: {
+    /* mov %rbx, %rsi */
+    static const unsigned char registers[] = {0x48, 0x89, 0xde};
+    machineArgument(j);
+    bytes(j, sizeof(registers), registers);
+    byte(j, 0x48); /* mov $pc, %rdx */
+    byte(j, 0xba);
+    quad(j, pc);
+    callC(j, (void *)library);
+    break;
+  }
+  case OP_RET: {
+    static const unsigned char restore[] = {
+        0x44, 0x8b, 0xb3, 0, 0, 0, 0, /* mov (%rbx), %r14d */
+        0x41, 0x81, 0xc6};            /* add $k, %r14d */
+    window(j, LOAD, RAX, 1);
+    bytes(j, sizeof(restore), restore);
+    word(j, 8 + 4 * f->formalCount);
+    byte(j, 0xc3); /* ret */
+    break;
+  }
+  case OP_COUNT:
+    assert(0);
+  }
+}
+
+/* The words of the instruction at "pc" */
+static int instructionSize(const int32_t *pc) {
+  switch ((VM_opcode)pc[0]) {
+  case OP_MOVI:
+  case OP_MOV:
+    return 3;
+  case OP_JMP:
+    return 2;
+  case OP_CALL:
+  case OP_LIB:
+    return 4 + pc[3];
+  case OP_RET:
+    return 1;
+  default:
+    return 4;
+  }
+}
+
+static void translateFunction(jit *j, VM_function *f, int end) {
+  static const unsigned char entry[] = {
+      0x44, 0x8b, 0xb3, 0, 0, 0, 0, /* mov (%rbx), %r14d */
+      0x41, 0x81, 0xee};            /* sub $k, %r14d */
+  const int32_t *code = j->p->code;
+  int at;
+  j->native[f->entry] = j->size;
+  bytes(j, sizeof(entry), entry);
+  word(j, f->frameSize);
+  for (at = f->entry; at < end; at += instructionSize(code + at)) {
+    if (at != f->entry)
+      j->native[at] = j->size;
+    translate(j, f, code + at);
+  }
+}
+
+/* The code that enters it from C: enter(machine, window, memory, stack,
+ * tigermain). */
+static void entry(jit *j) {
+  static const unsigned char code[] = {
+      0x53, 0x55, 0x41, 0x54, 0x41, 0x55, /* push %rbx, %rbp, %r12, %r13 */
+      0x41, 0x56, 0x41, 0x57,             /* push %r14, %r15 */
+      0x49, 0x89, 0xfd,                   /* mov %rdi, %r13 */
+      0x48, 0x89, 0xf3,                   /* mov %rsi, %rbx */
+      0x49, 0x89, 0xd4,                   /* mov %rdx, %r12 */
+      0x48, 0x89, 0xe5,                   /* mov %rsp, %rbp */
+      0x48, 0x89, 0xcc,                   /* mov %rcx, %rsp */
+      0x41, 0xff, 0xd0,                   /* call *%r8 */
+      0x48, 0x89, 0xec,                   /* mov %rbp, %rsp */
+      0x41, 0x5f, 0x41, 0x5e, 0x41, 0x5d, /* pop %r15, %r14, %r13 */
+      0x41, 0x5c, 0x5d, 0x5b,             /* pop %r12, %rbp, %rbx */
+      0xc3};                              /* ret */
+  bytes(j, sizeof(code), code);
+}
+
+typedef void (*enterer)(VM_machine *m, int32_t *window, unsigned char *memory,
+                        void *stack, void *tigermain);
+
+typedef struct {
+  unsigned char *code; /* executable */
+  size_t size;
+  int main; /* the offset of tigermain in it */
+  unsigned char *stack;
+} native;
+
+static native compiled; /* for the run, which VM_execute cannot pass on */
+
+static void runNative(VM_machine *m) {
+  VM_function *f = &m->p->functions[m->p->main];
+  int32_t staticLink = 0;
+  m->registers[0] = VM_enterFrame(m, f, &staticLink, m->registers);
+  ((enterer)compiled.code)(m, m->registers, m->memory,
+                           compiled.stack + NATIVE_STACK,
+                           compiled.code + compiled.main);
+}
+
+int VM_jit(VM_program p, FILE *in, FILE *out) {
+  jit j;
+  int i, status;
+  memset(&j, 0, sizeof(j));
+  j.p = p;
+  j.native = checked_malloc((p->codeSize + 1) * sizeof(int));
+  entry(&j);
+  for (i = 0; i < p->functionCount; i++)
+    translateFunction(&j, &p->functions[i], i + 1 < p->functionCount
+                                                ? p->functions[i + 1].entry
+                                                : p->codeSize);
+  j.overflow = j.size;
+  stub(&j, "stack overflow");
+  j.division = j.size;
+  stub(&j, "division by zero");
+  for (i = 0; i < j.fixupCount; i++) {
+    fixup *x = &j.fixups[i];
+    int target = x->target == STUB_OVERFLOW   ? j.overflow
+                 : x->target == STUB_DIVISION ? j.division
+                                              : j.native[x->target];
+    int32_t offset = target - x->at;
+    memcpy(j.bytes + x->at - 4, &offset, 4);
+  }
+
+  compiled.size = j.size;
+  compiled.main = j.native[p->functions[p->main].entry];
+  compiled.code = mmap(NULL, j.size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  compiled.stack = mmap(NULL, NATIVE_STACK, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (compiled.code == MAP_FAILED || compiled.stack == MAP_FAILED) {
+    fprintf(stderr, "vm: cannot map native code\n");
+    return 1;
+  }
+  memcpy(compiled.code, j.bytes, j.size);
+  free(j.bytes);
+  free(j.native);
+  free(j.fixups);
+  if (mprotect(compiled.code, compiled.size, PROT_READ | PROT_EXEC)) {
+    fprintf(stderr, "vm: cannot make native code executable\n");
+    return 1;
+  }
+  status = VM_execute(p, in, out, runNative);
+  munmap(compiled.code, compiled.size);
+  munmap(compiled.stack, NATIVE_STACK);
+  return status;
+}
+
+#else
+
+/* Elsewhere the bytecode is run as it is. */
+int VM_jit(VM_program p, FILE *in, FILE *out) { return VM_run(p, in, out); }
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * machine.h - The bytecode of vm.c and the machine that runs it, shared
+ * with jit.c, which translates the bytecode to native code.
+ *
+ * Include it after vm.h, with <stdint.h>, <setjmp.h> and table.h.
+ */
+
+#define PAGE 4096
+#define MEMORY_SIZE (1u << 30)   /* mapped: the heap and stack */
+#define STACK_SIZE (16u << 20)   /* at the top of it */
+#define REGISTER_WORDS (1 << 24) /* in all the windows at once */
+#define MAX_CALLS (1 << 20)      /* activations of VM_run */
+
+typedef enum {
+  OP_MOVI, /* d k: d = k */
+  OP_MOV,  /* d s: d = s */
+  /* d a b: d = a op b, in the order of T_binOp */
+  OP_ADD,
+  OP_SUB,
+  OP_MUL,
+  OP_DIV,
+  OP_AND,
+  OP_OR,
+  OP_SHL,
+  OP_SHR,
+  OP_SAR,
+  OP_XOR,
+  OP_ADDI, /* d a k: d = a + k */
+  OP_MULI, /* d a k: d = a * k */
+  OP_DIVI, /* d a k: d = a / k, k not 0 */
+  OP_LOAD,  /* d b k: d = mem[b + k] */
+  OP_STORE, /* b k s: mem[b + k] = s */
+  OP_JMP,   /* t */
+  /* a b t: to t if a relop b, in the order of T_relOp */
+  OP_BEQ,
+  OP_BNE,
+  OP_BLT,
+  OP_BGT,
+  OP_BLE,
+  OP_BGE,
+  OP_BULT,
+  OP_BULE,
+  OP_BUGT,
+  OP_BUGE,
+  /* a k t: the same against a constant, for the signed ones */
+  OP_BEQI,
+  OP_BNEI,
+  OP_BLTI,
+  OP_BGTI,
+  OP_BLEI,
+  OP_BGEI,
+  OP_CALL, /* f d n a1 .. an: d = function f (a1, .., an) */
+  OP_LIB,  /* l d n a1 .. an: d = library function l (a1, .., an) */
+  OP_RET,  /* return register 1 */
+  OP_COUNT
+} VM_opcode;
+
+typedef struct {
+  F_frame frame;
+  T_stmList stms;   /* canonical */
+  int entry;        /* where its code starts */
+  int registers;    /* in its window */
+  int frameSize;    /* bytes of locals below the frame pointer */
+  int formalCount;  /* the static link first */
+  int *formals;     /* an offset from the frame pointer, or ~register */
+  int firstTemp;    /* VM_walk keeps temps from here to lastTemp */
+  int lastTemp;
+  TAB_table labels; /* label -> its cell of stms, for VM_walk */
+} VM_function;
+
+struct VM_program_ {
+  int32_t *code;
+  int codeSize, codeCapacity;
+  VM_function *functions;
+  int functionCount, main;
+  unsigned char *data; /* the image of memory from CONSTS to dataEnd */
+  uint32_t dataEnd;
+  TAB_table functionIndex; /* label -> index + 1 */
+  TAB_table libraryIndex;  /* label -> libraryFunction + 1 */
+  TAB_table strings;       /* label -> address */
+};
+
+typedef struct {
+  const int32_t *pc; /* to go on from */
+  int32_t *registers;
+  int dst, window;
+  uint32_t sp;
+} VM_activation;
+
+typedef struct {
+  VM_program p;
+  unsigned char *memory;
+  uint32_t heap, sp; /* the next free byte of each */
+  int32_t *registers, *registersEnd;
+  VM_activation *calls;
+  FILE *in, *out;
+  sigjmp_buf exit;
+  int status, depth;
+} VM_machine;
+
+/* End the run with an error of the machine's own. */
+void VM_error(VM_machine *m, const char *message);
+
+/* Call library function "function" (see vm.c) with arguments "a" */
+int32_t VM_library(VM_machine *m, int function, int32_t *a);
+
+/* Make the frame of "f", called with "args", below m->sp; return its frame
+ *  pointer, and leave the arguments that go in registers in "window", if it
+ *  is not NULL. */
+uint32_t VM_enterFrame(VM_machine *m, VM_function *f, int32_t *args,
+                       int32_t *window);
+
+/* Set up the memory of a machine for "p", run "body" on it and take it all
+ *  down again; return the exit status. */
+int VM_execute(VM_program p, FILE *in, FILE *out,
+               void (*body)(VM_machine *m));
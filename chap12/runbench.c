@@ -0,0 +1,289 @@
+/*
+ * runbench.c - Build the benchmark programs and measure how they run.
+ *
+ * Each program is built by tigerbuild (tigerbuild.c), then run -runs
+ * times with name.in as its input, if there is one, and what it prints is
+ * compared with name.out. For each program the least wall time is
+ * printed, with the instructions it retired in user mode, as counted by
+ * the processor where the kernel lets us, and its peak resident size.
+ *
+ *   runbench [-build path] [-runs n] [tigerbuild options] file.tig ...
+ *
+ * The programs in bench are the suite. The exit status is 1 if any of
+ * them could not be built, failed or printed the wrong thing.
+ *
+ *   cc -O2 -o runbench runbench.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+
+#define MAX_ARGS 32
+
+typedef struct {
+  int status;
+  double ms;
+  long long instructions; /* -1 if they could not be counted */
+  long rss;               /* kilobytes */
+} measurement;
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+static int exitStatus(int status) {
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+/* A counter of the instructions "pid" retires once it calls exec */
+static int countInstructions(pid_t pid) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+  attr.disabled = 1;
+  attr.enable_on_exec = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0);
+}
+
+/* Run "program" with "in" as its input and "out" as its output. The child
+ * waits on a pipe until the counter is on it. */
+static measurement measure(char *program, int in, int out) {
+  measurement m;
+  struct rusage usage;
+  int ready[2], counter, status;
+  double start;
+  pid_t pid;
+  if (pipe(ready) < 0) {
+    perror("pipe");
+    exit(1);
+  }
+  if ((pid = fork()) < 0) {
+    perror("fork");
+    exit(1);
+  }
+  if (pid == 0) {
+    char c, *argv[2];
+    close(ready[1]);
+    if (read(ready[0], &c, 1) != 1)
+      _exit(127);
+    dup2(in, 0);
+    dup2(out, 1);
+    argv[0] = program;
+    argv[1] = NULL;
+    execv(program, argv);
+    perror(program);
+    _exit(127);
+  }
+  close(ready[0]);
+  counter = countInstructions(pid);
+  start = now();
+  if (write(ready[1], "", 1) != 1)
+    perror("write");
+  close(ready[1]);
+  if (wait4(pid, &status, 0, &usage) < 0) {
+    perror("wait4");
+    exit(1);
+  }
+  m.ms = now() - start;
+  m.status = exitStatus(status);
+  m.rss = usage.ru_maxrss;
+  m.instructions = -1;
+  if (counter >= 0) {
+    long long count;
+    if (read(counter, &count, sizeof(count)) == sizeof(count))
+      m.instructions = count;
+    close(counter);
+  }
+  return m;
+}
+
+/* The contents of "fname", or NULL */
+static char *readFile(const char *fname, long *size) {
+  FILE *f = fopen(fname, "rb");
+  char *text;
+  if (!f)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  rewind(f);
+  text = malloc(*size + 1);
+  if (fread(text, 1, *size, f) != (size_t)*size) {
+    free(text);
+    text = NULL;
+  }
+  fclose(f);
+  return text;
+}
+
+/* "fname" with its .tig replaced by "suffix" */
+static char *sibling(const char *fname, const char *suffix) {
+  size_t length = strlen(fname);
+  char *name = malloc(length + strlen(suffix) + 1);
+  strcpy(name, fname);
+  if (length > 4 && !strcmp(name + length - 4, ".tig"))
+    name[length - 4] = '\0';
+  return strcat(name, suffix);
+}
+
+static int build(char **buildArgs, int buildCount, char *source,
+                 char *program) {
+  int status;
+  pid_t pid;
+  buildArgs[buildCount] = "-o";
+  buildArgs[buildCount + 1] = program;
+  buildArgs[buildCount + 2] = source;
+  buildArgs[buildCount + 3] = NULL;
+  if ((pid = fork()) < 0) {
+    perror("fork");
+    exit(1);
+  }
+  if (pid == 0) {
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, 1); /* its errors are left to show */
+    execv(buildArgs[0], buildArgs);
+    perror(buildArgs[0]);
+    _exit(127);
+  }
+  if (waitpid(pid, &status, 0) < 0)
+    return 1;
+  return exitStatus(status);
+}
+
+/* Build and run "source"; tell if it did what it should. */
+static int bench(char **buildArgs, int buildCount, char *source, int runs,
+                 char *dir) {
+  char *base = strrchr(source, '/') ? strrchr(source, '/') + 1 : source;
+  char *program = malloc(strlen(dir) + strlen(base) + 2);
+  char *inName = sibling(source, ".in"), *expectedName;
+  char *output = NULL, *expected;
+  long outputSize, expectedSize;
+  char name[64], result[32], instructions[32];
+  measurement best = {0, 0, -1, 0};
+  int in, out, k, ok = 1;
+
+  sprintf(program, "%s/%s", dir, base);
+  snprintf(name, sizeof(name), "%s", base);
+  if (strchr(name, '.'))
+    *strchr(name, '.') = '\0';
+  if (build(buildArgs, buildCount, source, program)) {
+    printf("%-16s %-12s\n", name, "not built");
+    free(program);
+    free(inName);
+    return 0;
+  }
+  for (k = 0; k < runs; k++) {
+    measurement m;
+    char outName[] = "/tmp/runbenchXXXXXX";
+    in = open(inName, O_RDONLY);
+    if (in < 0)
+      in = open("/dev/null", O_RDONLY);
+    out = mkstemp(outName);
+    if (out < 0) {
+      perror("mkstemp");
+      exit(1);
+    }
+    m = measure(program, in, out);
+    close(in);
+    close(out);
+    free(output);
+    output = readFile(outName, &outputSize);
+    unlink(outName);
+    if (k == 0 || m.ms < best.ms)
+      best = m;
+    if (m.status)
+      break;
+  }
+  expectedName = sibling(source, ".out");
+  expected = readFile(expectedName, &expectedSize);
+  if (best.status) {
+    snprintf(result, sizeof(result), "status %d", best.status);
+    ok = 0;
+  } else if (!expected)
+    snprintf(result, sizeof(result), "no .out");
+  else if (!output || outputSize != expectedSize ||
+           memcmp(output, expected, expectedSize)) {
+    snprintf(result, sizeof(result), "wrong output");
+    ok = 0;
+  } else
+    snprintf(result, sizeof(result), "ok");
+  if (best.instructions >= 0)
+    snprintf(instructions, sizeof(instructions), "%.1f",
+             best.instructions / 1e6);
+  else
+    snprintf(instructions, sizeof(instructions), "-");
+  printf("%-16s %-12s %10.1f %16s %10ld\n", name, result, best.ms,
+         instructions, best.rss);
+  unlink(program);
+  free(program);
+  free(output);
+  free(expected);
+  free(inName);
+  free(expectedName);
+  return ok;
+}
+
+/* Whether an option of tigerbuild, or of tiger, is followed by a value */
+static int takesValue(const char *option) {
+  static const char *options[] = {"-tiger", "-runtime", "-cc", "-threads",
+                                  "-cache", "-cache-size", "-trace"};
+  size_t i;
+  for (i = 0; i < sizeof(options) / sizeof(options[0]); i++)
+    if (!strcmp(option, options[i]))
+      return 1;
+  return 0;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: runbench [-build path] [-runs n] "
+                  "[tigerbuild options] file.tig ...\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  char *buildArgs[MAX_ARGS + 4], dir[] = "/tmp/runbenchXXXXXX";
+  int buildCount = 1, runs = 3, i, failed = 0;
+  buildArgs[0] = "./tigerbuild";
+  for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if (!strcmp(argv[i], "-build") && i + 1 < argc)
+      buildArgs[0] = argv[++i];
+    else if (!strcmp(argv[i], "-runs") && i + 1 < argc) {
+      if ((runs = atoi(argv[++i])) < 1)
+        usage();
+    } else if (buildCount + 2 >= MAX_ARGS)
+      usage();
+    else {
+      buildArgs[buildCount++] = argv[i];
+      if (takesValue(argv[i])) {
+        if (i + 1 == argc)
+          usage();
+        buildArgs[buildCount++] = argv[++i];
+      }
+    }
+  }
+  if (i == argc)
+    usage();
+  if (!mkdtemp(dir)) {
+    perror("mkdtemp");
+    return 1;
+  }
+  printf("%-16s %-12s %10s %16s %10s\n", "program", "result", "ms",
+         "instructions (M)", "rss (kB)");
+  for (; i < argc; i++)
+    failed |= !bench(buildArgs, buildCount, argv[i], runs, dir);
+  rmdir(dir);
+  return failed;
+}
@@ -1,5 +1,48 @@
-#undef __STDC__
+/* Tiger's getchar returns a string, so stdio's is kept out of the way. */
+#define getchar stdio_getchar
 #include <stdio.h>
+#include <stdlib.h>
+#undef getchar
+#include <stdint.h>
+
+int tigermain(int staticLink);
+
+/* A Tiger word holds an address. The code tiger makes is 32-bit, but the C
+ * that cgen.c makes may be built for a 64-bit host, linked -no-pie so that
+ * its static data is low; what is allocated is then kept low too. */
+#if UINTPTR_MAX > 0xffffffffu
+#include <sys/mman.h>
+#ifdef MAP_32BIT
+
+#define HEAP_SIZE (1ul << 29) /* MAP_32BIT has 1 GB to give */
+
+static void *lowMalloc(size_t size) {
+  static char *next, *end;
+  void *p;
+  if (!next) {
+    next = mmap(NULL, HEAP_SIZE, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_32BIT, -1,
+                0);
+    if (next == MAP_FAILED) {
+      fprintf(stderr, "cannot map the heap\n");
+      exit(1);
+    }
+    end = next + HEAP_SIZE;
+  }
+  size = (size + 7) & ~(size_t)7;
+  if (size > (size_t)(end - next)) {
+    fflush(stdout);
+    fprintf(stderr, "out of memory\n");
+    exit(1);
+  }
+  p = next;
+  next += size;
+  return p;
+}
+
+#define malloc lowMalloc
+#endif
+#endif
 
 int *initArray(int size, int init) {
   int i;
@@ -42,12 +85,12 @@ void print(struct string *s) {
     putchar(*p);
 }
 
-void flush() { fflush(stdout); }
+void flush(void) { fflush(stdout); }
 
 struct string consts[256];
 struct string empty = {0, ""};
 
-int main() {
+int main(void) {
   int i;
   for (i = 0; i < 256; i++) {
     consts[i].length = 1;
@@ -109,9 +152,7 @@ struct string *concat(struct string *a, struct string *b) {
 
 int not(int i) { return !i; }
 
-#undef getchar
-
-struct string *getchar() {
+struct string *getchar(void) {
   int i = getc(stdin);
   if (i == EOF)
     return &empty;
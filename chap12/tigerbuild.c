@@ -0,0 +1,143 @@
+/*
+ * tigerbuild.c - Compile a Tiger program all the way to an executable.
+ *
+ * tiger writes the assembly of file.tig to file.tig.s; this runs it, then
+ * has the system C compiler assemble that and link it with the runtime
+ * (runtime.c), which holds main and the library Tiger programs call. The
+ * code tiger makes is for 32-bit x86, so the C compiler gets -m32.
+ *
+ * With -via-c, tiger writes the program as C instead (cgen.h), to
+ * file.tig.c, which the C compiler builds with -O2 for the host; it is
+ * linked -no-pie, so that its data has 32-bit addresses.
+ *
+ *   tigerbuild [-tiger path] [-runtime path] [-cc path] [-o output]
+ *     [-via-c] [tiger options] file.tig
+ *
+ * Other options go to tiger. The executable is named after the program,
+ * less its .tig (or a.out), unless -o names it; the assembly, or the C,
+ * is left behind. The compiler and the runtime are looked for next to
+ * tigerbuild itself.
+ *
+ *   cc -O2 -o tigerbuild tigerbuild.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define MAX_ARGS 32
+
+/* Run "argv", looking it up in PATH; return its exit status. */
+static int run(char **argv) {
+  int status;
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return 1;
+  }
+  if (pid == 0) {
+    execvp(argv[0], argv);
+    perror(argv[0]);
+    _exit(127);
+  }
+  if (waitpid(pid, &status, 0) < 0) {
+    perror("waitpid");
+    return 1;
+  }
+  if (WIFSIGNALED(status))
+    fprintf(stderr, "%s: killed by signal %d\n", argv[0], WTERMSIG(status));
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+/* "name" in the directory tigerbuild was run from */
+static char *besideSelf(const char *self, const char *name) {
+  const char *slash = strrchr(self, '/');
+  int dirLength = slash ? slash - self + 1 : 2;
+  char *path = malloc(dirLength + strlen(name) + 1);
+  if (slash)
+    memcpy(path, self, dirLength);
+  else
+    memcpy(path, "./", 2);
+  strcpy(path + dirLength, name);
+  return path;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: tigerbuild [-tiger path] [-runtime path] [-cc path] "
+                  "[-o output]\n  [-via-c] [tiger options] file.tig\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  char *tiger = besideSelf(argv[0], "tiger");
+  char *runtime = besideSelf(argv[0], "runtime.c");
+  char *cc = "cc", *output = NULL, *source = NULL, *assembly;
+  char *tigerArgs[MAX_ARGS], *ccArgs[MAX_ARGS];
+  int tigerCount = 1, ccCount = 0, viaC = 0, i, status;
+  for (i = 1; i < argc; i++) {
+    if (argv[i][0] != '-') {
+      if (source)
+        usage();
+      source = argv[i];
+    } else if (tigerCount + 3 >= MAX_ARGS)
+      usage();
+    else if (!strcmp(argv[i], "-tiger") && i + 1 < argc)
+      tiger = argv[++i];
+    else if (!strcmp(argv[i], "-runtime") && i + 1 < argc)
+      runtime = argv[++i];
+    else if (!strcmp(argv[i], "-cc") && i + 1 < argc)
+      cc = argv[++i];
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+      output = argv[++i];
+    else if (!strcmp(argv[i], "-via-c"))
+      viaC = 1;
+    else if (!strcmp(argv[i], "-threads") || !strcmp(argv[i], "-cache") ||
+             !strcmp(argv[i], "-cache-size") || !strcmp(argv[i], "-trace")) {
+      /* the options of tiger that take an argument */
+      if (i + 1 == argc)
+        usage();
+      tigerArgs[tigerCount++] = argv[i];
+      tigerArgs[tigerCount++] = argv[++i];
+    } else
+      tigerArgs[tigerCount++] = argv[i];
+  }
+  if (!source)
+    usage();
+  if (!output) {
+    size_t length = strlen(source);
+    output = "a.out";
+    if (length > 4 && !strcmp(source + length - 4, ".tig")) {
+      output = strdup(source);
+      output[length - 4] = '\0';
+    }
+  }
+  assembly = strcat(strcpy(malloc(strlen(source) + 3), source),
+                    viaC ? ".c" : ".s");
+
+  tigerArgs[0] = tiger;
+  if (viaC) {
+    /* -emit-c must come first */
+    memmove(tigerArgs + 2, tigerArgs + 1, (tigerCount - 1) * sizeof(char *));
+    tigerArgs[1] = "-emit-c";
+    tigerCount++;
+  }
+  tigerArgs[tigerCount++] = source;
+  tigerArgs[tigerCount] = NULL;
+  if ((status = run(tigerArgs)))
+    return status;
+
+  ccArgs[ccCount++] = cc;
+  if (viaC) {
+    ccArgs[ccCount++] = "-O2";
+    ccArgs[ccCount++] = "-no-pie";
+  } else
+    ccArgs[ccCount++] = "-m32";
+  ccArgs[ccCount++] = "-o";
+  ccArgs[ccCount++] = output;
+  ccArgs[ccCount++] = assembly;
+  ccArgs[ccCount++] = runtime;
+  ccArgs[ccCount] = NULL;
+  return run(ccArgs);
+}
@@ -0,0 +1,225 @@
+/*
+ * tigervm.c - Run Tiger programs on the bytecode machine (vm.h).
+ *
+ *   tigervm [-walk | -jit] file.tig
+ *
+ * compiles file.tig and runs it, with the standard input and output as
+ * its own; -walk runs it on the tree walker instead, and -jit as native
+ * code (jit.c). The exit status is the program's.
+ *
+ *   tigervm -bench [-runs n] file.tig ...
+ *
+ * runs each program -runs times on each, with name.in as its input if
+ * there is one, checks what it prints against name.out and prints the
+ * least time of the bytecode, the native code and the walker, how many
+ * times faster than the walker the other two are, and how many words of
+ * bytecode there are. The programs in bench are the suite.
+ *
+ * Build it from a directory holding the chap7, chap9 and chap12 sources:
+ *
+ *   cc -O2 -pthread -o tigervm tigervm.c vm.c jit.c canon.c parse.c y.tab.c
+ *     lex.yy.c scan.c errormsg.c util.c absyn.c symbol.c table.c types.c
+ *     env.c semant.c temp.c translate.c x86frame.c tree.c arena.c context.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "absyn.h"
+#include "errormsg.h"
+#include "temp.h"
+#include "tree.h"
+#include "frame.h"
+#include "translate.h"
+#include "semant.h"
+#include "parse.h"
+#include "vm.h"
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+/* Parse, check and translate "fname"; NULL if it has errors. Escape
+ * analysis is left out: every variable escapes, as absyn.c has it. */
+static VM_program compile(string fname) {
+  A_exp absyn_root = parseFrom(fname, fname);
+  F_fragList frags;
+  if (!absyn_root)
+    return NULL;
+  frags = SEM_transProg(absyn_root);
+  if (EM_anyErrors())
+    return NULL;
+  return VM_load(frags);
+}
+
+/* Nothing from one program is needed to run the next. */
+static void forget(VM_program p) {
+  VM_free(p);
+  AR_resetAll();
+  Tr_reset();
+  Temp_reset();
+  F_reset();
+}
+
+/* The contents of "f", from the start */
+static char *contents(FILE *f, long *size) {
+  char *text;
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  rewind(f);
+  text = checked_malloc(*size + 1);
+  if (fread(text, 1, *size, f) != (size_t)*size)
+    *size = -1;
+  return text;
+}
+
+/* "fname" with its .tig replaced by "suffix" */
+static char *sibling(const char *fname, const char *suffix) {
+  size_t length = strlen(fname);
+  char *name = checked_malloc(length + strlen(suffix) + 1);
+  strcpy(name, fname);
+  if (length > 4 && !strcmp(name + length - 4, ".tig"))
+    name[length - 4] = '\0';
+  return strcat(name, suffix);
+}
+
+typedef int (*runner)(VM_program p, FILE *in, FILE *out);
+
+/* Run "p" "runs" times on "run"; return the least time, and leave what
+ * the last run printed in "output". */
+static double measure(VM_program p, runner run, int runs, const char *inName,
+                      char **output, long *outputSize, int *status) {
+  double best = 0;
+  int k;
+  *output = NULL;
+  for (k = 0; k < runs; k++) {
+    FILE *in = fopen(inName, "rb"), *out = tmpfile();
+    double start;
+    if (!in)
+      in = fopen("/dev/null", "rb");
+    start = now();
+    *status = run(p, in, out);
+    start = now() - start;
+    if (k == 0 || start < best)
+      best = start;
+    free(*output);
+    *output = contents(out, outputSize);
+    fclose(in);
+    fclose(out);
+    if (*status)
+      break;
+  }
+  return best;
+}
+
+static bool same(char *output, long outputSize, char *expected,
+                 long expectedSize) {
+  return outputSize == expectedSize && !memcmp(output, expected, outputSize);
+}
+
+/* Compile and run "fname" on all three; tell if it did what it should. */
+static bool bench(string fname, int runs) {
+  char *inName = sibling(fname, ".in"), *outName = sibling(fname, ".out");
+  char *base = strrchr(fname, '/') ? strrchr(fname, '/') + 1 : fname;
+  char name[64], result[32], *expected = NULL, *vmOutput, *walkOutput;
+  char *jitOutput;
+  long expectedSize = -1, vmSize, jitSize, walkSize;
+  double vmTime, jitTime, walkTime;
+  int vmStatus, jitStatus, walkStatus, words;
+  FILE *f = fopen(outName, "rb");
+  VM_program p;
+  bool ok = TRUE;
+
+  snprintf(name, sizeof(name), "%s", base);
+  if (strchr(name, '.'))
+    *strchr(name, '.') = '\0';
+  if (f) {
+    expected = contents(f, &expectedSize);
+    fclose(f);
+  }
+  if (!(p = compile(fname))) {
+    printf("%-16s %-12s\n", name, "not compiled");
+    forget(NULL);
+    free(expected);
+    free(inName);
+    free(outName);
+    return FALSE;
+  }
+  words = VM_codeSize(p);
+  vmTime = measure(p, VM_run, runs, inName, &vmOutput, &vmSize, &vmStatus);
+  jitTime = measure(p, VM_jit, runs, inName, &jitOutput, &jitSize, &jitStatus);
+  walkTime =
+      measure(p, VM_walk, runs, inName, &walkOutput, &walkSize, &walkStatus);
+  forget(p);
+
+  if (vmStatus || jitStatus || walkStatus) {
+    snprintf(result, sizeof(result), "status %d",
+             vmStatus ? vmStatus : jitStatus ? jitStatus : walkStatus);
+    ok = FALSE;
+  } else if (!same(vmOutput, vmSize, walkOutput, walkSize) ||
+             !same(jitOutput, jitSize, walkOutput, walkSize)) {
+    snprintf(result, sizeof(result), "disagree");
+    ok = FALSE;
+  } else if (!expected)
+    snprintf(result, sizeof(result), "no .out");
+  else if (!same(vmOutput, vmSize, expected, expectedSize)) {
+    snprintf(result, sizeof(result), "wrong output");
+    ok = FALSE;
+  } else
+    snprintf(result, sizeof(result), "ok");
+  printf("%-16s %-12s %8.1f %8.1f %8.1f %7.1fx %7.1fx %7d\n", name, result,
+         vmTime, jitTime, walkTime, walkTime / (vmTime > 0 ? vmTime : 1e-3),
+         walkTime / (jitTime > 0 ? jitTime : 1e-3), words);
+  free(vmOutput);
+  free(jitOutput);
+  free(walkOutput);
+  free(expected);
+  free(inName);
+  free(outName);
+  return ok;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: tigervm [-walk | -jit] file.tig\n"
+                  "       tigervm -bench [-runs n] file.tig ...\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  bool benchmark = FALSE, failed = FALSE;
+  runner run = VM_run;
+  int runs = 3, i, status;
+  VM_program p;
+  for (i = 1; i < argc && argv[i][0] == '-'; i++)
+    if (!strcmp(argv[i], "-walk"))
+      run = VM_walk;
+    else if (!strcmp(argv[i], "-jit"))
+      run = VM_jit;
+    else if (!strcmp(argv[i], "-bench"))
+      benchmark = TRUE;
+    else if (!strcmp(argv[i], "-runs") && i + 1 < argc) {
+      if ((runs = atoi(argv[++i])) < 1)
+        usage();
+    } else
+      usage();
+  if (i == argc || (!benchmark && i + 1 != argc))
+    usage();
+  if (benchmark) {
+    printf("%-16s %-12s %8s %8s %8s %8s %8s %7s\n", "program", "result",
+           "vm ms", "jit ms", "walk ms", "vm", "jit", "words");
+    for (; i < argc; i++)
+      failed |= !bench(argv[i], runs);
+    return failed;
+  }
+  if (!(p = compile(argv[i])))
+    return 1;
+  status = run(p, stdin, stdout);
+  forget(p);
+  return status;
+}
@@ -0,0 +1,1132 @@
+/*
+ * vm.c - Lower canonical trees to bytecode, and run it.
+ *
+ * An instruction is an opcode followed by its operands, each a 32-bit
+ * word. Register operands index the window of the running function:
+ * register 0 holds its frame pointer and register 1 its return value, the
+ * temps of its body come next, and scratch registers for the values
+ * inside one statement last. Opcodes are dispatched through a table of
+ * label addresses (computed goto).
+ *
+ * Memory is one reservation of 4 GB, so that every 32-bit address falls
+ * inside it. The strings of the program and the characters chr returns
+ * are at the bottom, above a page left unmapped to catch nil; the heap
+ * grows up from them and the stack down from the top of MEMORY_SIZE. A
+ * fault anywhere in the reservation ends the run, not the process.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include "util.h"
+#include "symbol.h"
+#include "temp.h"
+#include "tree.h"
+#include "frame.h"
+#include "canon.h"
+#include "table.h"
+#include "errormsg.h"
+#include "vm.h"
+#include "machine.h"
+
+#define RESERVED (((size_t)1 << 32) + PAGE) /* any 32-bit address, and a word */
+#define CONSTS PAGE              /* chr(i) is CONSTS + 8i */
+#define EMPTY (CONSTS + 256 * 8) /* "" */
+#define STRINGS (EMPTY + 8)      /* the literals of the program */
+#define MAX_WALK_DEPTH 10000     /* of VM_walk, which recurses */
+
+/* The library of runtime.c, less main */
+typedef enum {
+  LIB_initArray,
+  LIB_allocRecord,
+  LIB_stringEqual,
+  LIB_print,
+  LIB_flush,
+  LIB_ord,
+  LIB_chr,
+  LIB_size,
+  LIB_substring,
+  LIB_concat,
+  LIB_not,
+  LIB_getchar,
+  LIB_exit,
+  LIB_COUNT
+} libraryFunction;
+
+static const char *libraryNames[LIB_COUNT] = {
+    "initArray", "allocRecord", "stringEqual", "print",  "flush",
+    "ord",       "chr",         "size",        "substring", "concat",
+    "not",       "getchar",     "exit"};
+static const int libraryArity[LIB_COUNT] = {2, 1, 2, 1, 0, 1, 1,
+                                            1, 3, 2, 1, 0, 1};
+
+
+
+/* Lowering */
+
+typedef struct {
+  int at;
+  Temp_label label;
+} fixup;
+
+typedef struct {
+  VM_program p;
+  VM_function *f;
+  TAB_table registers; /* temp -> register + 1 */
+  int temps;           /* registers taken by temps */
+  int scratch, maxScratch;
+  TAB_table labels; /* label -> offset + 1 */
+  fixup *fixups;
+  int fixupCount, fixupCapacity;
+  bool failed;
+} lowering;
+
+static void fail(lowering *l, string message, string name) {
+  if (!l->failed)
+    EM_error(0, "%s: %s %s", Temp_labelstring(F_name(l->f->frame)), message,
+             name ? name : "");
+  l->failed = TRUE;
+}
+
+static void emit(lowering *l, int32_t word) {
+  VM_program p = l->p;
+  if (p->codeSize == p->codeCapacity) {
+    int32_t *code;
+    p->codeCapacity = p->codeCapacity ? 2 * p->codeCapacity : 1024;
+    code = checked_malloc(p->codeCapacity * sizeof(int32_t));
+    if (p->codeSize)
+      memcpy(code, p->code, p->codeSize * sizeof(int32_t));
+    free(p->code);
+    p->code = code;
+  }
+  p->code[p->codeSize++] = word;
+}
+
+static void emitLabel(lowering *l, Temp_label label) {
+  if (l->fixupCount == l->fixupCapacity) {
+    fixup *fixups;
+    l->fixupCapacity = l->fixupCapacity ? 2 * l->fixupCapacity : 64;
+    fixups = checked_malloc(l->fixupCapacity * sizeof(fixup));
+    if (l->fixupCount)
+      memcpy(fixups, l->fixups, l->fixupCount * sizeof(fixup));
+    free(l->fixups);
+    l->fixups = fixups;
+  }
+  l->fixups[l->fixupCount].at = l->p->codeSize;
+  l->fixups[l->fixupCount++].label = label;
+  emit(l, 0);
+}
+
+static int reg(lowering *l, Temp_temp t) {
+  intptr_t r = (intptr_t)TAB_look(l->registers, t);
+  if (!r) {
+    r = ++l->temps;
+    TAB_enter(l->registers, t, (void *)r);
+  }
+  return r - 1;
+}
+
+static void numberExp(lowering *l, T_exp e);
+
+static void numberTemp(lowering *l, Temp_temp t) {
+  int n = Temp_num(t);
+  reg(l, t);
+  if (t == F_FP() || t == F_RV())
+    return; /* VM_walk keeps these apart */
+  if (l->f->firstTemp > l->f->lastTemp)
+    l->f->firstTemp = l->f->lastTemp = n;
+  else if (n < l->f->firstTemp)
+    l->f->firstTemp = n;
+  else if (n > l->f->lastTemp)
+    l->f->lastTemp = n;
+}
+
+static void numberExp(lowering *l, T_exp e) {
+  T_expList a;
+  switch (e->kind) {
+  case T_BINOP:
+    numberExp(l, e->u.BINOP.left);
+    numberExp(l, e->u.BINOP.right);
+    break;
+  case T_MEM:
+    numberExp(l, e->u.MEM);
+    break;
+  case T_TEMP:
+    numberTemp(l, e->u.TEMP);
+    break;
+  case T_CALL:
+    numberExp(l, e->u.CALL.fun);
+    for (a = e->u.CALL.args; a; a = a->tail)
+      numberExp(l, a->head);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Give every temp of the function its register before any scratch one is
+ * handed out. */
+static void numberTemps(lowering *l, T_stmList stms) {
+  F_accessList formals;
+  reg(l, F_FP());
+  reg(l, F_RV());
+  for (formals = F_formals(l->f->frame); formals; formals = formals->tail)
+    if (F_accessTemp(formals->head))
+      numberTemp(l, F_accessTemp(formals->head));
+  for (; stms; stms = stms->tail) {
+    T_stm s = stms->head;
+    switch (s->kind) {
+    case T_MOVE:
+      numberExp(l, s->u.MOVE.dst);
+      numberExp(l, s->u.MOVE.src);
+      break;
+    case T_EXP:
+      numberExp(l, s->u.EXP);
+      break;
+    case T_CJUMP:
+      numberExp(l, s->u.CJUMP.left);
+      numberExp(l, s->u.CJUMP.right);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+static int scratch(lowering *l) {
+  if (++l->scratch > l->maxScratch)
+    l->maxScratch = l->scratch;
+  return l->temps + l->scratch - 1;
+}
+
+static int munchExp(lowering *l, T_exp e, int dst);
+
+static int into(lowering *l, int dst) { return dst >= 0 ? dst : scratch(l); }
+
+static void munchCall(lowering *l, T_exp e, int dst) {
+  T_expList a;
+  int args[16], n = 0, i;
+  intptr_t index;
+  Temp_label name;
+  if (e->u.CALL.fun->kind != T_NAME) {
+    fail(l, "calls through a pointer", NULL);
+    return;
+  }
+  name = e->u.CALL.fun->u.NAME;
+  for (a = e->u.CALL.args; a; a = a->tail) {
+    if (n == 16) {
+      fail(l, "more than 16 arguments to", Temp_labelstring(name));
+      return;
+    }
+    args[n++] = munchExp(l, a->head, -1);
+  }
+  if ((index = (intptr_t)TAB_look(l->p->functionIndex, name))) {
+    if (l->p->functions[index - 1].formalCount != n)
+      fail(l, "wrong number of arguments to", Temp_labelstring(name));
+    emit(l, OP_CALL);
+  } else if ((index = (intptr_t)TAB_look(l->p->libraryIndex, name))) {
+    if (libraryArity[index - 1] != n)
+      fail(l, "wrong number of arguments to", Temp_labelstring(name));
+    emit(l, OP_LIB);
+  } else {
+    fail(l, "call of undefined function", Temp_labelstring(name));
+    return;
+  }
+  emit(l, index - 1);
+  emit(l, dst);
+  emit(l, n);
+  for (i = 0; i < n; i++)
+    emit(l, args[i]);
+}
+
+/* The base register and constant offset of an address */
+static void munchAddress(lowering *l, T_exp e, int *base, int *offset) {
+  if (e->kind == T_BINOP && e->u.BINOP.op == T_plus &&
+      e->u.BINOP.right->kind == T_CONST) {
+    *base = munchExp(l, e->u.BINOP.left, -1);
+    *offset = e->u.BINOP.right->u.CONST;
+  } else if (e->kind == T_BINOP && e->u.BINOP.op == T_plus &&
+             e->u.BINOP.left->kind == T_CONST) {
+    *base = munchExp(l, e->u.BINOP.right, -1);
+    *offset = e->u.BINOP.left->u.CONST;
+  } else {
+    *base = munchExp(l, e, -1);
+    *offset = 0;
+  }
+}
+
+/* Put the value of "e" in register "dst", or any register if it is -1;
+ * return the register. Only the last instruction writes "dst", so "e" may
+ * read it. */
+static int munchExp(lowering *l, T_exp e, int dst) {
+  switch (e->kind) {
+  case T_TEMP: {
+    int r = reg(l, e->u.TEMP);
+    if (dst < 0 || dst == r)
+      return r;
+    emit(l, OP_MOV);
+    emit(l, dst);
+    emit(l, r);
+    return dst;
+  }
+  case T_CONST:
+    dst = into(l, dst);
+    emit(l, OP_MOVI);
+    emit(l, dst);
+    emit(l, e->u.CONST);
+    return dst;
+  case T_NAME: {
+    intptr_t address = (intptr_t)TAB_look(l->p->strings, e->u.NAME);
+    if (!address)
+      fail(l, "no string at", Temp_labelstring(e->u.NAME));
+    dst = into(l, dst);
+    emit(l, OP_MOVI);
+    emit(l, dst);
+    emit(l, address);
+    return dst;
+  }
+  case T_MEM: {
+    int base, offset;
+    munchAddress(l, e->u.MEM, &base, &offset);
+    dst = into(l, dst);
+    emit(l, OP_LOAD);
+    emit(l, dst);
+    emit(l, base);
+    emit(l, offset);
+    return dst;
+  }
+  case T_BINOP: {
+    T_binOp op = e->u.BINOP.op;
+    T_exp left = e->u.BINOP.left, right = e->u.BINOP.right;
+    int a, b;
+    if ((op == T_plus || op == T_mul) && left->kind == T_CONST) {
+      T_exp t = left;
+      left = right;
+      right = t;
+    }
+    if (right->kind == T_CONST &&
+        (op == T_plus || op == T_minus || op == T_mul ||
+         (op == T_div && right->u.CONST != 0))) {
+      uint32_t k = right->u.CONST;
+      a = munchExp(l, left, -1);
+      dst = into(l, dst);
+      emit(l, op == T_mul ? OP_MULI : op == T_div ? OP_DIVI : OP_ADDI);
+      emit(l, dst);
+      emit(l, a);
+      emit(l, op == T_minus ? (int32_t)-k : (int32_t)k);
+      return dst;
+    }
+    a = munchExp(l, left, -1);
+    b = munchExp(l, right, -1);
+    dst = into(l, dst);
+    emit(l, OP_ADD + op);
+    emit(l, dst);
+    emit(l, a);
+    emit(l, b);
+    return dst;
+  }
+  case T_CALL:
+    dst = into(l, dst);
+    munchCall(l, e, dst);
+    return dst;
+  case T_ESEQ:
+    fail(l, "ESEQ left by canon", NULL);
+    return 0;
+  }
+  assert(0);
+  return 0;
+}
+
+static T_relOp commute(T_relOp op) {
+  switch (op) {
+  case T_lt:
+    return T_gt;
+  case T_gt:
+    return T_lt;
+  case T_le:
+    return T_ge;
+  case T_ge:
+    return T_le;
+  case T_ult:
+    return T_ugt;
+  case T_ugt:
+    return T_ult;
+  case T_ule:
+    return T_uge;
+  case T_uge:
+    return T_ule;
+  default:
+    return op;
+  }
+}
+
+static void munchStm(lowering *l, T_stm s, T_stm next) {
+  l->scratch = 0;
+  switch (s->kind) {
+  case T_LABEL:
+    TAB_enter(l->labels, s->u.LABEL, (void *)(intptr_t)(l->p->codeSize + 1));
+    break;
+  case T_JUMP:
+    if (s->u.JUMP.exp->kind != T_NAME) {
+      fail(l, "computed jump", NULL);
+      break;
+    }
+    // Traces fall through into the next block where they can.
+    if (next && next->kind == T_LABEL && next->u.LABEL == s->u.JUMP.exp->u.NAME)
+      break;
+    emit(l, OP_JMP);
+    emitLabel(l, s->u.JUMP.exp->u.NAME);
+    break;
+  case T_CJUMP: {
+    T_relOp op = s->u.CJUMP.op;
+    T_exp left = s->u.CJUMP.left, right = s->u.CJUMP.right;
+    int a;
+    if (left->kind == T_CONST && right->kind != T_CONST) {
+      T_exp t = left;
+      left = right;
+      right = t;
+      op = commute(op);
+    }
+    a = munchExp(l, left, -1);
+    if (right->kind == T_CONST && op < T_ult) {
+      emit(l, OP_BEQI + op);
+      emit(l, a);
+      emit(l, right->u.CONST);
+    } else {
+      int b = munchExp(l, right, -1);
+      emit(l, OP_BEQ + op);
+      emit(l, a);
+      emit(l, b);
+    }
+    emitLabel(l, s->u.CJUMP.true);
+    // Canon puts the false label next; this is in case it did not.
+    if (!next || next->kind != T_LABEL || next->u.LABEL != s->u.CJUMP.false) {
+      emit(l, OP_JMP);
+      emitLabel(l, s->u.CJUMP.false);
+    }
+    break;
+  }
+  case T_MOVE: {
+    T_exp dst = s->u.MOVE.dst;
+    if (dst->kind == T_TEMP)
+      munchExp(l, s->u.MOVE.src, reg(l, dst->u.TEMP));
+    else if (dst->kind == T_MEM) {
+      int base, offset, value;
+      munchAddress(l, dst->u.MEM, &base, &offset);
+      value = munchExp(l, s->u.MOVE.src, -1);
+      emit(l, OP_STORE);
+      emit(l, base);
+      emit(l, offset);
+      emit(l, value);
+    } else
+      fail(l, "move to neither a temp nor memory", NULL);
+    break;
+  }
+  case T_EXP:
+    // Evaluated all the same: a load of nil, or a division by zero, fails.
+    munchExp(l, s->u.EXP, -1);
+    break;
+  case T_SEQ:
+    fail(l, "SEQ left by canon", NULL);
+    break;
+  }
+}
+
+static void lowerFunction(VM_program p, VM_function *f) {
+  lowering l;
+  T_stmList s;
+  F_accessList formals;
+  int i;
+  memset(&l, 0, sizeof(l));
+  l.p = p;
+  l.f = f;
+  l.registers = TAB_empty();
+  l.labels = TAB_empty();
+  f->firstTemp = 0;
+  f->lastTemp = -1;
+  numberTemps(&l, f->stms);
+  f->formals = checked_malloc(f->formalCount * sizeof(int));
+  for (formals = F_formals(f->frame), i = 0; formals;
+       formals = formals->tail, i++) {
+    Temp_temp t = F_accessTemp(formals->head);
+    f->formals[i] = t ? ~reg(&l, t) : F_frameOffset(formals->head);
+  }
+  f->entry = p->codeSize;
+  f->labels = TAB_empty();
+  for (s = f->stms; s; s = s->tail) {
+    if (s->head->kind == T_LABEL)
+      TAB_enter(f->labels, s->head->u.LABEL, s);
+    munchStm(&l, s->head, s->tail ? s->tail->head : NULL);
+  }
+  emit(&l, OP_RET);
+  f->registers = l.temps + l.maxScratch;
+  for (i = 0; i < l.fixupCount; i++) {
+    intptr_t at = (intptr_t)TAB_look(l.labels, l.fixups[i].label);
+    if (!at)
+      fail(&l, "jump to undefined label", Temp_labelstring(l.fixups[i].label));
+    p->code[l.fixups[i].at] = at - 1;
+  }
+  free(l.fixups);
+  if (l.failed)
+    p->main = -1;
+}
+
+/* Put the string at "address" of the data image. */
+static void putString(VM_program p, uint32_t address, const char *chars,
+                      int length) {
+  unsigned char *s = p->data + (address - CONSTS);
+  memcpy(s, &length, 4);
+  memcpy(s + 4, chars, length);
+}
+
+VM_program VM_load(F_fragList frags) {
+  VM_program p = checked_malloc(sizeof(*p));
+  F_fragList f;
+  uint32_t address = STRINGS;
+  int i;
+  memset(p, 0, sizeof(*p));
+  p->main = -1;
+  p->functionIndex = TAB_empty();
+  p->libraryIndex = TAB_empty();
+  p->strings = TAB_empty();
+  for (i = 0; i < LIB_COUNT; i++)
+    TAB_enter(p->libraryIndex, Temp_namedlabel((string)libraryNames[i]),
+              (void *)(intptr_t)(i + 1));
+
+  for (f = frags; f; f = f->tail)
+    if (f->head->kind == F_procFrag)
+      p->functionCount++;
+    else {
+      TAB_enter(p->strings, f->head->u.string.label, (void *)(intptr_t)address);
+      address += (4 + strlen(f->head->u.string.str) + 3) & ~3u;
+    }
+  p->dataEnd = address;
+  p->data = checked_malloc(address - CONSTS);
+  memset(p->data, 0, address - CONSTS);
+  for (i = 0; i < 256; i++) {
+    char c = i;
+    putString(p, CONSTS + 8 * i, &c, 1);
+  }
+  for (f = frags; f; f = f->tail)
+    if (f->head->kind == F_stringFrag) {
+      string s = f->head->u.string.str;
+      putString(p, (intptr_t)TAB_look(p->strings, f->head->u.string.label), s,
+                strlen(s));
+    }
+
+  p->functions = checked_malloc((p->functionCount ? p->functionCount : 1) *
+                                sizeof(VM_function));
+  for (f = frags, i = 0; f; f = f->tail)
+    if (f->head->kind == F_procFrag) {
+      VM_function *fn = &p->functions[i];
+      F_accessList formals;
+      memset(fn, 0, sizeof(*fn));
+      fn->frame = f->head->u.proc.frame;
+      fn->stms =
+          C_traceSchedule(C_basicBlocks(C_linearize(f->head->u.proc.body)));
+      fn->frameSize = F_localCount(fn->frame) * F_wordSize;
+      for (formals = F_formals(fn->frame); formals; formals = formals->tail)
+        fn->formalCount++;
+      TAB_enter(p->functionIndex, F_name(fn->frame), (void *)(intptr_t)++i);
+      if (!strcmp(Temp_labelstring(F_name(fn->frame)), "tigermain"))
+        p->main = i - 1;
+    }
+  if (p->main < 0) {
+    EM_error(0, "no tigermain to run");
+    VM_free(p);
+    return NULL;
+  }
+  i = p->main;
+  for (p->main = 0; p->main >= 0 && p->main < p->functionCount; p->main++)
+    lowerFunction(p, &p->functions[p->main]);
+  if (p->main < 0) {
+    VM_free(p);
+    return NULL;
+  }
+  p->main = i;
+  return p;
+}
+
+int VM_codeSize(VM_program p) { return p->codeSize; }
+
+void VM_free(VM_program p) {
+  int i;
+  if (!p)
+    return;
+  for (i = 0; i < p->functionCount; i++)
+    free(p->functions[i].formals);
+  free(p->functions);
+  free(p->code);
+  free(p->data);
+  free(p);
+}
+
+/* The machine */
+
+
+
+static VM_machine *running;
+
+static int32_t load(VM_machine *m, uint32_t address) {
+  int32_t word;
+  memcpy(&word, m->memory + address, 4);
+  return word;
+}
+
+static void store(VM_machine *m, uint32_t address, int32_t word) {
+  memcpy(m->memory + address, &word, 4);
+}
+
+/* End the run with an error of the machine's own */
+void VM_error(VM_machine *m, const char *message) {
+  fflush(m->out);
+  fprintf(stderr, "vm: %s\n", message);
+  m->status = 1;
+  siglongjmp(m->exit, 1);
+}
+
+/* An access outside the mapped memory, nil's page among it */
+static void onFault(int sig, siginfo_t *info, void *context) {
+  VM_machine *m = running;
+  unsigned char *address = info->si_addr;
+  (void)context;
+  if (m && address >= m->memory && address < m->memory + RESERVED) {
+    fprintf(stderr, "vm: bad address %lu\n",
+            (unsigned long)(address - m->memory));
+    m->status = 1;
+    siglongjmp(m->exit, 1);
+  }
+  signal(sig, SIG_DFL);
+}
+
+static uint32_t allocate(VM_machine *m, int32_t size) {
+  uint32_t address = m->heap;
+  if (size < 0 || (uint32_t)size > MEMORY_SIZE - STACK_SIZE - m->heap)
+    VM_error(m, "out of memory");
+  m->heap += ((uint32_t)size + 3) & ~3u;
+  return address;
+}
+
+static int32_t divide(VM_machine *m, int32_t a, int32_t b) {
+  if (b == 0)
+    VM_error(m, "division by zero");
+  if (b == -1)
+    return (int32_t)-(uint32_t)a; /* of the least integer, too */
+  return a / b;
+}
+
+static int32_t length(VM_machine *m, uint32_t s) { return load(m, s); }
+
+static unsigned char *chars(VM_machine *m, uint32_t s) {
+  return m->memory + s + 4;
+}
+
+/* As runtime.c has them, errors and all */
+int32_t VM_library(VM_machine *m, int function, int32_t *a) {
+  switch (function) {
+  case LIB_initArray: {
+    uint32_t array = allocate(m, a[0] < 0 ? -1 : a[0] * 4), i;
+    for (i = 0; i < (uint32_t)a[0]; i++)
+      store(m, array + 4 * i, a[1]);
+    return array;
+  }
+  case LIB_allocRecord:
+    return allocate(m, a[0]); /* memory starts out zero */
+  case LIB_stringEqual:
+    return a[0] == a[1] ||
+           (length(m, a[0]) == length(m, a[1]) &&
+            !memcmp(chars(m, a[0]), chars(m, a[1]), length(m, a[0])));
+  case LIB_print:
+    fwrite(chars(m, a[0]), 1, length(m, a[0]), m->out);
+    return 0;
+  case LIB_flush:
+    fflush(m->out);
+    return 0;
+  case LIB_ord:
+    return length(m, a[0]) == 0 ? -1 : chars(m, a[0])[0];
+  case LIB_chr:
+    if (a[0] < 0 || a[0] >= 256) {
+      fprintf(m->out, "chr(%d) out of range\n", a[0]);
+      m->status = 1;
+      siglongjmp(m->exit, 1);
+    }
+    return CONSTS + 8 * a[0];
+  case LIB_size:
+    return length(m, a[0]);
+  case LIB_substring: {
+    int32_t n = a[2];
+    uint32_t s;
+    if (a[1] < 0 || n < 0 || a[1] + n > length(m, a[0])) {
+      fprintf(m->out, "substring([%d],%d,%d) out of range\n", length(m, a[0]),
+              a[1], n);
+      m->status = 1;
+      siglongjmp(m->exit, 1);
+    }
+    if (n == 1)
+      return CONSTS + 8 * chars(m, a[0])[a[1]];
+    s = allocate(m, 4 + n);
+    store(m, s, n);
+    memcpy(chars(m, s), chars(m, a[0]) + a[1], n);
+    return s;
+  }
+  case LIB_concat: {
+    int32_t n0 = length(m, a[0]), n1 = length(m, a[1]);
+    uint32_t s;
+    if (n0 == 0)
+      return a[1];
+    if (n1 == 0)
+      return a[0];
+    s = allocate(m, 4 + n0 + n1);
+    store(m, s, n0 + n1);
+    memcpy(chars(m, s), chars(m, a[0]), n0);
+    memcpy(chars(m, s) + n0, chars(m, a[1]), n1);
+    return s;
+  }
+  case LIB_not:
+    return !a[0];
+  case LIB_getchar: {
+    int c = getc(m->in);
+    return c == EOF ? EMPTY : CONSTS + 8 * c;
+  }
+  case LIB_exit:
+    m->status = a[0];
+    siglongjmp(m->exit, 1);
+  }
+  assert(0);
+  return 0;
+}
+
+static int32_t binop(VM_machine *m, T_binOp op, int32_t a, int32_t b) {
+  switch (op) {
+  case T_plus:
+    return (uint32_t)a + (uint32_t)b;
+  case T_minus:
+    return (uint32_t)a - (uint32_t)b;
+  case T_mul:
+    return (uint32_t)a * (uint32_t)b;
+  case T_div:
+    return divide(m, a, b);
+  case T_and:
+    return a & b;
+  case T_or:
+    return a | b;
+  case T_lshift:
+    return (uint32_t)a << (b & 31);
+  case T_rshift:
+    return (uint32_t)a >> (b & 31);
+  case T_arshift:
+    return a >> (b & 31);
+  case T_xor:
+    return a ^ b;
+  }
+  assert(0);
+  return 0;
+}
+
+static bool relop(T_relOp op, int32_t a, int32_t b) {
+  switch (op) {
+  case T_eq:
+    return a == b;
+  case T_ne:
+    return a != b;
+  case T_lt:
+    return a < b;
+  case T_gt:
+    return a > b;
+  case T_le:
+    return a <= b;
+  case T_ge:
+    return a >= b;
+  case T_ult:
+    return (uint32_t)a < (uint32_t)b;
+  case T_ule:
+    return (uint32_t)a <= (uint32_t)b;
+  case T_ugt:
+    return (uint32_t)a > (uint32_t)b;
+  case T_uge:
+    return (uint32_t)a >= (uint32_t)b;
+  }
+  assert(0);
+  return FALSE;
+}
+
+/* Make the frame of "f", called with "args", below m->sp; return its frame
+ * pointer, and leave the arguments that go in registers in "window". */
+uint32_t VM_enterFrame(VM_machine *m, VM_function *f, int32_t *args,
+                       int32_t *window) {
+  uint32_t fp = m->sp - 8 - 4 * f->formalCount;
+  int i;
+  if (fp - f->frameSize < MEMORY_SIZE - STACK_SIZE)
+    VM_error(m, "stack overflow");
+  for (i = 0; i < f->formalCount; i++)
+    if (f->formals[i] >= 0)
+      store(m, fp + f->formals[i], args[i]);
+    else if (window)
+      window[~f->formals[i]] = args[i];
+  return fp;
+}
+
+#define NEXT goto *dispatch[*pc]
+
+static void interpret(VM_machine *m) {
+  static void *dispatch[OP_COUNT] = {
+      [OP_MOVI] = &&movi,   [OP_MOV] = &&mov,     [OP_ADD] = &&add,
+      [OP_SUB] = &&sub,     [OP_MUL] = &&mul,     [OP_DIV] = &&div,
+      [OP_AND] = &&and,     [OP_OR] = &&or,       [OP_SHL] = &&shl,
+      [OP_SHR] = &&shr,     [OP_SAR] = &&sar,     [OP_XOR] = &&xor,
+      [OP_ADDI] = &&addi,   [OP_MULI] = &&muli,   [OP_DIVI] = &&divi,
+      [OP_LOAD] = &&load,   [OP_STORE] = &&store, [OP_JMP] = &&jmp,
+      [OP_BEQ] = &&beq,     [OP_BNE] = &&bne,     [OP_BLT] = &&blt,
+      [OP_BGT] = &&bgt,     [OP_BLE] = &&ble,     [OP_BGE] = &&bge,
+      [OP_BULT] = &&bult,   [OP_BULE] = &&bule,   [OP_BUGT] = &&bugt,
+      [OP_BUGE] = &&buge,   [OP_BEQI] = &&beqi,   [OP_BNEI] = &&bnei,
+      [OP_BLTI] = &&blti,   [OP_BGTI] = &&bgti,   [OP_BLEI] = &&blei,
+      [OP_BGEI] = &&bgei,   [OP_CALL] = &&call,   [OP_LIB] = &&lib,
+      [OP_RET] = &&ret};
+  VM_program p = m->p;
+  const int32_t *code = p->code, *pc;
+  unsigned char *memory = m->memory;
+  VM_activation *top = m->calls, *last = m->calls + MAX_CALLS - 1;
+  VM_function *f = &p->functions[p->main];
+  int32_t *r = m->registers, staticLink = 0;
+  int window = f->registers;
+  int32_t a, b;
+
+  if (r + window > m->registersEnd)
+    VM_error(m, "stack overflow");
+  r[0] = VM_enterFrame(m, f, &staticLink, r);
+  m->sp = r[0] - f->frameSize;
+  pc = code + f->entry;
+  NEXT;
+
+movi:
+  r[pc[1]] = pc[2];
+  pc += 3;
+  NEXT;
+mov:
+  r[pc[1]] = r[pc[2]];
+  pc += 3;
+  NEXT;
+add:
+  r[pc[1]] = (uint32_t)r[pc[2]] + (uint32_t)r[pc[3]];
+  pc += 4;
+  NEXT;
+sub:
+  r[pc[1]] = (uint32_t)r[pc[2]] - (uint32_t)r[pc[3]];
+  pc += 4;
+  NEXT;
+mul:
+  r[pc[1]] = (uint32_t)r[pc[2]] * (uint32_t)r[pc[3]];
+  pc += 4;
+  NEXT;
+div:
+  r[pc[1]] = divide(m, r[pc[2]], r[pc[3]]);
+  pc += 4;
+  NEXT;
+and:
+  r[pc[1]] = r[pc[2]] & r[pc[3]];
+  pc += 4;
+  NEXT;
+or:
+  r[pc[1]] = r[pc[2]] | r[pc[3]];
+  pc += 4;
+  NEXT;
+shl:
+  r[pc[1]] = (uint32_t)r[pc[2]] << (r[pc[3]] & 31);
+  pc += 4;
+  NEXT;
+shr:
+  r[pc[1]] = (uint32_t)r[pc[2]] >> (r[pc[3]] & 31);
+  pc += 4;
+  NEXT;
+sar:
+  r[pc[1]] = r[pc[2]] >> (r[pc[3]] & 31);
+  pc += 4;
+  NEXT;
+xor:
+  r[pc[1]] = r[pc[2]] ^ r[pc[3]];
+  pc += 4;
+  NEXT;
+addi:
+  r[pc[1]] = (uint32_t)r[pc[2]] + (uint32_t)pc[3];
+  pc += 4;
+  NEXT;
+muli:
+  r[pc[1]] = (uint32_t)r[pc[2]] * (uint32_t)pc[3];
+  pc += 4;
+  NEXT;
+divi:
+  r[pc[1]] = divide(m, r[pc[2]], pc[3]);
+  pc += 4;
+  NEXT;
+load:
+  memcpy(&r[pc[1]], memory + (uint32_t)(r[pc[2]] + pc[3]), 4);
+  pc += 4;
+  NEXT;
+store:
+  memcpy(memory + (uint32_t)(r[pc[1]] + pc[2]), &r[pc[3]], 4);
+  pc += 4;
+  NEXT;
+jmp:
+  pc = code + pc[1];
+  NEXT;
+
+#define BRANCH(test)                                                           \
+  a = r[pc[1]];                                                                \
+  b = r[pc[2]];                                                                \
+  pc = (test) ? code + pc[3] : pc + 4;                                         \
+  NEXT;
+#define BRANCHI(test)                                                          \
+  a = r[pc[1]];                                                                \
+  b = pc[2];                                                                   \
+  pc = (test) ? code + pc[3] : pc + 4;                                         \
+  NEXT;
+beq:
+  BRANCH(a == b)
+bne:
+  BRANCH(a != b)
+blt:
+  BRANCH(a < b)
+bgt:
+  BRANCH(a > b)
+ble:
+  BRANCH(a <= b)
+bge:
+  BRANCH(a >= b)
+bult:
+  BRANCH((uint32_t)a < (uint32_t)b)
+bule:
+  BRANCH((uint32_t)a <= (uint32_t)b)
+bugt:
+  BRANCH((uint32_t)a > (uint32_t)b)
+buge:
+  BRANCH((uint32_t)a >= (uint32_t)b)
+beqi:
+  BRANCHI(a == b)
+bnei:
+  BRANCHI(a != b)
+blti:
+  BRANCHI(a < b)
+bgti:
+  BRANCHI(a > b)
+blei:
+  BRANCHI(a <= b)
+bgei:
+  BRANCHI(a >= b)
+
+call: {
+  int32_t args[16], *callee = r + window;
+  int i, n = pc[3];
+  f = &p->functions[pc[1]];
+  if (top == last || callee + f->registers > m->registersEnd)
+    VM_error(m, "stack overflow");
+  for (i = 0; i < n; i++)
+    args[i] = r[pc[4 + i]];
+  ++top;
+  top->pc = pc + 4 + n;
+  top->registers = r;
+  top->dst = pc[2];
+  top->window = window;
+  top->sp = m->sp;
+  r = callee;
+  window = f->registers;
+  r[0] = VM_enterFrame(m, f, args, r);
+  m->sp = r[0] - f->frameSize;
+  pc = code + f->entry;
+  NEXT;
+}
+lib: {
+  int32_t args[3];
+  int i, n = pc[3];
+  for (i = 0; i < n; i++)
+    args[i] = r[pc[4 + i]];
+  r[pc[2]] = VM_library(m, pc[1], args);
+  pc += 4 + n;
+  NEXT;
+}
+ret:
+  if (top == m->calls)
+    return; /* from tigermain */
+  a = r[1];
+  pc = top->pc;
+  r = top->registers;
+  r[top->dst] = a;
+  window = top->window;
+  m->sp = top->sp;
+  --top;
+  NEXT;
+}
+
+/* The walker: each activation keeps the temps of its function, bar the
+ * frame pointer and the return value, in an array indexed by number. */
+
+typedef struct {
+  VM_function *f;
+  int32_t *temps, fp, rv;
+} walkFrame;
+
+static int32_t walkCall(VM_machine *m, VM_function *f, int32_t *args);
+
+static int32_t *temp(walkFrame *w, Temp_temp t) {
+  static int32_t nowhere;
+  if (t == F_FP())
+    return &w->fp;
+  if (t == F_RV())
+    return &w->rv;
+  if (Temp_num(t) < w->f->firstTemp || Temp_num(t) > w->f->lastTemp)
+    return &nowhere; /* cannot happen: numberTemps saw them all */
+  return &w->temps[Temp_num(t) - w->f->firstTemp];
+}
+
+static int32_t eval(VM_machine *m, walkFrame *w, T_exp e) {
+  switch (e->kind) {
+  case T_CONST:
+    return e->u.CONST;
+  case T_NAME:
+    return (intptr_t)TAB_look(m->p->strings, e->u.NAME);
+  case T_TEMP:
+    return *temp(w, e->u.TEMP);
+  case T_BINOP: {
+    int32_t a = eval(m, w, e->u.BINOP.left);
+    return binop(m, e->u.BINOP.op, a, eval(m, w, e->u.BINOP.right));
+  }
+  case T_MEM:
+    return load(m, eval(m, w, e->u.MEM));
+  case T_CALL: {
+    Temp_label name = e->u.CALL.fun->u.NAME;
+    int32_t args[16];
+    intptr_t index;
+    T_expList a;
+    int n = 0;
+    for (a = e->u.CALL.args; a; a = a->tail)
+      args[n++] = eval(m, w, a->head);
+    if ((index = (intptr_t)TAB_look(m->p->functionIndex, name)))
+      return walkCall(m, &m->p->functions[index - 1], args);
+    index = (intptr_t)TAB_look(m->p->libraryIndex, name);
+    return VM_library(m, index - 1, args);
+  }
+  case T_ESEQ:
+    break;
+  }
+  assert(0);
+  return 0;
+}
+
+static int32_t walkCall(VM_machine *m, VM_function *f, int32_t *args) {
+  walkFrame w;
+  uint32_t sp = m->sp;
+  int32_t *registers = m->registers;
+  T_stmList s = f->stms;
+  F_accessList formals;
+  int count = f->lastTemp - f->firstTemp + 1, i;
+  if (++m->depth > MAX_WALK_DEPTH || registers + count > m->registersEnd)
+    VM_error(m, "stack overflow");
+  w.f = f;
+  w.temps = registers;
+  w.rv = 0;
+  m->registers += count;
+  w.fp = VM_enterFrame(m, f, args, NULL);
+  for (formals = F_formals(f->frame), i = 0; formals;
+       formals = formals->tail, i++)
+    if (f->formals[i] < 0)
+      *temp(&w, F_accessTemp(formals->head)) = args[i];
+  m->sp = w.fp - f->frameSize;
+  while (s) {
+    T_stm stm = s->head;
+    s = s->tail;
+    switch (stm->kind) {
+    case T_MOVE:
+      if (stm->u.MOVE.dst->kind == T_TEMP)
+        *temp(&w, stm->u.MOVE.dst->u.TEMP) = eval(m, &w, stm->u.MOVE.src);
+      else {
+        uint32_t address = eval(m, &w, stm->u.MOVE.dst->u.MEM);
+        store(m, address, eval(m, &w, stm->u.MOVE.src));
+      }
+      break;
+    case T_EXP:
+      eval(m, &w, stm->u.EXP);
+      break;
+    case T_JUMP:
+      s = TAB_look(f->labels, stm->u.JUMP.exp->u.NAME);
+      break;
+    case T_CJUMP: {
+      int32_t a = eval(m, &w, stm->u.CJUMP.left);
+      bool taken = relop(stm->u.CJUMP.op, a, eval(m, &w, stm->u.CJUMP.right));
+      s = TAB_look(f->labels,
+                   taken ? stm->u.CJUMP.true : stm->u.CJUMP.false);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+  m->registers = registers;
+  m->sp = sp;
+  m->depth--;
+  return w.rv;
+}
+
+static void walk(VM_machine *m) {
+  int32_t staticLink = 0;
+  walkCall(m, &m->p->functions[m->p->main], &staticLink);
+}
+
+static void *reserve(size_t size) {
+  void *p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  return p == MAP_FAILED ? NULL : p;
+}
+
+/* Set up memory, run "body" on it and take it all down again. */
+int VM_execute(VM_program p, FILE *in, FILE *out,
+               void (*body)(VM_machine *m)) {
+  struct sigaction fault, oldSegv, oldBus;
+  VM_machine m;
+  memset(&m, 0, sizeof(m));
+  m.p = p;
+  m.in = in;
+  m.out = out;
+  m.memory = mmap(NULL, RESERVED, PROT_NONE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  m.registers = reserve(REGISTER_WORDS * sizeof(int32_t));
+  m.calls = reserve(MAX_CALLS * sizeof(VM_activation));
+  if (m.memory == MAP_FAILED || !m.registers || !m.calls ||
+      mprotect(m.memory + PAGE, MEMORY_SIZE - PAGE, PROT_READ | PROT_WRITE)) {
+    fprintf(stderr, "vm: cannot map its memory\n");
+    return 1;
+  }
+  m.registersEnd = m.registers + REGISTER_WORDS;
+  memcpy(m.memory + CONSTS, p->data, p->dataEnd - CONSTS);
+  m.heap = p->dataEnd;
+  m.sp = MEMORY_SIZE;
+
+  memset(&fault, 0, sizeof(fault));
+  fault.sa_sigaction = onFault;
+  fault.sa_flags = SA_SIGINFO | SA_NODEFER;
+  sigaction(SIGSEGV, &fault, &oldSegv);
+  sigaction(SIGBUS, &fault, &oldBus);
+  running = &m;
+  if (!sigsetjmp(m.exit, 1))
+    body(&m);
+  running = NULL;
+  sigaction(SIGSEGV, &oldSegv, NULL);
+  sigaction(SIGBUS, &oldBus, NULL);
+  fflush(out);
+
+  munmap(m.memory, RESERVED);
+  munmap(m.registers, REGISTER_WORDS * sizeof(int32_t));
+  munmap(m.calls, MAX_CALLS * sizeof(VM_activation));
+  return m.status;
+}
+
+int VM_run(VM_program p, FILE *in, FILE *out) {
+  return VM_execute(p, in, out, interpret);
+}
+
+int VM_walk(VM_program p, FILE *in, FILE *out) {
+  return VM_execute(p, in, out, walk);
+}
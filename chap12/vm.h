@@ -0,0 +1,37 @@
+/*
+ * vm.h - Run a translated program on a register-based bytecode machine.
+ *
+ * Each procedure fragment is put through canon and its statements lowered
+ * to a compact bytecode, in which the temps of the function are registers
+ * of a window of its own and the frame lives in the memory of the machine,
+ * where escaping variables and static links are found by the same offsets
+ * the frame (x86frame.c) gives them. The library of runtime.c is bound to
+ * native functions that work on that memory.
+ *
+ * The machine is 32-bit, as the code tiger makes is: an address is an
+ * offset into its memory, and nil is 0.
+ */
+
+typedef struct VM_program_ *VM_program;
+
+/* Lower the fragments of a program; NULL, after an error, if they cannot
+ *  be run. */
+VM_program VM_load(F_fragList frags);
+
+/* Run it from tigermain, with "in" as the input of getchar and "out" as
+ *  what print writes to; return its exit status. */
+int VM_run(VM_program p, FILE *in, FILE *out);
+
+/* The same, but by walking the canonical trees, node by node, instead of
+ *  running the bytecode: the yardstick the bytecode is measured by. The
+ *  trees must still be there, so the arenas must not have been reset. */
+int VM_walk(VM_program p, FILE *in, FILE *out);
+
+/* The same, but by translating the bytecode to x86-64 code in memory and
+ *  running that (jit.c). Elsewhere it runs the bytecode. */
+int VM_jit(VM_program p, FILE *in, FILE *out);
+
+/* The number of 32-bit words of bytecode the program was lowered to */
+int VM_codeSize(VM_program p);
+
+void VM_free(VM_program p);
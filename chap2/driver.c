@@ -1,11 +1,17 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "util.h"
 #include "errormsg.h"
 #include "tokens.h"
+#include "scan.h"
 
 YYSTYPE yylval;
 
 int yylex(void); /* prototype for the lexing function */
+void yyrestart(FILE *input_file);
+extern FILE *yyin, *yyout;
 
 string toknames[] = {
     "ID",     "STRING", "INT",    "COMMA",  "COLON",  "SEMICOLON", "LPAREN",
@@ -20,17 +26,65 @@ string tokname(tok) {
   return tok < 257 || tok > 299 ? "BAD_TOKEN" : toknames[tok - 257];
 }
 
+/* Scan "fname" with "lex" until at least a second has gone by, and report
+ * how many tokens were read per second. */
+static void bench(string name, string fname, bool mmapped) {
+  long tokens = 0;
+  int passes = 0;
+  clock_t start = clock(), elapsed;
+  double seconds;
+  do {
+    if (yyin)
+      fclose(yyin);
+    EM_reset(fname);
+    if (mmapped) {
+      if (!SC_open(fname)) {
+        EM_error(0, "cannot map");
+        exit(1);
+      }
+      while (SC_lex())
+        tokens++;
+    } else {
+      yyrestart(yyin);
+      while (yylex())
+        tokens++;
+    }
+    passes++;
+    elapsed = clock() - start;
+  } while (elapsed < CLOCKS_PER_SEC);
+  seconds = (double)elapsed / CLOCKS_PER_SEC;
+  printf("%-6s %6d passes %10ld tokens %8.3f s %12.0f tokens/s\n", name,
+         passes, tokens, seconds, tokens / seconds);
+}
+
 int main(int argc, char **argv) {
   string fname;
   int tok;
+  bool useMmap = FALSE;
+  if (argc == 3 && !strcmp(argv[1], "-bench")) {
+    /* flex echoes the newlines inside comments; keep them out of the way. */
+    yyout = fopen("/dev/null", "w");
+    bench("flex", argv[2], FALSE);
+    bench("mmap", argv[2], TRUE);
+    return 0;
+  }
+  if (argc == 3 && !strcmp(argv[1], "-mmap")) {
+    useMmap = TRUE;
+    argc--;
+    argv++;
+  }
   if (argc != 2) {
-    fprintf(stderr, "usage: a.out filename\n");
+    fprintf(stderr, "usage: a.out [-mmap | -bench] filename\n");
     exit(1);
   }
   fname = argv[1];
   EM_reset(fname);
+  if (useMmap && !SC_open(fname)) {
+    EM_error(0, "cannot map");
+    exit(1);
+  }
   for (;;) {
-    tok = yylex();
+    tok = useMmap ? SC_lex() : yylex();
     if (tok == 0)
       break;
     switch (tok) {
@@ -0,0 +1,389 @@
+/*
+ * scan.c - Hand-written scanner over a memory-mapped source file.
+ *
+ * The file is mapped read-only and scanned in place. Keywords are told
+ * apart by a perfect hash of their first and last characters and their
+ * length, without copying them anywhere. Identifiers and string literals
+ * are copied once, straight into a buffer of their own.
+ *
+ * Positions follow the flex scanner: EM_tokPos is one more than the offset
+ * of the first character of a token, or of the closing quote of a string.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "util.h"
+#include "tokens.h"
+#include "errormsg.h"
+#include "scan.h"
+
+static const char *base = NULL; /* first byte of the file */
+static const char *end;         /* one past the last byte */
+static const char *next;        /* where the next token starts */
+static size_t mapped = 0;       /* bytes mapped; empty files aren't */
+static bool isOpen = FALSE;
+
+#define POS(p) ((int)((p) - base) + 1)
+
+/* Keywords */
+
+static struct {
+  string name;
+  int len, token;
+} keywords[] = {
+    {"while", 5, WHILE}, {"for", 3, FOR},       {"to", 2, TO},
+    {"break", 5, BREAK}, {"let", 3, LET},       {"in", 2, IN},
+    {"end", 3, END},     {"function", 8, FUNCTION}, {"var", 3, VAR},
+    {"type", 4, TYPE},   {"array", 5, ARRAY},   {"if", 2, IF},
+    {"then", 4, THEN},   {"else", 4, ELSE},     {"do", 2, DO},
+    {"of", 2, OF},       {"nil", 3, NIL}};
+
+#define KEYWORD_COUNT (int)(sizeof(keywords) / sizeof(keywords[0]))
+#define KEYWORD_SLOTS 32 /* must be a power of two */
+
+/* One more than the index of the keyword hashing to each slot, or 0 */
+static int keywordSlot[KEYWORD_SLOTS];
+
+static unsigned int keywordHash(const char *s, int len) {
+  unsigned int first = (unsigned char)s[0], last = (unsigned char)s[len - 1];
+  return (first * 29 + last * 22 + len) & (KEYWORD_SLOTS - 1);
+}
+
+static void initKeywords(void) {
+  static bool done = FALSE;
+  int i;
+  if (done)
+    return;
+  for (i = 0; i < KEYWORD_COUNT; i++) {
+    unsigned int h = keywordHash(keywords[i].name, keywords[i].len);
+    assert(!keywordSlot[h]); /* the hash must stay perfect */
+    keywordSlot[h] = i + 1;
+  }
+  done = TRUE;
+}
+
+/* The keyword token for "len" bytes at "s", or 0 */
+static int keyword(const char *s, int len) {
+  int k = keywordSlot[keywordHash(s, len)] - 1;
+  if (k >= 0 && keywords[k].len == len && !memcmp(keywords[k].name, s, len))
+    return keywords[k].token;
+  return 0;
+}
+
+static bool isLetter(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+static bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/* A fresh copy of the "len" bytes at "s" */
+static string copy(const char *s, int len) {
+  string p = checked_malloc(len + 1);
+  memcpy(p, s, len);
+  p[len] = 0;
+  return p;
+}
+
+/* Mapping the file */
+
+bool SC_open(string fname) {
+  struct stat st;
+  int fd;
+  SC_close();
+  initKeywords();
+  fd = open(fname, O_RDONLY);
+  if (fd < 0)
+    return FALSE;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return FALSE;
+  }
+  mapped = st.st_size;
+  if (mapped) {
+    void *p = mmap(NULL, mapped, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      close(fd);
+      mapped = 0;
+      return FALSE;
+    }
+    madvise(p, mapped, MADV_SEQUENTIAL);
+    base = p;
+  } else
+    base = "";
+  close(fd);
+  end = base + mapped;
+  next = base;
+  isOpen = TRUE;
+  return TRUE;
+}
+
+bool SC_isOpen(void) { return isOpen; }
+
+void SC_close(void) {
+  if (mapped)
+    munmap((void *)base, mapped);
+  base = NULL;
+  mapped = 0;
+  isOpen = FALSE;
+}
+
+/* Comments and string literals */
+
+static void newline(const char *p) {
+  EM_tokPos = POS(p);
+  EM_newline();
+}
+
+/* Skip a comment whose opening has just been read; return where it ends,
+ * or NULL if the file ends first. */
+static const char *skipComment(const char *p) {
+  int depth = 1;
+  while (p < end) {
+    if (*p == '\n')
+      newline(p++);
+    else if (*p == '/' && p + 1 < end && p[1] == '*') {
+      depth++;
+      p += 2;
+    } else if (*p == '*' && p + 1 < end && p[1] == '/') {
+      EM_tokPos = POS(p);
+      p += 2;
+      if (--depth == 0)
+        return p;
+    } else
+      p++;
+  }
+  EM_tokPos = POS(end);
+  EM_error(EM_tokPos, "encountered eof within a comment");
+  return NULL;
+}
+
+/* Literals with escapes are decoded here, then copied out at their size. */
+static char *scratch = NULL;
+static int scratchSize = 0;
+
+static void put(int *len, char c) {
+  if (*len == scratchSize) {
+    char *old = scratch;
+    scratchSize = scratchSize ? 2 * scratchSize : 1024;
+    scratch = checked_malloc(scratchSize);
+    if (old)
+      memcpy(scratch, old, *len);
+    free(old);
+  }
+  scratch[(*len)++] = c;
+}
+
+/* Decode the escape sequence at "p" into the scratch buffer; return where
+ * the rest of the literal starts. */
+static const char *escape(const char *p, int *len) {
+  const char *q = p + 1;
+  int digits = 0;
+  EM_tokPos = POS(p);
+  if (q < end)
+    switch (*q) {
+    case 'n':
+      put(len, '\n');
+      return q + 1;
+    case 't':
+      put(len, '\t');
+      return q + 1;
+    case '"':
+    case '\\':
+      put(len, *q);
+      return q + 1;
+    case '^':
+      if (q + 1 < end && q[1] >= '@' && q[1] <= '_') {
+        put(len, q[1] - '@');
+        return q + 2;
+      }
+      if (q + 1 < end && q[1] == '?') {
+        put(len, 127);
+        return q + 2;
+      }
+      break;
+    default:
+      while (q + digits < end && isDigit(q[digits]))
+        digits++;
+      if (digits == 3) {
+        put(len, (q[0] - '0') * 100 + (q[1] - '0') * 10 + (q[2] - '0'));
+        return q + 3;
+      }
+      if (digits) {
+        EM_error(EM_tokPos, "illegal ascii code");
+        return q + digits;
+      }
+      /* \ followed by white space up to another \ is skipped, so a
+       * literal can be continued on the next line. */
+      while (q < end && isSpace(*q))
+        q++;
+      if (q > p + 1 && q < end && *q == '\\') {
+        for (q = p + 1; *q != '\\'; q++)
+          if (*q == '\n')
+            newline(q);
+        return q + 1;
+      }
+    }
+  EM_error(EM_tokPos, "illegal escape sequence");
+  return p + 1;
+}
+
+/* Scan a string literal whose opening quote has just been read. */
+static int stringLiteral(const char *p) {
+  const char *q = p;
+  int len = 0;
+  /* Most literals have no escapes and can be copied as they are. */
+  while (q < end && *q != '"' && *q != '\\' && *q != '\n')
+    q++;
+  if (q < end && *q == '"') {
+    yylval.sval = copy(p, q - p);
+  } else {
+    for (q = p; q < end && *q != '"';)
+      if (*q == '\\')
+        q = escape(q, &len);
+      else {
+        if (*q == '\n')
+          newline(q);
+        put(&len, *q++);
+      }
+    if (q == end) {
+      EM_tokPos = POS(end);
+      EM_error(EM_tokPos, "encountered eof within a string literal");
+      SC_close();
+      return 0;
+    }
+    yylval.sval = checked_malloc(len + 1);
+    if (len)
+      memcpy(yylval.sval, scratch, len);
+    yylval.sval[len] = 0;
+  }
+  EM_tokPos = POS(q);
+  next = q + 1;
+  return STRING;
+}
+
+/* Tokens */
+
+static int token(const char *start, int len, int tok) {
+  EM_tokPos = POS(start);
+  next = start + len;
+  return tok;
+}
+
+int SC_lex(void) {
+  const char *p = next;
+  if (!isOpen)
+    return 0;
+  for (;;) {
+    const char *q;
+    if (p >= end) {
+      SC_close();
+      return 0;
+    }
+    switch (*p) {
+    case ' ':
+    case '\t':
+    case '\r':
+      EM_tokPos = POS(p);
+      while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+      continue;
+    case '\n':
+      newline(p++);
+      continue;
+    case ',':
+      return token(p, 1, COMMA);
+    case ';':
+      return token(p, 1, SEMICOLON);
+    case '(':
+      return token(p, 1, LPAREN);
+    case ')':
+      return token(p, 1, RPAREN);
+    case '[':
+      return token(p, 1, LBRACK);
+    case ']':
+      return token(p, 1, RBRACK);
+    case '{':
+      return token(p, 1, LBRACE);
+    case '}':
+      return token(p, 1, RBRACE);
+    case '.':
+      return token(p, 1, DOT);
+    case '+':
+      return token(p, 1, PLUS);
+    case '-':
+      return token(p, 1, MINUS);
+    case '=':
+      return token(p, 1, EQ);
+    case '&':
+      return token(p, 1, AND);
+    case '|':
+      return token(p, 1, OR);
+    case ':':
+      if (p + 1 < end && p[1] == '=')
+        return token(p, 2, ASSIGN);
+      return token(p, 1, COLON);
+    case '<':
+      if (p + 1 < end && p[1] == '>')
+        return token(p, 2, NEQ);
+      if (p + 1 < end && p[1] == '=')
+        return token(p, 2, LE);
+      return token(p, 1, LT);
+    case '>':
+      if (p + 1 < end && p[1] == '=')
+        return token(p, 2, GE);
+      return token(p, 1, GT);
+    case '*':
+      if (p + 1 < end && p[1] == '/') {
+        EM_tokPos = POS(p);
+        EM_error(EM_tokPos, "close comment without a corresponding open");
+        p += 2;
+        continue;
+      }
+      return token(p, 1, TIMES);
+    case '/':
+      if (p + 1 < end && p[1] == '*') {
+        EM_tokPos = POS(p);
+        p = skipComment(p + 2);
+        if (!p) {
+          SC_close();
+          return 0;
+        }
+        continue;
+      }
+      return token(p, 1, DIVIDE);
+    case '"':
+      return stringLiteral(p + 1);
+    default:
+      break;
+    }
+    if (isDigit(*p)) {
+      unsigned int value = 0;
+      for (q = p; q < end && isDigit(*q); q++)
+        value = value * 10 + (*q - '0');
+      yylval.ival = (int)value;
+      return token(p, q - p, INT);
+    }
+    if (isLetter(*p)) {
+      int tok;
+      for (q = p + 1; q < end && (isLetter(*q) || isDigit(*q) || *q == '_');)
+        q++;
+      tok = keyword(p, q - p);
+      if (tok)
+        return token(p, q - p, tok);
+      yylval.sval = copy(p, q - p);
+      return token(p, q - p, ID);
+    }
+    EM_tokPos = POS(p);
+    EM_error(EM_tokPos, "illegal token");
+    p++;
+  }
+}
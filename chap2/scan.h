@@ -0,0 +1,21 @@
+/*
+ * scan.h - A hand-written scanner that reads the source file through mmap.
+ *
+ * It returns the same tokens as the flex scanner and fills in yylval the
+ * same way, but nothing is read through stdio, and string literals may be
+ * of any length.
+ */
+
+/* Map "fname" and start scanning it; tell if it could be mapped.
+ *  EM_reset should already have been called for the file. */
+bool SC_open(string fname);
+
+/* Tell if a file is open, so yylex should leave the work to SC_lex */
+bool SC_isOpen(void);
+
+/* Return the next token, or 0 at the end of the file. The file is unmapped
+ *  when the end is reached. */
+int SC_lex(void);
+
+/* Unmap the current file, if any. */
+void SC_close(void);
@@ -4,11 +4,12 @@
  */
 
 #include "util.h"
+#include "arena.h"
 #include "symbol.h" /* symbol table data structures */
 #include "absyn.h"  /* abstract syntax data structures */
 
 A_var A_SimpleVar(A_pos pos, S_symbol sym) {
-  A_var p = checked_malloc(sizeof(*p));
+  A_var p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_simpleVar;
   p->pos = pos;
   p->u.simple = sym;
@@ -16,7 +17,7 @@ A_var A_SimpleVar(A_pos pos, S_symbol sym) {
 }
 
 A_var A_FieldVar(A_pos pos, A_var var, S_symbol sym) {
-  A_var p = checked_malloc(sizeof(*p));
+  A_var p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_fieldVar;
   p->pos = pos;
   p->u.field.var = var;
@@ -25,7 +26,7 @@ A_var A_FieldVar(A_pos pos, A_var var, S_symbol sym) {
 }
 
 A_var A_SubscriptVar(A_pos pos, A_var var, A_exp exp) {
-  A_var p = checked_malloc(sizeof(*p));
+  A_var p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_subscriptVar;
   p->pos = pos;
   p->u.subscript.var = var;
@@ -34,7 +35,7 @@ A_var A_SubscriptVar(A_pos pos, A_var var, A_exp exp) {
 }
 
 A_exp A_VarExp(A_pos pos, A_var var) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_varExp;
   p->pos = pos;
   p->u.var = var;
@@ -42,14 +43,14 @@ A_exp A_VarExp(A_pos pos, A_var var) {
 }
 
 A_exp A_NilExp(A_pos pos) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_nilExp;
   p->pos = pos;
   return p;
 }
 
 A_exp A_IntExp(A_pos pos, int i) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_intExp;
   p->pos = pos;
   p->u.intt = i;
@@ -57,7 +58,7 @@ A_exp A_IntExp(A_pos pos, int i) {
 }
 
 A_exp A_StringExp(A_pos pos, string s) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_stringExp;
   p->pos = pos;
   p->u.stringg = s;
@@ -65,7 +66,7 @@ A_exp A_StringExp(A_pos pos, string s) {
 }
 
 A_exp A_CallExp(A_pos pos, S_symbol func, A_expList args) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_callExp;
   p->pos = pos;
   p->u.call.func = func;
@@ -74,7 +75,7 @@ A_exp A_CallExp(A_pos pos, S_symbol func, A_expList args) {
 }
 
 A_exp A_OpExp(A_pos pos, A_oper oper, A_exp left, A_exp right) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_opExp;
   p->pos = pos;
   p->u.op.oper = oper;
@@ -84,7 +85,7 @@ A_exp A_OpExp(A_pos pos, A_oper oper, A_exp left, A_exp right) {
 }
 
 A_exp A_RecordExp(A_pos pos, S_symbol typ, A_efieldList fields) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_recordExp;
   p->pos = pos;
   p->u.record.typ = typ;
@@ -93,7 +94,7 @@ A_exp A_RecordExp(A_pos pos, S_symbol typ, A_efieldList fields) {
 }
 
 A_exp A_SeqExp(A_pos pos, A_expList seq) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_seqExp;
   p->pos = pos;
   p->u.seq = seq;
@@ -101,7 +102,7 @@ A_exp A_SeqExp(A_pos pos, A_expList seq) {
 }
 
 A_exp A_AssignExp(A_pos pos, A_var var, A_exp exp) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_assignExp;
   p->pos = pos;
   p->u.assign.var = var;
@@ -110,7 +111,7 @@ A_exp A_AssignExp(A_pos pos, A_var var, A_exp exp) {
 }
 
 A_exp A_IfExp(A_pos pos, A_exp test, A_exp then, A_exp elsee) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_ifExp;
   p->pos = pos;
   p->u.iff.test = test;
@@ -120,7 +121,7 @@ A_exp A_IfExp(A_pos pos, A_exp test, A_exp then, A_exp elsee) {
 }
 
 A_exp A_WhileExp(A_pos pos, A_exp test, A_exp body) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_whileExp;
   p->pos = pos;
   p->u.whilee.test = test;
@@ -129,7 +130,7 @@ A_exp A_WhileExp(A_pos pos, A_exp test, A_exp body) {
 }
 
 A_exp A_ForExp(A_pos pos, S_symbol var, A_exp lo, A_exp hi, A_exp body) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_forExp;
   p->pos = pos;
   p->u.forr.var = var;
@@ -141,14 +142,14 @@ A_exp A_ForExp(A_pos pos, S_symbol var, A_exp lo, A_exp hi, A_exp body) {
 }
 
 A_exp A_BreakExp(A_pos pos) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_breakExp;
   p->pos = pos;
   return p;
 }
 
 A_exp A_LetExp(A_pos pos, A_decList decs, A_exp body) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_letExp;
   p->pos = pos;
   p->u.let.decs = decs;
@@ -157,7 +158,7 @@ A_exp A_LetExp(A_pos pos, A_decList decs, A_exp body) {
 }
 
 A_exp A_ArrayExp(A_pos pos, S_symbol typ, A_exp size, A_exp init) {
-  A_exp p = checked_malloc(sizeof(*p));
+  A_exp p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_arrayExp;
   p->pos = pos;
   p->u.array.typ = typ;
@@ -167,7 +168,7 @@ A_exp A_ArrayExp(A_pos pos, S_symbol typ, A_exp size, A_exp init) {
 }
 
 A_dec A_FunctionDec(A_pos pos, A_fundecList function) {
-  A_dec p = checked_malloc(sizeof(*p));
+  A_dec p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_functionDec;
   p->pos = pos;
   p->u.function = function;
@@ -175,7 +176,7 @@ A_dec A_FunctionDec(A_pos pos, A_fundecList function) {
 }
 
 A_dec A_VarDec(A_pos pos, S_symbol var, S_symbol typ, A_exp init) {
-  A_dec p = checked_malloc(sizeof(*p));
+  A_dec p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_varDec;
   p->pos = pos;
   p->u.var.var = var;
@@ -186,7 +187,7 @@ A_dec A_VarDec(A_pos pos, S_symbol var, S_symbol typ, A_exp init) {
 }
 
 A_dec A_TypeDec(A_pos pos, A_nametyList type) {
-  A_dec p = checked_malloc(sizeof(*p));
+  A_dec p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_typeDec;
   p->pos = pos;
   p->u.type = type;
@@ -194,7 +195,7 @@ A_dec A_TypeDec(A_pos pos, A_nametyList type) {
 }
 
 A_ty A_NameTy(A_pos pos, S_symbol name) {
-  A_ty p = checked_malloc(sizeof(*p));
+  A_ty p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_nameTy;
   p->pos = pos;
   p->u.name = name;
@@ -202,7 +203,7 @@ A_ty A_NameTy(A_pos pos, S_symbol name) {
 }
 
 A_ty A_RecordTy(A_pos pos, A_fieldList record) {
-  A_ty p = checked_malloc(sizeof(*p));
+  A_ty p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_recordTy;
   p->pos = pos;
   p->u.record = record;
@@ -210,7 +211,7 @@ A_ty A_RecordTy(A_pos pos, A_fieldList record) {
 }
 
 A_ty A_ArrayTy(A_pos pos, S_symbol array) {
-  A_ty p = checked_malloc(sizeof(*p));
+  A_ty p = AR_alloc(AR_absyn, sizeof(*p));
   p->kind = A_arrayTy;
   p->pos = pos;
   p->u.array = array;
@@ -218,7 +219,7 @@ A_ty A_ArrayTy(A_pos pos, S_symbol array) {
 }
 
 A_field A_Field(A_pos pos, S_symbol name, S_symbol typ) {
-  A_field p = checked_malloc(sizeof(*p));
+  A_field p = AR_alloc(AR_absyn, sizeof(*p));
   p->pos = pos;
   p->name = name;
   p->typ = typ;
@@ -227,14 +228,14 @@ A_field A_Field(A_pos pos, S_symbol name, S_symbol typ) {
 }
 
 A_fieldList A_FieldList(A_field head, A_fieldList tail) {
-  A_fieldList p = checked_malloc(sizeof(*p));
+  A_fieldList p = AR_alloc(AR_absyn, sizeof(*p));
   p->head = head;
   p->tail = tail;
   return p;
 }
 
 A_expList A_ExpList(A_exp head, A_expList tail) {
-  A_expList p = checked_malloc(sizeof(*p));
+  A_expList p = AR_alloc(AR_absyn, sizeof(*p));
   p->head = head;
   p->tail = tail;
   return p;
@@ -242,7 +243,7 @@ A_expList A_ExpList(A_exp head, A_expList tail) {
 
 A_fundec A_Fundec(A_pos pos, S_symbol name, A_fieldList params, S_symbol result,
                   A_exp body) {
-  A_fundec p = checked_malloc(sizeof(*p));
+  A_fundec p = AR_alloc(AR_absyn, sizeof(*p));
   p->pos = pos;
   p->name = name;
   p->params = params;
@@ -252,42 +253,42 @@ A_fundec A_Fundec(A_pos pos, S_symbol name, A_fieldList params, S_symbol result,
 }
 
 A_fundecList A_FundecList(A_fundec head, A_fundecList tail) {
-  A_fundecList p = checked_malloc(sizeof(*p));
+  A_fundecList p = AR_alloc(AR_absyn, sizeof(*p));
   p->head = head;
   p->tail = tail;
   return p;
 }
 
 A_decList A_DecList(A_dec head, A_decList tail) {
-  A_decList p = checked_malloc(sizeof(*p));
+  A_decList p = AR_alloc(AR_absyn, sizeof(*p));
   p->head = head;
   p->tail = tail;
   return p;
 }
 
 A_namety A_Namety(S_symbol name, A_ty ty) {
-  A_namety p = checked_malloc(sizeof(*p));
+  A_namety p = AR_alloc(AR_absyn, sizeof(*p));
   p->name = name;
   p->ty = ty;
   return p;
 }
 
 A_nametyList A_NametyList(A_namety head, A_nametyList tail) {
-  A_nametyList p = checked_malloc(sizeof(*p));
+  A_nametyList p = AR_alloc(AR_absyn, sizeof(*p));
   p->head = head;
   p->tail = tail;
   return p;
 }
 
 A_efield A_Efield(S_symbol name, A_exp exp) {
-  A_efield p = checked_malloc(sizeof(*p));
+  A_efield p = AR_alloc(AR_absyn, sizeof(*p));
   p->name = name;
   p->exp = exp;
   return p;
 }
 
 A_efieldList A_EfieldList(A_efield head, A_efieldList tail) {
-  A_efieldList p = checked_malloc(sizeof(*p));
+  A_efieldList p = AR_alloc(AR_absyn, sizeof(*p));
   p->head = head;
   p->tail = tail;
   return p;
@@ -0,0 +1,194 @@
+/*
+ * arena.c - Bump-pointer allocation for compiler data structures.
+ *
+ * An arena is a list of chunks. Allocation bumps a pointer through the
+ * current chunk and moves on to the next one (reusing a chunk left over from
+ * an earlier reset if there is one) when it runs out of room. What each
+ * arena hands out is counted as it goes, which costs a few additions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "util.h"
+#include "arena.h"
+#include "context.h"
+
+#define CHUNK_SIZE (64 * 1024)
+#define ALIGNMENT 16
+
+typedef struct chunk_ *chunk;
+struct chunk_ {
+  chunk next;
+  int size; /* usable bytes after the header */
+};
+
+/* Keep the data of every chunk aligned for any node type. */
+#define HEADER_SIZE                                                            \
+  ((sizeof(struct chunk_) + ALIGNMENT - 1) & ~(ALIGNMENT - 1))
+
+struct arena_ {
+  chunk used;  /* chunks holding live data, current chunk first */
+  chunk spare; /* standard sized chunks left over from a reset */
+  char *next;  /* first free byte in the current chunk */
+  char *limit; /* end of the current chunk */
+  long allocations;
+  long live, total, peak; /* bytes, as in struct AR_stats */
+};
+
+/* The arenas of the current context */
+typedef struct {
+  struct arena_ arenas[AR_numKinds];
+  long live, total, peak; /* of all of them together */
+  bool phaseReset;
+} state;
+
+static string names[AR_numKinds] = {
+    "absyn", "table", "types", "translate", "tree",     "frame", "temp",
+    "canon", "assem", "graph", "liveness",  "regalloc", "symbol"};
+
+static void freeChunks(chunk c) {
+  chunk next;
+  for (; c; c = next) {
+    next = c->next;
+    free(c);
+  }
+}
+
+static void freeState(void *p) {
+  state *st = p;
+  int kind;
+  for (kind = 0; kind < AR_numKinds; kind++) {
+    freeChunks(st->arenas[kind].used);
+    freeChunks(st->arenas[kind].spare);
+  }
+}
+
+static state *current(void) {
+  return CX_state(CX_arena, sizeof(state), NULL, freeState);
+}
+
+static chunk Chunk(int size) {
+  chunk c = checked_malloc(HEADER_SIZE + size);
+  c->size = size;
+  return c;
+}
+
+static void *grow(struct arena_ *a, int len) {
+  chunk c;
+  if (len > CHUNK_SIZE / 4) {
+    /* Big requests get a chunk of their own behind the current one, so that
+     * the space left in the current chunk isn't wasted. */
+    c = Chunk(len);
+    if (a->used) {
+      c->next = a->used->next;
+      a->used->next = c;
+    } else {
+      c->next = NULL;
+      a->used = c;
+      a->next = a->limit = (char *)c + HEADER_SIZE + len;
+    }
+    return (char *)c + HEADER_SIZE;
+  }
+  if (a->spare) {
+    c = a->spare;
+    a->spare = c->next;
+  } else
+    c = Chunk(CHUNK_SIZE);
+  c->next = a->used;
+  a->used = c;
+  a->next = (char *)c + HEADER_SIZE + len;
+  a->limit = (char *)c + HEADER_SIZE + c->size;
+  return (char *)c + HEADER_SIZE;
+}
+
+void *AR_alloc(AR_kind kind, int len) {
+  state *st = current();
+  struct arena_ *a = &st->arenas[kind];
+  char *p = a->next;
+  assert(kind >= 0 && kind < AR_numKinds && len >= 0);
+  a->allocations++;
+  len = (len + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  a->live += len;
+  a->total += len;
+  if (a->live > a->peak)
+    a->peak = a->live;
+  st->live += len;
+  st->total += len;
+  if (st->live > st->peak)
+    st->peak = st->live;
+  if (len > a->limit - p)
+    return grow(a, len);
+  a->next = p + len;
+  return p;
+}
+
+long AR_allocations(AR_kind kind) {
+  return current()->arenas[kind].allocations;
+}
+
+struct AR_stats AR_stats(AR_kind kind) {
+  state *st = current();
+  struct AR_stats s;
+  int k;
+  assert(kind >= 0 && kind <= AR_numKinds);
+  if (kind < AR_numKinds) {
+    struct arena_ *a = &st->arenas[kind];
+    s.allocations = a->allocations;
+    s.live = a->live;
+    s.total = a->total;
+    s.peak = a->peak;
+    return s;
+  }
+  s.allocations = 0;
+  for (k = 0; k < AR_numKinds; k++)
+    s.allocations += st->arenas[k].allocations;
+  s.live = st->live;
+  s.total = st->total;
+  s.peak = st->peak;
+  return s;
+}
+
+void AR_markPeaks(void) {
+  state *st = current();
+  int kind;
+  for (kind = 0; kind < AR_numKinds; kind++)
+    st->arenas[kind].peak = st->arenas[kind].live;
+  st->peak = st->live;
+}
+
+string AR_name(AR_kind kind) {
+  assert(kind >= 0 && kind < AR_numKinds);
+  return names[kind];
+}
+
+void AR_reset(AR_kind kind) {
+  state *st = current();
+  struct arena_ *a = &st->arenas[kind];
+  chunk c = a->used, next;
+  for (; c; c = next) {
+    next = c->next;
+    if (c->size == CHUNK_SIZE) {
+      c->next = a->spare;
+      a->spare = c;
+    } else
+      free(c);
+  }
+  a->used = NULL;
+  a->next = a->limit = NULL;
+  st->live -= a->live;
+  a->live = 0;
+}
+
+void AR_resetAll(void) {
+  int kind;
+  for (kind = 0; kind < AR_numKinds; kind++)
+    if (kind != AR_symbol)
+      AR_reset(kind);
+}
+
+void AR_setPhaseReset(bool enabled) { current()->phaseReset = enabled; }
+
+void AR_phaseDone(AR_kind kind) {
+  if (current()->phaseReset)
+    AR_reset(kind);
+}
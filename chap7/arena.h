@@ -0,0 +1,62 @@
+/*
+ * arena.h - Bump-pointer allocation for compiler data structures.
+ *
+ * Nodes are never freed one at a time. Each kind of data is carved out of
+ * its own arena instead, and the whole arena is released at once when
+ * nothing refers to that data any more.
+ */
+
+typedef enum {
+  AR_absyn,     /* abstract syntax (absyn.c) */
+  AR_table,     /* TAB_table buckets and binders */
+  AR_types,     /* types and environment entries (types.c, env.c) */
+  AR_translate, /* Tr_exp, Tr_access, Tr_level and patch lists */
+  AR_tree,      /* IR tree nodes (tree.c) */
+  AR_frame,     /* F_frame, F_access and fragments */
+  AR_temp,      /* temps, gensym labels and temp maps */
+  AR_canon,     /* basic blocks and the lists canon.c works with */
+  AR_assem,     /* instructions (assem.c) */
+  AR_graph,     /* flow graphs (graph.c) */
+  AR_liveness,  /* liveness sets of the function being allocated */
+  AR_regalloc,  /* the coloring or linear scan of that function */
+  AR_symbol,    /* interned symbols; these outlive every compilation */
+  AR_numKinds
+} AR_kind;
+
+/* Allocate "len" bytes from the arena for "kind". */
+void *AR_alloc(AR_kind kind, int len);
+
+/* The number of allocations made so far from the arena for "kind" in the
+ *  current context, counting those that have since been released. With
+ *  one allocation for each node, this counts the nodes built. */
+long AR_allocations(AR_kind kind);
+
+/* What the arena for "kind" has handed out in the current context, or all
+ *  the arenas together for AR_numKinds. Sizes are as rounded up for
+ *  alignment; the chunks around them are not counted. */
+struct AR_stats {
+  long allocations; /* as AR_allocations */
+  long live;        /* bytes handed out since the arena was last reset */
+  long total;       /* bytes ever handed out */
+  long peak;        /* the most bytes live at once since AR_markPeaks */
+};
+struct AR_stats AR_stats(AR_kind kind);
+
+/* Start each peak over from what is live now, to find that of a phase. */
+void AR_markPeaks(void);
+
+/* The name of "kind", for reports */
+string AR_name(AR_kind kind);
+
+/* Release everything allocated from the arena for "kind".
+ *  The arena keeps its chunks so the next compilation can reuse them. */
+void AR_reset(AR_kind kind);
+
+/* Release every arena except AR_symbol. Used between compilations. */
+void AR_resetAll(void);
+
+/* When phase reset is enabled, AR_phaseDone releases the arena for "kind"
+ *  as soon as the phase that consumes that data has finished. Otherwise
+ *  the data lives until the next AR_resetAll. */
+void AR_setPhaseReset(bool enabled);
+void AR_phaseDone(AR_kind kind);
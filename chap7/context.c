@@ -0,0 +1,68 @@
+/*
+ * context.c - The state of one compilation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+#include "context.h"
+
+struct CX_context_ {
+  void *state[CX_numModules];
+  CX_hook release[CX_numModules];
+  bool shared[CX_numModules]; /* the state belongs to another context */
+};
+
+static struct CX_context_ defaultContext;
+
+static __thread CX_context current = NULL;
+
+CX_context CX_newContext(void) {
+  CX_context c = checked_malloc(sizeof(*c));
+  memset(c, 0, sizeof(*c));
+  return c;
+}
+
+void CX_use(CX_context c) { current = c; }
+
+CX_context CX_current(void) { return current ? current : &defaultContext; }
+
+void CX_share(CX_context c, CX_context from, CX_module module) {
+  assert(from->state[module] && !c->state[module]);
+  c->state[module] = from->state[module];
+  c->shared[module] = TRUE;
+}
+
+void CX_drop(CX_context c, CX_module module) {
+  if (c->state[module] && !c->shared[module]) {
+    if (c->release[module])
+      c->release[module](c->state[module]);
+    free(c->state[module]);
+  }
+  c->state[module] = NULL;
+  c->release[module] = NULL;
+  c->shared[module] = FALSE;
+}
+
+void CX_freeContext(CX_context c) {
+  int m;
+  assert(c != &defaultContext);
+  for (m = 0; m < CX_numModules; m++)
+    CX_drop(c, m);
+  free(c);
+}
+
+void *CX_state(CX_module module, int size, CX_hook init, CX_hook release) {
+  CX_context c = current ? current : &defaultContext;
+  void *state = c->state[module];
+  if (!state) {
+    state = checked_malloc(size);
+    memset(state, 0, size);
+    if (init)
+      init(state);
+    c->state[module] = state;
+    c->release[module] = release;
+  }
+  return state;
+}
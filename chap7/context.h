@@ -0,0 +1,58 @@
+/*
+ * context.h - The state of one compilation.
+ *
+ * Everything the compiler keeps between calls lives in a context, so that
+ * independent programs can be compiled at the same time on different
+ * threads. Each module keeps its part of the state in its own slot of the
+ * context that the calling thread is using. A thread that has never chosen
+ * a context uses a default one, so single-threaded drivers need not care.
+ */
+
+typedef struct CX_context_ *CX_context;
+
+/* The modules that keep state. When a context is freed, the states are
+ *  released in this order, so the arenas go last. */
+typedef enum {
+  CX_errormsg,  /* error positions and flags (errormsg.c) */
+  CX_scan,      /* the mapped source file (scan.c) */
+  CX_symbol,    /* the intern table (symbol.c) */
+  CX_temp,      /* temp and label numbering (temp.c) */
+  CX_translate, /* the outermost level and the fragments (translate.c) */
+  CX_frame,     /* machine registers (x86frame.c) */
+  CX_canon,     /* basic block labels (canon.c) */
+  CX_cache,     /* hit and miss counts (cache.c) */
+  CX_profile,   /* phase times, counters and trace events (profile.c) */
+  CX_arena,     /* every arena (arena.c) */
+  CX_numModules
+} CX_module;
+
+typedef void (*CX_hook)(void *state);
+
+/* A fresh context, with no state in it yet. */
+CX_context CX_newContext(void);
+
+/* Make "c" the context of the calling thread; NULL goes back to the
+ *  default one. */
+void CX_use(CX_context c);
+
+/* The context of the calling thread */
+CX_context CX_current(void);
+
+/* Let "c" use the state "from" has for "module" instead of one of its own.
+ *  The state stays "from"'s: it is not released with "c", and "from" must
+ *  outlive "c". It must already exist, and whoever uses it through both
+ *  contexts at once must only read it. */
+void CX_share(CX_context c, CX_context from, CX_module module);
+
+/* Release the state "c" has for "module", if any, so that the next time it
+ *  is asked for it is made afresh. No other thread may be using "c". */
+void CX_drop(CX_context c, CX_module module);
+
+/* Release every state of "c", which no thread may be using. */
+void CX_freeContext(CX_context c);
+
+/* The state of "module" in the current context. The first time it is asked
+ *  for, "size" zeroed bytes are allocated and handed to "init", if given.
+ *  "release" is called, if given, when the context is freed, so the state
+ *  can free what it owns. */
+void *CX_state(CX_module module, int size, CX_hook init, CX_hook release);
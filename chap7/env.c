@@ -2,6 +2,7 @@
 #include <stdio.h>
 
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "absyn.h"
 #include "types.h"
@@ -13,7 +14,7 @@
 #include "env.h"
 
 E_enventry E_VarEntry(Tr_access access, Ty_ty ty) {
-  E_enventry e = checked_malloc(sizeof(*e));
+  E_enventry e = AR_alloc(AR_types, sizeof(*e));
   e->kind = E_varEntry;
   e->u.var.access = access;
   e->u.var.ty = ty;
@@ -22,7 +23,7 @@ E_enventry E_VarEntry(Tr_access access, Ty_ty ty) {
 
 E_enventry E_FunEntry(Tr_level level, Temp_label label, Ty_tyList formals,
                       Ty_ty result) {
-  E_enventry e = checked_malloc(sizeof(*e));
+  E_enventry e = AR_alloc(AR_types, sizeof(*e));
   e->kind = E_funEntry;
   e->u.fun.level = level;
   e->u.fun.label = label;
@@ -38,38 +39,29 @@ S_table E_base_tenv(void) {
   return tenv;
 }
 
+/* The library functions have no level, and are called by their own names
+ * (see runtime.c). */
+static void library(S_table venv, string name, Ty_tyList formals,
+                    Ty_ty result) {
+  S_enter(venv, S_Symbol(name),
+          E_FunEntry(NULL, Temp_namedlabel(name), formals, result));
+}
+
 S_table E_base_venv(void) {
   S_table venv = S_empty();
-  S_enter(venv, S_Symbol("print"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(),
-                     Ty_TyList(Ty_String(), NULL), Ty_Void()));
-  S_enter(venv, S_Symbol("flush"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(), NULL, Ty_Void()));
-  S_enter(venv, S_Symbol("getchar"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(), NULL, Ty_String()));
-  S_enter(venv, S_Symbol("ord"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(),
-                     Ty_TyList(Ty_String(), NULL), Ty_Int()));
-  S_enter(venv, S_Symbol("chr"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(), Ty_TyList(Ty_Int(), NULL),
-                     Ty_String()));
-  S_enter(venv, S_Symbol("size"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(),
-                     Ty_TyList(Ty_String(), NULL), Ty_Int()));
-  S_enter(venv, S_Symbol("substring"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(),
-                     Ty_TyList(Ty_String(),
-                               Ty_TyList(Ty_Int(), Ty_TyList(Ty_Int(), NULL))),
-                     Ty_String()));
-  S_enter(venv, S_Symbol("concat"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(),
-                     Ty_TyList(Ty_String(), Ty_TyList(Ty_String(), NULL)),
-                     Ty_String()));
-  S_enter(venv, S_Symbol("not"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(), Ty_TyList(Ty_Int(), NULL),
-                     Ty_Int()));
-  S_enter(venv, S_Symbol("exit"),
-          E_FunEntry(Tr_outermost(), Temp_newlabel(), Ty_TyList(Ty_Int(), NULL),
-                     Ty_Void()));
+  library(venv, "print", Ty_TyList(Ty_String(), NULL), Ty_Void());
+  library(venv, "flush", NULL, Ty_Void());
+  library(venv, "getchar", NULL, Ty_String());
+  library(venv, "ord", Ty_TyList(Ty_String(), NULL), Ty_Int());
+  library(venv, "chr", Ty_TyList(Ty_Int(), NULL), Ty_String());
+  library(venv, "size", Ty_TyList(Ty_String(), NULL), Ty_Int());
+  library(venv, "substring",
+          Ty_TyList(Ty_String(),
+                    Ty_TyList(Ty_Int(), Ty_TyList(Ty_Int(), NULL))),
+          Ty_String());
+  library(venv, "concat", Ty_TyList(Ty_String(), Ty_TyList(Ty_String(), NULL)),
+          Ty_String());
+  library(venv, "not", Ty_TyList(Ty_Int(), NULL), Ty_Int());
+  library(venv, "exit", Ty_TyList(Ty_Int(), NULL), Ty_Void());
   return venv;
 }
@@ -7,67 +7,94 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 #include "util.h"
 #include "errormsg.h"
+#include "context.h"
 
-bool anyErrors = FALSE;
+/* The error state of the current context */
+typedef struct {
+  bool anyErrors;
+  string fileName;
+  FILE *out;   /* where the messages go */
+  int tokPos;  /* EM_tokPos */
+  int lineNum; /* lines started so far */
+  /* Offsets of the line breaks seen so far: linePos[0] is 0, and
+   * linePos[i] is the offset of the newline that ends line i. */
+  int *linePos;
+  int lineCapacity;
+} state;
 
-static string fileName = "";
-
-static int lineNum = 1;
+static void initState(void *p) {
+  state *st = p;
+  st->fileName = "";
+  st->out = stderr;
+}
 
-int EM_tokPos = 0;
+static void freeState(void *p) { free(((state *)p)->linePos); }
 
-extern FILE *yyin;
+static state *current(void) {
+  return CX_state(CX_errormsg, sizeof(state), initState, freeState);
+}
 
-typedef struct intList {
-  int i;
-  struct intList *rest;
-} * IntList;
+int *EM_tokPosRef(void) { return &current()->tokPos; }
 
-static IntList intList(int i, IntList rest) {
-  IntList l = checked_malloc(sizeof *l);
-  l->i = i;
-  l->rest = rest;
-  return l;
-}
+bool EM_anyErrors(void) { return current()->anyErrors; }
 
-static IntList linePos = NULL;
+void EM_setOutput(FILE *out) { current()->out = out; }
 
 void EM_newline(void) {
-  lineNum++;
-  linePos = intList(EM_tokPos, linePos);
+  state *st = current();
+  if (st->lineNum == st->lineCapacity) {
+    int *old = st->linePos;
+    st->lineCapacity = st->lineCapacity ? 2 * st->lineCapacity : 1024;
+    st->linePos = checked_malloc(st->lineCapacity * sizeof(int));
+    if (old)
+      memcpy(st->linePos, old, st->lineNum * sizeof(int));
+    free(old);
+  }
+  st->linePos[st->lineNum++] = st->tokPos;
+}
+
+bool EM_lineCol(int pos, int *line, int *col) {
+  state *st = current();
+  int lo = 0, hi = st->lineNum;
+  /* Find the last line break before "pos". */
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (st->linePos[mid] < pos)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == 0)
+    return FALSE;
+  *line = lo;
+  *col = pos - st->linePos[lo - 1];
+  return TRUE;
 }
 
 void EM_error(int pos, char *message, ...) {
+  state *st = current();
   va_list ap;
-  IntList lines = linePos;
-  int num = lineNum;
+  int line, col;
 
-  anyErrors = TRUE;
-  while (lines && lines->i >= pos) {
-    lines = lines->rest;
-    num--;
-  }
-
-  if (fileName)
-    fprintf(stderr, "%s:", fileName);
-  if (lines)
-    fprintf(stderr, "%d.%d: ", num, pos - lines->i);
+  st->anyErrors = TRUE;
+  if (st->fileName)
+    fprintf(st->out, "%s:", st->fileName);
+  if (EM_lineCol(pos, &line, &col))
+    fprintf(st->out, "%d.%d: ", line, col);
   va_start(ap, message);
-  vfprintf(stderr, message, ap);
+  vfprintf(st->out, message, ap);
   va_end(ap);
-  fprintf(stderr, "\n");
+  fprintf(st->out, "\n");
 }
 
 void EM_reset(string fname) {
-  anyErrors = FALSE;
-  fileName = fname;
-  lineNum = 1;
-  linePos = intList(0, NULL);
-  yyin = fopen(fname, "r");
-  if (!yyin) {
-    EM_error(0, "cannot open");
-    exit(1);
-  }
+  state *st = current();
+  st->anyErrors = FALSE;
+  st->fileName = fname;
+  st->lineNum = 0;
+  st->tokPos = 0;
+  EM_newline();
 }
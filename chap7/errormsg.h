@@ -1,9 +1,23 @@
-extern bool EM_anyErrors;
+/* Tell if an error has been reported since the last EM_reset */
+bool EM_anyErrors(void);
 
 void EM_newline(void);
 
-extern int EM_tokPos;
+/* The position of the token just read. It belongs to the current context,
+ *  like the rest of the error state. */
+int *EM_tokPosRef(void);
+#define EM_tokPos (*EM_tokPosRef())
+
+/* Find the line and column of character offset "pos" of the current file.
+ * Returns FALSE if "pos" comes before the first character. */
+bool EM_lineCol(int pos, int *line, int *col);
 
 void EM_error(int, string, ...);
 void EM_impossible(string, ...);
+
+/* Start reporting errors against "filename", from its first line. The
+ *  scanner opens the file itself. */
 void EM_reset(string filename);
+
+/* Send the messages of the current context to "out" instead of stderr. */
+void EM_setOutput(FILE *out);
@@ -12,8 +12,27 @@ Temp_label F_name(F_frame f);
 F_accessList F_formals(F_frame f);
 F_access F_allocLocal(F_frame f, bool escape);
 
+/* A copy of "f" named "name", with "rename" applied to the temps of its
+ *  formals, in order; the back end can work on it instead of "f". */
+typedef Temp_temp (*F_renamer)(Temp_temp t, void *closure);
+F_frame F_copyFrame(F_frame f, Temp_label name, F_renamer rename,
+                    void *closure);
+/* The number of locals "f" has made room for */
+int F_localCount(F_frame f);
+/* The temp of an access that lives in a register, or NULL */
+Temp_temp F_accessTemp(F_access acc);
+
+/* Names of the machine registers */
+Temp_map F_tempMap(void);
+/* Registers the allocator may hand out */
+Temp_tempList F_registers(void);
 Temp_temp F_FP(void);
+Temp_temp F_SP(void);
+/* Forget the register temps of the previous compilation. */
+void F_reset(void);
 extern const int F_wordSize;
+/* Offset from the frame pointer of an access that lives in the frame */
+int F_frameOffset(F_access acc);
 T_exp F_Exp(F_access acc, T_exp framePtr);
 T_exp F_externalCall(string s, T_expList args);
 Temp_temp F_RV(void);
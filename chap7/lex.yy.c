@@ -535,8 +535,13 @@ char *yytext;
 #include "symbol.h"
 #include "absyn.h"
 #include "y.tab.h"
+#include "scan.h"
 #include "errormsg.h"
 
+/* The parser is pure: the value of a token goes where it asks. */
+#define YY_DECL int yylex(YYSTYPE *lvalp)
+#define yylval (*lvalp)
+
 int charPos=1;
 
 int yywrap(void)
@@ -567,7 +572,7 @@ int commentNesting = 0;
 
 
 
-#line 571 "lex.yy.c"
+#line 576 "lex.yy.c"
 
 #define INITIAL 0
 #define comment 1
@@ -751,9 +756,14 @@ YY_DECL
 	register char *yy_cp, *yy_bp;
 	register int yy_act;
     
-#line 45 "tiger.lex"
+#line 50 "tiger.lex"
+
+ /* The hand-written scanner takes over once SC_open has mapped a file. */
 
-#line 757 "lex.yy.c"
+    if (SC_isOpen())
+        return SC_lex(lvalp);
+
+#line 767 "lex.yy.c"
 
 	if ( !(yy_init) )
 		{
@@ -838,221 +848,221 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 46 "tiger.lex"
+#line 56 "tiger.lex"
 {adjust(); continue;}
 	YY_BREAK
 case 2:
 /* rule 2 can match eol */
 YY_RULE_SETUP
-#line 47 "tiger.lex"
+#line 57 "tiger.lex"
 {adjust(); EM_newline(); continue;}
 	YY_BREAK
 /* Symbols. */
 case 3:
 YY_RULE_SETUP
-#line 50 "tiger.lex"
+#line 60 "tiger.lex"
 {adjust(); return COMMA;}
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 51 "tiger.lex"
+#line 61 "tiger.lex"
 {adjust(); return COLON;}
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 52 "tiger.lex"
+#line 62 "tiger.lex"
 {adjust(); return SEMICOLON;}
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 53 "tiger.lex"
+#line 63 "tiger.lex"
 {adjust(); return LPAREN;}
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 54 "tiger.lex"
+#line 64 "tiger.lex"
 {adjust(); return RPAREN;}
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 55 "tiger.lex"
+#line 65 "tiger.lex"
 {adjust(); return LBRACK;}
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 56 "tiger.lex"
+#line 66 "tiger.lex"
 {adjust(); return RBRACK;}
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 57 "tiger.lex"
+#line 67 "tiger.lex"
 {adjust(); return LBRACE;}
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 58 "tiger.lex"
+#line 68 "tiger.lex"
 {adjust(); return RBRACE;}
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 59 "tiger.lex"
+#line 69 "tiger.lex"
 {adjust(); return DOT;}
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 60 "tiger.lex"
+#line 70 "tiger.lex"
 {adjust(); return PLUS;}
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 61 "tiger.lex"
+#line 71 "tiger.lex"
 {adjust(); return MINUS;}
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 62 "tiger.lex"
+#line 72 "tiger.lex"
 {adjust(); return TIMES;}
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 63 "tiger.lex"
+#line 73 "tiger.lex"
 {adjust(); return DIVIDE;}
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 64 "tiger.lex"
+#line 74 "tiger.lex"
 {adjust(); return EQ;}
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 65 "tiger.lex"
+#line 75 "tiger.lex"
 {adjust(); return NEQ;}
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 66 "tiger.lex"
+#line 76 "tiger.lex"
 {adjust(); return LT;}
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 67 "tiger.lex"
+#line 77 "tiger.lex"
 {adjust(); return LE;}
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 68 "tiger.lex"
+#line 78 "tiger.lex"
 {adjust(); return GT;}
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 69 "tiger.lex"
+#line 79 "tiger.lex"
 {adjust(); return GE;}
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 70 "tiger.lex"
+#line 80 "tiger.lex"
 {adjust(); return AND;}
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 71 "tiger.lex"
+#line 81 "tiger.lex"
 {adjust(); return OR;}
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 72 "tiger.lex"
+#line 82 "tiger.lex"
 {adjust(); return ASSIGN;}
 	YY_BREAK
 /* Keywords. */
 case 26:
 YY_RULE_SETUP
-#line 75 "tiger.lex"
+#line 85 "tiger.lex"
 {adjust(); return WHILE;}
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 76 "tiger.lex"
+#line 86 "tiger.lex"
 {adjust(); return FOR;}
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 77 "tiger.lex"
+#line 87 "tiger.lex"
 {adjust(); return TO;}
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 78 "tiger.lex"
+#line 88 "tiger.lex"
 {adjust(); return BREAK;}
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 79 "tiger.lex"
+#line 89 "tiger.lex"
 {adjust(); return LET;}
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 80 "tiger.lex"
+#line 90 "tiger.lex"
 {adjust(); return IN;}
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 81 "tiger.lex"
+#line 91 "tiger.lex"
 {adjust(); return END;}
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 82 "tiger.lex"
+#line 92 "tiger.lex"
 {adjust(); return FUNCTION;}
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 83 "tiger.lex"
+#line 93 "tiger.lex"
 {adjust(); return VAR;}
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 84 "tiger.lex"
+#line 94 "tiger.lex"
 {adjust(); return TYPE;}
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 85 "tiger.lex"
+#line 95 "tiger.lex"
 {adjust(); return ARRAY;}
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 86 "tiger.lex"
+#line 96 "tiger.lex"
 {adjust(); return IF;}
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 87 "tiger.lex"
+#line 97 "tiger.lex"
 {adjust(); return THEN;}
 	YY_BREAK
 case 39:
 YY_RULE_SETUP
-#line 88 "tiger.lex"
+#line 98 "tiger.lex"
 {adjust(); return ELSE;}
 	YY_BREAK
 case 40:
 YY_RULE_SETUP
-#line 89 "tiger.lex"
+#line 99 "tiger.lex"
 {adjust(); return DO;}
 	YY_BREAK
 case 41:
 YY_RULE_SETUP
-#line 90 "tiger.lex"
+#line 100 "tiger.lex"
 {adjust(); return OF;}
 	YY_BREAK
 case 42:
 YY_RULE_SETUP
-#line 91 "tiger.lex"
+#line 101 "tiger.lex"
 {adjust(); return NIL;}
 	YY_BREAK
 /* Number literals. */
 case 43:
 YY_RULE_SETUP
-#line 94 "tiger.lex"
+#line 104 "tiger.lex"
 {
     adjust();
     yylval.ival = atoi(yytext);
@@ -1062,7 +1072,7 @@ YY_RULE_SETUP
 /* Identifiers. */
 case 44:
 YY_RULE_SETUP
-#line 101 "tiger.lex"
+#line 111 "tiger.lex"
 {
     adjust();
     yylval.sval = String(yytext);
@@ -1072,7 +1082,7 @@ YY_RULE_SETUP
 /* Beginning of a comment. */
 case 45:
 YY_RULE_SETUP
-#line 108 "tiger.lex"
+#line 118 "tiger.lex"
 {
     adjust();
     BEGIN comment;
@@ -1082,7 +1092,7 @@ YY_RULE_SETUP
 /* End of a comment outside of a comment. */
 case 46:
 YY_RULE_SETUP
-#line 114 "tiger.lex"
+#line 124 "tiger.lex"
 {
     adjust();
     EM_error(EM_tokPos, "close comment without a corresponding open");
@@ -1091,12 +1101,12 @@ YY_RULE_SETUP
 /* Beginning of a string literal. */
 case 47:
 YY_RULE_SETUP
-#line 120 "tiger.lex"
+#line 130 "tiger.lex"
 {adjust(); BEGIN string;}
 	YY_BREAK
 case 48:
 YY_RULE_SETUP
-#line 122 "tiger.lex"
+#line 132 "tiger.lex"
 {adjust(); EM_error(EM_tokPos,"illegal token");}
 	YY_BREAK
 /* Comment rules. */
@@ -1104,7 +1114,7 @@ YY_RULE_SETUP
 /* Nested comment. */
 case 49:
 YY_RULE_SETUP
-#line 127 "tiger.lex"
+#line 137 "tiger.lex"
 {
         adjust();
         ++commentNesting;
@@ -1112,7 +1122,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 50:
 YY_RULE_SETUP
-#line 131 "tiger.lex"
+#line 141 "tiger.lex"
 {
         adjust();
         --commentNesting;
@@ -1121,7 +1131,7 @@ YY_RULE_SETUP
     }
 	YY_BREAK
 case YY_STATE_EOF(comment):
-#line 137 "tiger.lex"
+#line 147 "tiger.lex"
 {
         adjust();
         EM_error(EM_tokPos, "encountered eof within a comment");
@@ -1130,7 +1140,7 @@ case YY_STATE_EOF(comment):
 	YY_BREAK
 case 51:
 YY_RULE_SETUP
-#line 142 "tiger.lex"
+#line 152 "tiger.lex"
 {adjust(); continue;}
 	YY_BREAK
 
@@ -1138,32 +1148,32 @@ YY_RULE_SETUP
 
 case 52:
 YY_RULE_SETUP
-#line 147 "tiger.lex"
+#line 157 "tiger.lex"
 {adjust(); stringLiteralPushChar('\n');}
 	YY_BREAK
 case 53:
 YY_RULE_SETUP
-#line 148 "tiger.lex"
+#line 158 "tiger.lex"
 {adjust(); stringLiteralPushChar('\t');}
 	YY_BREAK
 case 54:
 YY_RULE_SETUP
-#line 149 "tiger.lex"
+#line 159 "tiger.lex"
 {adjust(); stringLiteralPushChar('\"');}
 	YY_BREAK
 case 55:
 YY_RULE_SETUP
-#line 150 "tiger.lex"
+#line 160 "tiger.lex"
 {adjust(); stringLiteralPushChar('\\');}
 	YY_BREAK
 case 56:
 YY_RULE_SETUP
-#line 151 "tiger.lex"
+#line 161 "tiger.lex"
 {adjust(); stringLiteralPushChar(atoi(&yytext[1]));}
 	YY_BREAK
 case 57:
 YY_RULE_SETUP
-#line 152 "tiger.lex"
+#line 162 "tiger.lex"
 {
         adjust();
         EM_error(EM_tokPos, "illegal ascii code");
@@ -1171,7 +1181,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 58:
 YY_RULE_SETUP
-#line 156 "tiger.lex"
+#line 166 "tiger.lex"
 {
         adjust();
         stringLiteralTerminate();
@@ -1183,7 +1193,7 @@ YY_RULE_SETUP
 /* Control characters. */
 case 59:
 YY_RULE_SETUP
-#line 164 "tiger.lex"
+#line 174 "tiger.lex"
 {
         adjust();
         stringLiteralPushChar('@' - yytext[1]);
@@ -1192,7 +1202,7 @@ YY_RULE_SETUP
 /* The DEL control character is a special case as it's in a different range from the rest. */
 case 60:
 YY_RULE_SETUP
-#line 169 "tiger.lex"
+#line 179 "tiger.lex"
 {
         adjust();
         stringLiteralPushChar(127);
@@ -1202,7 +1212,7 @@ YY_RULE_SETUP
 case 61:
 /* rule 61 can match eol */
 YY_RULE_SETUP
-#line 174 "tiger.lex"
+#line 184 "tiger.lex"
 {
         adjust();
         for (int i  = 0; yytext[i] != 0; ++i) {
@@ -1213,11 +1223,11 @@ YY_RULE_SETUP
 	YY_BREAK
 case 62:
 YY_RULE_SETUP
-#line 181 "tiger.lex"
+#line 191 "tiger.lex"
 {adjust(); EM_error(EM_tokPos,"illegal escape sequence");}
 	YY_BREAK
 case YY_STATE_EOF(string):
-#line 182 "tiger.lex"
+#line 192 "tiger.lex"
 {
         adjust();
         EM_error(EM_tokPos, "encountered eof within a string literal");
@@ -1226,16 +1236,16 @@ case YY_STATE_EOF(string):
 	YY_BREAK
 case 63:
 YY_RULE_SETUP
-#line 187 "tiger.lex"
+#line 197 "tiger.lex"
 {adjust(); stringLiteralPushChar(yytext[0]);}
 	YY_BREAK
 
 case 64:
 YY_RULE_SETUP
-#line 189 "tiger.lex"
+#line 199 "tiger.lex"
 ECHO;
 	YY_BREAK
-#line 1239 "lex.yy.c"
+#line 1249 "lex.yy.c"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -2232,4 +2242,4 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 189 "tiger.lex"
+#line 199 "tiger.lex"
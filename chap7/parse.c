@@ -3,21 +3,38 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "util.h"
 #include "symbol.h"
 #include "absyn.h"
 #include "errormsg.h"
+#include "y.tab.h"
+#include "scan.h"
 #include "parse.h"
 
-extern int yyparse(void);
-extern A_exp absyn_root;
+static A_exp parseOpened(void) {
+  A_exp absyn_root = NULL;
+  if (yyparse(&absyn_root) == 0) /* parsing worked */
+    return absyn_root;
+  else
+    return NULL;
+}
 
 /* parse source file fname;
    return abstract syntax data structure */
-A_exp parse(string fname) {
+A_exp parse(string fname) { return parseFrom(fname, fname); }
+
+A_exp parseFrom(string fname, string path) {
   EM_reset(fname);
-  if (yyparse() == 0) /* parsing worked */
-    return absyn_root;
-  else
+  if (!SC_open(path)) {
+    EM_error(0, "cannot open");
     return NULL;
+  }
+  return parseOpened();
+}
+
+A_exp parseText(string fname, const char *text, int len) {
+  EM_reset(fname);
+  SC_openText(text, len);
+  return parseOpened();
 }
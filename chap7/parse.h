@@ -1,2 +1,10 @@
 /* function prototype from parse.c */
 A_exp parse(string fname);
+
+/* Parse the file at "path" as the source file "fname", which is only used
+ *  to report errors. */
+A_exp parseFrom(string fname, string path);
+
+/* Parse the "len" bytes at "text" as the source file "fname", which is only
+ *  used to report errors. */
+A_exp parseText(string fname, const char *text, int len);
@@ -1,50 +1,283 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include "util.h"
+#include "arena.h"
 #include "errormsg.h"
 #include "symbol.h"
 #include "absyn.h"
+#include "y.tab.h"
 #include "prabsyn.h"
 #include "temp.h"
 #include "tree.h"
 #include "frame.h"
+#include "translate.h"
 #include "semant.h"
 #include "printtree.h"
+#include "scan.h"
+#include "context.h"
 
-extern int yyparse(void);
 extern int yydebug;
-extern A_exp absyn_root;
+extern FILE *yyin;
+extern void yyrestart(FILE *);
 
-void parse(string fname) {
+static bool useMmap = FALSE;
+static int lexThreads = 0; /* lex the whole file first, on this many */
+
+static void openScanner(string fname) {
+  EM_reset(fname);
+  if (!SC_open(fname)) {
+    EM_error(0, "cannot map");
+    exit(1);
+  }
+}
+
+/* The flex scanner reads through stdio, and isn't reentrant. */
+static void openFlex(string fname) {
   EM_reset(fname);
-  if (yyparse() == 0) /* parsing worked */
-    fprintf(stderr, "Parsing successful!\n");
+  if (yyin)
+    fclose(yyin);
+  yyin = fopen(fname, "r");
+  if (!yyin) {
+    EM_error(0, "cannot open");
+    exit(1);
+  }
+  yyrestart(yyin);
+}
+
+/* Compile "fname" in the current context, printing its syntax tree and IR
+ * to "out" and how parsing went to "errors". */
+static void compile(string fname, bool flex, FILE *out, FILE *errors) {
+  A_exp absyn_root = NULL;
+  EM_setOutput(errors);
+  if (flex)
+    openFlex(fname);
   else
-    fprintf(stderr, "Parsing failed\n");
-  fprintf(stdout, "Abstract Syntax Tree:\n");
+    openScanner(fname);
+  if (lexThreads)
+    SC_tokenize(lexThreads, 0);
+  if (yyparse(&absyn_root) == 0) /* parsing worked */
+    fprintf(errors, "Parsing successful!\n");
+  else
+    fprintf(errors, "Parsing failed\n");
+  fprintf(out, "Abstract Syntax Tree:\n");
   if (absyn_root) {
-    pr_exp(stdout, absyn_root, 0);
+    pr_exp(out, absyn_root, 0);
     F_fragList frags = SEM_transProg(absyn_root);
-    fprintf(stdout, "\nIR Tree:\n");
+    // The AST and the Tr_exps are dead once we have the fragments.
+    AR_phaseDone(AR_absyn);
+    AR_phaseDone(AR_translate);
+    fprintf(out, "\nIR Tree:\n");
     while (frags) {
       F_frag f = frags->head;
       if (f->kind == F_procFrag) {
         T_stm body = f->u.proc.body;
         // Am I missing something here?
         // Why are we expecting a T_stmList?
-        printStmList(stdout, T_StmList(body, NULL));
+        printStmList(out, T_StmList(body, NULL));
       }
       frags = frags->tail;
     }
   }
 }
 
+/* Lex "fname" and write each token, with its line and column, to "out",
+ * and the errors found to "errors". */
+static void lexTo(string fname, int threads, int chunkSize, FILE *out,
+                  FILE *errors) {
+  YYSTYPE lval;
+  int tok, line, col;
+  EM_setOutput(errors);
+  openScanner(fname);
+  if (threads)
+    SC_tokenize(threads, chunkSize);
+  while ((tok = SC_lex(&lval))) {
+    if (!EM_lineCol(EM_tokPos, &line, &col))
+      line = col = 0;
+    fprintf(out, "%d %d %d.%d", tok, EM_tokPos, line, col);
+    if (tok == ID || tok == STRING)
+      fprintf(out, " %s", lval.sval);
+    else if (tok == INT)
+      fprintf(out, " %d", lval.ival);
+    fprintf(out, "\n");
+  }
+  fprintf(out, "0 %d\n", EM_tokPos);
+  EM_setOutput(stderr);
+}
+
+static bool sameContents(FILE *a, FILE *b) {
+  int c;
+  rewind(a);
+  rewind(b);
+  do {
+    c = getc(a);
+    if (c != getc(b))
+      return FALSE;
+  } while (c != EOF);
+  return TRUE;
+}
+
+/* Check that lexing "fname" in parallel gives the same tokens, positions
+ * and errors as lexing it sequentially, whatever the number of threads and
+ * wherever the chunks are cut. */
+static bool lexCheck(string fname) {
+  static int threads[] = {1, 2, 3, 4, 8};
+  static int chunkSizes[] = {0, 1, 7, 64, 4096};
+  FILE *want = tmpfile(), *wantErrors = tmpfile();
+  bool ok = TRUE;
+  int t, c;
+  lexTo(fname, 0, 0, want, wantErrors);
+  for (t = 0; t < (int)(sizeof(threads) / sizeof(threads[0])); t++)
+    for (c = 0; c < (int)(sizeof(chunkSizes) / sizeof(chunkSizes[0])); c++) {
+      FILE *got = tmpfile(), *gotErrors = tmpfile();
+      lexTo(fname, threads[t], chunkSizes[c], got, gotErrors);
+      if (!sameContents(want, got) || !sameContents(wantErrors, gotErrors)) {
+        fprintf(stderr, "%s: %d threads, chunks of %d: differs\n", fname,
+                threads[t], chunkSizes[c]);
+        ok = FALSE;
+      }
+      fclose(got);
+      fclose(gotErrors);
+    }
+  fclose(want);
+  fclose(wantErrors);
+  return ok;
+}
+
+/* Stress test: compile "files" over and over on "threads" threads at once,
+ * each compilation in a context of its own, and check that each one prints
+ * exactly what the same file printed when compiled alone. */
+
+#define STRESS_ROUNDS 64
+
+typedef struct {
+  string fname;
+  char *out, *errors; /* what compiling it alone printed */
+} stressJob;
+
+static stressJob *jobs;
+static int jobCount, nextJob, stressFailures;
+static bool phaseReset = FALSE;
+
+/* Compile "fname" in a fresh context; return what it printed. */
+static void compileAlone(string fname, char **out, char **errors) {
+  CX_context c = CX_newContext();
+  size_t outSize, errorsSize;
+  FILE *o = open_memstream(out, &outSize);
+  FILE *e = open_memstream(errors, &errorsSize);
+  CX_use(c);
+  AR_setPhaseReset(phaseReset);
+  compile(fname, FALSE, o, e);
+  CX_use(NULL);
+  CX_freeContext(c);
+  fclose(o);
+  fclose(e);
+}
+
+static void *stressWorker(void *unused) {
+  (void)unused;
+  for (;;) {
+    int i = __sync_fetch_and_add(&nextJob, 1);
+    stressJob *job;
+    char *out, *errors;
+    if (i >= jobCount * STRESS_ROUNDS)
+      return NULL;
+    job = &jobs[i % jobCount];
+    compileAlone(job->fname, &out, &errors);
+    if (strcmp(out, job->out) || strcmp(errors, job->errors)) {
+      fprintf(stderr, "%s: differs when compiled concurrently\n", job->fname);
+      __sync_fetch_and_add(&stressFailures, 1);
+    }
+    free(out);
+    free(errors);
+  }
+}
+
+static int stress(string *files, int count, int threads) {
+  pthread_t *workers = checked_malloc(threads * sizeof(pthread_t));
+  int i;
+  jobs = checked_malloc(count * sizeof(stressJob));
+  jobCount = count;
+  for (i = 0; i < count; i++) {
+    jobs[i].fname = files[i];
+    compileAlone(files[i], &jobs[i].out, &jobs[i].errors);
+  }
+  nextJob = stressFailures = 0;
+  for (i = 0; i < threads; i++)
+    pthread_create(&workers[i], NULL, stressWorker, NULL);
+  for (i = 0; i < threads; i++)
+    pthread_join(workers[i], NULL);
+  fprintf(stderr, "%d compilations on %d threads, %d differ\n",
+          count * STRESS_ROUNDS, threads, stressFailures);
+  for (i = 0; i < count; i++) {
+    free(jobs[i].out);
+    free(jobs[i].errors);
+  }
+  free(jobs);
+  free(workers);
+  return stressFailures;
+}
+
+static void printStats(FILE *out) {
+  struct S_stats s = S_stats();
+  int k;
+  fprintf(out, "symbols: %d interned, %d slots\n", s.symbols, s.capacity);
+  fprintf(out, "symbol lookups: %ld, %ld hits, %.2f probes per lookup\n",
+          s.lookups, s.hits, s.lookups ? (double)s.probes / s.lookups : 0.0);
+  for (k = 0; k < AR_numKinds; k++) {
+    struct AR_stats a = AR_stats(k);
+    if (a.allocations)
+      fprintf(out, "%s arena: %ld allocations, %ld bytes, %ld at most\n",
+              AR_name(k), a.allocations, a.total, a.peak);
+  }
+}
+
 int main(int argc, char **argv) {
+  int i, stressThreads = 0;
+  bool stats = FALSE, check = FALSE;
   // yydebug = 1;
-  if (argc != 2) {
-    fprintf(stderr, "usage: a.out filename\n");
+  for (i = 1; i < argc && argv[i][0] == '-'; ++i) {
+    if (!strcmp(argv[i], "-reset"))
+      phaseReset = TRUE;
+    else if (!strcmp(argv[i], "-stats"))
+      stats = TRUE;
+    else if (!strcmp(argv[i], "-mmap"))
+      useMmap = TRUE;
+    else if (!strcmp(argv[i], "-parallel") && i + 1 < argc)
+      lexThreads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-lexcheck"))
+      check = TRUE;
+    else if (!strcmp(argv[i], "-stress") && i + 1 < argc)
+      stressThreads = atoi(argv[++i]);
+    else
+      break;
+  }
+  if (i >= argc) {
+    fprintf(stderr, "usage: a.out [-reset] [-stats] [-mmap] [-parallel n] "
+                    "[-lexcheck] [-stress n] filename...\n");
     exit(1);
   }
-  parse(argv[1]);
+  AR_setPhaseReset(phaseReset);
+  if (stressThreads)
+    return stress(argv + i, argc - i, stressThreads) ? 1 : 0;
+  if (check) {
+    int failed = 0, files = argc - i;
+    for (; i < argc; ++i)
+      if (!lexCheck(argv[i]))
+        failed++;
+    fprintf(stderr, "%d files lexed in parallel, %d differ\n", files, failed);
+    return failed ? 1 : 0;
+  }
+  for (; i < argc; ++i) {
+    compile(argv[i], !useMmap && !lexThreads, stdout, stderr);
+    // Nothing from this file is needed to compile the next one.
+    AR_resetAll();
+    Tr_reset();
+    Temp_reset();
+    F_reset();
+  }
+  if (stats)
+    printStats(stderr);
   return 0;
 }
@@ -0,0 +1,720 @@
+/*
+ * scan.c - Hand-written scanner over a memory-mapped source file.
+ *
+ * The file is mapped read-only and scanned in place. Keywords are told
+ * apart by a perfect hash of their first and last characters and their
+ * length, and identifiers are interned straight from the mapped bytes, so
+ * nothing is copied for them. String literals are the only tokens that
+ * get copied, once, into a buffer of their own.
+ *
+ * Positions follow the flex scanner: EM_tokPos is one more than the offset
+ * of the first character of a token, or of the closing quote of a string.
+ *
+ * A large file can also be lexed on several threads. It is cut into chunks
+ * at line starts, and each chunk is lexed on the guess that no comment or
+ * string literal is open where it starts. The chunks are then stitched
+ * together in order: where the guess was wrong, the text is lexed again
+ * from where the previous chunk really stopped, until the two runs meet at
+ * a token they both start at the same place, from which on they must
+ * agree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "util.h"
+#include "symbol.h"
+#include "absyn.h"
+#include "y.tab.h"
+#include "errormsg.h"
+#include "scan.h"
+#include "context.h"
+
+#define POS(s, p) ((int)((p) - (s)->base) + 1)
+
+/* Keywords */
+
+static struct {
+  string name;
+  int len, token;
+} keywords[] = {
+    {"while", 5, WHILE}, {"for", 3, FOR},       {"to", 2, TO},
+    {"break", 5, BREAK}, {"let", 3, LET},       {"in", 2, IN},
+    {"end", 3, END},     {"function", 8, FUNCTION}, {"var", 3, VAR},
+    {"type", 4, TYPE},   {"array", 5, ARRAY},   {"if", 2, IF},
+    {"then", 4, THEN},   {"else", 4, ELSE},     {"do", 2, DO},
+    {"of", 2, OF},       {"nil", 3, NIL}};
+
+#define KEYWORD_COUNT (int)(sizeof(keywords) / sizeof(keywords[0]))
+#define KEYWORD_SLOTS 32 /* must be a power of two */
+
+/* One more than the index of the keyword hashing to each slot, or 0 */
+static int keywordSlot[KEYWORD_SLOTS];
+
+static unsigned int keywordHash(const char *s, int len) {
+  unsigned int first = (unsigned char)s[0], last = (unsigned char)s[len - 1];
+  return (first * 29 + last * 22 + len) & (KEYWORD_SLOTS - 1);
+}
+
+static void fillKeywordSlots(void) {
+  int i;
+  for (i = 0; i < KEYWORD_COUNT; i++) {
+    unsigned int h = keywordHash(keywords[i].name, keywords[i].len);
+    assert(!keywordSlot[h]); /* the hash must stay perfect */
+    keywordSlot[h] = i + 1;
+  }
+}
+
+/* The slots are shared by every context, so they are filled only once. */
+static void initKeywords(void) {
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+  pthread_once(&once, fillKeywordSlots);
+}
+
+/* The keyword token for "len" bytes at "s", or 0 */
+static int keyword(const char *s, int len) {
+  int k = keywordSlot[keywordHash(s, len)] - 1;
+  if (k >= 0 && keywords[k].len == len && !memcmp(keywords[k].name, s, len))
+    return keywords[k].token;
+  return 0;
+}
+
+static bool isLetter(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+static bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/* Scanner state */
+
+#define ERROR_TOKEN (-1) /* a recorded error, not a token */
+
+/* A token as recorded for SC_lex to hand out later. Identifiers are kept
+ * as their length and interned when they are handed out, so that only one
+ * thread ever touches the symbol table. */
+typedef struct {
+  int tok, pos;
+  union {
+    int ival;
+    int len;        /* of an ID */
+    string sval;    /* of a STRING */
+    string message; /* of an ERROR_TOKEN */
+  } u;
+} lexeme;
+
+/* A scanner either reports what it finds as it goes, for SC_lex, or
+ * records it in its arrays, for SC_tokenize. It stops when the end of the
+ * file is reached, or when it is at "limit" and no token, comment or
+ * string literal is under way. */
+typedef struct scanner_ *scanner;
+struct scanner_ {
+  const char *base, *end; /* the file */
+  const char *p, *limit;
+  bool record;
+  int lastPos; /* what flex leaves in EM_tokPos: where it last matched */
+  lexeme cur; /* the token just scanned */
+  lexeme *tokens;
+  int tokenCount, tokenCapacity;
+  int *lines; /* positions of the newlines, as EM_newline wants them */
+  int lineCount, lineCapacity;
+  char *scratch; /* literals with escapes are decoded here */
+  int scratchSize;
+};
+
+static void *grow(void *old, int count, int *capacity, int size) {
+  void *p;
+  *capacity = *capacity ? 2 * *capacity : 256;
+  p = checked_malloc(*capacity * size);
+  if (old)
+    memcpy(p, old, (size_t)count * size);
+  free(old);
+  return p;
+}
+
+static void addToken(scanner s, lexeme t) {
+  if (s->tokenCount == s->tokenCapacity)
+    s->tokens =
+        grow(s->tokens, s->tokenCount, &s->tokenCapacity, sizeof(lexeme));
+  s->tokens[s->tokenCount++] = t;
+}
+
+static void addLine(scanner s, int pos) {
+  if (s->lineCount == s->lineCapacity)
+    s->lines = grow(s->lines, s->lineCount, &s->lineCapacity, sizeof(int));
+  s->lines[s->lineCount++] = pos;
+}
+
+static void newline(scanner s, const char *p) {
+  s->lastPos = POS(s, p);
+  if (s->record)
+    addLine(s, POS(s, p));
+  else {
+    EM_tokPos = POS(s, p);
+    EM_newline();
+  }
+}
+
+static void report(scanner s, const char *p, string message) {
+  s->lastPos = POS(s, p);
+  if (s->record) {
+    lexeme t;
+    t.tok = ERROR_TOKEN;
+    t.pos = POS(s, p);
+    t.u.message = message;
+    addToken(s, t);
+  } else
+    EM_error(POS(s, p), message);
+}
+
+static void freeScanner(scanner s) {
+  int i;
+  for (i = 0; i < s->tokenCount; i++)
+    if (s->tokens[i].tok == STRING)
+      free(s->tokens[i].u.sval);
+  free(s->tokens);
+  free(s->lines);
+  free(s->scratch);
+  memset(s, 0, sizeof(*s));
+}
+
+/* Comments and string literals */
+
+/* Skip a comment whose opening has just been read; return where it ends,
+ * or NULL if the file ends first. */
+static const char *skipComment(scanner s, const char *p) {
+  int depth = 1;
+  while (p < s->end) {
+    if (*p == '\n')
+      newline(s, p++);
+    else if (*p == '/' && p + 1 < s->end && p[1] == '*') {
+      depth++;
+      p += 2;
+    } else if (*p == '*' && p + 1 < s->end && p[1] == '/') {
+      s->lastPos = POS(s, p);
+      p += 2;
+      if (--depth == 0)
+        return p;
+    } else
+      p++;
+  }
+  report(s, s->end, "encountered eof within a comment");
+  return NULL;
+}
+
+static void put(scanner s, int *len, char c) {
+  if (*len == s->scratchSize)
+    s->scratch = grow(s->scratch, *len, &s->scratchSize, 1);
+  s->scratch[(*len)++] = c;
+}
+
+/* Decode the escape sequence at "p" into the scratch buffer; return where
+ * the rest of the literal starts. */
+static const char *escape(scanner s, const char *p, int *len) {
+  const char *q = p + 1;
+  int digits = 0;
+  if (q < s->end)
+    switch (*q) {
+    case 'n':
+      put(s, len, '\n');
+      return q + 1;
+    case 't':
+      put(s, len, '\t');
+      return q + 1;
+    case '"':
+    case '\\':
+      put(s, len, *q);
+      return q + 1;
+    case '^':
+      if (q + 1 < s->end && q[1] >= '@' && q[1] <= '_') {
+        put(s, len, q[1] - '@');
+        return q + 2;
+      }
+      if (q + 1 < s->end && q[1] == '?') {
+        put(s, len, 127);
+        return q + 2;
+      }
+      break;
+    default:
+      while (q + digits < s->end && isDigit(q[digits]))
+        digits++;
+      if (digits == 3) {
+        put(s, len, (q[0] - '0') * 100 + (q[1] - '0') * 10 + (q[2] - '0'));
+        return q + 3;
+      }
+      if (digits) {
+        report(s, p, "illegal ascii code");
+        return q + digits;
+      }
+      /* \ followed by white space up to another \ is skipped, so a
+       * literal can be continued on the next line. */
+      while (q < s->end && isSpace(*q))
+        q++;
+      if (q > p + 1 && q < s->end && *q == '\\') {
+        for (q = p + 1; *q != '\\'; q++)
+          if (*q == '\n')
+            newline(s, q);
+        return q + 1;
+      }
+    }
+  report(s, p, "illegal escape sequence");
+  return p + 1;
+}
+
+/* Scan a string literal whose opening quote has just been read. */
+static int stringLiteral(scanner s, const char *p) {
+  const char *q = p;
+  int len = 0;
+  /* Most literals have no escapes and can be copied as they are. */
+  while (q < s->end && *q != '"' && *q != '\\' && *q != '\n')
+    q++;
+  if (q < s->end && *q == '"') {
+    s->cur.u.sval = checked_malloc(q - p + 1);
+    memcpy(s->cur.u.sval, p, q - p);
+    s->cur.u.sval[q - p] = 0;
+  } else {
+    for (q = p; q < s->end && *q != '"';)
+      if (*q == '\\')
+        q = escape(s, q, &len);
+      else {
+        if (*q == '\n')
+          newline(s, q);
+        put(s, &len, *q++);
+      }
+    if (q == s->end) {
+      report(s, s->end, "encountered eof within a string literal");
+      s->p = s->end;
+      return 0;
+    }
+    s->cur.u.sval = checked_malloc(len + 1);
+    if (len)
+      memcpy(s->cur.u.sval, s->scratch, len);
+    s->cur.u.sval[len] = 0;
+  }
+  s->cur.tok = STRING;
+  s->cur.pos = s->lastPos = POS(s, q);
+  s->p = q + 1;
+  return STRING;
+}
+
+/* Tokens */
+
+static int token(scanner s, const char *start, int len, int tok) {
+  s->cur.tok = tok;
+  s->cur.pos = s->lastPos = POS(s, start);
+  s->p = start + len;
+  return tok;
+}
+
+/* Scan the next token into s->cur and return it, or return 0 if the
+ * scanner has stopped. */
+static int scan(scanner s) {
+  const char *p = s->p;
+  for (;;) {
+    const char *q;
+    if (p >= s->limit) {
+      s->p = p;
+      return 0;
+    }
+    switch (*p) {
+    case ' ':
+    case '\t':
+    case '\r':
+      s->lastPos = POS(s, p);
+      while (p < s->limit && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+      continue;
+    case '\n':
+      newline(s, p++);
+      continue;
+    case ',':
+      return token(s, p, 1, COMMA);
+    case ';':
+      return token(s, p, 1, SEMICOLON);
+    case '(':
+      return token(s, p, 1, LPAREN);
+    case ')':
+      return token(s, p, 1, RPAREN);
+    case '[':
+      return token(s, p, 1, LBRACK);
+    case ']':
+      return token(s, p, 1, RBRACK);
+    case '{':
+      return token(s, p, 1, LBRACE);
+    case '}':
+      return token(s, p, 1, RBRACE);
+    case '.':
+      return token(s, p, 1, DOT);
+    case '+':
+      return token(s, p, 1, PLUS);
+    case '-':
+      return token(s, p, 1, MINUS);
+    case '=':
+      return token(s, p, 1, EQ);
+    case '&':
+      return token(s, p, 1, AND);
+    case '|':
+      return token(s, p, 1, OR);
+    case ':':
+      if (p + 1 < s->end && p[1] == '=')
+        return token(s, p, 2, ASSIGN);
+      return token(s, p, 1, COLON);
+    case '<':
+      if (p + 1 < s->end && p[1] == '>')
+        return token(s, p, 2, NEQ);
+      if (p + 1 < s->end && p[1] == '=')
+        return token(s, p, 2, LE);
+      return token(s, p, 1, LT);
+    case '>':
+      if (p + 1 < s->end && p[1] == '=')
+        return token(s, p, 2, GE);
+      return token(s, p, 1, GT);
+    case '*':
+      if (p + 1 < s->end && p[1] == '/') {
+        report(s, p, "close comment without a corresponding open");
+        p += 2;
+        continue;
+      }
+      return token(s, p, 1, TIMES);
+    case '/':
+      if (p + 1 < s->end && p[1] == '*') {
+        s->lastPos = POS(s, p);
+        p = skipComment(s, p + 2);
+        if (!p) {
+          s->p = s->end;
+          return 0;
+        }
+        continue;
+      }
+      return token(s, p, 1, DIVIDE);
+    case '"':
+      return stringLiteral(s, p + 1);
+    default:
+      break;
+    }
+    if (isDigit(*p)) {
+      unsigned int value = 0;
+      for (q = p; q < s->end && isDigit(*q); q++)
+        value = value * 10 + (*q - '0');
+      s->cur.u.ival = (int)value;
+      return token(s, p, q - p, INT);
+    }
+    if (isLetter(*p)) {
+      int tok;
+      for (q = p + 1; q < s->end && (isLetter(*q) || isDigit(*q) || *q == '_');)
+        q++;
+      tok = keyword(p, q - p);
+      if (tok)
+        return token(s, p, q - p, tok);
+      s->cur.u.len = q - p;
+      return token(s, p, q - p, ID);
+    }
+    report(s, p, "illegal token");
+    p++;
+  }
+}
+
+/* Scan from where "s" is up to its limit, recording everything. */
+static void scanAll(scanner s) {
+  while (scan(s))
+    addToken(s, s->cur);
+}
+
+/* Mapping the file */
+
+/* What SC_tokenize recorded: stretches of the chunks' arrays, in order */
+typedef struct {
+  lexeme *tokens;
+  int next, count;
+} segment;
+
+/* The file being scanned in the current context */
+typedef struct {
+  size_t mapped; /* bytes mapped; empty files aren't */
+  bool isOpen;
+  struct scanner_ current; /* what SC_lex scans, when not recorded */
+  segment *segments;       /* what SC_lex hands out, if anything */
+  int segmentCount, nextSegment;
+  int stoppedPos; /* lastPos of the scanner that reached the end */
+} state;
+
+static void closeFile(state *st) {
+  int i, j;
+  for (i = st->nextSegment; i < st->segmentCount; i++) {
+    segment *g = &st->segments[i];
+    for (j = g->next; j < g->count; j++)
+      if (g->tokens[j].tok == STRING)
+        free(g->tokens[j].u.sval);
+  }
+  for (i = 0; i < st->segmentCount; i++)
+    free(st->segments[i].tokens);
+  free(st->segments);
+  st->segments = NULL;
+  st->segmentCount = st->nextSegment = 0;
+  if (st->mapped)
+    munmap((void *)st->current.base, st->mapped);
+  freeScanner(&st->current);
+  st->mapped = 0;
+  st->isOpen = FALSE;
+}
+
+static void freeState(void *p) { closeFile(p); }
+
+static state *current(void) {
+  return CX_state(CX_scan, sizeof(state), NULL, freeState);
+}
+
+/* Start scanning the "len" bytes at st->current.base. */
+static void start(state *st, size_t len) {
+  st->current.end = st->current.base + len;
+  st->current.p = st->current.base;
+  st->current.limit = st->current.end;
+  st->current.record = FALSE;
+  st->isOpen = TRUE;
+}
+
+bool SC_open(string fname) {
+  state *st = current();
+  struct stat sb;
+  int fd;
+  closeFile(st);
+  initKeywords();
+  fd = open(fname, O_RDONLY);
+  if (fd < 0)
+    return FALSE;
+  if (fstat(fd, &sb) < 0) {
+    close(fd);
+    return FALSE;
+  }
+  st->mapped = sb.st_size;
+  if (st->mapped) {
+    void *p = mmap(NULL, st->mapped, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      close(fd);
+      st->mapped = 0;
+      return FALSE;
+    }
+    madvise(p, st->mapped, MADV_SEQUENTIAL);
+    st->current.base = p;
+  } else
+    st->current.base = "";
+  close(fd);
+  start(st, st->mapped);
+  return TRUE;
+}
+
+void SC_openText(const char *text, int len) {
+  state *st = current();
+  closeFile(st);
+  initKeywords();
+  st->current.base = text;
+  start(st, len);
+}
+
+bool SC_isOpen(void) { return current()->isOpen; }
+
+void SC_close(void) { closeFile(current()); }
+
+/* Hand out a token the way yylex does. */
+static int deliver(state *st, lexeme *t, YYSTYPE *lval) {
+  EM_tokPos = t->pos;
+  switch (t->tok) {
+  case ID:
+    lval->sval = S_name(
+        S_SymbolSlice(st->current.base + t->pos - 1, t->u.len));
+    break;
+  case STRING:
+    lval->sval = t->u.sval;
+    break;
+  case INT:
+    lval->ival = t->u.ival;
+    break;
+  }
+  return t->tok;
+}
+
+int SC_lex(YYSTYPE *lval) {
+  state *st = current();
+  if (!st->isOpen)
+    return 0;
+  if (st->segments) {
+    for (; st->nextSegment < st->segmentCount; st->nextSegment++) {
+      segment *g = &st->segments[st->nextSegment];
+      while (g->next < g->count) {
+        lexeme *t = &g->tokens[g->next++];
+        if (t->tok != ERROR_TOKEN)
+          return deliver(st, t, lval);
+        EM_error(t->pos, t->u.message);
+      }
+    }
+    EM_tokPos = st->stoppedPos;
+  } else if (scan(&st->current))
+    return deliver(st, &st->current.cur, lval);
+  else
+    EM_tokPos = st->current.lastPos;
+  closeFile(st);
+  return 0;
+}
+
+/* Lexing in parallel */
+
+#define MAX_CHUNK (1 << 24) /* bytes; keeps each token array well in range */
+
+typedef struct {
+  const char *start;
+  struct scanner_ s;
+} chunk;
+
+/* The chunks of one SC_tokenize, shared with its threads */
+typedef struct {
+  chunk *chunks;
+  int chunkCount, nextChunk;
+} work;
+
+static void *lexChunks(void *p) {
+  work *w = p;
+  for (;;) {
+    int i = __sync_fetch_and_add(&w->nextChunk, 1);
+    if (i >= w->chunkCount)
+      return NULL;
+    scanAll(&w->chunks[i].s);
+  }
+}
+
+/* Index of an entry of "s" that is a token other than a string literal
+ * starting at "pos", or -1. Positions never decrease along the tokens. */
+static int findToken(scanner s, int pos) {
+  int lo = 0, hi = s->tokenCount, i;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (s->tokens[mid].pos < pos)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  for (i = lo; i < s->tokenCount && s->tokens[i].pos == pos; i++)
+    if (s->tokens[i].tok != STRING && s->tokens[i].tok != ERROR_TOKEN)
+      return i;
+  return -1;
+}
+
+/* Hand the tokens of "s" from "t" on, and its newlines from "l" on, over
+ * to SC_lex and the error messages. */
+static void keep(state *st, scanner s, int t, int l) {
+  segment *g = &st->segments[st->segmentCount++];
+  g->tokens = s->tokens;
+  g->next = t;
+  g->count = s->tokenCount;
+  for (; l < s->lineCount; l++) {
+    EM_tokPos = s->lines[l];
+    EM_newline();
+  }
+  s->tokens = NULL;
+  s->tokenCount = s->tokenCapacity = 0;
+}
+
+/* Keep what chunk "c" found, given that lexing really stopped at "at" just
+ * before it; return where it stops after the chunk. */
+static const char *stitch(state *st, chunk *c, const char *at) {
+  struct scanner_ fix;
+  int t, l, i;
+  if (at == c->start) {
+    keep(st, &c->s, 0, 0);
+    st->stoppedPos = c->s.lastPos;
+    return c->s.p;
+  }
+  if (at >= c->s.limit)
+    return at;
+  /* The guess was wrong: lex again until a token lines up with one of the
+   * chunk's own. */
+  memset(&fix, 0, sizeof(fix));
+  fix.base = c->s.base;
+  fix.end = c->s.end;
+  fix.p = at;
+  fix.limit = c->s.limit;
+  fix.record = TRUE;
+  while (scan(&fix)) {
+    t = fix.cur.tok == STRING ? -1 : findToken(&c->s, fix.cur.pos);
+    if (t >= 0) {
+      for (l = 0; l < c->s.lineCount && c->s.lines[l] < fix.cur.pos;)
+        l++;
+      for (i = 0; i < t; i++)
+        if (c->s.tokens[i].tok == STRING)
+          free(c->s.tokens[i].u.sval);
+      keep(st, &fix, 0, 0);
+      keep(st, &c->s, t, l);
+      freeScanner(&fix);
+      st->stoppedPos = c->s.lastPos;
+      return c->s.p;
+    }
+    addToken(&fix, fix.cur);
+  }
+  keep(st, &fix, 0, 0);
+  st->stoppedPos = fix.lastPos;
+  at = fix.p;
+  freeScanner(&fix);
+  return at;
+}
+
+void SC_tokenize(int threads, int chunkSize) {
+  state *st = current();
+  const char *base = st->current.base, *end = st->current.end, *at;
+  size_t size = end - base;
+  pthread_t *workers;
+  work w;
+  int i;
+  if (!st->isOpen || st->segments)
+    return;
+  if (threads < 1)
+    threads = 1;
+  if (chunkSize <= 0 || chunkSize > MAX_CHUNK)
+    chunkSize = size / threads < MAX_CHUNK ? size / threads + 1 : MAX_CHUNK;
+
+  /* Cut the file into chunks at line starts. Tokens take a few bytes each,
+   * so a third of a chunk's size is room enough for them in most code. */
+  w.chunks = checked_malloc((size / chunkSize + 2) * sizeof(chunk));
+  w.chunkCount = 0;
+  for (at = st->current.p; at < end || w.chunkCount == 0;) {
+    chunk *c = &w.chunks[w.chunkCount++];
+    const char *limit = end - at > chunkSize ? at + chunkSize : end;
+    while (limit < end && limit[-1] != '\n')
+      limit++;
+    memset(&c->s, 0, sizeof(c->s));
+    c->s.base = base;
+    c->s.end = end;
+    c->start = c->s.p = at;
+    c->s.limit = limit;
+    c->s.record = TRUE;
+    c->s.tokenCapacity = (limit - at) / 3 + 16;
+    c->s.tokens = checked_malloc(c->s.tokenCapacity * sizeof(lexeme));
+    at = limit;
+  }
+
+  w.nextChunk = 0;
+  workers = checked_malloc(threads * sizeof(pthread_t));
+  for (i = 1; i < threads; i++)
+    pthread_create(&workers[i], NULL, lexChunks, &w);
+  lexChunks(&w);
+  for (i = 1; i < threads; i++)
+    pthread_join(workers[i], NULL);
+  free(workers);
+
+  /* Each chunk leaves at most two stretches of tokens. */
+  st->segments = checked_malloc(2 * w.chunkCount * sizeof(segment));
+  st->segmentCount = st->nextSegment = 0;
+  st->stoppedPos = st->current.lastPos;
+  at = st->current.p;
+  for (i = 0; i < w.chunkCount; i++) {
+    at = stitch(st, &w.chunks[i], at);
+    freeScanner(&w.chunks[i].s);
+  }
+  free(w.chunks);
+}
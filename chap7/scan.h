@@ -0,0 +1,32 @@
+/*
+ * scan.h - A hand-written scanner that reads the source file through mmap.
+ *
+ * It returns the same tokens as the flex scanner and fills in the semantic
+ * value the same way, but identifiers come straight out of the mapped file
+ * into the symbol table, and string literals may be of any length. The file
+ * belongs to the current context, so several threads can each scan one.
+ */
+
+/* Map "fname" and start scanning it; tell if it could be mapped.
+ *  EM_reset should already have been called for the file. */
+bool SC_open(string fname);
+
+/* Scan the "len" bytes at "text" as if they were a file. They are not
+ *  copied, and must stay put until the end is reached or SC_close. */
+void SC_openText(const char *text, int len);
+
+/* Tell if a file is open, so yylex should leave the work to SC_lex */
+bool SC_isOpen(void);
+
+/* Return the next token, or 0 at the end of the file, and store its value
+ *  in "lval". The file is unmapped when the end is reached. */
+int SC_lex(YYSTYPE *lval);
+
+/* Unmap the current file, if any. */
+void SC_close(void);
+
+/* Lex all of the open file now, on "threads" threads, cutting it into
+ *  chunks of about "chunkSize" bytes, or one per thread if it is 0. SC_lex
+ *  then hands out the tokens, with the same positions, values and errors
+ *  as if it had lexed them itself. */
+void SC_tokenize(int threads, int chunkSize);
@@ -38,25 +38,42 @@ Ty_ty actual_ty(Ty_ty type) {
   return t;
 }
 
-struct expty transVar(Tr_level level, S_table venv, S_table tenv, A_var v);
-struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a);
-void transDec(Tr_level level, S_table venv, S_table tenv, A_dec dec);
+/* Whether a value of type "have" can go where one of type "want" is
+ * expected: they are the same type, or it is nil and a record is wanted. */
+static bool assignable(Ty_ty want, Ty_ty have) {
+  want = actual_ty(want);
+  have = actual_ty(have);
+  if (want == have)
+    return true;
+  return want && have && want->kind == Ty_record && have->kind == Ty_nil;
+}
+
+/* "breakk" is the label a break jumps to, that of the innermost loop, or
+ * NULL outside of any. */
+struct expty transVar(Tr_level level, S_table venv, S_table tenv, A_var v,
+                      Temp_label breakk);
+struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a,
+                      Temp_label breakk);
+Tr_exp transDec(Tr_level level, S_table venv, S_table tenv, A_dec dec,
+                Temp_label breakk);
 Ty_ty transTy(S_table tenv, A_ty a);
 
+/* The main program is the body of tigermain, at the outermost level. */
 F_fragList SEM_transProg(A_exp exp) {
   S_table venv = E_base_venv(), tenv = E_base_tenv();
   Tr_level outerLevel = Tr_outermost();
-  transExp(outerLevel, venv, tenv, exp);
+  struct expty main = transExp(outerLevel, venv, tenv, exp, NULL);
+  Tr_procEntryExit(outerLevel, main.exp, false);
   return Tr_getResult();
 }
 
-struct expty transVar(Tr_level level, S_table venv, S_table tenv, A_var v) {
+struct expty transVar(Tr_level level, S_table venv, S_table tenv, A_var v,
+                      Temp_label breakk) {
   switch (v->kind) {
   case A_simpleVar: {
     E_enventry x = S_look(venv, v->u.simple);
     if (x && x->kind == E_varEntry) {
-      Tr_access local = Tr_allocLocal(level, true);
-      Tr_exp simpleVar = Tr_simpleVar(local, level);
+      Tr_exp simpleVar = Tr_simpleVar(x->u.var.access, level);
       return expTy(simpleVar, actual_ty(x->u.var.ty));
     } else {
       EM_error(v->pos, "undefined variable %s", S_name(v->u.simple));
@@ -64,7 +81,8 @@ struct expty transVar(Tr_level level, S_table venv, S_table tenv, A_var v) {
     }
   }
   case A_fieldVar: {
-    struct expty recordType = transVar(level, venv, tenv, v->u.field.var);
+    struct expty recordType =
+        transVar(level, venv, tenv, v->u.field.var, breakk);
     if (!recordType.ty || recordType.ty->kind != Ty_record) {
       EM_error(v->pos, "variable is not a record");
       return expTy(NULL, Ty_Int());
@@ -75,8 +93,9 @@ struct expty transVar(Tr_level level, S_table venv, S_table tenv, A_var v) {
     size_t fieldNum = 0;
     while (fields) {
       if (desiredField == fields->head->name) {
-        Tr_exp fieldVar = Tr_fieldVar(recordType.exp, fieldNum);
-        return expTy(fieldVar, fields->head->ty);
+        Tr_exp fieldVar =
+            recordType.exp ? Tr_fieldVar(recordType.exp, fieldNum) : NULL;
+        return expTy(fieldVar, actual_ty(fields->head->ty));
       }
       fields = fields->tail;
       ++fieldNum;
@@ -86,30 +105,35 @@ struct expty transVar(Tr_level level, S_table venv, S_table tenv, A_var v) {
     return expTy(NULL, Ty_Int());
   }
   case A_subscriptVar: {
-    struct expty arrayType = transVar(level, venv, tenv, v->u.subscript.var);
+    struct expty arrayType =
+        transVar(level, venv, tenv, v->u.subscript.var, breakk);
     if (!arrayType.ty || arrayType.ty->kind != Ty_array) {
       EM_error(v->pos, "subscript operator used on non-array type");
       return expTy(NULL, Ty_Int());
     }
-    struct expty indexType = transExp(level, venv, tenv, v->u.subscript.exp);
+    struct expty indexType =
+        transExp(level, venv, tenv, v->u.subscript.exp, breakk);
     if (!indexType.ty || indexType.ty->kind != Ty_int) {
       EM_error(v->pos, "subscript operator used with non-integer index");
       return expTy(NULL, Ty_Int());
     }
     // Now evaluate to the array type.
-    Tr_exp subscriptExp = Tr_subscriptVar(arrayType.exp, indexType.exp);
-    return expTy(subscriptExp, arrayType.ty->u.array);
+    Tr_exp subscriptExp = arrayType.exp && indexType.exp
+                              ? Tr_subscriptVar(arrayType.exp, indexType.exp)
+                              : NULL;
+    return expTy(subscriptExp, actual_ty(arrayType.ty->u.array));
   }
   }
 }
 
-struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a) {
+struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a,
+                      Temp_label breakk) {
   switch (a->kind) {
   case A_varExp: {
-    return transVar(level, venv, tenv, a->u.var);
+    return transVar(level, venv, tenv, a->u.var, breakk);
   }
   case A_nilExp: {
-    return expTy(NULL, Ty_Nil());
+    return expTy(Tr_nilExp(), Ty_Nil());
   }
   case A_intExp: {
     return expTy(Tr_intExp(a->u.intt), Ty_Int());
@@ -123,25 +147,28 @@ struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a) {
       EM_error(a->pos, "undefined function %s", S_name(a->u.call.func));
       return expTy(NULL, Ty_Void()); // What to do here?
     }
+    Ty_ty resultType =
+        func->u.fun.result ? actual_ty(func->u.fun.result) : Ty_Void();
     // Check arguments here.
     A_expList args = a->u.call.args;
     Ty_tyList desiredTypes = func->u.fun.formals;
     Tr_expList headIR = NULL, tailIR = NULL;
+    bool complete = true;
     while (args) {
       if (!desiredTypes) {
         EM_error(a->pos, "function %s called with too many arguments",
                  S_name(a->u.call.func));
-        return expTy(NULL, Ty_Void());
+        return expTy(NULL, resultType);
       }
-      struct expty argType = transExp(level, venv, tenv, args->head);
-      Ty_ty desiredType = actual_ty(desiredTypes->head);
-      if (argType.ty != desiredType) {
+      struct expty argType = transExp(level, venv, tenv, args->head, breakk);
+      if (!assignable(desiredTypes->head, argType.ty)) {
         EM_error(a->pos, "mismatching type to function call %s",
                  S_name(a->u.call.func));
-        return expTy(NULL, Ty_Void());
+        return expTy(NULL, resultType);
       }
       args = args->tail;
       desiredTypes = desiredTypes->tail;
+      complete = complete && argType.exp;
 
       // Add to the IR expression list.
       Tr_expList newIR = Tr_ExpList(argType.exp, NULL);
@@ -154,15 +181,19 @@ struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a) {
     if (desiredTypes) {
       EM_error(a->pos, "function %s called with not enough arguments",
                S_name(a->u.call.func));
-      return expTy(NULL, Ty_Void());
+      return expTy(NULL, resultType);
     }
-    Tr_exp callExp = Tr_callExp(func->u.fun.label, headIR);
-    return expTy(callExp, func->u.fun.result ? func->u.fun.result : Ty_Void());
+    if (!complete)
+      return expTy(NULL, resultType);
+    Tr_exp callExp =
+        Tr_callExp(func->u.fun.level, level, func->u.fun.label, headIR);
+    return expTy(callExp, resultType);
   }
   case A_opExp: {
     A_oper oper = a->u.op.oper;
-    struct expty left = transExp(level, venv, tenv, a->u.op.left);
-    struct expty right = transExp(level, venv, tenv, a->u.op.right);
+    struct expty left = transExp(level, venv, tenv, a->u.op.left, breakk);
+    struct expty right = transExp(level, venv, tenv, a->u.op.right, breakk);
+    bool complete = left.exp && right.exp;
     // Arithmetic operators.
     switch (oper) {
     case A_plusOp:
@@ -173,6 +204,8 @@ struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a) {
         EM_error(a->u.op.left->pos, "integer required");
       if (right.ty->kind != Ty_int)
         EM_error(a->u.op.right->pos, "integer required");
+      if (!complete)
+        return expTy(NULL, Ty_Int());
       return expTy(Tr_binOpExp(oper, left.exp, right.exp), Ty_Int());
     case A_ltOp:
     case A_leOp:
@@ -184,16 +217,23 @@ struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a) {
         EM_error(a->u.op.right->pos, "integer required");
     case A_eqOp:
     case A_neqOp:
-      if (left.ty->kind != right.ty->kind)
+      if (!assignable(left.ty, right.ty) && !assignable(right.ty, left.ty))
         EM_error(a->u.op.left->pos, "mismatching types in eq/neq");
       Tr_exp relOpExp = NULL;
       if (left.ty->kind == Ty_int)
-        relOpExp = Tr_relOpExp(oper, left.exp, right.exp);
+        relOpExp = complete ? Tr_relOpExp(oper, left.exp, right.exp) : NULL;
       else if (left.ty->kind == Ty_string)
-        relOpExp = Tr_relOpStringExp(oper, left.exp, right.exp);
+        relOpExp =
+            complete ? Tr_relOpStringExp(oper, left.exp, right.exp) : NULL;
+      else if (left.ty->kind == Ty_record || left.ty->kind == Ty_array ||
+               left.ty->kind == Ty_nil)
+        // Records and arrays are equal only if they are the same one.
+        relOpExp = complete ? Tr_relOpExp(oper, left.exp, right.exp) : NULL;
       else
         EM_error(a->u.op.left->pos, "non integer/string type in eq/neq");
-      assert(relOpExp);
+      if (oper != A_eqOp && oper != A_neqOp &&
+          (left.ty->kind != Ty_int || right.ty->kind != Ty_int))
+        relOpExp = NULL;
       return expTy(relOpExp, Ty_Int());
     default:
       EM_error(a->pos, "unknown oper");
@@ -201,28 +241,57 @@ struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a) {
     }
   }
   case A_recordExp: {
-    Ty_ty recordType = S_look(tenv, a->u.record.typ);
+    Ty_ty recordType = actual_ty(S_look(tenv, a->u.record.typ));
     if (!recordType) {
       EM_error(a->pos, "unrecognised record type: %s", S_name(a->u.record.typ));
       return expTy(NULL, Ty_Void());
     }
-    size_t numFields = 0;
+    if (recordType->kind != Ty_record) {
+      EM_error(a->pos, "%s is not a record type", S_name(a->u.record.typ));
+      return expTy(NULL, Ty_Void());
+    }
+    // The fields are given in the order of the type.
+    Ty_fieldList fieldTypes = recordType->u.record;
     A_efieldList fields = a->u.record.fields;
-    while (fields) {
-      fields = fields->tail;
-      ++numFields;
+    Tr_expList headIR = NULL, tailIR = NULL;
+    bool complete = true;
+    for (; fields && fieldTypes;
+         fields = fields->tail, fieldTypes = fieldTypes->tail) {
+      struct expty field =
+          transExp(level, venv, tenv, fields->head->exp, breakk);
+      if (fields->head->name != fieldTypes->head->name)
+        EM_error(a->pos, "expected field %s of record type %s",
+                 S_name(fieldTypes->head->name), S_name(a->u.record.typ));
+      else if (!assignable(fieldTypes->head->ty, field.ty))
+        EM_error(a->pos, "type error in field %s",
+                 S_name(fieldTypes->head->name));
+      complete = complete && field.exp;
+      Tr_expList newIR = Tr_ExpList(field.exp, NULL);
+      if (headIR)
+        tailIR->tail = newIR;
+      else
+        headIR = newIR;
+      tailIR = newIR;
     }
-    Tr_exp recordExp = Tr_recordVar(numFields);
+    if (fields || fieldTypes) {
+      EM_error(a->pos, "wrong number of fields for record type %s",
+               S_name(a->u.record.typ));
+      return expTy(NULL, recordType);
+    }
+    Tr_exp recordExp = complete ? Tr_recordVar(headIR) : NULL;
     return expTy(recordExp, recordType);
   }
   case A_seqExp: {
     A_expList currentExp = a->u.seq;
     Ty_ty currentExpType = NULL;
     Tr_expList headIR = NULL, tailIR = NULL;
+    bool complete = true;
     while (currentExp) {
-      struct expty exp = transExp(level, venv, tenv, currentExp->head);
+      struct expty exp =
+          transExp(level, venv, tenv, currentExp->head, breakk);
       currentExpType = exp.ty;
       currentExp = currentExp->tail;
+      complete = complete && exp.exp;
 
       // Add to the IR expressions.
       Tr_expList newIR = Tr_ExpList(exp.exp, NULL);
@@ -232,88 +301,126 @@ struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a) {
         headIR = newIR;
       tailIR = newIR;
     }
-    Tr_exp seqExp = Tr_seqExp(headIR);
+    Tr_exp seqExp = complete ? Tr_seqExp(headIR) : NULL;
     return expTy(seqExp, currentExpType ? currentExpType : Ty_Void());
   }
   case A_assignExp: {
     // Check that the types match up.
-    struct expty lhs = transVar(level, venv, tenv, a->u.assign.var);
-    struct expty rhs = transExp(level, venv, tenv, a->u.assign.exp);
-    if (lhs.ty != rhs.ty)
+    struct expty lhs = transVar(level, venv, tenv, a->u.assign.var, breakk);
+    struct expty rhs = transExp(level, venv, tenv, a->u.assign.exp, breakk);
+    if (!assignable(lhs.ty, rhs.ty))
       EM_error(a->pos, "type error in assignment");
     // Assignments don't evaluate to anything.
-    Tr_exp assignExp = Tr_assignExp(lhs.exp, rhs.exp);
+    Tr_exp assignExp =
+        lhs.exp && rhs.exp ? Tr_assignExp(lhs.exp, rhs.exp) : NULL;
     return expTy(assignExp, Ty_Void());
   }
   case A_ifExp: {
-    struct expty condType = transExp(level, venv, tenv, a->u.iff.test);
+    struct expty condType = transExp(level, venv, tenv, a->u.iff.test, breakk);
     if (condType.ty->kind != Ty_int) {
       EM_error(a->pos, "if condition evaluates to non-integer value");
       return expTy(NULL, Ty_Void());
     }
-    struct expty thenType = transExp(level, venv, tenv, a->u.iff.then);
+    struct expty thenType = transExp(level, venv, tenv, a->u.iff.then, breakk);
     // If there is no else clause, then clause can't evaluate to a type.
     if (!a->u.iff.elsee) {
       if (thenType.ty->kind != Ty_void)
         EM_error(a->pos, "if expression with else block has a then block "
                          "returning non-void");
-    } else {
-      struct expty elseType = transExp(level, venv, tenv, a->u.iff.elsee);
-      if (thenType.ty != elseType.ty)
-        EM_error(a->pos, "if expression has then and else blocks that evaluate "
-                         "to different types");
-      else {
-        Tr_exp ifExp =
-            Tr_ifThenElseExp(condType.exp, thenType.exp, elseType.exp);
-        return expTy(ifExp, thenType.ty);
-      }
+      Tr_exp ifExp = condType.exp && thenType.exp
+                         ? Tr_ifThenNoElseExp(condType.exp, thenType.exp)
+                         : NULL;
+      return expTy(ifExp, Ty_Void());
+    }
+    struct expty elseType =
+        transExp(level, venv, tenv, a->u.iff.elsee, breakk);
+    if (!assignable(thenType.ty, elseType.ty) &&
+        !assignable(elseType.ty, thenType.ty)) {
+      EM_error(a->pos, "if expression has then and else blocks that evaluate "
+                       "to different types");
+      return expTy(NULL, Ty_Void());
     }
-    Tr_exp ifExp = Tr_ifThenElseExp(condType.exp, thenType.exp, NULL);
-    return expTy(ifExp, Ty_Void());
+    Tr_exp ifExp = condType.exp && thenType.exp && elseType.exp
+                       ? Tr_ifThenElseExp(condType.exp, thenType.exp,
+                                          elseType.exp)
+                       : NULL;
+    // Where one side is nil, the other tells the record type.
+    return expTy(ifExp,
+                 thenType.ty->kind == Ty_nil ? elseType.ty : thenType.ty);
   }
   case A_whileExp: {
-    struct expty condType = transExp(level, venv, tenv, a->u.whilee.test);
+    Temp_label done = Temp_newlabel();
+    struct expty condType =
+        transExp(level, venv, tenv, a->u.whilee.test, breakk);
     if (condType.ty->kind != Ty_int) {
       EM_error(a->pos, "while condition evaluates to non-integer value");
       return expTy(NULL, Ty_Int());
     }
-    struct expty bodyType = transExp(level, venv, tenv, a->u.whilee.body);
+    struct expty bodyType =
+        transExp(level, venv, tenv, a->u.whilee.body, done);
     if (bodyType.ty->kind != Ty_void)
       EM_error(a->pos, "while expression contains a non-void body expression");
-    Tr_exp whileExp = Tr_whileExp(condType.exp, bodyType.exp);
-    return expTy(whileExp, Ty_Int());
+    Tr_exp whileExp = condType.exp && bodyType.exp
+                          ? Tr_whileExp(condType.exp, bodyType.exp, done)
+                          : NULL;
+    return expTy(whileExp, Ty_Void());
   }
   case A_forExp: {
-    Tr_access local = Tr_allocLocal(level, true);
-    S_beginScope(venv);
-    S_enter(venv, a->u.forr.var, E_VarEntry(local, Ty_Int()));
-    struct expty lowType = transExp(level, venv, tenv, a->u.forr.lo);
+    // The bounds are outside the scope of the variable.
+    Temp_label done = Temp_newlabel();
+    struct expty lowType = transExp(level, venv, tenv, a->u.forr.lo, breakk);
     if (lowType.ty->kind != Ty_int)
       EM_error(a->pos, "lower bound of for expression has non-integer type");
-    struct expty highType = transExp(level, venv, tenv, a->u.forr.hi);
+    struct expty highType = transExp(level, venv, tenv, a->u.forr.hi, breakk);
     if (highType.ty->kind != Ty_int)
       EM_error(a->pos, "upper bound of for expression has non-integer type");
-    struct expty bodyType = transExp(level, venv, tenv, a->u.forr.body);
+    Tr_access local = Tr_allocLocal(level, true);
+    S_beginScope(venv);
+    S_enter(venv, a->u.forr.var, E_VarEntry(local, Ty_Int()));
+    struct expty bodyType = transExp(level, venv, tenv, a->u.forr.body, done);
     if (bodyType.ty->kind != Ty_void)
       EM_error(a->pos, "body of for expression has non-void type");
     S_endScope(venv);
-    Tr_exp forExp = Tr_forExp(lowType.exp, highType.exp, bodyType.exp);
+    if (!lowType.exp || !highType.exp || !bodyType.exp)
+      return expTy(NULL, Ty_Void());
+    Tr_exp forExp = Tr_forExp(local, level, lowType.exp, highType.exp,
+                              bodyType.exp, done);
     return expTy(forExp, Ty_Void());
   }
   case A_breakExp: {
-    // Check that we're nested within a loop here.
-    return expTy(NULL, Ty_Void());
+    if (!breakk) {
+      EM_error(a->pos, "break outside of a loop");
+      return expTy(NULL, Ty_Void());
+    }
+    return expTy(Tr_breakExp(breakk), Ty_Void());
   }
   case A_letExp: {
     A_decList d;
+    Tr_expList headIR = NULL, tailIR = NULL;
     S_beginScope(venv);
     S_beginScope(tenv);
-    for (d = a->u.let.decs; d; d = d->tail)
-      transDec(level, venv, tenv, d->head);
-    struct expty exp = transExp(level, venv, tenv, a->u.let.body);
+    for (d = a->u.let.decs; d; d = d->tail) {
+      // Variables are initialized in order, before the body.
+      Tr_exp init = transDec(level, venv, tenv, d->head, breakk);
+      if (!init)
+        continue;
+      Tr_expList newIR = Tr_ExpList(init, NULL);
+      if (headIR)
+        tailIR->tail = newIR;
+      else
+        headIR = newIR;
+      tailIR = newIR;
+    }
+    struct expty exp = transExp(level, venv, tenv, a->u.let.body, breakk);
     S_endScope(tenv);
     S_endScope(venv);
-    return expTy(NULL, exp.ty);
+    if (!exp.exp)
+      return expTy(NULL, exp.ty);
+    if (headIR)
+      tailIR->tail = Tr_ExpList(exp.exp, NULL);
+    else
+      headIR = Tr_ExpList(exp.exp, NULL);
+    return expTy(Tr_seqExp(headIR), exp.ty);
   }
   case A_arrayExp: {
     Ty_ty nameType = S_look(tenv, a->u.array.typ);
@@ -321,25 +428,30 @@ struct expty transExp(Tr_level level, S_table venv, S_table tenv, A_exp a) {
       EM_error(a->pos, "undefined array type: %s", S_name(a->u.array.typ));
       return expTy(NULL, Ty_Void());
     }
-    assert(nameType->kind == Ty_name);
     Ty_ty arrayType = actual_ty(nameType);
-    assert(arrayType->kind == Ty_array);
-    Ty_ty elemType = actual_ty(arrayType->u.array);
+    if (!arrayType || arrayType->kind != Ty_array) {
+      EM_error(a->pos, "%s is not an array type", S_name(a->u.array.typ));
+      return expTy(NULL, Ty_Void());
+    }
     // Check that initializer is the right type.
-    struct expty initType = transExp(level, venv, tenv, a->u.array.init);
-    if (initType.ty->kind != elemType->kind) {
+    struct expty initType =
+        transExp(level, venv, tenv, a->u.array.init, breakk);
+    if (!assignable(arrayType->u.array, initType.ty)) {
       EM_error(a->pos, "init type does not match array type %s",
                S_name(a->u.array.typ));
-      return expTy(NULL, nameType);
+      return expTy(NULL, arrayType);
     }
     // Check that size evaluates to an integer.
-    struct expty sizeType = transExp(level, venv, tenv, a->u.array.size);
+    struct expty sizeType =
+        transExp(level, venv, tenv, a->u.array.size, breakk);
     if (sizeType.ty->kind != Ty_int) {
       EM_error(a->pos, "array size is not an integer");
-      return expTy(NULL, nameType);
+      return expTy(NULL, arrayType);
     }
-    Tr_exp arrayExp = Tr_arrayVar(sizeType.exp, initType.exp);
-    return expTy(arrayExp, nameType);
+    Tr_exp arrayExp = sizeType.exp && initType.exp
+                          ? Tr_arrayVar(sizeType.exp, initType.exp)
+                          : NULL;
+    return expTy(arrayExp, arrayType);
   }
   }
 }
@@ -374,18 +486,23 @@ U_boolList makeFormalBoolList(A_fieldList fieldList) {
   return head;
 }
 
-void transDec(Tr_level level, S_table venv, S_table tenv, A_dec d) {
+Tr_exp transDec(Tr_level level, S_table venv, S_table tenv, A_dec d,
+                Temp_label breakk) {
   switch (d->kind) {
   case A_varDec: {
-    struct expty e = transExp(level, venv, tenv, d->u.var.init);
+    struct expty e = transExp(level, venv, tenv, d->u.var.init, breakk);
+    Ty_ty varType = e.ty;
     if (d->u.var.typ) {
       Ty_ty specifiedType = S_look(tenv, d->u.var.typ);
-      if (actual_ty(specifiedType) != actual_ty(e.ty))
+      if (!assignable(specifiedType, e.ty))
         EM_error(d->pos, "type error in variable decl");
-    }
+      else
+        varType = specifiedType;
+    } else if (e.ty->kind == Ty_nil)
+      EM_error(d->pos, "nil needs the record type of the variable");
     Tr_access local = Tr_allocLocal(level, true);
-    S_enter(venv, d->u.var.var, E_VarEntry(local, e.ty));
-    break;
+    S_enter(venv, d->u.var.var, E_VarEntry(local, varType));
+    return e.exp ? Tr_varDec(local, e.exp) : NULL;
   }
   case A_typeDec: {
     // We do two passes to handle recursive types.
@@ -440,10 +557,12 @@ void transDec(Tr_level level, S_table venv, S_table tenv, A_dec d) {
              l; l = l->tail, t = t->tail, a = a->tail)
           S_enter(venv, l->head->name, E_VarEntry(a->head, t->head));
       }
-      struct expty actualReturn = transExp(e->u.fun.level, venv, tenv, f->body);
+      // A break in the body cannot leave a loop around the declaration.
+      struct expty actualReturn =
+          transExp(e->u.fun.level, venv, tenv, f->body, NULL);
       Ty_ty expectedReturn = f->result ? S_look(tenv, f->result) : NULL;
       if (expectedReturn) {
-        if (actualReturn.ty->kind != expectedReturn->kind)
+        if (!assignable(expectedReturn, actualReturn.ty))
           EM_error(f->pos, "function %s returns wrong type", S_name(f->name));
       } else {
         if (actualReturn.ty->kind != Ty_void)
@@ -451,13 +570,14 @@ void transDec(Tr_level level, S_table venv, S_table tenv, A_dec d) {
       }
       // Construct and keep track of this proc frag.
       Tr_procEntryExit(e->u.fun.level, actualReturn.exp,
-                       Tr_formals(e->u.fun.level));
+                       expectedReturn != NULL);
       S_endScope(venv);
       funDecList = funDecList->tail;
     }
     break;
   }
   }
+  return NULL;
 }
 
 Ty_fieldList transFieldList(S_table tenv, A_pos pos, A_fieldList fieldList) {
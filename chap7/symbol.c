@@ -1,47 +1,146 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "table.h"
+#include "context.h"
 
 struct S_symbol_ {
   string name;
-  S_symbol next;
 };
 
-static S_symbol mksymbol(string name, S_symbol next) {
-  S_symbol s = checked_malloc(sizeof(*s));
-  s->name = name;
-  s->next = next;
-  return s;
-}
+/* The intern table uses open addressing with linear probing. Each slot
+ * caches the full hash and the length of its name, so a probe only touches
+ * the name itself when both match, and growing the table never rehashes a
+ * string. The names are copied into the symbol arena right behind their
+ * S_symbol. */
+typedef struct {
+  unsigned int hash;
+  int len;
+  S_symbol sym;
+} slot;
+
+#define INITIAL_CAPACITY 256 /* must be a power of two */
 
-#define SIZE 109 /* should be prime */
+/* The intern table of the current context */
+typedef struct {
+  slot *slots;
+  int capacity, count;
+  struct S_stats stats;
+} state;
 
-static S_symbol hashtable[SIZE];
+static void freeState(void *p) { free(((state *)p)->slots); }
+
+static state *current(void) {
+  return CX_state(CX_symbol, sizeof(state), NULL, freeState);
+}
 
-static unsigned int hash(char *s0) {
+static unsigned int hash(const char *s, int len) {
   unsigned int h = 0;
-  char *s;
-  for (s = s0; *s; s++)
-    h = h * 65599 + *s;
+  int i;
+  for (i = 0; i < len; i++)
+    h = h * 65599 + s[i];
+  /* Mix the high bits down, since the index only uses the low ones. */
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
   return h;
 }
 
-static int streq(string a, string b) { return !strcmp(a, b); }
-
-S_symbol S_Symbol(string name) {
-  int index = hash(name) % SIZE;
-  S_symbol syms = hashtable[index], sym;
-  for (sym = syms; sym; sym = sym->next)
-    if (streq(sym->name, name))
-      return sym;
-  sym = mksymbol(name, syms);
-  hashtable[index] = sym;
-  return sym;
+static S_symbol mksymbol(const char *name, int len) {
+  S_symbol s = AR_alloc(AR_symbol, sizeof(*s) + len + 1);
+  s->name = (string)(s + 1);
+  memcpy(s->name, name, len);
+  s->name[len] = 0;
+  return s;
+}
+
+static void grow(state *st) {
+  slot *old = st->slots;
+  int oldCapacity = st->capacity, capacity, i;
+  capacity = st->capacity = oldCapacity ? oldCapacity * 2 : INITIAL_CAPACITY;
+  st->slots = checked_malloc(capacity * sizeof(slot));
+  memset(st->slots, 0, capacity * sizeof(slot));
+  for (i = 0; i < oldCapacity; i++)
+    if (old[i].sym) {
+      unsigned int j = old[i].hash & (capacity - 1);
+      while (st->slots[j].sym)
+        j = (j + 1) & (capacity - 1);
+      st->slots[j] = old[i];
+    }
+  free(old);
+  st->stats.capacity = capacity;
+}
+
+static S_symbol intern(const char *name, int len) {
+  state *st = current();
+  unsigned int h = hash(name, len), i;
+  slot *sl;
+  if (4 * (st->count + 1) > 3 * st->capacity)
+    grow(st);
+  st->stats.lookups++;
+  for (i = h & (st->capacity - 1);; i = (i + 1) & (st->capacity - 1)) {
+    sl = &st->slots[i];
+    st->stats.probes++;
+    if (!sl->sym)
+      break;
+    if (sl->hash == h && sl->len == len && !memcmp(sl->sym->name, name, len)) {
+      st->stats.hits++;
+      return sl->sym;
+    }
+  }
+  sl->hash = h;
+  sl->len = len;
+  sl->sym = mksymbol(name, len);
+  st->stats.symbols = ++st->count;
+  return sl->sym;
 }
 
-string S_name(S_symbol sym) { return sym->name; }
+S_symbol S_Symbol(string name) { return intern(name, strlen(name)); }
+
+S_symbol S_SymbolSlice(const char *s, int len) { return intern(s, len); }
+
+struct S_stats S_stats(void) { return current()->stats; }
+
+/* A gensym carries what it needs to build its name, and builds it the first
+ * time S_name is called. Only the context that made it keeps the name: in
+ * any other, say a back-end task printing a label the front end made, the
+ * name is built afresh each time, since keeping it would mean writing into
+ * the gensym from several threads, and into the other context's arena. */
+typedef struct {
+  struct S_symbol_ sym;
+  string prefix;
+  int num;
+  CX_context owner;
+} gensym;
+
+S_symbol S_Gensym(string prefix, int num) {
+  gensym *g = AR_alloc(AR_temp, sizeof(*g));
+  g->sym.name = NULL;
+  g->prefix = prefix;
+  g->num = num;
+  g->owner = CX_current();
+  return &g->sym;
+}
+
+string S_name(S_symbol sym) {
+  gensym *g = (gensym *)sym;
+  char buf[32];
+  string name;
+  if (sym->name)
+    return sym->name;
+  sprintf(buf, "%d", g->num);
+  name = AR_alloc(AR_temp, strlen(g->prefix) + strlen(buf) + 1);
+  strcpy(name, g->prefix);
+  strcat(name, buf);
+  if (g->owner == CX_current())
+    sym->name = name;
+  return name;
+}
 
 S_table S_empty(void) { return TAB_empty(); }
 
@@ -49,16 +148,9 @@ void S_enter(S_table t, S_symbol sym, void *value) { TAB_enter(t, sym, value); }
 
 void *S_look(S_table t, S_symbol sym) { return TAB_look(t, sym); }
 
-static struct S_symbol_ marksym = {"<mark>", 0};
+void S_beginScope(S_table t) { TAB_beginScope(t); }
 
-void S_beginScope(S_table t) { S_enter(t, &marksym, NULL); }
-
-void S_endScope(S_table t) {
-  S_symbol s;
-  do
-    s = TAB_pop(t);
-  while (s != &marksym);
-}
+void S_endScope(S_table t) { TAB_endScope(t); }
 
 void S_dump(S_table t, void (*show)(S_symbol sym, void *binding)) {
   TAB_dump(t, (void (*)(void *, void *))show);
@@ -6,13 +6,38 @@
 typedef struct S_symbol_ *S_symbol;
 
 /* Make a unique symbol from a given string.
- *  Different calls to S_Symbol("foo") will yield the same S_symbol
- *  value, even if the "foo" strings are at different locations. */
+ *  Different calls to S_Symbol("foo") in the same context will yield the
+ *  same S_symbol value, even if the "foo" strings are at different
+ *  locations. Each context has its own intern table (see context.h), so
+ *  the back end's worker contexts would get other values for "foo" than
+ *  the front end. Only code in the context that parsed the program, such
+ *  as semant or VM_load looking up runtime calls, may compare a symbol it
+ *  interns with the program's; workers use the labels they are handed. */
 S_symbol S_Symbol(string);
 
+/* Like S_Symbol, for the "len" characters at "s", which need not be
+ *  followed by a null character. */
+S_symbol S_SymbolSlice(const char *s, int len);
+
+/* Make a fresh symbol named "prefix" followed by "num". It is not interned:
+ *  it differs from every other symbol, including S_Symbol of the same name,
+ *  and its name is only built when S_name is first called. Gensyms belong
+ *  to the current compilation and are released with the AR_temp arena. */
+S_symbol S_Gensym(string prefix, int num);
+
 /* Extract the underlying string from a symbol */
 string S_name(S_symbol);
 
+/* Counters describing how the symbol intern table is behaving */
+struct S_stats {
+  int symbols;  /* distinct names interned so far */
+  int capacity; /* slots in the intern table */
+  long lookups; /* calls to S_Symbol and S_SymbolSlice */
+  long hits;    /* lookups that found an existing symbol */
+  long probes;  /* slots examined over all lookups */
+};
+struct S_stats S_stats(void);
+
 /* S_table is a mapping from S_symbol->any, where "any" is represented
  *     here by void*  */
 typedef struct TAB_table_ *S_table;
@@ -1,98 +1,139 @@
 /*
  * table.c - Functions to manipulate generic tables.
  * Copyright (c) 1997 Andrew W. Appel.
+ *
+ * The bindings of a table live in one array, oldest first, which doubles as
+ * the undo log: popping a binding or closing a scope just moves the top of
+ * the array back. Each binding is also chained into a hash bucket so that
+ * lookups don't have to scan the log. Popped slots are reused by the next
+ * TAB_enter.
  */
 
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include "util.h"
+#include "arena.h"
 #include "table.h"
 
-#define TABSIZE 127
+#define INITIAL_BUCKETS 16 /* must be a power of two */
+#define INITIAL_BINDERS 16
+#define INITIAL_SCOPES 8
 
-typedef struct binder_ *binder;
-struct binder_ {
+typedef struct {
   void *key;
   void *value;
-  binder next;
-  void *prevtop;
-};
+  int next; /* index of the next older binder in the same bucket, or -1 */
+} binder;
+
 struct TAB_table_ {
-  binder table[TABSIZE];
-  void *top;
+  int *buckets; /* index of the most recent binder in each bucket, or -1 */
+  int bucketCount;
+  binder *binders; /* every binding, oldest first */
+  int top, binderCount;
+  int *scopes; /* value of top when each open scope began */
+  int scopeTop, scopeCount;
 };
 
-static binder Binder(void *key, void *value, binder next, void *prevtop) {
-  binder b = checked_malloc(sizeof(*b));
-  b->key = key;
-  b->value = value;
-  b->next = next;
-  b->prevtop = prevtop;
-  return b;
+/* Pointers are aligned and often close together, so their low bits are a
+ * poor index on their own. Mix all 64 bits down first. */
+static unsigned int hash(void *key) {
+  uint64_t k = (uintptr_t)key;
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  return (unsigned int)k;
 }
 
-TAB_table TAB_empty(void) {
-  TAB_table t = checked_malloc(sizeof(*t));
+/* Tables come and go with their arena, so a bigger array is simply a fresh
+ * allocation; the old one goes when the arena is reset. */
+static void *growArray(void *old, int used, int *count, int size) {
+  void *p;
+  *count *= 2;
+  p = AR_alloc(AR_table, *count * size);
+  memcpy(p, old, used * size);
+  return p;
+}
+
+static void rehash(TAB_table t, int bucketCount) {
   int i;
-  t->top = NULL;
-  for (i = 0; i < TABSIZE; i++)
-    t->table[i] = NULL;
-  return t;
+  t->bucketCount = bucketCount;
+  t->buckets = AR_alloc(AR_table, bucketCount * sizeof(int));
+  memset(t->buckets, -1, bucketCount * sizeof(int));
+  /* Oldest first, so every chain ends up most recent first. */
+  for (i = 0; i < t->top; i++) {
+    int index = hash(t->binders[i].key) & (bucketCount - 1);
+    t->binders[i].next = t->buckets[index];
+    t->buckets[index] = i;
+  }
 }
 
-/* The cast from pointer to integer in the expression
- *   ((unsigned)key) % TABSIZE
- * may lead to a warning message.  However, the code is safe,
- * and will still operate correctly.  This line is just hashing
- * a pointer value into an integer value, and no matter how the
- * conversion is done, as long as it is done consistently, a
- * reasonable and repeatable index into the table will result.
- */
+TAB_table TAB_empty(void) {
+  TAB_table t = AR_alloc(AR_table, sizeof(*t));
+  t->top = 0;
+  t->binderCount = INITIAL_BINDERS;
+  t->binders = AR_alloc(AR_table, INITIAL_BINDERS * sizeof(binder));
+  t->scopeTop = 0;
+  t->scopeCount = INITIAL_SCOPES;
+  t->scopes = AR_alloc(AR_table, INITIAL_SCOPES * sizeof(int));
+  rehash(t, INITIAL_BUCKETS);
+  return t;
+}
 
 void TAB_enter(TAB_table t, void *key, void *value) {
   int index;
+  binder *b;
   assert(t && key);
-  index = ((unsigned)key) % TABSIZE;
-  t->table[index] = Binder(key, value, t->table[index], t->top);
-  t->top = key;
+  if (t->top == t->binderCount)
+    t->binders =
+        growArray(t->binders, t->top, &t->binderCount, sizeof(binder));
+  if (t->top >= t->bucketCount)
+    rehash(t, t->bucketCount * 2);
+  index = hash(key) & (t->bucketCount - 1);
+  b = &t->binders[t->top];
+  b->key = key;
+  b->value = value;
+  b->next = t->buckets[index];
+  t->buckets[index] = t->top++;
 }
 
 void *TAB_look(TAB_table t, void *key) {
-  int index;
-  binder b;
+  int i;
   assert(t && key);
-  index = ((unsigned)key) % TABSIZE;
-  for (b = t->table[index]; b; b = b->next)
-    if (b->key == key)
-      return b->value;
+  for (i = t->buckets[hash(key) & (t->bucketCount - 1)]; i >= 0;
+       i = t->binders[i].next)
+    if (t->binders[i].key == key)
+      return t->binders[i].value;
   return NULL;
 }
 
 void *TAB_pop(TAB_table t) {
-  void *k;
-  binder b;
-  int index;
+  binder *b;
   assert(t);
-  k = t->top;
-  assert(k);
-  index = ((unsigned)k) % TABSIZE;
-  b = t->table[index];
-  assert(b);
-  t->table[index] = b->next;
-  t->top = b->prevtop;
+  assert(t->top > 0);
+  b = &t->binders[--t->top];
+  /* The most recent binding is at the head of its bucket. */
+  t->buckets[hash(b->key) & (t->bucketCount - 1)] = b->next;
   return b->key;
 }
 
+void TAB_beginScope(TAB_table t) {
+  assert(t);
+  if (t->scopeTop == t->scopeCount)
+    t->scopes = growArray(t->scopes, t->scopeTop, &t->scopeCount, sizeof(int));
+  t->scopes[t->scopeTop++] = t->top;
+}
+
+void TAB_endScope(TAB_table t) {
+  int mark;
+  assert(t && t->scopeTop > 0);
+  mark = t->scopes[--t->scopeTop];
+  while (t->top > mark)
+    TAB_pop(t);
+}
+
 void TAB_dump(TAB_table t, void (*show)(void *key, void *value)) {
-  void *k = t->top;
-  int index = ((unsigned)k) % TABSIZE;
-  binder b = t->table[index];
-  if (b == NULL)
-    return;
-  t->table[index] = b->next;
-  t->top = b->prevtop;
-  show(b->key, b->value);
-  TAB_dump(t, show);
-  assert(t->top == b->prevtop && t->table[index] == b->next);
-  t->top = k;
-  t->table[index] = b;
+  int i;
+  for (i = t->top - 1; i >= 0; i--)
+    show(t->binders[i].key, t->binders[i].value);
 }
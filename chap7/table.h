@@ -23,6 +23,13 @@ void *TAB_look(TAB_table t, void *key);
  * This may expose another binding for the same key, if there was one. */
 void *TAB_pop(TAB_table t);
 
+/* Start a new scope in "t".  Scopes are nested. */
+void TAB_beginScope(TAB_table t);
+
+/* Pop every binding entered since the current scope began,
+ *  and end the current scope. */
+void TAB_endScope(TAB_table t);
+
 /* Call "show" on every "key"->"value" pair in the table,
  *  including shadowed bindings, in order from the most
  *  recent binding of any key to the oldest binding in the table */
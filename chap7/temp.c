@@ -9,9 +9,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "temp.h"
-#include "table.h"
+#include "context.h"
 
 struct Temp_temp_ {
   int num;
@@ -19,50 +20,100 @@ struct Temp_temp_ {
 
 string Temp_labelstring(Temp_label s) { return S_name(s); }
 
-static int labels = 0;
+/* Temps are handed out of blocks so that they sit next to each other. */
+#define TEMP_BLOCK 256
+
+/* The numbering of the current context */
+typedef struct {
+  int labels, temps;
+  string labelPrefix;
+  Temp_temp block;
+  int blockLeft;
+  Temp_map names;
+} state;
+
+static void initState(void *p) {
+  ((state *)p)->temps = 100;
+  ((state *)p)->labelPrefix = "L";
+}
+
+static state *current(void) {
+  return CX_state(CX_temp, sizeof(state), initState, NULL);
+}
 
+/* Labels are gensyms, so a fresh label costs neither a sprintf nor a trip
+ * through the intern table until somebody asks for its name. */
 Temp_label Temp_newlabel(void) {
-  char buf[100];
-  sprintf(buf, "L%d", labels++);
-  return Temp_namedlabel(String(buf));
+  state *st = current();
+  return S_Gensym(st->labelPrefix, st->labels++);
 }
 
+int Temp_labelCount(void) { return current()->labels; }
+
 /* The label will be created only if it is not found. */
 Temp_label Temp_namedlabel(string s) { return S_Symbol(s); }
 
-static int temps = 100;
-
 Temp_temp Temp_newtemp(void) {
-  Temp_temp p = (Temp_temp)checked_malloc(sizeof(*p));
-  p->num = temps++;
-  {
-    char r[16];
-    sprintf(r, "%d", p->num);
-    Temp_enter(Temp_name(), p, String(r));
+  state *st = current();
+  Temp_temp p;
+  if (!st->blockLeft) {
+    st->block = AR_alloc(AR_temp, TEMP_BLOCK * sizeof(*st->block));
+    st->blockLeft = TEMP_BLOCK;
   }
+  p = st->block++;
+  --st->blockLeft;
+  p->num = st->temps++;
   return p;
 }
 
+int Temp_num(Temp_temp t) { return t->num; }
+
+int Temp_count(void) { return current()->temps; }
+
+/* A map is an array of strings indexed by temp number. Layered maps share
+ * the arrays of the maps they were made from. */
+typedef struct {
+  string *names;
+  int size;
+} * nameTable;
+
 struct Temp_map_ {
-  TAB_table tab;
+  nameTable tab;
   Temp_map under;
 };
 
 Temp_map Temp_name(void) {
-  static Temp_map m = NULL;
-  if (!m)
-    m = Temp_empty();
-  return m;
+  state *st = current();
+  if (!st->names)
+    st->names = Temp_empty();
+  return st->names;
+}
+
+void Temp_reset(void) { Temp_renumber(100, "L"); }
+
+void Temp_renumber(int firstTemp, string labelPrefix) {
+  state *st = current();
+  st->names = NULL;
+  st->temps = firstTemp;
+  st->labels = 0;
+  st->labelPrefix = labelPrefix;
+  st->block = NULL;
+  st->blockLeft = 0;
 }
 
-Temp_map newMap(TAB_table tab, Temp_map under) {
-  Temp_map m = checked_malloc(sizeof(*m));
+static Temp_map newMap(nameTable tab, Temp_map under) {
+  Temp_map m = AR_alloc(AR_temp, sizeof(*m));
   m->tab = tab;
   m->under = under;
   return m;
 }
 
-Temp_map Temp_empty(void) { return newMap(TAB_empty(), NULL); }
+Temp_map Temp_empty(void) {
+  nameTable tab = AR_alloc(AR_temp, sizeof(*tab));
+  tab->names = NULL;
+  tab->size = 0;
+  return newMap(tab, NULL);
+}
 
 Temp_map Temp_layerMap(Temp_map over, Temp_map under) {
   if (over == NULL)
@@ -72,16 +123,47 @@ Temp_map Temp_layerMap(Temp_map over, Temp_map under) {
 }
 
 void Temp_enter(Temp_map m, Temp_temp t, string s) {
+  nameTable tab;
   assert(m && m->tab);
-  TAB_enter(m->tab, t, s);
+  tab = m->tab;
+  if (t->num >= tab->size) {
+    int size = tab->size ? tab->size : 128;
+    string *grown;
+    while (size <= t->num)
+      size *= 2;
+    grown = AR_alloc(AR_temp, size * sizeof(string));
+    memset(grown, 0, size * sizeof(string));
+    if (tab->names)
+      memcpy(grown, tab->names, tab->size * sizeof(string));
+    tab->names = grown;
+    tab->size = size;
+  }
+  tab->names[t->num] = s;
 }
 
-string Temp_look(Temp_map m, Temp_temp t) {
+/* Temp_name() names temps after their number, but only builds the string
+ * for a temp the first time somebody looks it up. */
+static string tempName(Temp_temp t) {
+  char r[16];
   string s;
+  sprintf(r, "%d", t->num);
+  s = AR_alloc(AR_temp, strlen(r) + 1);
+  strcpy(s, r);
+  Temp_enter(current()->names, t, s);
+  return s;
+}
+
+string Temp_look(Temp_map m, Temp_temp t) {
+  string s = NULL;
+  Temp_map names;
   assert(m && m->tab);
-  s = TAB_look(m->tab, t);
+  if (t->num < m->tab->size)
+    s = m->tab->names[t->num];
   if (s)
     return s;
+  names = current()->names;
+  if (names && m->tab == names->tab)
+    return tempName(t);
   else if (m->under)
     return Temp_look(m->under, t);
   else
@@ -89,27 +171,24 @@ string Temp_look(Temp_map m, Temp_temp t) {
 }
 
 Temp_tempList Temp_TempList(Temp_temp h, Temp_tempList t) {
-  Temp_tempList p = (Temp_tempList)checked_malloc(sizeof(*p));
+  Temp_tempList p = (Temp_tempList)AR_alloc(AR_temp, sizeof(*p));
   p->head = h;
   p->tail = t;
   return p;
 }
 
 Temp_labelList Temp_LabelList(Temp_label h, Temp_labelList t) {
-  Temp_labelList p = (Temp_labelList)checked_malloc(sizeof(*p));
+  Temp_labelList p = (Temp_labelList)AR_alloc(AR_temp, sizeof(*p));
   p->head = h;
   p->tail = t;
   return p;
 }
 
-static FILE *outfile;
-void showit(Temp_temp t, string r) {
-  fprintf(outfile, "t%d -> %s\n", t->num, r);
-}
-
 void Temp_dumpMap(FILE *out, Temp_map m) {
-  outfile = out;
-  TAB_dump(m->tab, (void (*)(void *, void *))showit);
+  int i;
+  for (i = 0; i < m->tab->size; i++)
+    if (m->tab->names[i])
+      fprintf(out, "t%d -> %s\n", i, m->tab->names[i]);
   if (m->under) {
     fprintf(out, "---------\n");
     Temp_dumpMap(out, m->under);
@@ -6,6 +6,11 @@
 typedef struct Temp_temp_ *Temp_temp;
 Temp_temp Temp_newtemp(void);
 
+/* Temps are numbered densely, so their numbers can index arrays and bit
+ *  vectors. Every temp made so far has a number below Temp_count(). */
+int Temp_num(Temp_temp t);
+int Temp_count(void);
+
 typedef struct Temp_tempList_ *Temp_tempList;
 struct Temp_tempList_ {
   Temp_temp head;
@@ -17,6 +22,8 @@ typedef S_symbol Temp_label;
 Temp_label Temp_newlabel(void);
 Temp_label Temp_namedlabel(string name);
 string Temp_labelstring(Temp_label s);
+/* The number of labels Temp_newlabel has made since numbering started */
+int Temp_labelCount(void);
 
 typedef struct Temp_labelList_ *Temp_labelList;
 struct Temp_labelList_ {
@@ -33,3 +40,14 @@ string Temp_look(Temp_map m, Temp_temp t);
 void Temp_dumpMap(FILE *out, Temp_map m);
 
 Temp_map Temp_name(void);
+
+/* Forget the temps and labels made by the previous compilation, so that
+ * numbering starts over. */
+void Temp_reset(void);
+
+/* Start numbering over in the current context: temps from "firstTemp" on,
+ * and labels named "labelPrefix" followed by a number counting from 0.
+ * The back end of each function starts out this way, so that what it makes
+ * depends on that function alone, whatever thread it runs on. The prefix
+ * must outlive the labels. */
+void Temp_renumber(int firstTemp, string labelPrefix);
@@ -1,11 +1,13 @@
 #include <stdio.h>
 
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "absyn.h"
 #include "temp.h"
 #include "tree.h"
 #include "frame.h"
+#include "context.h"
 
 #include "translate.h"
 
@@ -22,21 +24,21 @@ struct Tr_level_ {
 };
 
 Tr_access Tr_Access(Tr_level level, F_access fAccess) {
-  Tr_access access = checked_malloc(sizeof(struct Tr_access_));
+  Tr_access access = AR_alloc(AR_translate, sizeof(struct Tr_access_));
   access->level = level;
   access->access = fAccess;
   return access;
 }
 
 Tr_accessList Tr_AccessList(Tr_access head, Tr_accessList tail) {
-  Tr_accessList list = checked_malloc(sizeof(struct Tr_accessList_));
+  Tr_accessList list = AR_alloc(AR_translate, sizeof(struct Tr_accessList_));
   list->head = head;
   list->tail = tail;
   return list;
 }
 
 Tr_expList Tr_ExpList(Tr_exp head, Tr_expList tail) {
-  Tr_expList list = checked_malloc(sizeof(*list));
+  Tr_expList list = AR_alloc(AR_translate, sizeof(*list));
   list->head = head;
   list->tail = tail;
   return list;
@@ -44,7 +46,7 @@ Tr_expList Tr_ExpList(Tr_exp head, Tr_expList tail) {
 
 Tr_level Tr_Level(Tr_level parent, Temp_label name, F_frame frame,
                   Tr_accessList formals) {
-  Tr_level level = checked_malloc(sizeof(struct Tr_level_));
+  Tr_level level = AR_alloc(AR_translate, sizeof(struct Tr_level_));
   level->parent = parent;
   level->name = name;
   level->frame = frame;
@@ -52,12 +54,21 @@ Tr_level Tr_Level(Tr_level parent, Temp_label name, F_frame frame,
   return level;
 }
 
-static Tr_level outerLevel = NULL;
+/* The outermost level and the fragments of the current context */
+typedef struct {
+  Tr_level outerLevel;
+  F_fragList frags;
+} state;
+
+static state *current(void) {
+  return CX_state(CX_translate, sizeof(state), NULL, NULL);
+}
 
 Tr_level Tr_outermost(void) {
-  if (!outerLevel)
-    outerLevel = Tr_newLevel(NULL, Temp_newlabel(), NULL);
-  return outerLevel;
+  state *st = current();
+  if (!st->outerLevel)
+    st->outerLevel = Tr_newLevel(NULL, Temp_namedlabel("tigermain"), NULL);
+  return st->outerLevel;
 }
 
 static Tr_accessList makeAccessList(F_accessList fAccessList, Tr_level level) {
@@ -75,10 +86,12 @@ static Tr_accessList makeAccessList(F_accessList fAccessList, Tr_level level) {
   return head;
 }
 
+/* The static link is passed as an extra first formal, which escapes, since
+ * the functions nested inside follow it through memory. */
 Tr_level Tr_newLevel(Tr_level parent, Temp_label name, U_boolList formals) {
-  F_frame frame = F_newFrame(name, formals);
+  F_frame frame = F_newFrame(name, U_BoolList(TRUE, formals));
   Tr_level newLevel = Tr_Level(parent, name, frame, NULL);
-  newLevel->formals = makeAccessList(F_formals(frame), newLevel);
+  newLevel->formals = makeAccessList(F_formals(frame)->tail, newLevel);
   return newLevel;
 }
 
@@ -95,7 +108,7 @@ struct patchList_ {
   patchList tail;
 };
 static patchList PatchList(Temp_label *head, patchList tail) {
-  patchList patch = checked_malloc(sizeof(*patch));
+  patchList patch = AR_alloc(AR_translate, sizeof(*patch));
   patch->head = head;
   patch->tail = tail;
   return patch;
@@ -135,21 +148,21 @@ struct Tr_exp_ {
 };
 
 static Tr_exp Tr_Ex(T_exp ex) {
-  Tr_exp newEx = checked_malloc(sizeof(*newEx));
+  Tr_exp newEx = AR_alloc(AR_translate, sizeof(*newEx));
   newEx->kind = Tr_ex;
   newEx->u.ex = ex;
   return newEx;
 }
 
 static Tr_exp Tr_Nx(T_stm nx) {
-  Tr_exp newNx = checked_malloc(sizeof(*newNx));
+  Tr_exp newNx = AR_alloc(AR_translate, sizeof(*newNx));
   newNx->kind = Tr_nx;
   newNx->u.nx = nx;
   return newNx;
 }
 
 static Tr_exp Tr_Cx(patchList trues, patchList falses, T_stm stm) {
-  Tr_exp newCx = checked_malloc(sizeof(*newCx));
+  Tr_exp newCx = AR_alloc(AR_translate, sizeof(*newCx));
   newCx->kind = Tr_cx;
   newCx->u.cx.trues = trues;
   newCx->u.cx.falses = falses;
@@ -205,9 +218,9 @@ static struct Cx unCx(Tr_exp e) {
   switch (e->kind) {
   case Tr_ex: {
     struct Cx cx;
-    cx.stm = T_Cjump(T_eq, e->u.ex, T_Const(0), NULL, NULL);
-    cx.trues = PatchList(&cx.stm->u.CJUMP.false, NULL);
-    cx.falses = PatchList(&cx.stm->u.CJUMP.true, NULL);
+    cx.stm = T_Cjump(T_ne, e->u.ex, T_Const(0), NULL, NULL);
+    cx.trues = PatchList(&cx.stm->u.CJUMP.true, NULL);
+    cx.falses = PatchList(&cx.stm->u.CJUMP.false, NULL);
     return cx;
   }
   case Tr_nx: {
@@ -221,15 +234,20 @@ static struct Cx unCx(Tr_exp e) {
   assert(0);
 }
 
-Tr_exp Tr_simpleVar(Tr_access access, Tr_level level) {
-  // Travel up each level and find the one that this access belongs to.
+/* The frame pointer of "target" as code at "level" sees it: the static
+ * links are followed up from there, one level at a time. */
+static T_exp framePointer(Tr_level target, Tr_level level) {
   T_exp addr = T_Temp(F_FP());
-  while (level != access->level) {
+  while (level != target) {
     F_access staticLink = F_formals(level->frame)->head;
     addr = F_Exp(staticLink, addr);
     level = level->parent;
   }
-  return Tr_Ex(F_Exp(access->access, addr));
+  return addr;
+}
+
+Tr_exp Tr_simpleVar(Tr_access access, Tr_level level) {
+  return Tr_Ex(F_Exp(access->access, framePointer(access->level, level)));
 }
 
 Tr_exp Tr_fieldVar(Tr_exp record, size_t fieldNum) {
@@ -251,20 +269,35 @@ Tr_exp Tr_arrayVar(Tr_exp sizeExp, Tr_exp initExp) {
   return Tr_Ex(F_externalCall("initArray", args));
 }
 
-Tr_exp Tr_recordVar(size_t numFields) {
-  T_expList args = T_ExpList(T_Const(numFields * F_wordSize), NULL);
-  return Tr_Ex(F_externalCall("initRecord", args));
-}
+/* The record is allocated into a temp, then its fields are stored in
+ * order. */
+Tr_exp Tr_recordVar(Tr_expList fields) {
+  Temp_temp r = Temp_newtemp();
+  Tr_expList f;
+  T_stm init;
+  int numFields = 0;
+  for (f = fields; f; f = f->tail)
+    numFields++;
+  init = T_Move(T_Temp(r),
+                F_externalCall("allocRecord",
+                               T_ExpList(T_Const(numFields * F_wordSize),
+                                         NULL)));
+  for (f = fields, numFields = 0; f; f = f->tail, numFields++)
+    init = T_Seq(init, T_Move(T_Mem(T_Binop(T_plus, T_Temp(r),
+                                            T_Const(numFields * F_wordSize))),
+                              unEx(f->head)));
+  return Tr_Ex(T_Eseq(init, T_Temp(r)));
+}
+
+Tr_exp Tr_nilExp(void) { return Tr_Ex(T_Const(0)); }
 
 Tr_exp Tr_intExp(int val) { return Tr_Ex(T_Const(val)); }
 
-// Global fragments list.
-static F_fragList frags = NULL;
-
 static void Tr_pushFrag(F_frag frag) {
+  state *st = current();
   // Put at the head of the list.
-  F_fragList newEntry = F_FragList(frag, frags);
-  frags = newEntry;
+  F_fragList newEntry = F_FragList(frag, st->frags);
+  st->frags = newEntry;
 }
 
 Tr_exp Tr_stringExp(string val) {
@@ -274,8 +307,11 @@ Tr_exp Tr_stringExp(string val) {
   return Tr_Ex(T_Name(stringLabel));
 }
 
-Tr_exp Tr_callExp(Temp_label functionLabel, Tr_expList args) {
-  // TODO: Pass in the static link?
+/* A function of the program gets the frame of the level it was declared
+ * in as its static link; one of the library, which has no level, gets
+ * nothing. */
+Tr_exp Tr_callExp(Tr_level callee, Tr_level caller, Temp_label functionLabel,
+                  Tr_expList args) {
   T_expList convertedHead = NULL, convertedTail = NULL;
   while (args) {
     T_expList convertedArg = T_ExpList(unEx(args->head), NULL);
@@ -283,9 +319,14 @@ Tr_exp Tr_callExp(Temp_label functionLabel, Tr_expList args) {
       convertedTail->tail = convertedArg;
     else
       convertedHead = convertedArg;
+    convertedTail = convertedArg;
     args = args->tail;
   }
-  return Tr_Ex(T_Call(T_Name(functionLabel), convertedHead));
+  if (!callee)
+    return Tr_Ex(F_externalCall(S_name(functionLabel), convertedHead));
+  return Tr_Ex(T_Call(T_Name(functionLabel),
+                      T_ExpList(framePointer(callee->parent, caller),
+                                convertedHead)));
 }
 
 Tr_exp Tr_binOpExp(A_oper op, Tr_exp left, Tr_exp right) {
@@ -336,41 +377,45 @@ Tr_exp Tr_relOpExp(A_oper op, Tr_exp left, Tr_exp right) {
     return NULL;
   }
   T_stm cond = T_Cjump(relOp, unEx(left), unEx(right), NULL, NULL);
-  patchList trues = PatchList(&cond->u.CJUMP.false, NULL);
-  patchList falses = PatchList(&cond->u.CJUMP.true, NULL);
+  patchList trues = PatchList(&cond->u.CJUMP.true, NULL);
+  patchList falses = PatchList(&cond->u.CJUMP.false, NULL);
   return Tr_Cx(trues, falses, cond);
 }
 
 Tr_exp Tr_relOpStringExp(A_oper oper, Tr_exp left, Tr_exp right) {
-  assert(oper == T_eq || oper == T_ne);
+  assert(oper == A_eqOp || oper == A_neqOp);
   T_expList args = T_ExpList(unEx(left), T_ExpList(unEx(right), NULL));
   T_exp equals = F_externalCall("stringEqual", args);
-  if (oper == T_eq)
+  if (oper == A_eqOp)
     return Tr_Ex(equals);
   else {
     // If we're checking that it's NOT equal, we'll need to negate the result.
-    assert(oper == T_ne);
     return Tr_Ex(T_Binop(T_minus, T_Const(1), equals));
   }
 }
 
 Tr_exp Tr_seqExp(Tr_expList expList) {
-  T_exp convertedHead = NULL, convertedTail = NULL;
-  while (expList) {
-    T_exp convertedNode = T_Eseq(unNx(expList->head), NULL);
-    expList = expList->tail;
-    if (convertedHead)
-      convertedTail->u.ESEQ.exp = convertedNode;
-    else
-      convertedHead = convertedNode;
-    convertedTail = convertedNode;
+  // Each expression is evaluated for its effect but the last, for its value.
+  T_stm effects = NULL;
+  if (!expList)
+    return Tr_Ex(T_Const(0));
+  for (; expList->tail; expList = expList->tail) {
+    T_stm effect = unNx(expList->head);
+    effects = effects ? T_Seq(effects, effect) : effect;
   }
-  return Tr_Ex(convertedHead);
+  if (!effects)
+    return expList->head;
+  return Tr_Ex(T_Eseq(effects, unEx(expList->head)));
+}
+
+Tr_exp Tr_varDec(Tr_access access, Tr_exp init) {
+  T_exp var = F_Exp(access->access, T_Temp(F_FP()));
+  return Tr_Nx(T_Move(var, unEx(init)));
 }
 
 Tr_exp Tr_assignExp(Tr_exp left, Tr_exp right) {
-  T_exp assignMem = T_Mem(unEx(left));
-  return Tr_Nx(T_Move(assignMem, unEx(right)));
+  // The left side is already the MEM (or TEMP) of the variable.
+  return Tr_Nx(T_Move(unEx(left), unEx(right)));
 }
 
 Tr_exp Tr_ifThenExp(Tr_exp condExp, Tr_exp thenExp, Tr_exp elseExp) {
@@ -393,69 +438,96 @@ Tr_exp Tr_ifThenElseExp(Tr_exp condExp, Tr_exp thenExp, Tr_exp elseExp) {
                                             Temp_LabelList(joinLabel, NULL)),
                                      T_Seq(T_Label(falseLabel),
                                            T_Seq(T_Move(T_Temp(r), e),
-                                                 T_Seq(T_Label(joinLabel),
-                                                       T_Exp(T_Temp(r)))))))));
+                                                 T_Label(joinLabel)))))));
   doPatch(c.trues, trueLabel);
   doPatch(c.falses, falseLabel);
-  return Tr_Nx(seq);
+  return Tr_Ex(T_Eseq(seq, T_Temp(r)));
 }
 
 Tr_exp Tr_ifThenNoElseExp(Tr_exp condExp, Tr_exp thenExp) {
   struct Cx c = unCx(condExp);
-  T_exp t = unEx(thenExp);
+  T_stm t = unNx(thenExp);
   Temp_label trueLabel = Temp_newlabel(), falseLabel = Temp_newlabel();
-  T_stm seq =
-      T_Seq(c.stm, T_Seq(T_Label(trueLabel),
-                         T_Seq(T_Exp(t), T_Seq(T_Label(falseLabel), NULL))));
+  T_stm seq = T_Seq(c.stm, T_Seq(T_Label(trueLabel),
+                                 T_Seq(t, T_Label(falseLabel))));
   doPatch(c.trues, trueLabel);
   doPatch(c.falses, falseLabel);
   return Tr_Nx(seq);
 }
 
-Tr_exp Tr_whileExp(Tr_exp condExp, Tr_exp bodyExp) {
+Tr_exp Tr_whileExp(Tr_exp condExp, Tr_exp bodyExp, Temp_label done) {
   struct Cx c = unCx(condExp);
-  T_exp b = unEx(bodyExp);
-  Temp_label condLabel = Temp_newlabel(), trueLabel = Temp_newlabel(),
-             falseLabel = Temp_newlabel();
+  T_stm b = unNx(bodyExp);
+  Temp_label condLabel = Temp_newlabel(), trueLabel = Temp_newlabel();
   T_stm seq = T_Seq(
       T_Label(condLabel),
       T_Seq(c.stm,
             T_Seq(T_Label(trueLabel),
-                  T_Seq(T_Exp(b), T_Seq(T_Jump(T_Name(condLabel),
-                                               Temp_LabelList(condLabel, NULL)),
-                                        T_Seq(T_Label(falseLabel), NULL))))));
+                  T_Seq(b, T_Seq(T_Jump(T_Name(condLabel),
+                                        Temp_LabelList(condLabel, NULL)),
+                                 T_Label(done))))));
   doPatch(c.trues, trueLabel);
-  doPatch(c.falses, falseLabel);
+  doPatch(c.falses, done);
   return Tr_Nx(seq);
 }
 
-Tr_exp Tr_forExp(Tr_exp lowExp, Tr_exp highExp, Tr_exp bodyExp) {
-  Temp_temp counter = Temp_newtemp();
-  T_exp low = unEx(lowExp), high = unEx(highExp), body = unEx(bodyExp);
-  Temp_label trueLabel = Temp_newlabel(), falseLabel = Temp_newlabel();
-
-  // Put together the cond.
-  T_stm condStm = T_Cjump(T_lt, T_Temp(counter), high, NULL, NULL);
-  patchList trues = PatchList(&condStm->u.CJUMP.false, NULL);
-  patchList falses = PatchList(&condStm->u.CJUMP.true, NULL);
-  struct Cx c = unCx(Tr_Cx(trues, falses, condStm));
-
-  // Put together the loop.
-  T_stm seq =
-      T_Seq(T_Move(T_Temp(counter), low),
-            T_Seq(condStm, T_Seq(T_Label(trueLabel),
-                                 T_Seq(T_Exp(body), T_Label(falseLabel)))));
-
-  // Patch up the cond labels.
-  doPatch(trues, trueLabel);
-  doPatch(falses, falseLabel);
+/* The bounds are evaluated once. The variable is tested against the limit
+ * before it is incremented, not after, so that a limit of the largest
+ * integer does not overflow it:
+ *
+ *   i := lo; limit := hi; if i <= limit goto body else done
+ *   body: ...; if i < limit goto next else done
+ *   next: i := i + 1; goto body
+ *   done:
+ */
+Tr_exp Tr_forExp(Tr_access var, Tr_level level, Tr_exp lowExp,
+                 Tr_exp highExp, Tr_exp bodyExp, Temp_label done) {
+  Temp_temp limit = Temp_newtemp();
+  Temp_label bodyLabel = Temp_newlabel(), nextLabel = Temp_newlabel();
+  T_stm start = T_Seq(T_Move(unEx(Tr_simpleVar(var, level)), unEx(lowExp)),
+                      T_Move(T_Temp(limit), unEx(highExp)));
+  T_stm enter = T_Cjump(T_le, unEx(Tr_simpleVar(var, level)), T_Temp(limit),
+                        bodyLabel, done);
+  T_stm again = T_Cjump(T_lt, unEx(Tr_simpleVar(var, level)), T_Temp(limit),
+                        nextLabel, done);
+  T_stm increment =
+      T_Move(unEx(Tr_simpleVar(var, level)),
+             T_Binop(T_plus, unEx(Tr_simpleVar(var, level)), T_Const(1)));
+  T_stm loop = T_Jump(T_Name(bodyLabel), Temp_LabelList(bodyLabel, NULL));
+  T_stm seq = T_Seq(
+      start,
+      T_Seq(enter,
+            T_Seq(T_Label(bodyLabel),
+                  T_Seq(unNx(bodyExp),
+                        T_Seq(again, T_Seq(T_Label(nextLabel),
+                                           T_Seq(increment,
+                                                 T_Seq(loop,
+                                                       T_Label(done)))))))));
   return Tr_Nx(seq);
 }
 
-void Tr_procEntryExit(Tr_level level, Tr_exp body, Tr_accessList formals) {
-  T_stm stm = unNx(body);
+Tr_exp Tr_breakExp(Temp_label done) {
+  return Tr_Nx(T_Jump(T_Name(done), Temp_LabelList(done, NULL)));
+}
+
+/* The body of a function that returns a value leaves it in the return
+ * value register. */
+void Tr_procEntryExit(Tr_level level, Tr_exp body, bool returnsValue) {
+  T_stm stm;
   F_frame f = level->frame;
-  Tr_pushFrag(F_ProcFrag(stm, f));
+  if (!body)
+    stm = T_Exp(T_Const(0)); /* there were errors */
+  else if (returnsValue)
+    stm = T_Move(T_Temp(F_RV()), unEx(body));
+  else
+    stm = unNx(body);
+  Tr_pushFrag(F_ProcFrag(F_procEntryExit1(f, stm), f));
 }
 
-F_fragList Tr_getResult(void) { return frags; }
+F_fragList Tr_getResult(void) { return current()->frags; }
+
+void Tr_reset(void) {
+  state *st = current();
+  st->outerLevel = NULL;
+  st->frags = NULL;
+}
@@ -26,20 +26,31 @@ Tr_exp Tr_simpleVar(Tr_access, Tr_level);
 Tr_exp Tr_fieldVar(Tr_exp, size_t);
 Tr_exp Tr_subscriptVar(Tr_exp, Tr_exp);
 Tr_exp Tr_arrayVar(Tr_exp, Tr_exp);
-Tr_exp Tr_recordVar(size_t);
+/* A new record holding the values of its fields, in order */
+Tr_exp Tr_recordVar(Tr_expList);
+Tr_exp Tr_nilExp(void);
 Tr_exp Tr_intExp(int);
 Tr_exp Tr_stringExp(string);
-Tr_exp Tr_callExp(Temp_label, Tr_expList);
+/* A call, from "caller", of the function at level "callee", or of the
+ * library function named by the label if "callee" is NULL */
+Tr_exp Tr_callExp(Tr_level callee, Tr_level caller, Temp_label, Tr_expList);
 Tr_exp Tr_binOpExp(A_oper, Tr_exp, Tr_exp);
 Tr_exp Tr_relOpExp(A_oper, Tr_exp, Tr_exp);
 Tr_exp Tr_relOpStringExp(A_oper, Tr_exp, Tr_exp);
 Tr_exp Tr_seqExp(Tr_expList);
+Tr_exp Tr_varDec(Tr_access, Tr_exp);
 Tr_exp Tr_assignExp(Tr_exp, Tr_exp);
 Tr_exp Tr_ifThenExp(Tr_exp, Tr_exp, Tr_exp);
 Tr_exp Tr_ifThenElseExp(Tr_exp, Tr_exp, Tr_exp);
 Tr_exp Tr_ifThenNoElseExp(Tr_exp, Tr_exp);
-Tr_exp Tr_whileExp(Tr_exp, Tr_exp);
-Tr_exp Tr_forExp(Tr_exp, Tr_exp, Tr_exp);
+/* A break in the body of a loop jumps to "done", which ends it. */
+Tr_exp Tr_whileExp(Tr_exp, Tr_exp, Temp_label done);
+Tr_exp Tr_forExp(Tr_access var, Tr_level, Tr_exp, Tr_exp, Tr_exp,
+                 Temp_label done);
+Tr_exp Tr_breakExp(Temp_label done);
 
-void Tr_procEntryExit(Tr_level level, Tr_exp body, Tr_accessList formals);
+void Tr_procEntryExit(Tr_level level, Tr_exp body, bool returnsValue);
 F_fragList Tr_getResult(void);
+
+/* Forget the levels and fragments of the previous compilation. */
+void Tr_reset(void);
@@ -7,6 +7,7 @@
 
 #include <stdio.h>
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "types.h"
 
@@ -23,21 +24,21 @@ static struct Ty_ty_ tyvoid = {Ty_void};
 Ty_ty Ty_Void(void) { return &tyvoid; }
 
 Ty_ty Ty_Record(Ty_fieldList fields) {
-  Ty_ty p = checked_malloc(sizeof(*p));
+  Ty_ty p = AR_alloc(AR_types, sizeof(*p));
   p->kind = Ty_record;
   p->u.record = fields;
   return p;
 }
 
 Ty_ty Ty_Array(Ty_ty ty) {
-  Ty_ty p = checked_malloc(sizeof(*p));
+  Ty_ty p = AR_alloc(AR_types, sizeof(*p));
   p->kind = Ty_array;
   p->u.array = ty;
   return p;
 }
 
 Ty_ty Ty_Name(S_symbol sym, Ty_ty ty) {
-  Ty_ty p = checked_malloc(sizeof(*p));
+  Ty_ty p = AR_alloc(AR_types, sizeof(*p));
   p->kind = Ty_name;
   p->u.name.sym = sym;
   p->u.name.ty = ty;
@@ -45,21 +46,21 @@ Ty_ty Ty_Name(S_symbol sym, Ty_ty ty) {
 }
 
 Ty_tyList Ty_TyList(Ty_ty head, Ty_tyList tail) {
-  Ty_tyList p = checked_malloc(sizeof(*p));
+  Ty_tyList p = AR_alloc(AR_types, sizeof(*p));
   p->head = head;
   p->tail = tail;
   return p;
 }
 
 Ty_field Ty_Field(S_symbol name, Ty_ty ty) {
-  Ty_field p = checked_malloc(sizeof(*p));
+  Ty_field p = AR_alloc(AR_types, sizeof(*p));
   p->name = name;
   p->ty = ty;
   return p;
 }
 
 Ty_fieldList Ty_FieldList(Ty_field head, Ty_fieldList tail) {
-  Ty_fieldList p = checked_malloc(sizeof(*p));
+  Ty_fieldList p = AR_alloc(AR_types, sizeof(*p));
   p->head = head;
   p->tail = tail;
   return p;
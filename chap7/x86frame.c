@@ -1,9 +1,11 @@
 #include <stdio.h>
 
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "temp.h"
 #include "tree.h"
+#include "context.h"
 
 #include "frame.h"
 
@@ -18,14 +20,14 @@ struct F_access_ {
 const int F_wordSize = 4;
 
 static F_access InFrame(int offset) {
-  F_access a = checked_malloc(sizeof(struct F_access_));
+  F_access a = AR_alloc(AR_frame, sizeof(struct F_access_));
   a->kind = inFrame;
   a->u.offset = offset;
   return a;
 }
 
 static F_access InReg(Temp_temp reg) {
-  F_access a = checked_malloc(sizeof(struct F_access_));
+  F_access a = AR_alloc(AR_frame, sizeof(struct F_access_));
   a->kind = inReg;
   a->u.reg = reg;
   return a;
@@ -38,15 +40,18 @@ struct F_frame_ {
 };
 
 static F_accessList F_AccessList(F_access head, F_accessList tail) {
-  F_accessList list = checked_malloc(sizeof(struct F_accessList_));
+  F_accessList list = AR_alloc(AR_frame, sizeof(struct F_accessList_));
   list->head = head;
   list->tail = tail;
   return list;
 }
 
+/* The caller pushes the arguments, then the call pushes the return address,
+ * and the callee the frame pointer it saves; so the formals are above the
+ * frame pointer, from 8 up, and the locals below it. */
 static F_accessList makeAccessList(U_boolList list) {
   F_accessList head = NULL, tail = NULL;
-  int formalOffset = -1; // Zero address is reserved for return value.
+  int formalOffset = 2;
   while (list) {
     F_access current = NULL;
     if (list->head)
@@ -61,13 +66,13 @@ static F_accessList makeAccessList(U_boolList list) {
       tail->tail = newTail;
     tail = newTail;
     list = list->tail;
-    --formalOffset;
+    ++formalOffset;
   }
   return head;
 }
 
 F_frame F_newFrame(Temp_label name, U_boolList formals) {
-  F_frame frame = checked_malloc(sizeof(struct F_frame_));
+  F_frame frame = AR_alloc(AR_frame, sizeof(struct F_frame_));
   frame->name = name;
   frame->formals = makeAccessList(formals);
   frame->localCount = 0;
@@ -88,15 +93,86 @@ F_access F_allocLocal(F_frame f, bool escape) {
   return local;
 }
 
-static Temp_temp fp = NULL;
-Temp_temp F_FP(void) {
-  if (!fp)
-    fp = Temp_newtemp();
-  return fp;
+F_frame F_copyFrame(F_frame f, Temp_label name, F_renamer rename,
+                    void *closure) {
+  F_frame frame = AR_alloc(AR_frame, sizeof(struct F_frame_));
+  F_accessList p, tail = NULL;
+  frame->name = name;
+  frame->formals = NULL;
+  frame->localCount = f->localCount;
+  for (p = f->formals; p; p = p->tail) {
+    F_access a = p->head->kind == inReg
+                     ? InReg(rename(p->head->u.reg, closure))
+                     : InFrame(p->head->u.offset);
+    F_accessList cell = F_AccessList(a, NULL);
+    if (tail)
+      tail->tail = cell;
+    else
+      frame->formals = cell;
+    tail = cell;
+  }
+  return frame;
 }
 
-T_exp F_Exp(F_access acc, T_exp framePtr) {
+int F_localCount(F_frame f) { return f->localCount; }
+
+Temp_temp F_accessTemp(F_access acc) {
+  return acc->kind == inReg ? acc->u.reg : NULL;
+}
+
+/* Machine registers. They are temps like any other, made the first time
+ * one of them is asked for; F_tempMap names them. */
+enum { EAX, EBX, ECX, EDX, ESI, EDI, EBP, ESP, REG_COUNT };
+static string regNames[REG_COUNT] = {"%eax", "%ebx", "%ecx", "%edx",
+                                     "%esi", "%edi", "%ebp", "%esp"};
+
+/* The registers of the current context */
+typedef struct {
+  Temp_temp regs[REG_COUNT];
+  Temp_map regMap;
+  Temp_tempList colorable;
+} state;
+
+static state *registers(void) {
+  state *st = CX_state(CX_frame, sizeof(state), NULL, NULL);
+  int i;
+  if (st->regMap)
+    return st;
+  st->regMap = Temp_empty();
+  for (i = 0; i < REG_COUNT; i++) {
+    st->regs[i] = Temp_newtemp();
+    Temp_enter(st->regMap, st->regs[i], regNames[i]);
+  }
+  /* %ebp and %esp hold the frame and stack pointers. */
+  for (i = EDI; i >= EAX; i--)
+    st->colorable = Temp_TempList(st->regs[i], st->colorable);
+  return st;
+}
+
+Temp_map F_tempMap(void) { return registers()->regMap; }
+
+Temp_tempList F_registers(void) { return registers()->colorable; }
+
+Temp_temp F_FP(void) { return registers()->regs[EBP]; }
+
+Temp_temp F_SP(void) { return registers()->regs[ESP]; }
+
+Temp_temp F_RV(void) { return registers()->regs[EAX]; }
+
+void F_reset(void) {
+  state *st = CX_state(CX_frame, sizeof(state), NULL, NULL);
+  st->regMap = NULL;
+  st->colorable = NULL;
+}
+
+int F_frameOffset(F_access acc) {
   assert(acc->kind == inFrame);
+  return acc->u.offset;
+}
+
+T_exp F_Exp(F_access acc, T_exp framePtr) {
+  if (acc->kind == inReg)
+    return T_Temp(acc->u.reg);
   T_exp memoryAddress = T_Binop(T_plus, framePtr, T_Const(acc->u.offset));
   return T_Mem(memoryAddress);
 }
@@ -112,7 +188,7 @@ T_stm F_procEntryExit1(F_frame f, T_stm stm) {
 }
 
 F_frag F_StringFrag(Temp_label label, string str) {
-  F_frag frag = checked_malloc(sizeof(*frag));
+  F_frag frag = AR_alloc(AR_frame, sizeof(*frag));
   frag->kind = F_stringFrag;
   frag->u.string.label = label;
   frag->u.string.str = str;
@@ -120,7 +196,7 @@ F_frag F_StringFrag(Temp_label label, string str) {
 }
 
 F_frag F_ProcFrag(T_stm body, F_frame frame) {
-  F_frag frag = checked_malloc(sizeof(*frag));
+  F_frag frag = AR_alloc(AR_frame, sizeof(*frag));
   frag->kind = F_procFrag;
   frag->u.proc.body = body;
   frag->u.proc.frame = frame;
@@ -128,7 +204,7 @@ F_frag F_ProcFrag(T_stm body, F_frame frame) {
 }
 
 F_fragList F_FragList(F_frag head, F_fragList tail) {
-  F_fragList fragList = checked_malloc(sizeof(*fragList));
+  F_fragList fragList = AR_alloc(AR_frame, sizeof(*fragList));
   fragList->head = head;
   fragList->tail = tail;
   return fragList;
@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton implementation for Bison's Yacc-like parsers in C
+/* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -36,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -43,76 +45,138 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.3"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 1 "tiger.grm"
+
+#include <stdio.h>
+#include "util.h"
+#include "symbol.h"
+#include "errormsg.h"
+#include "absyn.h"
 
-/* Using locations.  */
-#define YYLSP_NEEDED 0
+void yyerror(A_exp *absyn_root, char *s)
+{
+ (void)absyn_root;
+ EM_error(EM_tokPos, "%s", s);
+}
 
+#line 85 "y.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
+/* Use api.header.include to #include this header
+   instead of duplicating it here.  */
+#ifndef YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 1
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
 
-/* Tokens.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     ID = 258,
-     STRING = 259,
-     INT = 260,
-     COMMA = 261,
-     COLON = 262,
-     SEMICOLON = 263,
-     LPAREN = 264,
-     RPAREN = 265,
-     LBRACK = 266,
-     RBRACK = 267,
-     LBRACE = 268,
-     RBRACE = 269,
-     DOT = 270,
-     PLUS = 271,
-     MINUS = 272,
-     TIMES = 273,
-     DIVIDE = 274,
-     EQ = 275,
-     NEQ = 276,
-     LT = 277,
-     LE = 278,
-     GT = 279,
-     GE = 280,
-     AND = 281,
-     OR = 282,
-     ASSIGN = 283,
-     ARRAY = 284,
-     IF = 285,
-     THEN = 286,
-     ELSE = 287,
-     WHILE = 288,
-     FOR = 289,
-     TO = 290,
-     DO = 291,
-     LET = 292,
-     IN = 293,
-     END = 294,
-     OF = 295,
-     BREAK = 296,
-     NIL = 297,
-     FUNCTION = 298,
-     VAR = 299,
-     TYPE = 300,
-     UMINUS = 301
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    ID = 258,                      /* ID  */
+    STRING = 259,                  /* STRING  */
+    INT = 260,                     /* INT  */
+    COMMA = 261,                   /* COMMA  */
+    COLON = 262,                   /* COLON  */
+    SEMICOLON = 263,               /* SEMICOLON  */
+    LPAREN = 264,                  /* LPAREN  */
+    RPAREN = 265,                  /* RPAREN  */
+    LBRACK = 266,                  /* LBRACK  */
+    RBRACK = 267,                  /* RBRACK  */
+    LBRACE = 268,                  /* LBRACE  */
+    RBRACE = 269,                  /* RBRACE  */
+    DOT = 270,                     /* DOT  */
+    PLUS = 271,                    /* PLUS  */
+    MINUS = 272,                   /* MINUS  */
+    TIMES = 273,                   /* TIMES  */
+    DIVIDE = 274,                  /* DIVIDE  */
+    EQ = 275,                      /* EQ  */
+    NEQ = 276,                     /* NEQ  */
+    LT = 277,                      /* LT  */
+    LE = 278,                      /* LE  */
+    GT = 279,                      /* GT  */
+    GE = 280,                      /* GE  */
+    AND = 281,                     /* AND  */
+    OR = 282,                      /* OR  */
+    ASSIGN = 283,                  /* ASSIGN  */
+    ARRAY = 284,                   /* ARRAY  */
+    IF = 285,                      /* IF  */
+    THEN = 286,                    /* THEN  */
+    ELSE = 287,                    /* ELSE  */
+    WHILE = 288,                   /* WHILE  */
+    FOR = 289,                     /* FOR  */
+    TO = 290,                      /* TO  */
+    DO = 291,                      /* DO  */
+    LET = 292,                     /* LET  */
+    IN = 293,                      /* IN  */
+    END = 294,                     /* END  */
+    OF = 295,                      /* OF  */
+    BREAK = 296,                   /* BREAK  */
+    NIL = 297,                     /* NIL  */
+    FUNCTION = 298,                /* FUNCTION  */
+    VAR = 299,                     /* VAR  */
+    TYPE = 300,                    /* TYPE  */
+    UMINUS = 301                   /* UMINUS  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define ID 258
 #define STRING 259
 #define INT 260
@@ -158,50 +222,12 @@
 #define TYPE 300
 #define UMINUS 301
 
-
-
-
-/* Copy the first part of user declarations.  */
-#line 1 "tiger.grm"
-
-#include <stdio.h>
-#include "util.h"
-#include "symbol.h"
-#include "errormsg.h"
-#include "absyn.h"
-
-int yylex(void); /* function prototype */
-
-A_exp absyn_root;
-
-void yyerror(char *s)
-{
- EM_error(EM_tokPos, "%s", s);
-}
-
-
-/* Enabling traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 1
-#endif
-
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Enabling the token table.  */
-#ifndef YYTOKEN_TABLE
-# define YYTOKEN_TABLE 0
-#endif
-
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 19 "tiger.grm"
+union YYSTYPE
 {
+#line 25 "tiger.grm"
+
 	int pos;
 	int ival;
 	string sval;
@@ -218,52 +244,199 @@ typedef union YYSTYPE
         A_fieldList fieldList;
         A_nametyList nameTyList;
 	/* et cetera */
-	}
-/* Line 193 of yacc.c.  */
-#line 224 "y.tab.c"
-	YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
+	
+
+#line 250 "y.tab.c"
+
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
 
 
-/* Copy the second part of user declarations.  */
 
+int yyparse (A_exp *absyn_root);
 
-/* Line 216 of yacc.c.  */
-#line 237 "y.tab.c"
+
+#endif /* !YY_YY_Y_TAB_H_INCLUDED  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_ID = 3,                         /* ID  */
+  YYSYMBOL_STRING = 4,                     /* STRING  */
+  YYSYMBOL_INT = 5,                        /* INT  */
+  YYSYMBOL_COMMA = 6,                      /* COMMA  */
+  YYSYMBOL_COLON = 7,                      /* COLON  */
+  YYSYMBOL_SEMICOLON = 8,                  /* SEMICOLON  */
+  YYSYMBOL_LPAREN = 9,                     /* LPAREN  */
+  YYSYMBOL_RPAREN = 10,                    /* RPAREN  */
+  YYSYMBOL_LBRACK = 11,                    /* LBRACK  */
+  YYSYMBOL_RBRACK = 12,                    /* RBRACK  */
+  YYSYMBOL_LBRACE = 13,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 14,                    /* RBRACE  */
+  YYSYMBOL_DOT = 15,                       /* DOT  */
+  YYSYMBOL_PLUS = 16,                      /* PLUS  */
+  YYSYMBOL_MINUS = 17,                     /* MINUS  */
+  YYSYMBOL_TIMES = 18,                     /* TIMES  */
+  YYSYMBOL_DIVIDE = 19,                    /* DIVIDE  */
+  YYSYMBOL_EQ = 20,                        /* EQ  */
+  YYSYMBOL_NEQ = 21,                       /* NEQ  */
+  YYSYMBOL_LT = 22,                        /* LT  */
+  YYSYMBOL_LE = 23,                        /* LE  */
+  YYSYMBOL_GT = 24,                        /* GT  */
+  YYSYMBOL_GE = 25,                        /* GE  */
+  YYSYMBOL_AND = 26,                       /* AND  */
+  YYSYMBOL_OR = 27,                        /* OR  */
+  YYSYMBOL_ASSIGN = 28,                    /* ASSIGN  */
+  YYSYMBOL_ARRAY = 29,                     /* ARRAY  */
+  YYSYMBOL_IF = 30,                        /* IF  */
+  YYSYMBOL_THEN = 31,                      /* THEN  */
+  YYSYMBOL_ELSE = 32,                      /* ELSE  */
+  YYSYMBOL_WHILE = 33,                     /* WHILE  */
+  YYSYMBOL_FOR = 34,                       /* FOR  */
+  YYSYMBOL_TO = 35,                        /* TO  */
+  YYSYMBOL_DO = 36,                        /* DO  */
+  YYSYMBOL_LET = 37,                       /* LET  */
+  YYSYMBOL_IN = 38,                        /* IN  */
+  YYSYMBOL_END = 39,                       /* END  */
+  YYSYMBOL_OF = 40,                        /* OF  */
+  YYSYMBOL_BREAK = 41,                     /* BREAK  */
+  YYSYMBOL_NIL = 42,                       /* NIL  */
+  YYSYMBOL_FUNCTION = 43,                  /* FUNCTION  */
+  YYSYMBOL_VAR = 44,                       /* VAR  */
+  YYSYMBOL_TYPE = 45,                      /* TYPE  */
+  YYSYMBOL_UMINUS = 46,                    /* UMINUS  */
+  YYSYMBOL_YYACCEPT = 47,                  /* $accept  */
+  YYSYMBOL_program = 48,                   /* program  */
+  YYSYMBOL_exp = 49,                       /* exp  */
+  YYSYMBOL_let = 50,                       /* let  */
+  YYSYMBOL_decl_list = 51,                 /* decl_list  */
+  YYSYMBOL_exp_list_empty = 52,            /* exp_list_empty  */
+  YYSYMBOL_exp_list = 53,                  /* exp_list  */
+  YYSYMBOL_decl = 54,                      /* decl  */
+  YYSYMBOL_type_decl_list = 55,            /* type_decl_list  */
+  YYSYMBOL_type_decl = 56,                 /* type_decl  */
+  YYSYMBOL_type_id = 57,                   /* type_id  */
+  YYSYMBOL_fields = 58,                    /* fields  */
+  YYSYMBOL_var_decl = 59,                  /* var_decl  */
+  YYSYMBOL_function_decl_list = 60,        /* function_decl_list  */
+  YYSYMBOL_function_decl = 61,             /* function_decl  */
+  YYSYMBOL_function_args = 62,             /* function_args  */
+  YYSYMBOL_function_args_list = 63,        /* function_args_list  */
+  YYSYMBOL_lvalue = 64,                    /* lvalue  */
+  YYSYMBOL_lvalue_not_id = 65,             /* lvalue_not_id  */
+  YYSYMBOL_bin_op = 66,                    /* bin_op  */
+  YYSYMBOL_record = 67,                    /* record  */
+  YYSYMBOL_record_args = 68,               /* record_args  */
+  YYSYMBOL_array = 69,                     /* array  */
+  YYSYMBOL_if_exp = 70,                    /* if_exp  */
+  YYSYMBOL_while_loop = 71,                /* while_loop  */
+  YYSYMBOL_for_loop = 72,                  /* for_loop  */
+  YYSYMBOL_function_call = 73,             /* function_call  */
+  YYSYMBOL_function_call_args = 74         /* function_call_args  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+/* Unqualified %code blocks.  */
+#line 20 "tiger.grm"
+
+int yylex(YYSTYPE *lvalp); /* function prototype */
+
+#line 354 "y.tab.c"
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
 typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef short int yytype_int8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -271,55 +444,106 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
 #   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
 #  endif
 # endif
 # ifndef YY_
-#  define YY_(msgid) msgid
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(e) ((void) (e))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(e) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(n) (n)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int i)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (i)
-    int i;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return i;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
 #endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -336,11 +560,11 @@ YYID (i)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#     ifndef _STDLIB_H
-#      define _STDLIB_H 1
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
 #     endif
 #    endif
 #   endif
@@ -348,8 +572,8 @@ YYID (i)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -363,92 +587,93 @@ YYID (i)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
 #   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
 #  endif
-#  if (defined __cplusplus && ! defined _STDLIB_H \
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#   ifndef _STDLIB_H
-#    define _STDLIB_H 1
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
 #   endif
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss;
-  YYSTYPE yyvs;
-  };
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
-/* Copy COUNT objects from FROM to TO.  The source and destination do
-   not overlap.  */
-# ifndef YYCOPY
-#  if defined __GNUC__ && 1 < __GNUC__
-#   define YYCOPY(To, From, Count) \
-      __builtin_memcpy (To, From, (Count) * sizeof (*(From)))
-#  else
-#   define YYCOPY(To, From, Count)		\
-      do					\
-	{					\
-	  YYSIZE_T yyi;				\
-	  for (yyi = 0; yyi < (Count); yyi++)	\
-	    (To)[yyi] = (From)[yyi];		\
-	}					\
-      while (YYID (0))
-#  endif
-# endif
+# define YYCOPY_NEEDED 1
 
 /* Relocate STACK from its old location to the new one.  The
    local variables YYSIZE and YYSTACKSIZE give the old and new number of
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack)					\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack, Stack, yysize);				\
-	Stack = &yyptr->Stack;						\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  46
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   335
+#define YYLAST   363
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  47
@@ -456,18 +681,23 @@ union yyalloc
 #define YYNNTS  28
 /* YYNRULES -- Number of rules.  */
 #define YYNRULES  77
-/* YYNRULES -- Number of states.  */
+/* YYNSTATES -- Number of states.  */
 #define YYNSTATES  157
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   301
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -503,130 +733,89 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint16 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     5,     7,     9,    13,    17,    19,    21,
-      23,    26,    28,    30,    32,    34,    36,    38,    40,    42,
-      48,    51,    54,    55,    57,    58,    62,    66,    68,    70,
-      72,    74,    77,    79,    84,    86,    90,    94,   100,   104,
-     109,   116,   119,   121,   131,   139,   141,   142,   148,   152,
-     154,   159,   161,   165,   170,   174,   178,   182,   186,   190,
-     194,   198,   202,   206,   210,   214,   218,   223,   229,   233,
-     240,   245,   252,   257,   266,   271,   275,   279
+       0,    88,    88,    92,    93,    94,    95,    96,    97,    98,
+      99,   100,   101,   102,   103,   104,   105,   106,   107,   111,
+     115,   116,   117,   120,   121,   125,   126,   127,   131,   132,
+     133,   137,   138,   141,   144,   145,   146,   150,   151,   155,
+     156,   160,   161,   165,   166,   172,   173,   178,   179,   183,
+     184,   185,   189,   190,   194,   195,   196,   197,   198,   199,
+     200,   201,   202,   203,   204,   211,   221,   225,   226,   230,
+     233,   234,   238,   242,   246,   249,   256,   257
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      48,     0,    -1,    49,    -1,    50,    -1,    64,    -1,    64,
-      28,    49,    -1,     9,    52,    10,    -1,    42,    -1,     5,
-      -1,     4,    -1,    17,    49,    -1,    66,    -1,    67,    -1,
-      69,    -1,    70,    -1,    71,    -1,    72,    -1,    41,    -1,
-      73,    -1,    37,    51,    38,    53,    39,    -1,    54,    51,
-      -1,     1,    51,    -1,    -1,    53,    -1,    -1,    49,     8,
-      53,    -1,     1,     8,    53,    -1,    49,    -1,    55,    -1,
-      59,    -1,    60,    -1,    56,    55,    -1,    56,    -1,    45,
-       3,    20,    57,    -1,     3,    -1,    13,    58,    14,    -1,
-      29,    40,     3,    -1,     3,     7,     3,     6,    58,    -1,
-       3,     7,     3,    -1,    44,     3,    28,    49,    -1,    44,
-       3,     7,     3,    28,    49,    -1,    61,    60,    -1,    61,
-      -1,    43,     3,     9,    62,    10,     7,     3,    20,    49,
-      -1,    43,     3,     9,    62,    10,    20,    49,    -1,    63,
-      -1,    -1,     3,     7,     3,     6,    63,    -1,     3,     7,
-       3,    -1,     3,    -1,     3,    11,    49,    12,    -1,    65,
-      -1,    64,    15,     3,    -1,    65,    11,    49,    12,    -1,
-      49,    16,    49,    -1,    49,    17,    49,    -1,    49,    18,
-      49,    -1,    49,    19,    49,    -1,    49,    20,    49,    -1,
-      49,    21,    49,    -1,    49,    22,    49,    -1,    49,    24,
-      49,    -1,    49,    23,    49,    -1,    49,    25,    49,    -1,
-      49,    26,    49,    -1,    49,    27,    49,    -1,     3,    13,
-      68,    14,    -1,     3,    20,    49,     6,    68,    -1,     3,
-      20,    49,    -1,     3,    11,    49,    12,    40,    49,    -1,
-      30,    49,    31,    49,    -1,    30,    49,    31,    49,    32,
-      49,    -1,    33,    49,    36,    49,    -1,    34,     3,    28,
-      49,    35,    49,    36,    49,    -1,     3,     9,    74,    10,
-      -1,     3,     9,    10,    -1,    49,     6,    74,    -1,    49,
-      -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint8 yyrline[] =
-{
-       0,    78,    78,    82,    83,    84,    85,    86,    87,    88,
-      89,    90,    91,    92,    93,    94,    95,    96,    97,   101,
-     105,   106,   107,   110,   111,   115,   116,   117,   121,   122,
-     123,   127,   128,   131,   134,   135,   136,   140,   141,   145,
-     146,   150,   151,   155,   156,   162,   163,   168,   169,   173,
-     174,   175,   179,   180,   184,   185,   186,   187,   188,   189,
-     190,   191,   192,   193,   194,   201,   211,   215,   216,   220,
-     223,   224,   228,   232,   236,   239,   246,   247
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || YYTOKEN_TABLE
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "ID", "STRING", "INT", "COMMA", "COLON",
-  "SEMICOLON", "LPAREN", "RPAREN", "LBRACK", "RBRACK", "LBRACE", "RBRACE",
-  "DOT", "PLUS", "MINUS", "TIMES", "DIVIDE", "EQ", "NEQ", "LT", "LE", "GT",
-  "GE", "AND", "OR", "ASSIGN", "ARRAY", "IF", "THEN", "ELSE", "WHILE",
-  "FOR", "TO", "DO", "LET", "IN", "END", "OF", "BREAK", "NIL", "FUNCTION",
-  "VAR", "TYPE", "UMINUS", "$accept", "program", "exp", "let", "decl_list",
-  "exp_list_empty", "exp_list", "decl", "type_decl_list", "type_decl",
-  "type_id", "fields", "var_decl", "function_decl_list", "function_decl",
-  "function_args", "function_args_list", "lvalue", "lvalue_not_id",
-  "bin_op", "record", "record_args", "array", "if_exp", "while_loop",
-  "for_loop", "function_call", "function_call_args", 0
+  "\"end of file\"", "error", "\"invalid token\"", "ID", "STRING", "INT",
+  "COMMA", "COLON", "SEMICOLON", "LPAREN", "RPAREN", "LBRACK", "RBRACK",
+  "LBRACE", "RBRACE", "DOT", "PLUS", "MINUS", "TIMES", "DIVIDE", "EQ",
+  "NEQ", "LT", "LE", "GT", "GE", "AND", "OR", "ASSIGN", "ARRAY", "IF",
+  "THEN", "ELSE", "WHILE", "FOR", "TO", "DO", "LET", "IN", "END", "OF",
+  "BREAK", "NIL", "FUNCTION", "VAR", "TYPE", "UMINUS", "$accept",
+  "program", "exp", "let", "decl_list", "exp_list_empty", "exp_list",
+  "decl", "type_decl_list", "type_decl", "type_id", "fields", "var_decl",
+  "function_decl_list", "function_decl", "function_args",
+  "function_args_list", "lvalue", "lvalue_not_id", "bin_op", "record",
+  "record_args", "array", "if_exp", "while_loop", "for_loop",
+  "function_call", "function_call_args", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299,   300,   301
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
-{
-       0,    47,    48,    49,    49,    49,    49,    49,    49,    49,
-      49,    49,    49,    49,    49,    49,    49,    49,    49,    50,
-      51,    51,    51,    52,    52,    53,    53,    53,    54,    54,
-      54,    55,    55,    56,    57,    57,    57,    58,    58,    59,
-      59,    60,    60,    61,    61,    62,    62,    63,    63,    64,
-      64,    64,    65,    65,    66,    66,    66,    66,    66,    66,
-      66,    66,    66,    66,    66,    66,    67,    68,    68,    69,
-      70,    70,    71,    72,    73,    73,    74,    74
-};
+#define YYPACT_NINF (-36)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-25)
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+#define yytable_value_is_error(Yyn) \
+  ((Yyn) == YYTABLE_NINF)
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
 {
-       0,     2,     1,     1,     1,     3,     3,     1,     1,     1,
-       2,     1,     1,     1,     1,     1,     1,     1,     1,     5,
-       2,     2,     0,     1,     0,     3,     3,     1,     1,     1,
-       1,     2,     1,     4,     1,     3,     3,     5,     3,     4,
-       6,     2,     1,     9,     7,     1,     0,     5,     3,     1,
-       4,     1,     3,     4,     3,     3,     3,     3,     3,     3,
-       3,     3,     3,     3,     3,     3,     4,     5,     3,     6,
-       4,     6,     4,     8,     4,     3,     3,     1
+     163,    27,   -36,   -36,    65,   163,   163,   163,     7,     1,
+     -36,   -36,     4,   305,   -36,    13,    15,   -36,   -36,   -36,
+     -36,   -36,   -36,   -36,   128,   163,    28,    29,   212,    25,
+     -36,   -36,   261,    -4,    31,     1,    61,    62,    64,    38,
+       1,   -36,    32,   -36,   -36,    35,   -36,   163,   163,   163,
+     163,   163,   163,   163,   163,   163,   163,   163,   163,    76,
+     163,   163,   -36,   165,    70,   277,    81,    82,   118,   118,
+     -36,   163,   163,   163,   -36,    72,     2,    84,   118,   -36,
+     -36,   -36,    44,    44,   -36,   -36,   328,   328,   328,   328,
+     328,   328,   338,   317,   -36,   305,   293,   163,   -36,    68,
+     163,   -36,   -36,   -36,   244,   305,   224,   102,   107,   163,
+      -2,    73,   -36,   -36,   163,   192,   163,   163,   104,   103,
+     -36,    87,   305,   -36,   115,    80,   -36,   -36,   305,    28,
+     305,    67,   121,    22,   163,   119,   111,   125,   -36,   163,
+     123,   127,   163,   305,   133,   -36,   -36,   305,   102,   120,
+     305,   135,   -36,   163,   115,   305,   -36
 };
 
-/* YYDEFACT[STATE-NAME] -- Default rule to reduce with in state
-   STATE-NUM when YYTABLE doesn't specify something else to do.  Zero
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
    means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+static const yytype_int8 yydefact[] =
 {
        0,    49,     9,     8,     0,     0,     0,     0,     0,     0,
       17,     7,     0,     2,     3,     4,    51,    11,    12,    13,
@@ -646,50 +835,25 @@ static const yytype_uint8 yydefact[] =
       44,    38,    47,     0,     0,    43,    37
 };
 
-/* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
 {
-      -1,    12,    28,    14,    39,    29,    30,    40,    41,    42,
-     126,   136,    43,    44,    45,   119,   120,    15,    16,    17,
-      18,    67,    19,    20,    21,    22,    23,    64
+     -36,   -36,     0,   -36,   -32,   -36,   -35,   -36,   101,   -36,
+     -36,   -10,   -36,   105,   -36,   -36,    -1,   -36,   -36,   -36,
+     -36,    17,   -36,   -36,   -36,   -36,   -36,    52
 };
 
-/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-   STATE-NUM.  */
-#define YYPACT_NINF -36
-static const yytype_int16 yypact[] =
-{
-     163,    27,   -36,   -36,    65,   163,   163,   163,     7,     1,
-     -36,   -36,     4,   288,   -36,    13,    15,   -36,   -36,   -36,
-     -36,   -36,   -36,   -36,   128,   163,    28,    29,   212,    25,
-     -36,   -36,   244,    -4,    31,     1,    61,    62,    64,    38,
-       1,   -36,    32,   -36,   -36,    35,   -36,   163,   163,   163,
-     163,   163,   163,   163,   163,   163,   163,   163,   163,    76,
-     163,   163,   -36,   165,    70,   260,    81,    82,   118,   118,
-     -36,   163,   163,   163,   -36,    72,     2,    84,   118,   -36,
-     -36,   -36,    44,    44,   -36,   -36,   300,   300,   300,   300,
-     300,   300,   310,   310,   -36,   288,   276,   163,   -36,    68,
-     163,   -36,   -36,   -36,    73,   -36,   224,   107,   108,   163,
-      -2,    74,   -36,   -36,   163,   192,   163,   163,   105,   110,
-     -36,    87,   288,   -36,   115,    85,   -36,   -36,   -36,    28,
-     -36,    67,   121,    22,   163,   119,   114,   126,   -36,   163,
-     124,   133,   163,   288,   137,   -36,   -36,   -36,   107,   123,
-     288,   135,   -36,   163,   115,   288,   -36
-};
-
-/* YYPGOTO[NTERM-NUM].  */
-static const yytype_int8 yypgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-     -36,   -36,     0,   -36,   -32,   -36,   -35,   -36,   102,   -36,
-     -36,    -8,   -36,   104,   -36,   -36,    -1,   -36,   -36,   -36,
-     -36,    21,   -36,   -36,   -36,   -36,   -36,    57
+       0,    12,    28,    14,    39,    29,    30,    40,    41,    42,
+     126,   136,    43,    44,    45,   119,   120,    15,    16,    17,
+      18,    67,    19,    20,    21,    22,    23,    64
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
-   number is the opposite.  If zero, do what YYDEFACT says.
-   If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -25
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
       13,   123,    35,    74,    46,    31,    32,    33,    79,   108,
@@ -702,12 +866,12 @@ static const yytype_int16 yytable[] =
        3,   104,   105,   106,     4,   -24,    78,    38,    36,    94,
       98,   107,     5,    47,    48,    49,    50,    51,    52,    53,
       54,    55,    56,    57,    58,     6,   101,    63,     7,     8,
-     115,   100,     9,   139,   110,   116,    10,    11,   114,   122,
-     118,   121,   132,   127,   128,   134,   130,   131,   135,    27,
-     133,     1,     2,     3,   140,   137,   144,     4,   145,   146,
-     148,     1,     2,     3,   143,     5,   149,     4,    62,   147,
-     151,   154,   150,   153,    80,     5,   156,   152,     6,    81,
-     138,     7,     8,   155,   113,     9,     0,     0,     6,    10,
+     115,   100,     9,   139,   110,   118,    10,    11,   114,   122,
+     121,   132,   127,   133,   128,   134,   130,   131,   135,    27,
+     137,     1,     2,     3,   140,   145,   144,     4,   146,   148,
+     149,     1,     2,     3,   143,     5,   151,     4,    62,   147,
+     153,   154,   150,    80,   156,     5,   138,   152,     6,   113,
+      81,     7,     8,   155,     0,     9,     0,     0,     6,    10,
       11,     7,     8,     0,     0,     9,     1,     2,     3,    10,
       11,    97,     4,     0,     0,     0,     0,     0,     0,     0,
        5,    47,    48,    49,    50,    51,    52,    53,    54,    55,
@@ -719,13 +883,16 @@ static const yytype_int16 yytable[] =
       47,    48,    49,    50,    51,    52,    53,    54,    55,    56,
       57,    58,     0,     0,     0,     0,     0,     0,     0,   117,
       47,    48,    49,    50,    51,    52,    53,    54,    55,    56,
-      57,    58,    99,     0,     0,    71,    47,    48,    49,    50,
-      51,    52,    53,    54,    55,    56,    57,    58,   112,     0,
-       0,     0,    47,    48,    49,    50,    51,    52,    53,    54,
-      55,    56,    57,    58,    47,    48,    49,    50,    51,    52,
-      53,    54,    55,    56,    57,    58,    47,    48,    49,    50,
-     -25,   -25,   -25,   -25,   -25,   -25,    47,    48,    49,    50,
-      51,    52,    53,    54,    55,    56
+      57,    58,     0,     0,     0,     0,   116,    47,    48,    49,
+      50,    51,    52,    53,    54,    55,    56,    57,    58,    99,
+       0,     0,    71,    47,    48,    49,    50,    51,    52,    53,
+      54,    55,    56,    57,    58,   112,     0,     0,     0,    47,
+      48,    49,    50,    51,    52,    53,    54,    55,    56,    57,
+      58,    47,    48,    49,    50,    51,    52,    53,    54,    55,
+      56,    57,    58,    47,    48,    49,    50,    51,    52,    53,
+      54,    55,    56,    57,    47,    48,    49,    50,   -25,   -25,
+     -25,   -25,   -25,   -25,    47,    48,    49,    50,    51,    52,
+      53,    54,    55,    56
 };
 
 static const yytype_int16 yycheck[] =
@@ -740,12 +907,12 @@ static const yytype_int16 yycheck[] =
        5,    71,    72,    73,     9,    10,    38,    45,    43,     3,
       10,     9,    17,    16,    17,    18,    19,    20,    21,    22,
       23,    24,    25,    26,    27,    30,    14,    97,    33,    34,
-     100,    20,    37,    36,    20,    32,    41,    42,    40,   109,
-       3,     3,     7,    39,   114,    28,   116,   117,     3,     1,
-      10,     3,     4,     5,     3,    40,     7,     9,    14,     3,
-       6,     3,     4,     5,   134,    17,     3,     9,    10,   139,
-       3,     6,   142,    20,    42,    17,   154,   148,    30,    45,
-     129,    33,    34,   153,    97,    37,    -1,    -1,    30,    41,
+     100,    20,    37,    36,    20,     3,    41,    42,    40,   109,
+       3,     7,    39,    10,   114,    28,   116,   117,     3,     1,
+      40,     3,     4,     5,     3,    14,     7,     9,     3,     6,
+       3,     3,     4,     5,   134,    17,     3,     9,    10,   139,
+      20,     6,   142,    42,   154,    17,   129,   148,    30,    97,
+      45,    33,    34,   153,    -1,    37,    -1,    -1,    30,    41,
       42,    33,    34,    -1,    -1,    37,     3,     4,     5,    41,
       42,     6,     9,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
       17,    16,    17,    18,    19,    20,    21,    22,    23,    24,
@@ -757,18 +924,21 @@ static const yytype_int16 yycheck[] =
       16,    17,    18,    19,    20,    21,    22,    23,    24,    25,
       26,    27,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    35,
       16,    17,    18,    19,    20,    21,    22,    23,    24,    25,
-      26,    27,    12,    -1,    -1,    31,    16,    17,    18,    19,
-      20,    21,    22,    23,    24,    25,    26,    27,    12,    -1,
-      -1,    -1,    16,    17,    18,    19,    20,    21,    22,    23,
-      24,    25,    26,    27,    16,    17,    18,    19,    20,    21,
-      22,    23,    24,    25,    26,    27,    16,    17,    18,    19,
-      20,    21,    22,    23,    24,    25,    16,    17,    18,    19,
-      20,    21,    22,    23,    24,    25
+      26,    27,    -1,    -1,    -1,    -1,    32,    16,    17,    18,
+      19,    20,    21,    22,    23,    24,    25,    26,    27,    12,
+      -1,    -1,    31,    16,    17,    18,    19,    20,    21,    22,
+      23,    24,    25,    26,    27,    12,    -1,    -1,    -1,    16,
+      17,    18,    19,    20,    21,    22,    23,    24,    25,    26,
+      27,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    16,    17,    18,    19,    20,    21,    22,
+      23,    24,    25,    26,    16,    17,    18,    19,    20,    21,
+      22,    23,    24,    25,    16,    17,    18,    19,    20,    21,
+      22,    23,    24,    25
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     3,     4,     5,     9,    17,    30,    33,    34,    37,
       41,    42,    48,    49,    50,    64,    65,    66,    67,    69,
@@ -788,95 +958,67 @@ static const yytype_uint8 yystos[] =
       49,     3,    63,    20,     6,    49,    58
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
-
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
-
-
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  */
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    47,    48,    49,    49,    49,    49,    49,    49,    49,
+      49,    49,    49,    49,    49,    49,    49,    49,    49,    50,
+      51,    51,    51,    52,    52,    53,    53,    53,    54,    54,
+      54,    55,    55,    56,    57,    57,    57,    58,    58,    59,
+      59,    60,    60,    61,    61,    62,    62,    63,    63,    64,
+      64,    64,    65,    65,    66,    66,    66,    66,    66,    66,
+      66,    66,    66,    66,    66,    66,    67,    68,    68,    69,
+      70,    70,    71,    72,    73,    73,    74,    74
+};
 
-#define YYFAIL		goto yyerrlab
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     1,     1,     3,     3,     1,     1,     1,
+       2,     1,     1,     1,     1,     1,     1,     1,     1,     5,
+       2,     2,     0,     1,     0,     3,     3,     1,     1,     1,
+       1,     2,     1,     4,     1,     3,     3,     5,     3,     4,
+       6,     2,     1,     9,     7,     1,     0,     5,     3,     1,
+       4,     1,     3,     4,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     4,     5,     3,     6,
+       4,     6,     4,     8,     4,     3,     3,     1
+};
 
-#define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)					\
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    {								\
-      yychar = (Token);						\
-      yylval = (Value);						\
-      yytoken = YYTRANSLATE (yychar);				\
-      YYPOPSTACK (1);						\
-      goto yybackup;						\
-    }								\
-  else								\
-    {								\
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
-   If N is 0, then set CURRENT to the empty location which ends
-   the previous symbol: RHS[0] (always defined).  */
-
-#define YYRHSLOC(Rhs, K) ((Rhs)[K])
-#ifndef YYLLOC_DEFAULT
-# define YYLLOC_DEFAULT(Current, Rhs, N)				\
-    do									\
-      if (YYID (N))                                                    \
-	{								\
-	  (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;	\
-	  (Current).first_column = YYRHSLOC (Rhs, 1).first_column;	\
-	  (Current).last_line    = YYRHSLOC (Rhs, N).last_line;		\
-	  (Current).last_column  = YYRHSLOC (Rhs, N).last_column;	\
-	}								\
-      else								\
-	{								\
-	  (Current).first_line   = (Current).last_line   =		\
-	    YYRHSLOC (Rhs, 0).last_line;				\
-	  (Current).first_column = (Current).last_column =		\
-	    YYRHSLOC (Rhs, 0).last_column;				\
-	}								\
-    while (YYID (0))
-#endif
+enum { YYENOMEM = -2 };
 
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
-   This macro was not mandated originally: define only if we know
-   we won't break user code: when these are the locations we know.  */
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
-#  define YY_LOCATION_PRINT(File, Loc)			\
-     fprintf (File, "%d.%d-%d.%d",			\
-	      (Loc).first_line, (Loc).first_column,	\
-	      (Loc).last_line,  (Loc).last_column)
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
 
+#define YYRECOVERING()  (!!yyerrstatus)
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (absyn_root, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -886,80 +1028,59 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, absyn_root); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, A_exp *absyn_root)
 {
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (absyn_root);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
 static void
-yy_symbol_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, A_exp *absyn_root)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, absyn_root);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -967,80 +1088,68 @@ yy_symbol_print (yyoutput, yytype, yyvaluep)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_stack_print (yytype_int16 *bottom, yytype_int16 *top)
-#else
 static void
-yy_stack_print (bottom, top)
-    yytype_int16 *bottom;
-    yytype_int16 *top;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
-  for (; bottom <= top; ++bottom)
-    YYFPRINTF (stderr, " %d", *bottom);
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yyrule)
-    YYSTYPE *yyvsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, A_exp *absyn_root)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
-      fprintf (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       );
-      fprintf (stderr, "\n");
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], absyn_root);
+      YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, absyn_root); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -1055,478 +1164,226 @@ int yydebug;
 # define YYMAXDEPTH 10000
 #endif
 
-
 
-#if YYERROR_VERBOSE
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
-
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
 
-/* Copy into YYRESULT an error message about the unexpected token
-   YYCHAR while in state YYSTATE.  Return the number of bytes copied,
-   including the terminating null byte.  If YYRESULT is null, do not
-   copy anything; just return the number of bytes that would be
-   copied.  As a special case, return 0 if an ordinary "syntax error"
-   message will do.  Return YYSIZE_MAXIMUM if overflow occurs during
-   size calculation.  */
-static YYSIZE_T
-yysyntax_error (char *yyresult, int yystate, int yychar)
-{
-  int yyn = yypact[yystate];
-
-  if (! (YYPACT_NINF < yyn && yyn <= YYLAST))
-    return 0;
-  else
-    {
-      int yytype = YYTRANSLATE (yychar);
-      YYSIZE_T yysize0 = yytnamerr (0, yytname[yytype]);
-      YYSIZE_T yysize = yysize0;
-      YYSIZE_T yysize1;
-      int yysize_overflow = 0;
-      enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-      char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-      int yyx;
-
-# if 0
-      /* This is so xgettext sees the translatable formats that are
-	 constructed on the fly.  */
-      YY_("syntax error, unexpected %s");
-      YY_("syntax error, unexpected %s, expecting %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s");
-# endif
-      char *yyfmt;
-      char const *yyf;
-      static char const yyunexpected[] = "syntax error, unexpected %s";
-      static char const yyexpecting[] = ", expecting %s";
-      static char const yyor[] = " or %s";
-      char yyformat[sizeof yyunexpected
-		    + sizeof yyexpecting - 1
-		    + ((YYERROR_VERBOSE_ARGS_MAXIMUM - 2)
-		       * (sizeof yyor - 1))];
-      char const *yyprefix = yyexpecting;
-
-      /* Start YYX at -YYN if negative to avoid negative indexes in
-	 YYCHECK.  */
-      int yyxbegin = yyn < 0 ? -yyn : 0;
-
-      /* Stay within bounds of both yycheck and yytname.  */
-      int yychecklim = YYLAST - yyn + 1;
-      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-      int yycount = 1;
-
-      yyarg[0] = yytname[yytype];
-      yyfmt = yystpcpy (yyformat, yyunexpected);
-
-      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-	if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR)
-	  {
-	    if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-	      {
-		yycount = 1;
-		yysize = yysize0;
-		yyformat[sizeof yyunexpected - 1] = '\0';
-		break;
-	      }
-	    yyarg[yycount++] = yytname[yyx];
-	    yysize1 = yysize + yytnamerr (0, yytname[yyx]);
-	    yysize_overflow |= (yysize1 < yysize);
-	    yysize = yysize1;
-	    yyfmt = yystpcpy (yyfmt, yyprefix);
-	    yyprefix = yyor;
-	  }
-
-      yyf = YY_(yyformat);
-      yysize1 = yysize + yystrlen (yyf);
-      yysize_overflow |= (yysize1 < yysize);
-      yysize = yysize1;
-
-      if (yysize_overflow)
-	return YYSIZE_MAXIMUM;
-
-      if (yyresult)
-	{
-	  /* Avoid sprintf, as that infringes on the user's name space.
-	     Don't have undefined behavior even if the translation
-	     produced a string with the wrong number of "%s"s.  */
-	  char *yyp = yyresult;
-	  int yyi = 0;
-	  while ((*yyp = *yyf) != '\0')
-	    {
-	      if (*yyp == '%' && yyf[1] == 's' && yyi < yycount)
-		{
-		  yyp += yytnamerr (yyp, yyarg[yyi++]);
-		  yyf += 2;
-		}
-	      else
-		{
-		  yyp++;
-		  yyf++;
-		}
-	    }
-	}
-      return yysize;
-    }
-}
-#endif /* YYERROR_VERBOSE */
-
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
-#else
 static void
-yydestruct (yymsg, yytype, yyvaluep)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, A_exp *absyn_root)
 {
-  YYUSE (yyvaluep);
-
+  YY_USE (yyvaluep);
+  YY_USE (absyn_root);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-  switch (yytype)
-    {
-
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
-
 
-/* Prevent warnings from -Wmissing-prototypes.  */
 
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
 
 
 
-/* The look-ahead symbol.  */
-int yychar;
-
-/* The semantic value of the look-ahead symbol.  */
-YYSTYPE yylval;
-
-/* Number of syntax errors so far.  */
-int yynerrs;
-
-
 
 /*----------.
 | yyparse.  |
 `----------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void)
-#else
-int
-yyparse ()
-
-#endif
-#endif
+yyparse (A_exp *absyn_root)
 {
-  
-  int yystate;
-  int yyn;
-  int yyresult;
-  /* Number of tokens to shift before error messages enabled.  */
-  int yyerrstatus;
-  /* Look-ahead token as an internal (translated) token number.  */
-  int yytoken = 0;
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+/* Lookahead token kind.  */
+int yychar;
 
-  /* Three stacks and their tools:
-     `yyss': related to states,
-     `yyvs': related to semantic values,
-     `yyls': related to locations.
 
-     Refer to the stacks thru separate pointers, to allow yyoverflow
-     to reallocate them elsewhere.  */
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 
-  /* The state stack.  */
-  yytype_int16 yyssa[YYINITDEPTH];
-  yytype_int16 *yyss = yyssa;
-  yytype_int16 *yyssp;
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
 
-  /* The semantic value stack.  */
-  YYSTYPE yyvsa[YYINITDEPTH];
-  YYSTYPE *yyvs = yyvsa;
-  YYSTYPE *yyvsp;
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
 
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
 
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-  YYSIZE_T yystacksize = YYINITDEPTH;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
 
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
   /* The number of symbols on the RHS of the reduced rule.
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
-  yychar = YYEMPTY;		/* Cause a token to be read.  */
-
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
-
-  yyssp = yyss;
-  yyvsp = yyvs;
+  yychar = YYEMPTY; /* Cause a token to be read.  */
 
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss);
-	YYSTACK_RELOCATE (yyvs);
-
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
-     look-ahead token if we need one and don't already have one.  */
+     lookahead token if we need one and don't already have one.  */
 
-  /* First try to decide what to do without reference to look-ahead token.  */
+  /* First try to decide what to do without reference to lookahead token.  */
   yyn = yypact[yystate];
-  if (yyn == YYPACT_NINF)
+  if (yypact_value_is_default (yyn))
     goto yydefault;
 
-  /* Not known => get a look-ahead token if don't already have one.  */
+  /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid look-ahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex (&yylval);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1541,30 +1398,26 @@ yybackup:
   yyn = yytable[yyn];
   if (yyn <= 0)
     {
-      if (yyn == 0 || yyn == YYTABLE_NINF)
-	goto yyerrlab;
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
       yyn = -yyn;
       goto yyreduce;
     }
 
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
   /* Count tokens shifted since error; after three, turn off error
      status.  */
   if (yyerrstatus)
     yyerrstatus--;
 
-  /* Shift the look-ahead token.  */
+  /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token unless it is eof.  */
-  if (yychar != YYEOF)
-    yychar = YYEMPTY;
-
   yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1579,14 +1432,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1599,440 +1452,479 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 78 "tiger.grm"
-    {absyn_root=(yyvsp[(1) - (1)].exp);}
-    break;
-
-  case 4:
-#line 83 "tiger.grm"
-    {(yyval.exp)=A_VarExp(EM_tokPos,(yyvsp[(1) - (1)].var));}
-    break;
-
-  case 5:
-#line 84 "tiger.grm"
-    {(yyval.exp)=A_AssignExp(EM_tokPos,(yyvsp[(1) - (3)].var),(yyvsp[(3) - (3)].exp));}
-    break;
-
-  case 6:
-#line 85 "tiger.grm"
-    {(yyval.exp)=A_SeqExp(EM_tokPos,(yyvsp[(2) - (3)].expList));}
-    break;
-
-  case 7:
-#line 86 "tiger.grm"
-    {(yyval.exp)=A_NilExp(EM_tokPos);}
+  case 2: /* program: exp  */
+#line 88 "tiger.grm"
+                    {*absyn_root=(yyvsp[0].exp);}
+#line 1459 "y.tab.c"
     break;
 
-  case 8:
-#line 87 "tiger.grm"
-    {(yyval.exp)=A_IntExp(EM_tokPos,(yyvsp[(1) - (1)].ival));}
+  case 4: /* exp: lvalue  */
+#line 93 "tiger.grm"
+                       {(yyval.exp)=A_VarExp(EM_tokPos,(yyvsp[0].var));}
+#line 1465 "y.tab.c"
     break;
 
-  case 9:
-#line 88 "tiger.grm"
-    {(yyval.exp)=A_StringExp(EM_tokPos,(yyvsp[(1) - (1)].sval));}
+  case 5: /* exp: lvalue ASSIGN exp  */
+#line 94 "tiger.grm"
+                                  {(yyval.exp)=A_AssignExp(EM_tokPos,(yyvsp[-2].var),(yyvsp[0].exp));}
+#line 1471 "y.tab.c"
     break;
 
-  case 10:
-#line 89 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_minusOp,A_IntExp(EM_tokPos,0),(yyvsp[(2) - (2)].exp));}
+  case 6: /* exp: LPAREN exp_list_empty RPAREN  */
+#line 95 "tiger.grm"
+                                             {(yyval.exp)=A_SeqExp(EM_tokPos,(yyvsp[-1].expList));}
+#line 1477 "y.tab.c"
     break;
 
-  case 17:
+  case 7: /* exp: NIL  */
 #line 96 "tiger.grm"
-    {(yyval.exp)=A_BreakExp(EM_tokPos);}
+                    {(yyval.exp)=A_NilExp(EM_tokPos);}
+#line 1483 "y.tab.c"
     break;
 
-  case 19:
-#line 101 "tiger.grm"
-    {(yyval.exp)=A_LetExp(EM_tokPos,(yyvsp[(2) - (5)].declList),A_SeqExp(EM_tokPos,(yyvsp[(4) - (5)].expList)));}
+  case 8: /* exp: INT  */
+#line 97 "tiger.grm"
+                    {(yyval.exp)=A_IntExp(EM_tokPos,(yyvsp[0].ival));}
+#line 1489 "y.tab.c"
     break;
 
-  case 20:
-#line 105 "tiger.grm"
-    {(yyval.declList)=A_DecList((yyvsp[(1) - (2)].dec),(yyvsp[(2) - (2)].declList));}
+  case 9: /* exp: STRING  */
+#line 98 "tiger.grm"
+                       {(yyval.exp)=A_StringExp(EM_tokPos,(yyvsp[0].sval));}
+#line 1495 "y.tab.c"
     break;
 
-  case 21:
-#line 106 "tiger.grm"
-    {(yyval.declList)=(yyvsp[(2) - (2)].declList);}
+  case 10: /* exp: MINUS exp  */
+#line 99 "tiger.grm"
+                                       {(yyval.exp)=A_OpExp(EM_tokPos,A_minusOp,A_IntExp(EM_tokPos,0),(yyvsp[0].exp));}
+#line 1501 "y.tab.c"
     break;
 
-  case 22:
-#line 107 "tiger.grm"
-    {(yyval.declList)=NULL;}
+  case 17: /* exp: BREAK  */
+#line 106 "tiger.grm"
+                      {(yyval.exp)=A_BreakExp(EM_tokPos);}
+#line 1507 "y.tab.c"
     break;
 
-  case 24:
+  case 19: /* let: LET decl_list IN exp_list END  */
 #line 111 "tiger.grm"
-    {(yyval.expList)=NULL;}
+                                              {(yyval.exp)=A_LetExp(EM_tokPos,(yyvsp[-3].declList),A_SeqExp(EM_tokPos,(yyvsp[-1].expList)));}
+#line 1513 "y.tab.c"
     break;
 
-  case 25:
+  case 20: /* decl_list: decl decl_list  */
 #line 115 "tiger.grm"
-    {(yyval.expList)=A_ExpList((yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].expList));}
+                               {(yyval.declList)=A_DecList((yyvsp[-1].dec),(yyvsp[0].declList));}
+#line 1519 "y.tab.c"
     break;
 
-  case 26:
+  case 21: /* decl_list: error decl_list  */
 #line 116 "tiger.grm"
-    {(yyval.expList)=(yyvsp[(3) - (3)].expList);}
+                                                                          {(yyval.declList)=(yyvsp[0].declList);}
+#line 1525 "y.tab.c"
     break;
 
-  case 27:
+  case 22: /* decl_list: %empty  */
 #line 117 "tiger.grm"
-    {(yyval.expList)=A_ExpList((yyvsp[(1) - (1)].exp),NULL);}
+          {(yyval.declList)=NULL;}
+#line 1531 "y.tab.c"
     break;
 
-  case 28:
+  case 24: /* exp_list_empty: %empty  */
 #line 121 "tiger.grm"
-    {(yyval.dec)=A_TypeDec(EM_tokPos,(yyvsp[(1) - (1)].nameTyList));}
+          {(yyval.expList)=NULL;}
+#line 1537 "y.tab.c"
     break;
 
-  case 30:
-#line 123 "tiger.grm"
-    {(yyval.dec)=A_FunctionDec(EM_tokPos,(yyvsp[(1) - (1)].fundecList));}
+  case 25: /* exp_list: exp SEMICOLON exp_list  */
+#line 125 "tiger.grm"
+                                       {(yyval.expList)=A_ExpList((yyvsp[-2].exp),(yyvsp[0].expList));}
+#line 1543 "y.tab.c"
     break;
 
-  case 31:
-#line 127 "tiger.grm"
-    {(yyval.nameTyList)=A_NametyList((yyvsp[(1) - (2)].nameTy),(yyvsp[(2) - (2)].nameTyList));}
+  case 26: /* exp_list: error SEMICOLON exp_list  */
+#line 126 "tiger.grm"
+                                                                                   {(yyval.expList)=(yyvsp[0].expList);}
+#line 1549 "y.tab.c"
     break;
 
-  case 32:
-#line 128 "tiger.grm"
-    {(yyval.nameTyList)=A_NametyList((yyvsp[(1) - (1)].nameTy),NULL);}
+  case 27: /* exp_list: exp  */
+#line 127 "tiger.grm"
+                                       {(yyval.expList)=A_ExpList((yyvsp[0].exp),NULL);}
+#line 1555 "y.tab.c"
     break;
 
-  case 33:
+  case 28: /* decl: type_decl_list  */
 #line 131 "tiger.grm"
-    {(yyval.nameTy)=A_Namety(S_Symbol((yyvsp[(2) - (4)].sval)),(yyvsp[(4) - (4)].ty));}
+                                                       {(yyval.dec)=A_TypeDec(EM_tokPos,(yyvsp[0].nameTyList));}
+#line 1561 "y.tab.c"
     break;
 
-  case 34:
-#line 134 "tiger.grm"
-    {(yyval.ty)=A_NameTy(EM_tokPos,S_Symbol((yyvsp[(1) - (1)].sval)));}
+  case 30: /* decl: function_decl_list  */
+#line 133 "tiger.grm"
+                                                               {(yyval.dec)=A_FunctionDec(EM_tokPos,(yyvsp[0].fundecList));}
+#line 1567 "y.tab.c"
     break;
 
-  case 35:
-#line 135 "tiger.grm"
-    {(yyval.ty)=A_RecordTy(EM_tokPos,(yyvsp[(2) - (3)].fieldList));}
+  case 31: /* type_decl_list: type_decl type_decl_list  */
+#line 137 "tiger.grm"
+                                         {(yyval.nameTyList)=A_NametyList((yyvsp[-1].nameTy),(yyvsp[0].nameTyList));}
+#line 1573 "y.tab.c"
     break;
 
-  case 36:
-#line 136 "tiger.grm"
-    {(yyval.ty)=A_ArrayTy(EM_tokPos,S_Symbol((yyvsp[(3) - (3)].sval)));}
+  case 32: /* type_decl_list: type_decl  */
+#line 138 "tiger.grm"
+                          {(yyval.nameTyList)=A_NametyList((yyvsp[0].nameTy),NULL);}
+#line 1579 "y.tab.c"
     break;
 
-  case 37:
-#line 140 "tiger.grm"
-    {(yyval.fieldList)=A_FieldList(A_Field(EM_tokPos,S_Symbol((yyvsp[(1) - (5)].sval)),S_Symbol((yyvsp[(3) - (5)].sval))),(yyvsp[(5) - (5)].fieldList));}
+  case 33: /* type_decl: TYPE ID EQ type_id  */
+#line 141 "tiger.grm"
+                                   {(yyval.nameTy)=A_Namety(S_Symbol((yyvsp[-2].sval)),(yyvsp[0].ty));}
+#line 1585 "y.tab.c"
     break;
 
-  case 38:
-#line 141 "tiger.grm"
-    {(yyval.fieldList)=A_FieldList(A_Field(EM_tokPos,S_Symbol((yyvsp[(1) - (3)].sval)),S_Symbol((yyvsp[(3) - (3)].sval))),NULL);}
+  case 34: /* type_id: ID  */
+#line 144 "tiger.grm"
+                   {(yyval.ty)=A_NameTy(EM_tokPos,S_Symbol((yyvsp[0].sval)));}
+#line 1591 "y.tab.c"
     break;
 
-  case 39:
+  case 35: /* type_id: LBRACE fields RBRACE  */
 #line 145 "tiger.grm"
-    {(yyval.dec)=A_VarDec(EM_tokPos,S_Symbol((yyvsp[(2) - (4)].sval)),NULL,(yyvsp[(4) - (4)].exp));}
+                                     {(yyval.ty)=A_RecordTy(EM_tokPos,(yyvsp[-1].fieldList));}
+#line 1597 "y.tab.c"
     break;
 
-  case 40:
+  case 36: /* type_id: ARRAY OF ID  */
 #line 146 "tiger.grm"
-    {(yyval.dec)=A_VarDec(EM_tokPos,S_Symbol((yyvsp[(2) - (6)].sval)),S_Symbol((yyvsp[(4) - (6)].sval)),(yyvsp[(6) - (6)].exp));}
+                            {(yyval.ty)=A_ArrayTy(EM_tokPos,S_Symbol((yyvsp[0].sval)));}
+#line 1603 "y.tab.c"
     break;
 
-  case 41:
+  case 37: /* fields: ID COLON ID COMMA fields  */
 #line 150 "tiger.grm"
-    {(yyval.fundecList)=A_FundecList((yyvsp[(1) - (2)].fundec),(yyvsp[(2) - (2)].fundecList));}
+                                         {(yyval.fieldList)=A_FieldList(A_Field(EM_tokPos,S_Symbol((yyvsp[-4].sval)),S_Symbol((yyvsp[-2].sval))),(yyvsp[0].fieldList));}
+#line 1609 "y.tab.c"
     break;
 
-  case 42:
+  case 38: /* fields: ID COLON ID  */
 #line 151 "tiger.grm"
-    {(yyval.fundecList)=A_FundecList((yyvsp[(1) - (1)].fundec),NULL);}
+                            {(yyval.fieldList)=A_FieldList(A_Field(EM_tokPos,S_Symbol((yyvsp[-2].sval)),S_Symbol((yyvsp[0].sval))),NULL);}
+#line 1615 "y.tab.c"
     break;
 
-  case 43:
+  case 39: /* var_decl: VAR ID ASSIGN exp  */
 #line 155 "tiger.grm"
-    {(yyval.fundec)=A_Fundec(EM_tokPos,S_Symbol((yyvsp[(2) - (9)].sval)),(yyvsp[(4) - (9)].fieldList),S_Symbol((yyvsp[(7) - (9)].sval)),(yyvsp[(9) - (9)].exp));}
+                                  {(yyval.dec)=A_VarDec(EM_tokPos,S_Symbol((yyvsp[-2].sval)),NULL,(yyvsp[0].exp));}
+#line 1621 "y.tab.c"
     break;
 
-  case 44:
+  case 40: /* var_decl: VAR ID COLON ID ASSIGN exp  */
 #line 156 "tiger.grm"
-    {
-            (yyval.fundec) = A_Fundec(EM_tokPos, S_Symbol((yyvsp[(2) - (7)].sval)), (yyvsp[(4) - (7)].fieldList), NULL, (yyvsp[(7) - (7)].exp));
-                }
+                                           {(yyval.dec)=A_VarDec(EM_tokPos,S_Symbol((yyvsp[-4].sval)),S_Symbol((yyvsp[-2].sval)),(yyvsp[0].exp));}
+#line 1627 "y.tab.c"
     break;
 
-  case 46:
-#line 163 "tiger.grm"
-    {(yyval.fieldList)=NULL;}
+  case 41: /* function_decl_list: function_decl function_decl_list  */
+#line 160 "tiger.grm"
+                                                 {(yyval.fundecList)=A_FundecList((yyvsp[-1].fundec),(yyvsp[0].fundecList));}
+#line 1633 "y.tab.c"
     break;
 
-  case 47:
-#line 168 "tiger.grm"
-    {(yyval.fieldList)=A_FieldList(A_Field(EM_tokPos,S_Symbol((yyvsp[(1) - (5)].sval)),S_Symbol((yyvsp[(3) - (5)].sval))),(yyvsp[(5) - (5)].fieldList));}
+  case 42: /* function_decl_list: function_decl  */
+#line 161 "tiger.grm"
+                              {(yyval.fundecList)=A_FundecList((yyvsp[0].fundec),NULL);}
+#line 1639 "y.tab.c"
     break;
 
-  case 48:
-#line 169 "tiger.grm"
-    {(yyval.fieldList)=A_FieldList(A_Field(EM_tokPos,S_Symbol((yyvsp[(1) - (3)].sval)),S_Symbol((yyvsp[(3) - (3)].sval))), NULL);}
+  case 43: /* function_decl: FUNCTION ID LPAREN function_args RPAREN COLON ID EQ exp  */
+#line 165 "tiger.grm"
+                                                                        {(yyval.fundec)=A_Fundec(EM_tokPos,S_Symbol((yyvsp[-7].sval)),(yyvsp[-5].fieldList),S_Symbol((yyvsp[-2].sval)),(yyvsp[0].exp));}
+#line 1645 "y.tab.c"
+    break;
+
+  case 44: /* function_decl: FUNCTION ID LPAREN function_args RPAREN EQ exp  */
+#line 166 "tiger.grm"
+                                                                                     {
+            (yyval.fundec) = A_Fundec(EM_tokPos, S_Symbol((yyvsp[-5].sval)), (yyvsp[-3].fieldList), NULL, (yyvsp[0].exp));
+                }
+#line 1653 "y.tab.c"
     break;
 
-  case 49:
+  case 46: /* function_args: %empty  */
 #line 173 "tiger.grm"
-    {(yyval.var)=A_SimpleVar(EM_tokPos,S_Symbol((yyvsp[(1) - (1)].sval)));}
+          {(yyval.fieldList)=NULL;}
+#line 1659 "y.tab.c"
     break;
 
-  case 50:
-#line 174 "tiger.grm"
-    {(yyval.var)=A_SubscriptVar(EM_tokPos,A_SimpleVar(EM_tokPos,S_Symbol((yyvsp[(1) - (4)].sval))),(yyvsp[(3) - (4)].exp));}
+  case 47: /* function_args_list: ID COLON ID COMMA function_args_list  */
+#line 178 "tiger.grm"
+                                                     {(yyval.fieldList)=A_FieldList(A_Field(EM_tokPos,S_Symbol((yyvsp[-4].sval)),S_Symbol((yyvsp[-2].sval))),(yyvsp[0].fieldList));}
+#line 1665 "y.tab.c"
     break;
 
-  case 52:
+  case 48: /* function_args_list: ID COLON ID  */
 #line 179 "tiger.grm"
-    {(yyval.var)=A_FieldVar(EM_tokPos,(yyvsp[(1) - (3)].var),S_Symbol((yyvsp[(3) - (3)].sval)));}
+                            {(yyval.fieldList)=A_FieldList(A_Field(EM_tokPos,S_Symbol((yyvsp[-2].sval)),S_Symbol((yyvsp[0].sval))), NULL);}
+#line 1671 "y.tab.c"
     break;
 
-  case 53:
-#line 180 "tiger.grm"
-    {(yyval.var)=A_SubscriptVar(EM_tokPos,(yyvsp[(1) - (4)].var),(yyvsp[(3) - (4)].exp));}
+  case 49: /* lvalue: ID  */
+#line 183 "tiger.grm"
+                   {(yyval.var)=A_SimpleVar(EM_tokPos,S_Symbol((yyvsp[0].sval)));}
+#line 1677 "y.tab.c"
     break;
 
-  case 54:
+  case 50: /* lvalue: ID LBRACK exp RBRACK  */
 #line 184 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_plusOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+                                     {(yyval.var)=A_SubscriptVar(EM_tokPos,A_SimpleVar(EM_tokPos,S_Symbol((yyvsp[-3].sval))),(yyvsp[-1].exp));}
+#line 1683 "y.tab.c"
     break;
 
-  case 55:
-#line 185 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_minusOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+  case 52: /* lvalue_not_id: lvalue DOT ID  */
+#line 189 "tiger.grm"
+                                                          {(yyval.var)=A_FieldVar(EM_tokPos,(yyvsp[-2].var),S_Symbol((yyvsp[0].sval)));}
+#line 1689 "y.tab.c"
     break;
 
-  case 56:
-#line 186 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_timesOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+  case 53: /* lvalue_not_id: lvalue_not_id LBRACK exp RBRACK  */
+#line 190 "tiger.grm"
+                                                {(yyval.var)=A_SubscriptVar(EM_tokPos,(yyvsp[-3].var),(yyvsp[-1].exp));}
+#line 1695 "y.tab.c"
     break;
 
-  case 57:
-#line 187 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_divideOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+  case 54: /* bin_op: exp PLUS exp  */
+#line 194 "tiger.grm"
+                             {(yyval.exp)=A_OpExp(EM_tokPos,A_plusOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1701 "y.tab.c"
     break;
 
-  case 58:
-#line 188 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_eqOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+  case 55: /* bin_op: exp MINUS exp  */
+#line 195 "tiger.grm"
+                              {(yyval.exp)=A_OpExp(EM_tokPos,A_minusOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1707 "y.tab.c"
     break;
 
-  case 59:
-#line 189 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_neqOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+  case 56: /* bin_op: exp TIMES exp  */
+#line 196 "tiger.grm"
+                              {(yyval.exp)=A_OpExp(EM_tokPos,A_timesOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1713 "y.tab.c"
     break;
 
-  case 60:
-#line 190 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_ltOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+  case 57: /* bin_op: exp DIVIDE exp  */
+#line 197 "tiger.grm"
+                               {(yyval.exp)=A_OpExp(EM_tokPos,A_divideOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1719 "y.tab.c"
     break;
 
-  case 61:
-#line 191 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_gtOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+  case 58: /* bin_op: exp EQ exp  */
+#line 198 "tiger.grm"
+                           {(yyval.exp)=A_OpExp(EM_tokPos,A_eqOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1725 "y.tab.c"
     break;
 
-  case 62:
-#line 192 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_leOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+  case 59: /* bin_op: exp NEQ exp  */
+#line 199 "tiger.grm"
+                            {(yyval.exp)=A_OpExp(EM_tokPos,A_neqOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1731 "y.tab.c"
     break;
 
-  case 63:
-#line 193 "tiger.grm"
-    {(yyval.exp)=A_OpExp(EM_tokPos,A_geOp,(yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].exp));}
+  case 60: /* bin_op: exp LT exp  */
+#line 200 "tiger.grm"
+                           {(yyval.exp)=A_OpExp(EM_tokPos,A_ltOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1737 "y.tab.c"
     break;
 
-  case 64:
-#line 194 "tiger.grm"
-    {
+  case 61: /* bin_op: exp GT exp  */
+#line 201 "tiger.grm"
+                           {(yyval.exp)=A_OpExp(EM_tokPos,A_gtOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1743 "y.tab.c"
+    break;
+
+  case 62: /* bin_op: exp LE exp  */
+#line 202 "tiger.grm"
+                           {(yyval.exp)=A_OpExp(EM_tokPos,A_leOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1749 "y.tab.c"
+    break;
+
+  case 63: /* bin_op: exp GE exp  */
+#line 203 "tiger.grm"
+                           {(yyval.exp)=A_OpExp(EM_tokPos,A_geOp,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1755 "y.tab.c"
+    break;
+
+  case 64: /* bin_op: exp AND exp  */
+#line 204 "tiger.grm"
+                            {
             /*
              * If the first condition is true, we evaluate the truthiness of the second condition.
              * Otherwise, return false.
              */
-            (yyval.exp) = A_IfExp(EM_tokPos, (yyvsp[(1) - (3)].exp), (yyvsp[(3) - (3)].exp), A_IntExp(EM_tokPos, 0));
+            (yyval.exp) = A_IfExp(EM_tokPos, (yyvsp[-2].exp), (yyvsp[0].exp), A_IntExp(EM_tokPos, 0));
                 }
+#line 1767 "y.tab.c"
     break;
 
-  case 65:
-#line 201 "tiger.grm"
-    {
+  case 65: /* bin_op: exp OR exp  */
+#line 211 "tiger.grm"
+                           {
             /*
              * Similarly, if the first condition is true, we return true. Otherwise, evaluate and
              * return the truthiness of the second condition.
              */
-            (yyval.exp) = A_IfExp(EM_tokPos, (yyvsp[(1) - (3)].exp), A_IntExp(EM_tokPos, 1), (yyvsp[(3) - (3)].exp));
+            (yyval.exp) = A_IfExp(EM_tokPos, (yyvsp[-2].exp), A_IntExp(EM_tokPos, 1), (yyvsp[0].exp));
                 }
+#line 1779 "y.tab.c"
     break;
 
-  case 66:
-#line 211 "tiger.grm"
-    {(yyval.exp)=A_RecordExp(EM_tokPos,S_Symbol((yyvsp[(1) - (4)].sval)),(yyvsp[(3) - (4)].efieldList));}
+  case 66: /* record: ID LBRACE record_args RBRACE  */
+#line 221 "tiger.grm"
+                                             {(yyval.exp)=A_RecordExp(EM_tokPos,S_Symbol((yyvsp[-3].sval)),(yyvsp[-1].efieldList));}
+#line 1785 "y.tab.c"
     break;
 
-  case 67:
-#line 215 "tiger.grm"
-    {(yyval.efieldList)=A_EfieldList(A_Efield(S_Symbol((yyvsp[(1) - (5)].sval)),(yyvsp[(3) - (5)].exp)),(yyvsp[(5) - (5)].efieldList));}
+  case 67: /* record_args: ID EQ exp COMMA record_args  */
+#line 225 "tiger.grm"
+                                            {(yyval.efieldList)=A_EfieldList(A_Efield(S_Symbol((yyvsp[-4].sval)),(yyvsp[-2].exp)),(yyvsp[0].efieldList));}
+#line 1791 "y.tab.c"
     break;
 
-  case 68:
-#line 216 "tiger.grm"
-    {(yyval.efieldList)=A_EfieldList(A_Efield(S_Symbol((yyvsp[(1) - (3)].sval)),(yyvsp[(3) - (3)].exp)),NULL);}
+  case 68: /* record_args: ID EQ exp  */
+#line 226 "tiger.grm"
+                          {(yyval.efieldList)=A_EfieldList(A_Efield(S_Symbol((yyvsp[-2].sval)),(yyvsp[0].exp)),NULL);}
+#line 1797 "y.tab.c"
     break;
 
-  case 69:
-#line 220 "tiger.grm"
-    {(yyval.exp)=A_ArrayExp(EM_tokPos,S_Symbol((yyvsp[(1) - (6)].sval)),(yyvsp[(3) - (6)].exp),(yyvsp[(6) - (6)].exp));}
+  case 69: /* array: ID LBRACK exp RBRACK OF exp  */
+#line 230 "tiger.grm"
+                                            {(yyval.exp)=A_ArrayExp(EM_tokPos,S_Symbol((yyvsp[-5].sval)),(yyvsp[-3].exp),(yyvsp[0].exp));}
+#line 1803 "y.tab.c"
     break;
 
-  case 70:
-#line 223 "tiger.grm"
-    {(yyval.exp)=A_IfExp(EM_tokPos,(yyvsp[(2) - (4)].exp),(yyvsp[(4) - (4)].exp),NULL);}
+  case 70: /* if_exp: IF exp THEN exp  */
+#line 233 "tiger.grm"
+                                {(yyval.exp)=A_IfExp(EM_tokPos,(yyvsp[-2].exp),(yyvsp[0].exp),NULL);}
+#line 1809 "y.tab.c"
     break;
 
-  case 71:
-#line 224 "tiger.grm"
-    {(yyval.exp)=A_IfExp(EM_tokPos,(yyvsp[(2) - (6)].exp),(yyvsp[(4) - (6)].exp),(yyvsp[(6) - (6)].exp));}
+  case 71: /* if_exp: IF exp THEN exp ELSE exp  */
+#line 234 "tiger.grm"
+                                         {(yyval.exp)=A_IfExp(EM_tokPos,(yyvsp[-4].exp),(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1815 "y.tab.c"
     break;
 
-  case 72:
-#line 228 "tiger.grm"
-    {(yyval.exp)=A_WhileExp(EM_tokPos,(yyvsp[(2) - (4)].exp),(yyvsp[(4) - (4)].exp));}
+  case 72: /* while_loop: WHILE exp DO exp  */
+#line 238 "tiger.grm"
+                                 {(yyval.exp)=A_WhileExp(EM_tokPos,(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1821 "y.tab.c"
     break;
 
-  case 73:
-#line 232 "tiger.grm"
-    {(yyval.exp)=A_ForExp(EM_tokPos,S_Symbol((yyvsp[(2) - (8)].sval)),(yyvsp[(4) - (8)].exp),(yyvsp[(6) - (8)].exp),(yyvsp[(8) - (8)].exp));}
+  case 73: /* for_loop: FOR ID ASSIGN exp TO exp DO exp  */
+#line 242 "tiger.grm"
+                                                {(yyval.exp)=A_ForExp(EM_tokPos,S_Symbol((yyvsp[-6].sval)),(yyvsp[-4].exp),(yyvsp[-2].exp),(yyvsp[0].exp));}
+#line 1827 "y.tab.c"
     break;
 
-  case 74:
-#line 236 "tiger.grm"
-    {
-            (yyval.exp) = A_CallExp(EM_tokPos, S_Symbol((yyvsp[(1) - (4)].sval)), (yyvsp[(3) - (4)].expList));
+  case 74: /* function_call: ID LPAREN function_call_args RPAREN  */
+#line 246 "tiger.grm"
+                                                                          {
+            (yyval.exp) = A_CallExp(EM_tokPos, S_Symbol((yyvsp[-3].sval)), (yyvsp[-1].expList));
                 }
+#line 1835 "y.tab.c"
     break;
 
-  case 75:
-#line 239 "tiger.grm"
-    {
-            (yyval.exp) = A_CallExp(EM_tokPos, S_Symbol((yyvsp[(1) - (3)].sval)), NULL);
+  case 75: /* function_call: ID LPAREN RPAREN  */
+#line 249 "tiger.grm"
+                                                          {
+            (yyval.exp) = A_CallExp(EM_tokPos, S_Symbol((yyvsp[-2].sval)), NULL);
                 }
+#line 1843 "y.tab.c"
     break;
 
-  case 76:
-#line 246 "tiger.grm"
-    {(yyval.expList)=A_ExpList((yyvsp[(1) - (3)].exp),(yyvsp[(3) - (3)].expList));}
+  case 76: /* function_call_args: exp COMMA function_call_args  */
+#line 256 "tiger.grm"
+                                             {(yyval.expList)=A_ExpList((yyvsp[-2].exp),(yyvsp[0].expList));}
+#line 1849 "y.tab.c"
     break;
 
-  case 77:
-#line 247 "tiger.grm"
-    {(yyval.expList)=A_ExpList((yyvsp[(1) - (1)].exp),NULL);}
+  case 77: /* function_call_args: exp  */
+#line 257 "tiger.grm"
+                    {(yyval.expList)=A_ExpList((yyvsp[0].exp),NULL);}
+#line 1855 "y.tab.c"
     break;
 
 
-/* Line 1267 of yacc.c.  */
-#line 1943 "y.tab.c"
+#line 1859 "y.tab.c"
+
       default: break;
     }
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (YY_("syntax error"));
-#else
-      {
-	YYSIZE_T yysize = yysyntax_error (0, yystate, yychar);
-	if (yymsg_alloc < yysize && yymsg_alloc < YYSTACK_ALLOC_MAXIMUM)
-	  {
-	    YYSIZE_T yyalloc = 2 * yysize;
-	    if (! (yysize <= yyalloc && yyalloc <= YYSTACK_ALLOC_MAXIMUM))
-	      yyalloc = YYSTACK_ALLOC_MAXIMUM;
-	    if (yymsg != yymsgbuf)
-	      YYSTACK_FREE (yymsg);
-	    yymsg = (char *) YYSTACK_ALLOC (yyalloc);
-	    if (yymsg)
-	      yymsg_alloc = yyalloc;
-	    else
-	      {
-		yymsg = yymsgbuf;
-		yymsg_alloc = sizeof yymsgbuf;
-	      }
-	  }
-
-	if (0 < yysize && yysize <= yymsg_alloc)
-	  {
-	    (void) yysyntax_error (yymsg, yystate, yychar);
-	    yyerror (yymsg);
-	  }
-	else
-	  {
-	    yyerror (YY_("syntax error"));
-	    if (yysize != 0)
-	      goto yyexhaustedlab;
-	  }
-      }
-#endif
+      yyerror (absyn_root, YY_("syntax error"));
     }
 
-
-
   if (yyerrstatus == 3)
     {
-      /* If just tried and failed to reuse look-ahead token after an
-	 error, discard it.  */
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, absyn_root);
+          yychar = YYEMPTY;
+        }
     }
 
-  /* Else will try to reuse look-ahead token after shifting the error
+  /* Else will try to reuse lookahead token after shifting the error
      token.  */
   goto yyerrlab1;
 
@@ -2041,14 +1933,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -2061,42 +1952,42 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
-      if (yyn != YYPACT_NINF)
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, absyn_root);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
     }
 
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2107,50 +1998,53 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
-#ifndef yyoverflow
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (absyn_root, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
-  if (yychar != YYEOF && yychar != YYEMPTY)
-     yydestruct ("Cleanup: discarding lookahead",
-		 yytoken, &yylval);
-  /* Do not reclaim the symbols of the rule which action triggered
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, absyn_root);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, absyn_root);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
-
 
+  return yyresult;
+}
 
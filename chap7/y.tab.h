@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton interface for Bison's Yacc-like parsers in C
+/* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,59 +31,81 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Tokens.  */
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 1
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     ID = 258,
-     STRING = 259,
-     INT = 260,
-     COMMA = 261,
-     COLON = 262,
-     SEMICOLON = 263,
-     LPAREN = 264,
-     RPAREN = 265,
-     LBRACK = 266,
-     RBRACK = 267,
-     LBRACE = 268,
-     RBRACE = 269,
-     DOT = 270,
-     PLUS = 271,
-     MINUS = 272,
-     TIMES = 273,
-     DIVIDE = 274,
-     EQ = 275,
-     NEQ = 276,
-     LT = 277,
-     LE = 278,
-     GT = 279,
-     GE = 280,
-     AND = 281,
-     OR = 282,
-     ASSIGN = 283,
-     ARRAY = 284,
-     IF = 285,
-     THEN = 286,
-     ELSE = 287,
-     WHILE = 288,
-     FOR = 289,
-     TO = 290,
-     DO = 291,
-     LET = 292,
-     IN = 293,
-     END = 294,
-     OF = 295,
-     BREAK = 296,
-     NIL = 297,
-     FUNCTION = 298,
-     VAR = 299,
-     TYPE = 300,
-     UMINUS = 301
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    ID = 258,                      /* ID  */
+    STRING = 259,                  /* STRING  */
+    INT = 260,                     /* INT  */
+    COMMA = 261,                   /* COMMA  */
+    COLON = 262,                   /* COLON  */
+    SEMICOLON = 263,               /* SEMICOLON  */
+    LPAREN = 264,                  /* LPAREN  */
+    RPAREN = 265,                  /* RPAREN  */
+    LBRACK = 266,                  /* LBRACK  */
+    RBRACK = 267,                  /* RBRACK  */
+    LBRACE = 268,                  /* LBRACE  */
+    RBRACE = 269,                  /* RBRACE  */
+    DOT = 270,                     /* DOT  */
+    PLUS = 271,                    /* PLUS  */
+    MINUS = 272,                   /* MINUS  */
+    TIMES = 273,                   /* TIMES  */
+    DIVIDE = 274,                  /* DIVIDE  */
+    EQ = 275,                      /* EQ  */
+    NEQ = 276,                     /* NEQ  */
+    LT = 277,                      /* LT  */
+    LE = 278,                      /* LE  */
+    GT = 279,                      /* GT  */
+    GE = 280,                      /* GE  */
+    AND = 281,                     /* AND  */
+    OR = 282,                      /* OR  */
+    ASSIGN = 283,                  /* ASSIGN  */
+    ARRAY = 284,                   /* ARRAY  */
+    IF = 285,                      /* IF  */
+    THEN = 286,                    /* THEN  */
+    ELSE = 287,                    /* ELSE  */
+    WHILE = 288,                   /* WHILE  */
+    FOR = 289,                     /* FOR  */
+    TO = 290,                      /* TO  */
+    DO = 291,                      /* DO  */
+    LET = 292,                     /* LET  */
+    IN = 293,                      /* IN  */
+    END = 294,                     /* END  */
+    OF = 295,                      /* OF  */
+    BREAK = 296,                   /* BREAK  */
+    NIL = 297,                     /* NIL  */
+    FUNCTION = 298,                /* FUNCTION  */
+    VAR = 299,                     /* VAR  */
+    TYPE = 300,                    /* TYPE  */
+    UMINUS = 301                   /* UMINUS  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define ID 258
 #define STRING 259
 #define INT 260
@@ -131,13 +151,12 @@
 #define TYPE 300
 #define UMINUS 301
 
-
-
-
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 19 "tiger.grm"
+union YYSTYPE
 {
+#line 25 "tiger.grm"
+
 	int pos;
 	int ival;
 	string sval;
@@ -154,14 +173,20 @@ typedef union YYSTYPE
         A_fieldList fieldList;
         A_nametyList nameTyList;
 	/* et cetera */
-	}
-/* Line 1529 of yacc.c.  */
-#line 160 "y.tab.h"
-	YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
+	
+
+#line 179 "y.tab.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
-extern YYSTYPE yylval;
 
+
+
+int yyparse (A_exp *absyn_root);
+
+
+#endif /* !YY_YY_Y_TAB_H_INCLUDED  */
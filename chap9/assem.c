@@ -7,6 +7,7 @@
 #include <stdlib.h> /* for atoi */
 #include <string.h> /* for strcpy */
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "absyn.h"
 #include "temp.h"
@@ -16,13 +17,13 @@
 #include "errormsg.h"
 
 AS_targets AS_Targets(Temp_labelList labels) {
-  AS_targets p = checked_malloc(sizeof *p);
+  AS_targets p = AR_alloc(AR_assem, sizeof *p);
   p->labels = labels;
   return p;
 }
 
 AS_instr AS_Oper(string a, Temp_tempList d, Temp_tempList s, AS_targets j) {
-  AS_instr p = (AS_instr)checked_malloc(sizeof *p);
+  AS_instr p = (AS_instr)AR_alloc(AR_assem, sizeof *p);
   p->kind = I_OPER;
   p->u.OPER.assem = a;
   p->u.OPER.dst = d;
@@ -32,7 +33,7 @@ AS_instr AS_Oper(string a, Temp_tempList d, Temp_tempList s, AS_targets j) {
 }
 
 AS_instr AS_Label(string a, Temp_label label) {
-  AS_instr p = (AS_instr)checked_malloc(sizeof *p);
+  AS_instr p = (AS_instr)AR_alloc(AR_assem, sizeof *p);
   p->kind = I_LABEL;
   p->u.LABEL.assem = a;
   p->u.LABEL.label = label;
@@ -40,7 +41,7 @@ AS_instr AS_Label(string a, Temp_label label) {
 }
 
 AS_instr AS_Move(string a, Temp_tempList d, Temp_tempList s) {
-  AS_instr p = (AS_instr)checked_malloc(sizeof *p);
+  AS_instr p = (AS_instr)AR_alloc(AR_assem, sizeof *p);
   p->kind = I_MOVE;
   p->u.MOVE.assem = a;
   p->u.MOVE.dst = d;
@@ -49,7 +50,7 @@ AS_instr AS_Move(string a, Temp_tempList d, Temp_tempList s) {
 }
 
 AS_instrList AS_InstrList(AS_instr head, AS_instrList tail) {
-  AS_instrList p = (AS_instrList)checked_malloc(sizeof *p);
+  AS_instrList p = (AS_instrList)AR_alloc(AR_assem, sizeof *p);
   p->head = head;
   p->tail = tail;
   return p;
@@ -157,7 +158,7 @@ void AS_printInstrList(FILE *out, AS_instrList iList, Temp_map m) {
 }
 
 AS_proc AS_Proc(string p, AS_instrList b, string e) {
-  AS_proc proc = checked_malloc(sizeof(*proc));
+  AS_proc proc = AR_alloc(AR_assem, sizeof(*proc));
   proc->prolog = p;
   proc->body = b;
   proc->epilog = e;
@@ -0,0 +1,308 @@
+/*
+ * cache.c - Keep the results of compilations on disk, by what went in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "util.h"
+#include "context.h"
+#include "cache.h"
+
+/* What an entry starts with, before its status and the two lengths. A cache
+ * written in another format is not mistaken for this one. */
+#define MAGIC "tiger-cache-1"
+
+/* A temporary file this old was left behind by a compiler that died. */
+#define STALE_SECONDS 3600
+
+static struct CA_stats *stats(void) {
+  return CX_state(CX_cache, sizeof(struct CA_stats), NULL, NULL);
+}
+
+struct CA_stats CA_stats(void) { return *stats(); }
+
+void CA_countFunctions(int functions, int reused) {
+  stats()->functions += functions;
+  stats()->reused += reused;
+}
+
+/* SHA-256, as in FIPS 180-4 */
+
+typedef struct {
+  unsigned int h[8];
+  unsigned char block[64];
+  int used;
+  unsigned long long length;
+} sha256;
+
+static const unsigned int roundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void compress(sha256 *s) {
+  unsigned int w[64], v[8], t1, t2;
+  int i;
+  for (i = 0; i < 16; i++)
+    w[i] = (unsigned int)s->block[4 * i] << 24 | s->block[4 * i + 1] << 16 |
+           s->block[4 * i + 2] << 8 | s->block[4 * i + 3];
+  for (; i < 64; i++)
+    w[i] = (ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10)) +
+           w[i - 7] +
+           (ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3)) +
+           w[i - 16];
+  memcpy(v, s->h, sizeof(v));
+  for (i = 0; i < 64; i++) {
+    t1 = v[7] + (ROTR(v[4], 6) ^ ROTR(v[4], 11) ^ ROTR(v[4], 25)) +
+         ((v[4] & v[5]) ^ (~v[4] & v[6])) + roundConstants[i] + w[i];
+    t2 = (ROTR(v[0], 2) ^ ROTR(v[0], 13) ^ ROTR(v[0], 22)) +
+         ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+    memmove(v + 1, v, 7 * sizeof(v[0]));
+    v[4] += t1;
+    v[0] = t1 + t2;
+  }
+  for (i = 0; i < 8; i++)
+    s->h[i] += v[i];
+}
+
+static void shaStart(sha256 *s) {
+  static const unsigned int initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                          0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                          0x1f83d9ab, 0x5be0cd19};
+  memcpy(s->h, initial, sizeof(initial));
+  s->used = 0;
+  s->length = 0;
+}
+
+static void shaAdd(sha256 *s, const void *data, long len) {
+  const unsigned char *p = data;
+  s->length += len;
+  while (len > 0) {
+    int n = 64 - s->used < len ? 64 - s->used : len;
+    memcpy(s->block + s->used, p, n);
+    s->used += n;
+    p += n;
+    len -= n;
+    if (s->used == 64) {
+      compress(s);
+      s->used = 0;
+    }
+  }
+}
+
+/* Finish the hash and write it out in hex */
+static void shaEnd(sha256 *s, char hex[CA_KEY_SIZE]) {
+  unsigned long long bits = s->length * 8;
+  int i;
+  s->block[s->used++] = 0x80;
+  if (s->used > 56) {
+    memset(s->block + s->used, 0, 64 - s->used);
+    compress(s);
+    s->used = 0;
+  }
+  memset(s->block + s->used, 0, 56 - s->used);
+  for (i = 0; i < 8; i++)
+    s->block[56 + i] = bits >> (56 - 8 * i);
+  compress(s);
+  for (i = 0; i < 8; i++)
+    sprintf(hex + 8 * i, "%08x", s->h[i]);
+}
+
+/* The compiler's part of every key: the hash of its own executable, so that
+ * a rebuilt compiler never takes the results of another for its own. If the
+ * executable cannot be read, the time this file was compiled stands in. */
+static char version[CA_KEY_SIZE];
+
+static void hashExecutable(void) {
+  FILE *f = fopen("/proc/self/exe", "rb");
+  sha256 s;
+  char buf[1 << 16];
+  size_t n;
+  shaStart(&s);
+  if (f) {
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+      shaAdd(&s, buf, n);
+    fclose(f);
+  } else
+    shaAdd(&s, __DATE__ " " __TIME__, strlen(__DATE__ " " __TIME__));
+  shaEnd(&s, version);
+}
+
+void CA_key(char key[CA_KEY_SIZE], string options, string name,
+            const char *text, long len) {
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+  char length[32];
+  sha256 s;
+  pthread_once(&once, hashExecutable);
+  sprintf(length, "%ld", len);
+  /* Each part but the last ends in a null, so none can run into the next. */
+  shaStart(&s);
+  shaAdd(&s, version, strlen(version) + 1);
+  shaAdd(&s, options, strlen(options) + 1);
+  shaAdd(&s, name, strlen(name) + 1);
+  shaAdd(&s, length, strlen(length) + 1);
+  shaAdd(&s, text, len);
+  shaEnd(&s, key);
+}
+
+static string entryPath(string dir, string name) {
+  string path = checked_malloc(strlen(dir) + strlen(name) + 2);
+  sprintf(path, "%s/%s", dir, name);
+  return path;
+}
+
+/* Copy "size" bytes from "in" to "out"; tell if they were all there. */
+static bool copy(FILE *in, FILE *out, unsigned long size) {
+  char buf[1 << 16];
+  while (size > 0) {
+    size_t n = size < sizeof(buf) ? size : sizeof(buf);
+    if (fread(buf, 1, n, in) != n)
+      return FALSE;
+    fwrite(buf, 1, n, out);
+    size -= n;
+  }
+  return TRUE;
+}
+
+bool CA_lookup(string dir, string key, int *status, FILE *out,
+               FILE *errors) {
+  string path = entryPath(dir, key);
+  FILE *f = fopen(path, "rb");
+  struct stat st;
+  unsigned long asmSize, errSize;
+  int header;
+  bool found = FALSE;
+  free(path);
+  /* An entry is checked against its own size before any of it is used, so
+   * one that was cut short by a full disk is a miss, not a wrong answer. */
+  if (f && fstat(fileno(f), &st) == 0 &&
+      fscanf(f, MAGIC " %d %lu %lu%n", status, &asmSize, &errSize,
+             &header) == 3 &&
+      getc(f) == '\n' &&
+      (unsigned long)st.st_size == header + 1 + asmSize + errSize)
+    found = copy(f, out, asmSize) && copy(f, errors, errSize);
+  if (found)
+    futimens(fileno(f), NULL); /* it was used just now */
+  if (f)
+    fclose(f);
+  if (found)
+    stats()->hits++;
+  else
+    stats()->misses++;
+  return found;
+}
+
+typedef struct {
+  string name;
+  struct timespec used;
+  long size;
+} entry;
+
+static int leastRecent(const void *a, const void *b) {
+  const entry *x = a, *y = b;
+  if (x->used.tv_sec != y->used.tv_sec)
+    return x->used.tv_sec < y->used.tv_sec ? -1 : 1;
+  if (x->used.tv_nsec != y->used.tv_nsec)
+    return x->used.tv_nsec < y->used.tv_nsec ? -1 : 1;
+  return strcmp(x->name, y->name);
+}
+
+/* The entries used longest ago go first. Other compilers may be doing the
+ * same, so an entry that is already gone is no surprise. */
+void CA_trim(string dir, long maxBytes) {
+  DIR *d = opendir(dir);
+  struct dirent *de;
+  entry *entries = NULL;
+  int count = 0, capacity = 0, i;
+  long total = 0;
+  time_t now = time(NULL);
+  if (!d)
+    return;
+  while ((de = readdir(d))) {
+    string path;
+    struct stat st;
+    if (de->d_name[0] == '.')
+      continue;
+    path = entryPath(dir, de->d_name);
+    if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+      if (strncmp(de->d_name, "tmp.", 4) == 0) {
+        if (now - st.st_mtime > STALE_SECONDS)
+          unlink(path);
+      } else if (strlen(de->d_name) == CA_KEY_SIZE - 1) {
+        if (count == capacity) {
+          capacity = capacity ? 2 * capacity : 64;
+          entries = realloc(entries, capacity * sizeof(entry));
+          assert(entries);
+        }
+        entries[count].name = String(de->d_name);
+        entries[count].used = st.st_mtim;
+        entries[count].size = st.st_size;
+        total += st.st_size;
+        count++;
+      }
+    }
+    free(path);
+  }
+  closedir(d);
+  if (total > maxBytes)
+    qsort(entries, count, sizeof(entry), leastRecent);
+  for (i = 0; i < count; i++) {
+    if (total > maxBytes) {
+      string path = entryPath(dir, entries[i].name);
+      if (unlink(path) == 0)
+        stats()->evictions++;
+      total -= entries[i].size;
+      free(path);
+    }
+    free(entries[i].name);
+  }
+  free(entries);
+}
+
+void CA_store(string dir, string key, int status, const char *asmText,
+              size_t asmSize, const char *errText, size_t errSize) {
+  string temp = entryPath(dir, "tmp.XXXXXX"), path;
+  FILE *f;
+  int fd;
+  bool written;
+  if (mkdir(dir, 0777) < 0 && errno != EEXIST) {
+    free(temp);
+    return;
+  }
+  fd = mkstemp(temp);
+  if (fd < 0) {
+    free(temp);
+    return;
+  }
+  fchmod(fd, 0644);
+  f = fdopen(fd, "wb");
+  fprintf(f, MAGIC " %d %lu %lu\n", status, (unsigned long)asmSize,
+          (unsigned long)errSize);
+  fwrite(asmText, 1, asmSize, f);
+  fwrite(errText, 1, errSize, f);
+  path = entryPath(dir, key);
+  written = !ferror(f);
+  if (fclose(f) == 0 && written && rename(temp, path) == 0)
+    stats()->stores++;
+  else
+    unlink(temp);
+  free(path);
+  free(temp);
+}
@@ -0,0 +1,51 @@
+/*
+ * cache.h - Keep the results of compilations on disk, by what went in.
+ *
+ * An entry is named by a hash of everything the result depends on: the
+ * compiler itself (the bytes of its executable), the options that change
+ * the output, the file name the errors are reported under and the source.
+ * It holds the exit status, the assembly and the error messages, so that a
+ * hit stands for the whole compilation. Entries are written under another
+ * name and renamed into place, so that compilers sharing the directory
+ * never see half of one. An entry that is used again is touched, and once
+ * the directory grows past its bound the entries used longest ago go.
+ *
+ * The back end keeps the assembly of single functions in the same place,
+ * under keys of their own (fncache.h), so that a program that was edited
+ * only recompiles the functions that changed.
+ */
+
+#define CA_KEY_SIZE 65 /* hex digits of the hash, and a null */
+
+/* The key of compiling "text" ("len" bytes) under "name" with "options",
+ *  which must hold every option that changes the output. The back end
+ *  gives a name no file can have to the functions it keeps. */
+void CA_key(char key[CA_KEY_SIZE], string options, string name,
+            const char *text, long len);
+
+/* Find "key" in the cache in "dir". If it is there, write what it holds to
+ *  "out" and "errors", set "*status" and return TRUE. */
+bool CA_lookup(string dir, string key, int *status, FILE *out,
+               FILE *errors);
+
+/* Enter a result into the cache in "dir", creating the directory if need
+ *  be. A cache that cannot be written to is left alone. */
+void CA_store(string dir, string key, int status, const char *asmText,
+              size_t asmSize, const char *errText, size_t errSize);
+
+/* Evict what it takes to bring the cache in "dir" down to "maxBytes". This
+ *  looks at every entry, so it is done once a compilation is over rather
+ *  than after each store. */
+void CA_trim(string dir, long maxBytes);
+
+/* What the cache has done for the current context */
+struct CA_stats {
+  int hits, misses, stores, evictions;
+  int functions, reused; /* functions compiled, and those found cached */
+};
+struct CA_stats CA_stats(void);
+
+/* Count "functions" more functions compiled, "reused" of them from the
+ *  cache. Lookups of functions are made on other threads, in contexts of
+ *  their own, so they count in the hits and misses of those contexts. */
+void CA_countFunctions(int functions, int reused);
@@ -4,10 +4,12 @@
  */
 #include <stdio.h>
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "temp.h"
 #include "tree.h"
 #include "canon.h"
+#include "context.h"
 
 typedef struct expRefList_ *expRefList;
 struct expRefList_ {
@@ -22,7 +24,7 @@ static C_stmListList mkBlocks(T_stmList stms, Temp_label done);
 static T_stmList getNext(void);
 
 static expRefList ExpRefList(T_exp *head, expRefList tail) {
-  expRefList p = (expRefList)checked_malloc(sizeof *p);
+  expRefList p = (expRefList)AR_alloc(AR_canon, sizeof *p);
   p->head = head;
   p->tail = tail;
   return p;
@@ -161,7 +163,7 @@ static T_stmList linear(T_stm stm, T_stmList right) {
 T_stmList C_linearize(T_stm stm) { return linear(do_stm(stm), NULL); }
 
 static C_stmListList StmListList(T_stmList head, C_stmListList tail) {
-  C_stmListList p = (C_stmListList)checked_malloc(sizeof *p);
+  C_stmListList p = (C_stmListList)AR_alloc(AR_canon, sizeof *p);
   p->head = head;
   p->tail = tail;
   return p;
@@ -222,8 +224,15 @@ struct C_block C_basicBlocks(T_stmList stmList) {
   return b;
 }
 
-static S_table block_env;
-static struct C_block global_block;
+/* What the trace being scheduled in the current context has left */
+typedef struct {
+  S_table block_env;
+  struct C_block global_block;
+} traceState;
+
+static traceState *current(void) {
+  return CX_state(CX_canon, sizeof(traceState), NULL, NULL);
+}
 
 static T_stmList getLast(T_stmList list) {
   T_stmList last = list;
@@ -233,6 +242,7 @@ static T_stmList getLast(T_stmList list) {
 }
 
 static void trace(T_stmList list) {
+  S_table block_env = current()->block_env;
   T_stmList last = getLast(list);
   T_stm lab = list->head;
   T_stm s = last->tail->head;
@@ -271,15 +281,16 @@ static void trace(T_stmList list) {
 /* get the next block from the list of stmLists, using only those that have
  * not been traced yet */
 static T_stmList getNext() {
-  if (!global_block.stmLists)
-    return T_StmList(T_Label(global_block.label), NULL);
+  traceState *st = current();
+  if (!st->global_block.stmLists)
+    return T_StmList(T_Label(st->global_block.label), NULL);
   else {
-    T_stmList s = global_block.stmLists->head;
-    if (S_look(block_env, s->head->u.LABEL)) { /* label exists in the table */
+    T_stmList s = st->global_block.stmLists->head;
+    if (S_look(st->block_env, s->head->u.LABEL)) { /* label exists */
       trace(s);
       return s;
     } else {
-      global_block.stmLists = global_block.stmLists->tail;
+      st->global_block.stmLists = st->global_block.stmLists->tail;
       return getNext();
     }
   }
@@ -295,12 +306,13 @@ static T_stmList getNext() {
    as possible are eliminated by falling through into T.LABEL(lab).
 */
 T_stmList C_traceSchedule(struct C_block b) {
+  traceState *st = current();
   C_stmListList sList;
-  block_env = S_empty();
-  global_block = b;
+  st->block_env = S_empty();
+  st->global_block = b;
 
-  for (sList = global_block.stmLists; sList; sList = sList->tail) {
-    S_enter(block_env, sList->head->head->u.LABEL, sList->head);
+  for (sList = st->global_block.stmLists; sList; sList = sList->tail) {
+    S_enter(st->block_env, sList->head->head->u.LABEL, sList->head);
   }
 
   return getNext();
@@ -0,0 +1,213 @@
+/*
+ * client.c - Compile through the compile server, as tiger would.
+ *
+ *   tigerc [-linear] [-threads n] [-cache dir] [-cache-size mb] [-v]
+ *          [-time-report] [-mem-report] [-trace file] [-send] file.tig ...
+ *
+ * Each file is compiled by the server at $TIGER_SOCKET (or the default
+ * socket of "tiger -server") into file.tig.s, with the error messages on
+ * stderr and the exit status of tiger, so tigerc can stand in for it. The
+ * files go to the server as one batch over one connection. The server
+ * reads them itself unless -send is given, in which case they are sent
+ * along, for a server that cannot see them. If there is no server, or it
+ * goes away in the middle (as it does when the compiler crashes), tigerc
+ * runs $TIGER (or tiger) on the files left instead.
+ *
+ * It needs nothing else from the compiler:
+ *
+ *   cc -O2 -o tigerc client.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+static void writeField(FILE *out, const char *s, long len) {
+  fprintf(out, "%ld:", len);
+  fwrite(s, 1, len, out);
+}
+
+static char *readFile(const char *fname, long *len) {
+  FILE *f = fopen(fname, "rb");
+  char *text;
+  if (!f)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  *len = ftell(f);
+  rewind(f);
+  text = malloc(*len + 1);
+  if (!text || fread(text, 1, *len, f) != (size_t)*len) {
+    fclose(f);
+    free(text);
+    return NULL;
+  }
+  fclose(f);
+  return text;
+}
+
+/* "path" as seen from anywhere */
+static char *absolute(char *path) {
+  char cwd[4096], *s;
+  if (path[0] == '/' || !getcwd(cwd, sizeof(cwd)))
+    return path;
+  s = malloc(strlen(cwd) + strlen(path) + 2);
+  sprintf(s, "%s/%s", cwd, path);
+  return s;
+}
+
+static int connectTo(const char *path) {
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (fd < 0 || strlen(path) >= sizeof(addr.sun_path))
+    return -1;
+  strcpy(addr.sun_path, path);
+  if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/* Without a server: run the compiler on each file, with the same options. */
+static int runLocally(char **options, int optionCount, char **files,
+                      int fileCount) {
+  char *tiger = getenv("TIGER") ? getenv("TIGER") : "tiger";
+  char **argv = malloc((optionCount + 3) * sizeof(char *));
+  int i, status, worst = 0;
+  argv[0] = tiger;
+  memcpy(argv + 1, options, optionCount * sizeof(char *));
+  argv[optionCount + 2] = NULL;
+  for (i = 0; i < fileCount; i++) {
+    pid_t pid;
+    argv[optionCount + 1] = files[i];
+    pid = fork();
+    if (pid == 0) {
+      execvp(tiger, argv);
+      perror(tiger);
+      _exit(127);
+    }
+    if (pid < 0 || waitpid(pid, &status, 0) < 0)
+      status = 1;
+    else
+      status = WIFEXITED(status) ? WEXITSTATUS(status)
+                                 : 128 + WTERMSIG(status); /* as sh does */
+    if (status > worst)
+      worst = status;
+  }
+  free(argv);
+  return worst;
+}
+
+/* Send one request and handle its response; return the exit status, or -1
+ * if the server went away. */
+static int compileOne(FILE *in, FILE *out, char **options, int optionCount,
+                      const char *cwd, const char *fname, int send) {
+  char outfile[4096], *source = NULL, *text;
+  long len = 0;
+  unsigned long asmSize, errSize;
+  int i, status;
+  /* A file that cannot be read is left for the server to complain about. */
+  if (send)
+    source = readFile(fname, &len);
+  fprintf(out, "%d\n", optionCount + 3);
+  if (source) {
+    writeField(out, "-source", 7);
+    writeField(out, source, len);
+  } else {
+    writeField(out, "-C", 2);
+    writeField(out, cwd, strlen(cwd));
+  }
+  for (i = 0; i < optionCount; i++)
+    writeField(out, options[i], strlen(options[i]));
+  writeField(out, fname, strlen(fname));
+  fflush(out);
+  free(source);
+  if (fscanf(in, "%d %lu %lu", &status, &asmSize, &errSize) != 3 ||
+      getc(in) != '\n')
+    return -1;
+  text = malloc(asmSize + errSize + 1);
+  if (!text || fread(text, 1, asmSize + errSize, in) != asmSize + errSize) {
+    free(text);
+    return -1;
+  }
+  fwrite(text + asmSize, 1, errSize, stderr);
+  if (status == 0) {
+    FILE *s;
+    snprintf(outfile, sizeof(outfile), "%s.s", fname);
+    s = fopen(outfile, "w");
+    if (!s) {
+      perror(outfile);
+      status = 1;
+    } else {
+      fwrite(text, 1, asmSize, s);
+      fclose(s);
+    }
+  }
+  free(text);
+  return status;
+}
+
+int main(int argc, char **argv) {
+  char **options = malloc(argc * sizeof(char *)), cwd[4096];
+  int optionCount = 0, send = 0, fd, i, status, worst = 0;
+  FILE *in, *out;
+  char *socketPath = getenv("TIGER_SOCKET");
+  char defaultPath[64];
+  for (i = 1; i < argc - 1; i++)
+    if (!strcmp(argv[i], "-linear"))
+      options[optionCount++] = argv[i];
+    else if ((!strcmp(argv[i], "-threads") ||
+              !strcmp(argv[i], "-cache-size")) &&
+             i + 2 < argc) {
+      options[optionCount++] = argv[i++];
+      options[optionCount++] = argv[i];
+    } else if ((!strcmp(argv[i], "-cache") || !strcmp(argv[i], "-trace")) &&
+               i + 2 < argc) {
+      /* The server has a directory of its own. */
+      options[optionCount++] = argv[i++];
+      options[optionCount++] = absolute(argv[i]);
+    } else if (!strcmp(argv[i], "-v") || !strcmp(argv[i], "-time-report") ||
+               !strcmp(argv[i], "-mem-report"))
+      options[optionCount++] = argv[i];
+    else if (!strcmp(argv[i], "-send"))
+      send = 1;
+    else
+      break;
+  if (i >= argc) {
+    fprintf(stderr, "usage: tigerc [-linear] [-threads n] [-cache dir] [-v] "
+                    "[-time-report] [-mem-report] [-trace file] [-send] "
+                    "file.tig ...\n");
+    return 1;
+  }
+  if (!socketPath) { /* as SV_defaultSocket */
+    sprintf(defaultPath, "/tmp/tiger-%d.sock", (int)getuid());
+    socketPath = defaultPath;
+  }
+  fd = connectTo(socketPath);
+  if (fd < 0)
+    return runLocally(options, optionCount, argv + i, argc - i);
+  if (!getcwd(cwd, sizeof(cwd)))
+    strcpy(cwd, ".");
+  in = fdopen(fd, "r");
+  out = fdopen(dup(fd), "w");
+  signal(SIGPIPE, SIG_IGN);
+  for (; i < argc; i++) {
+    status = compileOne(in, out, options, optionCount, cwd, argv[i], send);
+    if (status < 0) {
+      status = runLocally(options, optionCount, argv + i, argc - i);
+      i = argc;
+    }
+    if (status > worst)
+      worst = status;
+  }
+  fclose(out);
+  fclose(in);
+  return worst;
+}
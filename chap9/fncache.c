@@ -0,0 +1,243 @@
+/*
+ * fncache.c - Key the back end of a function by what the function is.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include "util.h"
+#include "arena.h"
+#include "symbol.h"
+#include "table.h"
+#include "temp.h"
+#include "tree.h"
+#include "frame.h"
+#include "cache.h"
+#include "fncache.h"
+
+/* While a function is rewritten, it is also written down, node by node, in
+ * the order it is walked, which is the order the numbers are handed out in;
+ * the hash of that is the key. */
+typedef struct {
+  TAB_table temps;  /* the rewritten temp of each original */
+  TAB_table labels; /* the placeholder number of each original label */
+  int firstTemp;
+  Temp_label *originals, *placeholders;
+  int labelCount, labelCapacity;
+  char *buf;
+  int len, capacity;
+} rewriter;
+
+static void put(rewriter *w, const void *bytes, int len) {
+  if (!w->buf)
+    return;
+  if (w->len + len > w->capacity) {
+    while (w->len + len > w->capacity)
+      w->capacity *= 2;
+    w->buf = realloc(w->buf, w->capacity);
+    assert(w->buf);
+  }
+  memcpy(w->buf + w->len, bytes, len);
+  w->len += len;
+}
+
+static void putByte(rewriter *w, char c) { put(w, &c, 1); }
+
+static void putInt(rewriter *w, int i) { put(w, &i, sizeof(i)); }
+
+/* A register is written down by name, any other temp by its new number. */
+static void putTemp(rewriter *w, Temp_temp t) {
+  string reg = Temp_look(F_tempMap(), t);
+  if (reg) {
+    putByte(w, 'R');
+    put(w, reg, strlen(reg) + 1);
+  } else {
+    putByte(w, 'T');
+    putInt(w, Temp_num(t) - w->firstTemp);
+  }
+}
+
+static Temp_label *grow(Temp_label *old, int used, int capacity) {
+  Temp_label *grown = AR_alloc(AR_temp, capacity * sizeof(Temp_label));
+  memcpy(grown, old, used * sizeof(Temp_label));
+  return grown;
+}
+
+static Temp_temp temp(Temp_temp t, void *closure) {
+  rewriter *w = closure;
+  Temp_temp r;
+  if (Temp_look(F_tempMap(), t))
+    return t;
+  r = TAB_look(w->temps, t);
+  if (!r) {
+    r = Temp_newtemp();
+    TAB_enter(w->temps, t, r);
+  }
+  return r;
+}
+
+/* A label is written down by its placeholder number. */
+static Temp_label label(rewriter *w, Temp_label l) {
+  int n = (intptr_t)TAB_look(w->labels, l) - 1; /* entered one up */
+  if (n < 0) {
+    n = w->labelCount++;
+    if (n == w->labelCapacity) {
+      w->labelCapacity *= 2;
+      w->originals = grow(w->originals, n, w->labelCapacity);
+      w->placeholders = grow(w->placeholders, n, w->labelCapacity);
+    }
+    w->originals[n] = l;
+    w->placeholders[n] = Temp_newlabel();
+    TAB_enter(w->labels, l, (void *)(intptr_t)(n + 1));
+  }
+  putByte(w, 'L');
+  putInt(w, n);
+  return w->placeholders[n];
+}
+
+static T_exp rewriteExp(rewriter *w, T_exp e);
+
+static T_stm rewriteStm(rewriter *w, T_stm s) {
+  putByte(w, 's');
+  putByte(w, s->kind);
+  switch (s->kind) {
+  case T_SEQ: {
+    T_stm left = rewriteStm(w, s->u.SEQ.left);
+    return T_Seq(left, rewriteStm(w, s->u.SEQ.right));
+  }
+  case T_LABEL:
+    return T_Label(label(w, s->u.LABEL));
+  case T_JUMP: {
+    T_exp e = rewriteExp(w, s->u.JUMP.exp);
+    Temp_labelList p, jumps = NULL, *last = &jumps;
+    for (p = s->u.JUMP.jumps; p; p = p->tail) {
+      *last = Temp_LabelList(label(w, p->head), NULL);
+      last = &(*last)->tail;
+    }
+    putByte(w, ';');
+    return T_Jump(e, jumps);
+  }
+  case T_CJUMP: {
+    T_exp left, right;
+    Temp_label t, f;
+    putByte(w, s->u.CJUMP.op);
+    left = rewriteExp(w, s->u.CJUMP.left);
+    right = rewriteExp(w, s->u.CJUMP.right);
+    t = label(w, s->u.CJUMP.true);
+    f = label(w, s->u.CJUMP.false);
+    return T_Cjump(s->u.CJUMP.op, left, right, t, f);
+  }
+  case T_MOVE: {
+    T_exp dst = rewriteExp(w, s->u.MOVE.dst);
+    return T_Move(dst, rewriteExp(w, s->u.MOVE.src));
+  }
+  case T_EXP:
+    return T_Exp(rewriteExp(w, s->u.EXP));
+  }
+  assert(0);
+  return NULL;
+}
+
+static T_exp rewriteExp(rewriter *w, T_exp e) {
+  putByte(w, 'e');
+  putByte(w, e->kind);
+  switch (e->kind) {
+  case T_BINOP: {
+    T_exp left;
+    putByte(w, e->u.BINOP.op);
+    left = rewriteExp(w, e->u.BINOP.left);
+    return T_Binop(e->u.BINOP.op, left, rewriteExp(w, e->u.BINOP.right));
+  }
+  case T_MEM:
+    return T_Mem(rewriteExp(w, e->u.MEM));
+  case T_TEMP: {
+    Temp_temp t = temp(e->u.TEMP, w);
+    putTemp(w, t);
+    return T_Temp(t);
+  }
+  case T_ESEQ: {
+    T_stm s = rewriteStm(w, e->u.ESEQ.stm);
+    return T_Eseq(s, rewriteExp(w, e->u.ESEQ.exp));
+  }
+  case T_NAME:
+    return T_Name(label(w, e->u.NAME));
+  case T_CONST:
+    putInt(w, e->u.CONST);
+    return T_Const(e->u.CONST);
+  case T_CALL: {
+    T_exp fun = rewriteExp(w, e->u.CALL.fun);
+    T_expList p, args = NULL, *last = &args;
+    for (p = e->u.CALL.args; p; p = p->tail) {
+      *last = T_ExpList(rewriteExp(w, p->head), NULL);
+      last = &(*last)->tail;
+    }
+    putByte(w, ';');
+    return T_Call(fun, args);
+  }
+  }
+  assert(0);
+  return NULL;
+}
+
+FC_proc FC_rewrite(F_frame frame, T_stm body, string options) {
+  FC_proc p;
+  rewriter w;
+  F_accessList a;
+  w.temps = TAB_empty();
+  w.labels = TAB_empty();
+  w.firstTemp = Temp_count();
+  w.labelCount = 0;
+  w.labelCapacity = 16;
+  w.originals = AR_alloc(AR_temp, w.labelCapacity * sizeof(Temp_label));
+  w.placeholders = AR_alloc(AR_temp, w.labelCapacity * sizeof(Temp_label));
+  w.capacity = 1024;
+  w.len = 0;
+  w.buf = options ? checked_malloc(w.capacity) : NULL;
+  /* The frame comes first, so its label is placeholder 0. */
+  p.frame = F_copyFrame(frame, label(&w, F_name(frame)), temp, &w);
+  putInt(&w, F_localCount(p.frame));
+  for (a = F_formals(p.frame); a; a = a->tail)
+    if (F_accessTemp(a->head))
+      putTemp(&w, F_accessTemp(a->head));
+    else {
+      putByte(&w, 'F');
+      putInt(&w, F_frameOffset(a->head));
+    }
+  p.body = rewriteStm(&w, body);
+  if (options)
+    CA_key(p.key, options, "(function)", w.buf, w.len);
+  free(w.buf);
+  p.labels = w.originals;
+  p.labelCount = w.labelCount;
+  return p;
+}
+
+char *FC_restore(FC_proc *p, const char *text, size_t size, size_t *newSize) {
+  char *result = NULL;
+  const char *end = text + size;
+  string *names = checked_malloc(p->labelCount * sizeof(string));
+  FILE *out = open_memstream(&result, newSize);
+  int i;
+  for (i = 0; i < p->labelCount; i++)
+    names[i] = S_name(p->labels[i]);
+  while (text < end) {
+    const char *mark = memchr(text, FC_PREFIX[0], end - text);
+    int n = 0;
+    if (!mark)
+      mark = end;
+    fwrite(text, 1, mark - text, out);
+    if (mark == end)
+      break;
+    for (text = mark + 1; text < end && isdigit((unsigned char)*text); text++)
+      n = n * 10 + (*text - '0');
+    if (n < p->labelCount)
+      fputs(names[n], out);
+    else
+      fprintf(out, "%s_%d", names[0], n - p->labelCount);
+  }
+  fclose(out);
+  free(names);
+  return result;
+}
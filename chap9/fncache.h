@@ -0,0 +1,39 @@
+/*
+ * fncache.h - Key the back end of a function by what the function is.
+ *
+ * What the back end makes of a function depends on its IR tree and its
+ * frame, but not on the numbers the front end happened to give its temps
+ * and labels, which shift whenever another function is edited. So before
+ * its back end runs, a function is rewritten with its temps numbered in
+ * the order they are met, and its labels replaced by placeholders numbered
+ * the same way; the machine registers stay as they are. The back end works
+ * on the rewritten function, so that a function that has not changed makes
+ * the same assembly every time, which can be kept in the cache (cache.h)
+ * under the hash of the rewritten function. The real labels are put back
+ * into the assembly afterwards.
+ */
+
+/* The prefix of the placeholders */
+#define FC_PREFIX "\001"
+
+typedef struct {
+  F_frame frame; /* the rewritten frame */
+  T_stm body;    /* and body */
+  char key[CA_KEY_SIZE];
+  Temp_label *labels; /* the labels replaced, by placeholder number */
+  int labelCount;
+} FC_proc;
+
+/* Rewrite the function with "frame" and "body", in the current context,
+ *  whose numbering must just have been started over with FC_PREFIX as the
+ *  label prefix (see Temp_renumber). The label of the function becomes
+ *  placeholder 0. "options" must hold every option that changes what the
+ *  back end makes; it goes into the key, which is only made if "options"
+ *  is not NULL. */
+FC_proc FC_rewrite(F_frame frame, T_stm body, string options);
+
+/* Put the labels of the function back into "text", "size" bytes of what was
+ *  made from "p", and return the result, setting "*newSize". A label the
+ *  back end made itself is named after the function, as labelPrefix in
+ *  Temp_renumber would. The result must be freed. */
+char *FC_restore(FC_proc *p, const char *text, size_t size, size_t *newSize);
@@ -2,8 +2,13 @@
  * main.c
  */
 
+#define _GNU_SOURCE /* for fopencookie */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "util.h"
+#include "arena.h"
 #include "symbol.h"
 #include "absyn.h"
 #include "errormsg.h"
@@ -18,62 +23,418 @@
 #include "escape.h"
 #include "parse.h"
 #include "codegen.h"
-
-extern bool anyErrors;
+#include "regalloc.h"
+#include "context.h"
+#include "taskpool.h"
+#include "server.h"
+#include "cache.h"
+#include "fncache.h"
+#include "profile.h"
+#include "vm.h"
+#include "cgen.h"
 
 /* print the assembly language instructions to filename.s */
 static void doProc(FILE *out, F_frame frame, T_stm body) {
   AS_proc proc;
   struct RA_result allocation;
   T_stmList stmList;
+  struct C_block blocks;
   AS_instrList iList;
 
+  PF_begin(PF_linearize);
   stmList = C_linearize(body);
-  stmList = C_traceSchedule(C_basicBlocks(stmList));
+  PF_end(PF_linearize);
+  PF_begin(PF_basicBlocks);
+  blocks = C_basicBlocks(stmList);
+  PF_end(PF_basicBlocks);
+  PF_begin(PF_traceSchedule);
+  stmList = C_traceSchedule(blocks);
+  PF_end(PF_traceSchedule);
   /* printStmList(stdout, stmList);*/
+  PF_begin(PF_codegen);
   iList = F_codegen(frame, stmList); /* 9 */
+  PF_end(PF_codegen);
+  PF_begin(PF_regalloc);
+  allocation = RA_regAlloc(frame, iList); /* 11 */
+  PF_end(PF_regalloc);
+  if (PF_enabled()) {
+    for (iList = allocation.il; iList; iList = iList->tail)
+      PF_count(PF_instructions, 1);
+    PF_count(PF_spills, allocation.spills);
+  }
 
+  PF_begin(PF_emit);
   fprintf(out, "BEGIN %s\n", Temp_labelstring(F_name(frame)));
-  AS_printInstrList(out, iList, Temp_layerMap(F_tempMap, Temp_name()));
+  AS_printInstrList(out, allocation.il,
+                    Temp_layerMap(allocation.coloring, Temp_name()));
   fprintf(out, "END %s\n\n", Temp_labelstring(F_name(frame)));
+  PF_end(PF_emit);
 }
 
-int main(int argc, string *argv) {
-  A_exp absyn_root;
-  S_table base_env, base_tenv;
-  F_fragList frags;
-  char outfile[100];
-  FILE *out = stdout;
+/* Once SEM_transProg is done, the functions are independent of each other,
+ * so their back ends run as tasks on a pool of threads. Each worker has a
+ * context of its own, sharing only the machine registers with the front
+ * end. Each function is rewritten with temps and labels numbered afresh
+ * (fncache.h), so the code for a function is the same whichever worker
+ * makes it, and wherever it sits in the program; with a cache, it is only
+ * made if it is not there already. It goes into a buffer of its own, to be
+ * written out in fragment order. */
+typedef struct {
+  F_frame frame;
+  T_stm body;
+  bool reused; /* found in the cache */
+  char *text;
+  size_t size;
+} job;
+
+typedef struct {
+  job *jobs;
+  int firstTemp; /* the first temp above the machine registers */
+  bool linear;
+  string cacheDir;
+  bool profile, trace;
+  CX_context *contexts; /* one for each worker */
+} backEnd;
+
+static void runJob(void *arg, int index, int worker) {
+  backEnd *b = arg;
+  job *j = &b->jobs[index];
+  FC_proc p;
+  FILE *out;
+  char *text = NULL;
+  size_t size = 0;
+  int status, temps, labels;
+  CX_use(b->contexts[worker]);
+  RA_setLinearScan(b->linear);
+  AR_resetAll();
+  if (b->profile) {
+    PF_enable(b->trace);
+    PF_setThread(worker);
+  }
+  PF_beginFunction(Temp_labelstring(F_name(j->frame)));
+  Temp_renumber(b->firstTemp, FC_PREFIX);
+  PF_begin(PF_rewrite);
+  p = FC_rewrite(j->frame, j->body,
+                 !b->cacheDir ? NULL : b->linear ? "-linear" : "");
+  PF_end(PF_rewrite);
+  temps = Temp_count();
+  labels = Temp_labelCount();
+  out = open_memstream(&text, &size);
+  /* A function's entry holds no error messages. */
+  PF_begin(PF_cache);
+  j->reused = b->cacheDir && CA_lookup(b->cacheDir, p.key, &status, out, out);
+  PF_end(PF_cache);
+  if (!j->reused) {
+    doProc(out, p.frame, p.body);
+    fflush(out);
+    PF_count(PF_temps, Temp_count() - temps);
+    PF_count(PF_labels, Temp_labelCount() - labels);
+    PF_begin(PF_cache);
+    if (b->cacheDir)
+      CA_store(b->cacheDir, p.key, 0, text, size, "", 0);
+    PF_end(PF_cache);
+  }
+  fclose(out);
+  PF_begin(PF_rewrite);
+  j->text = FC_restore(&p, text, size, &j->size);
+  PF_end(PF_rewrite);
+  free(text);
+  PF_endFunction();
+}
+
+/* The number of the first temp above every machine register */
+static int aboveRegisters(void) {
+  Temp_tempList regs;
+  int last = Temp_num(F_FP()) > Temp_num(F_SP()) ? Temp_num(F_FP())
+                                                 : Temp_num(F_SP());
+  for (regs = F_registers(); regs; regs = regs->tail)
+    if (Temp_num(regs->head) > last)
+      last = Temp_num(regs->head);
+  return last + 1;
+}
+
+static void emitProcs(FILE *out, F_fragList frags, SV_request *r) {
+  CX_context self = CX_current();
+  backEnd b;
+  F_fragList f;
+  int count = 0, reused = 0, i;
+  for (f = frags; f; f = f->tail)
+    if (f->head->kind == F_procFrag)
+      count++;
+  b.jobs = checked_malloc((count ? count : 1) * sizeof(job));
+  b.linear = r->linear;
+  b.cacheDir = r->cacheDir;
+  b.profile = r->timeReport || r->memReport || r->traceFile;
+  b.trace = r->traceFile != NULL;
+  b.contexts = checked_malloc(r->threads * sizeof(CX_context));
+  for (f = frags, i = 0; f; f = f->tail)
+    if (f->head->kind == F_procFrag) {
+      job *j = &b.jobs[i++];
+      j->frame = f->head->u.proc.frame;
+      j->body = f->head->u.proc.body;
+    }
+  b.firstTemp = aboveRegisters();
+  for (i = 0; i < r->threads; i++) {
+    b.contexts[i] = CX_newContext();
+    CX_share(b.contexts[i], self, CX_frame);
+  }
+  TP_run(r->threads, count, runJob, &b);
+  CX_use(self);
+  for (i = 0; i < r->threads; i++) {
+    PF_merge(b.contexts[i]);
+    CX_freeContext(b.contexts[i]);
+  }
+  PF_begin(PF_emit);
+  for (f = frags, i = 0; f; f = f->tail) {
+    PF_count(PF_fragments, 1);
+    if (f->head->kind == F_procFrag) {
+      job *j = &b.jobs[i++];
+      fwrite(j->text, 1, j->size, out);
+      free(j->text);
+      reused += j->reused;
+    } else if (f->head->kind == F_stringFrag)
+      fprintf(out, "%s\n", f->head->u.string.str);
+  }
+  PF_end(PF_emit);
+  CA_countFunctions(count, reused);
+  free(b.jobs);
+  free(b.contexts);
+}
 
-  if (argc == 2) {
-    absyn_root = parse(argv[1]);
-    if (!absyn_root)
-      return 1;
+/* Parse and translate what "r" asks for; tell if it worked. */
+static bool translate(SV_request *r, F_fragList *frags) {
+  long nodes = AR_allocations(AR_absyn);
+  int temps = Temp_count(), labels = Temp_labelCount();
+  A_exp absyn_root;
+  PF_begin(PF_parse);
+  absyn_root = r->text ? parseText(r->name, r->text, r->len)
+                       : parseFrom(r->name, r->path);
+  PF_end(PF_parse);
+  PF_count(PF_astNodes, AR_allocations(AR_absyn) - nodes);
+  if (!absyn_root)
+    return FALSE;
 
 #if 0
    pr_exp(out, absyn_root, 0); /* print absyn data structure */
    fprintf(out, "\n");
 #endif
 
-    Esc_findEscape(absyn_root); /* set varDec's escape field */
+  PF_begin(PF_escape);
+  Esc_findEscape(absyn_root); /* set varDec's escape field */
+  PF_end(PF_escape);
 
-    frags = SEM_transProg(absyn_root);
-    if (anyErrors)
-      return 1; /* don't continue */
+  nodes = AR_allocations(AR_tree);
+  PF_begin(PF_semant);
+  *frags = SEM_transProg(absyn_root);
+  PF_end(PF_semant);
+  PF_count(PF_irNodes, AR_allocations(AR_tree) - nodes);
+  PF_count(PF_temps, Temp_count() - temps);
+  PF_count(PF_labels, Temp_labelCount() - labels);
+  return !EM_anyErrors();
+}
 
-    /* convert the filename */
-    sprintf(outfile, "%s.s", argv[1]);
-    out = fopen(outfile, "w");
-    /* Chapter 8, 9, 10, 11 & 12 */
-    for (; frags; frags = frags->tail)
-      if (frags->head->kind == F_procFrag)
-        doProc(out, frags->head->u.proc.frame, frags->head->u.proc.body);
-      else if (frags->head->kind == F_stringFrag)
-        fprintf(out, "%s\n", frags->head->u.stringg.str);
+/* Compile what "r" asks for, from scratch */
+static int compileAfresh(SV_request *r, FILE *out, FILE *errors) {
+  F_fragList frags;
+  EM_setOutput(errors);
+  if (!translate(r, &frags))
+    return 1; /* don't continue */
+  emitProcs(out, frags, r);
+  return 0;
+}
 
-    fclose(out);
+static char *readFile(string fname, int *len) {
+  FILE *f = fopen(fname, "rb");
+  char *text;
+  long size;
+  if (!f)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  rewind(f);
+  text = checked_malloc(size + 1);
+  if (size < 0 || fread(text, 1, size, f) != (size_t)size) {
+    fclose(f);
+    free(text);
+    return NULL;
+  }
+  fclose(f);
+  *len = size;
+  return text;
+}
+
+/* A stream that passes on what is written to it at once, keeping a copy */
+typedef struct {
+  FILE *to, *copy;
+} tee;
+
+static ssize_t teeWrite(void *cookie, const char *buf, size_t size) {
+  tee *t = cookie;
+  fwrite(buf, 1, size, t->to);
+  fflush(t->to);
+  fwrite(buf, 1, size, t->copy);
+  return size;
+}
+
+/* Compile through the cache, if "r" names one. The source is read first,
+ * since it is part of the key; on a miss it is compiled from that copy, so
+ * what is kept is what was compiled even if the file changes meanwhile.
+ * Only -linear is in the key, as the output is the same for any -threads. */
+static int compileCached(SV_request *r, FILE *out, FILE *errors) {
+  static cookie_io_functions_t teeFunctions = {NULL, teeWrite, NULL, NULL};
+  char key[CA_KEY_SIZE], *asmText = NULL, *errText = NULL;
+  size_t asmSize = 0, errSize = 0;
+  SV_request fresh = *r;
+  FILE *asmOut, *errOut, *errTee;
+  tee t;
+  int status;
+  bool hit;
+  if (!r->cacheDir)
+    return compileAfresh(r, out, errors);
+  if (!fresh.text && !(fresh.text = readFile(r->path, &fresh.len)))
+    return compileAfresh(r, out, errors); /* to say it cannot be opened */
+  CA_key(key, r->linear ? "-linear" : "", r->name, fresh.text, fresh.len);
+  PF_begin(PF_cache);
+  hit = CA_lookup(r->cacheDir, key, &status, out, errors);
+  PF_end(PF_cache);
+  if (!hit) {
+    /* The messages go out as they come, as they would without a cache, in
+     * case the compiler dies before it is done. */
+    asmOut = open_memstream(&asmText, &asmSize);
+    errOut = open_memstream(&errText, &errSize);
+    t.to = errors;
+    t.copy = errOut;
+    errTee = fopencookie(&t, "w", teeFunctions);
+    setvbuf(errTee, NULL, _IONBF, 0);
+    status = compileAfresh(&fresh, asmOut, errTee);
+    fclose(errTee);
+    EM_setOutput(errors);
+    fclose(asmOut);
+    fclose(errOut);
+    fwrite(asmText, 1, asmSize, out);
+    PF_begin(PF_cache);
+    CA_store(r->cacheDir, key, status, asmText, asmSize, errText, errSize);
+    CA_trim(r->cacheDir, r->cacheSize);
+    PF_end(PF_cache);
+    free(asmText);
+    free(errText);
+  }
+  if (r->verbose) {
+    struct CA_stats s = CA_stats();
+    fprintf(errors, "%s: cache %s (%d hits, %d misses, %d stored, "
+                    "%d evicted)",
+            r->name, hit ? "hit" : "miss", s.hits, s.misses, s.stores,
+            s.evictions);
+    if (s.functions)
+      fprintf(errors, ", %d of %d functions reused", s.reused,
+              s.functions);
+    fprintf(errors, "\n");
+  }
+  if (fresh.text != r->text)
+    free(fresh.text);
+  return status;
+}
+
+/* How the compiler compiles, for the command line and the server alike */
+static int compile(SV_request *r, FILE *out, FILE *errors) {
+  int status;
+  if (r->timeReport || r->memReport || r->traceFile)
+    PF_enable(r->traceFile != NULL);
+  status = compileCached(r, out, errors);
+  if (r->timeReport)
+    PF_report(errors);
+  if (r->memReport)
+    PF_memoryReport(errors);
+  if (r->traceFile && !PF_writeTrace(r->traceFile)) {
+    fprintf(errors, "%s: cannot write the trace\n", r->traceFile);
+    status = status ? status : 1;
+  }
+  return status;
+}
+
+/* Compile what "r" asks for and run it at once, as native code made in
+ * memory (vm.h), with our input and output as its own */
+static int run(SV_request *r) {
+  F_fragList frags;
+  VM_program p;
+  int status;
+  EM_setOutput(stderr);
+  if (!translate(r, &frags) || !(p = VM_load(frags)))
+    return 1;
+  status = VM_jit(p, stdin, stdout);
+  VM_free(p);
+  return status;
+}
+
+/* Compile what "r" asks for to C, in file.tig.c (cgen.h) */
+static int emitC(SV_request *r) {
+  F_fragList frags;
+  string outfile;
+  FILE *out;
+  EM_setOutput(stderr);
+  if (!translate(r, &frags))
+    return 1;
+  outfile = checked_malloc(strlen(r->name) + 3);
+  sprintf(outfile, "%s.c", r->name);
+  if (!(out = fopen(outfile, "w"))) {
+    EM_error(0, "cannot write %s", outfile);
+    return 1;
+  }
+  CG_program(out, frags);
+  fclose(out);
+  return 0;
+}
+
+int main(int argc, string *argv) {
+  SV_request r;
+  char *outfile, *asmText = NULL;
+  size_t asmSize = 0;
+  FILE *out;
+  int status;
+
+  /* -server [socket] compiles for tigerc until killed. */
+  if (argc <= 3 && argc > 1 && !strcmp(argv[1], "-server")) {
+    SV_serve(argc == 3 ? argv[2] : SV_defaultSocket(), compile);
     return 0;
   }
-  EM_error(0, "usage: tiger file.tig");
+  /* -run file.tig runs the program instead of writing its assembly, and
+   * -emit-c file.tig writes it as C, to file.tig.c. */
+  if (argc > 1 && !strcmp(argv[1], "-run")) {
+    if (SV_parseArgs(&r, argc - 2, argv + 2))
+      return run(&r);
+  } else if (argc > 1 && !strcmp(argv[1], "-emit-c")) {
+    if (SV_parseArgs(&r, argc - 2, argv + 2))
+      return emitC(&r);
+  }
+  /* -linear trades code quality for a faster register allocator, and
+   * -threads n runs the back end on n threads; the output is the same.
+   * -cache dir keeps results in dir, and -v tells how that went.
+   * -time-report prints where the time went, and -trace file writes it
+   * down for chrome://tracing; -mem-report prints what the arenas held. */
+  else if (SV_parseArgs(&r, argc - 1, argv + 1)) {
+    /* Chapter 8, 9, 10, 11 & 12 */
+    out = open_memstream(&asmText, &asmSize);
+    status = compile(&r, out, stderr);
+    fclose(out);
+    /* convert the filename */
+    outfile = checked_malloc(strlen(r.name) + 3);
+    sprintf(outfile, "%s.s", r.name);
+    if (status == 0) {
+      if (!(out = fopen(outfile, "w"))) {
+        EM_error(0, "cannot write %s", outfile);
+        status = 1;
+      } else {
+        fwrite(asmText, 1, asmSize, out);
+        fclose(out);
+      }
+    }
+    free(outfile);
+    free(asmText);
+    return status;
+  }
+  EM_error(0, "usage: tiger [-linear] [-threads n] [-cache dir] [-v] "
+              "[-time-report] [-mem-report] [-trace file] file.tig\n"
+              "       tiger -run file.tig\n"
+              "       tiger -emit-c file.tig");
   return 1;
 }
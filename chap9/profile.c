@@ -0,0 +1,408 @@
+/*
+ * profile.c - Time the phases of a compilation and count what they make.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "util.h"
+#include "arena.h"
+#include "context.h"
+#include "profile.h"
+
+/* The slowest functions, as many as the report shows */
+#define SLOWEST 10
+
+static string phaseNames[PF_numPhases] = {
+    "parse",   "escape",         "semant",          "rewrite",
+    "cache",   "linearize",      "basic blocks",    "trace schedule",
+    "codegen", "register alloc", "emit"};
+
+static string counterNames[PF_numCounters] = {
+    "ast nodes", "ir nodes",     "temps", "labels",
+    "fragments", "instructions", "spills"};
+
+/* A phase run: of the front end, or of the back end of a function */
+typedef struct {
+  PF_phase phase;
+  int function; /* index in the functions, or -1 */
+  int thread;
+  double start, wall;
+} event;
+
+typedef struct {
+  string name;
+  int thread;
+  double start, wall, cpu;
+  long instructions, spills;
+} function;
+
+/* The arenas are counted one by one, then all together. */
+#define ARENAS (AR_numKinds + 1)
+
+/* What the current context has gathered. Times are in microseconds. */
+typedef struct {
+  bool enabled, tracing;
+  int thread;
+  double start, startCpu; /* when profiling was enabled */
+  double beganWall[PF_numPhases], beganCpu[PF_numPhases];
+  double wall[PF_numPhases], cpu[PF_numPhases];
+  long rss[PF_numPhases]; /* peak of the process by the end, in kilobytes */
+  /* Bytes live in the arenas of a context during a phase, at most, and the
+   * most by which that exceeded what was live as the phase began */
+  long arenaPeak[PF_numPhases][ARENAS], arenaGrowth[PF_numPhases][ARENAS];
+  long beganLive[PF_numPhases][ARENAS];
+  struct AR_stats arenaStart[ARENAS]; /* when profiling was enabled */
+  long allocations[ARENAS], bytes[ARENAS]; /* merged from other contexts */
+  long counters[PF_numCounters];
+  event *events;
+  int eventCount, eventCapacity;
+  function *functions;
+  int functionCount, functionCapacity;
+  bool inFunction; /* the last function has begun, but not ended */
+} state;
+
+static void freeState(void *p) {
+  state *st = p;
+  int i;
+  for (i = 0; i < st->functionCount; i++)
+    free(st->functions[i].name);
+  free(st->functions);
+  free(st->events);
+}
+
+static state *current(void) {
+  return CX_state(CX_profile, sizeof(state), NULL, freeState);
+}
+
+static double now(clockid_t clock) {
+  struct timespec t;
+  clock_gettime(clock, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+static void *grow(void *array, int *capacity, int size) {
+  *capacity = *capacity ? 2 * *capacity : 256;
+  array = realloc(array, *capacity * size);
+  assert(array);
+  return array;
+}
+
+void PF_enable(bool tracing) {
+  state *st = current();
+  int k;
+  if (!st->enabled) {
+    st->start = now(CLOCK_MONOTONIC);
+    st->startCpu = now(CLOCK_PROCESS_CPUTIME_ID);
+    for (k = 0; k < ARENAS; k++)
+      st->arenaStart[k] = AR_stats(k);
+  }
+  st->enabled = TRUE;
+  st->tracing = st->tracing || tracing;
+}
+
+bool PF_enabled(void) { return current()->enabled; }
+
+void PF_setThread(int thread) { current()->thread = thread; }
+
+void PF_begin(PF_phase phase) {
+  state *st = current();
+  int k;
+  if (!st->enabled)
+    return;
+  st->beganWall[phase] = now(CLOCK_MONOTONIC);
+  st->beganCpu[phase] = now(CLOCK_THREAD_CPUTIME_ID);
+  for (k = 0; k < ARENAS; k++)
+    st->beganLive[phase][k] = AR_stats(k).live;
+  AR_markPeaks();
+}
+
+void PF_end(PF_phase phase) {
+  state *st = current();
+  struct rusage usage;
+  double wall;
+  int k;
+  if (!st->enabled)
+    return;
+  wall = now(CLOCK_MONOTONIC) - st->beganWall[phase];
+  st->wall[phase] += wall;
+  st->cpu[phase] += now(CLOCK_THREAD_CPUTIME_ID) - st->beganCpu[phase];
+  if (getrusage(RUSAGE_SELF, &usage) == 0 && usage.ru_maxrss > st->rss[phase])
+    st->rss[phase] = usage.ru_maxrss;
+  for (k = 0; k < ARENAS; k++) {
+    long peak = AR_stats(k).peak;
+    if (peak > st->arenaPeak[phase][k])
+      st->arenaPeak[phase][k] = peak;
+    if (peak - st->beganLive[phase][k] > st->arenaGrowth[phase][k])
+      st->arenaGrowth[phase][k] = peak - st->beganLive[phase][k];
+  }
+  if (st->tracing) {
+    event *e;
+    if (st->eventCount == st->eventCapacity)
+      st->events = grow(st->events, &st->eventCapacity, sizeof(event));
+    e = &st->events[st->eventCount++];
+    e->phase = phase;
+    e->function = st->inFunction ? st->functionCount - 1 : -1;
+    e->thread = st->thread;
+    e->start = st->beganWall[phase];
+    e->wall = wall;
+  }
+}
+
+void PF_beginFunction(string name) {
+  state *st = current();
+  function *f;
+  if (!st->enabled)
+    return;
+  if (st->functionCount == st->functionCapacity)
+    st->functions = grow(st->functions, &st->functionCapacity,
+                         sizeof(function));
+  f = &st->functions[st->functionCount++];
+  f->name = String(name);
+  f->thread = st->thread;
+  f->instructions = f->spills = 0;
+  f->start = now(CLOCK_MONOTONIC);
+  f->cpu = now(CLOCK_THREAD_CPUTIME_ID);
+  st->inFunction = TRUE;
+}
+
+void PF_endFunction(void) {
+  state *st = current();
+  function *f;
+  if (!st->enabled)
+    return;
+  f = &st->functions[st->functionCount - 1];
+  f->wall = now(CLOCK_MONOTONIC) - f->start;
+  f->cpu = now(CLOCK_THREAD_CPUTIME_ID) - f->cpu;
+  st->inFunction = FALSE;
+}
+
+void PF_count(PF_counter counter, long n) {
+  state *st = current();
+  if (!st->enabled)
+    return;
+  st->counters[counter] += n;
+  if (st->inFunction && counter == PF_instructions)
+    st->functions[st->functionCount - 1].instructions += n;
+  else if (st->inFunction && counter == PF_spills)
+    st->functions[st->functionCount - 1].spills += n;
+}
+
+/* What the arenas of the current context, whose profile is "st", and of
+ * the contexts merged into it have handed out since profiling began */
+static void arenaTotals(state *st, int k, long *allocations, long *bytes) {
+  struct AR_stats s = AR_stats(k);
+  *allocations = s.allocations - st->arenaStart[k].allocations +
+                 st->allocations[k];
+  *bytes = s.total - st->arenaStart[k].total + st->bytes[k];
+}
+
+/* The events and functions of "from" move over; only the functions' names
+ * are not copied. The peaks of the arenas are each context's own, so the
+ * greater is kept. */
+void PF_merge(CX_context from) {
+  CX_context self = CX_current();
+  long allocations[ARENAS], bytes[ARENAS];
+  state *st, *other;
+  int i, k;
+  CX_use(from);
+  other = current();
+  for (k = 0; k < ARENAS; k++)
+    arenaTotals(other, k, &allocations[k], &bytes[k]);
+  CX_use(self);
+  st = current();
+  for (i = 0; i < PF_numPhases; i++) {
+    st->wall[i] += other->wall[i];
+    st->cpu[i] += other->cpu[i];
+    if (other->rss[i] > st->rss[i])
+      st->rss[i] = other->rss[i];
+    for (k = 0; k < ARENAS; k++) {
+      if (other->arenaPeak[i][k] > st->arenaPeak[i][k])
+        st->arenaPeak[i][k] = other->arenaPeak[i][k];
+      if (other->arenaGrowth[i][k] > st->arenaGrowth[i][k])
+        st->arenaGrowth[i][k] = other->arenaGrowth[i][k];
+    }
+  }
+  for (k = 0; k < ARENAS; k++) {
+    st->allocations[k] += allocations[k];
+    st->bytes[k] += bytes[k];
+  }
+  for (i = 0; i < PF_numCounters; i++)
+    st->counters[i] += other->counters[i];
+  for (i = 0; i < other->eventCount; i++) {
+    event e = other->events[i];
+    if (e.function >= 0)
+      e.function += st->functionCount;
+    if (st->eventCount == st->eventCapacity)
+      st->events = grow(st->events, &st->eventCapacity, sizeof(event));
+    st->events[st->eventCount++] = e;
+  }
+  for (i = 0; i < other->functionCount; i++) {
+    if (st->functionCount == st->functionCapacity)
+      st->functions = grow(st->functions, &st->functionCapacity,
+                           sizeof(function));
+    st->functions[st->functionCount++] = other->functions[i];
+  }
+  other->eventCount = other->functionCount = 0;
+}
+
+static int slower(const void *a, const void *b) {
+  const function *x = *(function *const *)a, *y = *(function *const *)b;
+  if (x->wall != y->wall)
+    return x->wall > y->wall ? -1 : 1;
+  return strcmp(x->name, y->name);
+}
+
+void PF_report(FILE *out) {
+  state *st = current();
+  double wall = 0, cpu = 0;
+  function **order;
+  int i;
+  if (!st->enabled)
+    return;
+  fprintf(out, "%-24s %12s %12s %14s\n", "phase", "wall (ms)", "cpu (ms)",
+          "peak rss (kB)");
+  for (i = 0; i < PF_numPhases; i++) {
+    fprintf(out, "%-24s %12.3f %12.3f %14ld\n", phaseNames[i],
+            st->wall[i] / 1e3, st->cpu[i] / 1e3, st->rss[i]);
+    wall += st->wall[i];
+    cpu += st->cpu[i];
+  }
+  fprintf(out, "%-24s %12.3f %12.3f\n", "all phases", wall / 1e3, cpu / 1e3);
+  fprintf(out, "%-24s %12.3f %12.3f\n", "elapsed",
+          (now(CLOCK_MONOTONIC) - st->start) / 1e3,
+          (now(CLOCK_PROCESS_CPUTIME_ID) - st->startCpu) / 1e3);
+  fprintf(out, "(the back end's phases are summed over its threads; the peak "
+               "rss is the\nprocess's, by the time the phase last ended)\n\n");
+  for (i = 0; i < PF_numCounters; i++)
+    fprintf(out, "%-24s %12ld\n", counterNames[i], st->counters[i]);
+  if (!st->functionCount)
+    return;
+  order = checked_malloc(st->functionCount * sizeof(function *));
+  for (i = 0; i < st->functionCount; i++)
+    order[i] = &st->functions[i];
+  qsort(order, st->functionCount, sizeof(function *), slower);
+  fprintf(out, "\nslowest of %d functions in the back end:\n",
+          st->functionCount);
+  fprintf(out, "%-24s %12s %12s %12s %8s\n", "function", "wall (ms)",
+          "cpu (ms)", "instructions", "spills");
+  for (i = 0; i < st->functionCount && i < SLOWEST; i++)
+    fprintf(out, "%-24s %12.3f %12.3f %12ld %8ld\n", order[i]->name,
+            order[i]->wall / 1e3, order[i]->cpu / 1e3, order[i]->instructions,
+            order[i]->spills);
+  free(order);
+}
+
+/* The index of the greatest of "count" values, or -1 if none is above 0 */
+static int greatest(long *values, int count, int stride) {
+  int i, index = -1;
+  long most = 0;
+  for (i = 0; i < count; i++)
+    if (values[i * stride] > most) {
+      most = values[i * stride];
+      index = i;
+    }
+  return index;
+}
+
+void PF_memoryReport(FILE *out) {
+  state *st = current();
+  int i, k;
+  if (!st->enabled)
+    return;
+  fprintf(out, "%-24s %12s %12s %12s  %s\n", "arena", "allocations",
+          "total (kB)", "peak (kB)", "grew most during");
+  for (k = 0; k < ARENAS; k++) {
+    long allocations, bytes, peak = 0;
+    int phase = greatest(&st->arenaGrowth[0][k], PF_numPhases, ARENAS);
+    arenaTotals(st, k, &allocations, &bytes);
+    for (i = 0; i < PF_numPhases; i++)
+      if (st->arenaPeak[i][k] > peak)
+        peak = st->arenaPeak[i][k];
+    fprintf(out, "%-24s %12ld %12.1f %12.1f  %s\n",
+            k < AR_numKinds ? AR_name(k) : "all arenas", allocations,
+            bytes / 1024.0, peak / 1024.0,
+            phase < 0 ? "-" : phaseNames[phase]);
+  }
+  fprintf(out, "\n%-24s %12s %12s  %s\n", "phase", "peak (kB)", "grew (kB)",
+          "grew most");
+  for (i = 0; i < PF_numPhases; i++) {
+    int arena = greatest(st->arenaGrowth[i], AR_numKinds, 1);
+    fprintf(out, "%-24s %12.1f %12.1f  %s\n", phaseNames[i],
+            st->arenaPeak[i][AR_numKinds] / 1024.0,
+            st->arenaGrowth[i][AR_numKinds] / 1024.0,
+            arena < 0 ? "-" : AR_name(arena));
+  }
+  fprintf(out, "(peaks are of what was live at once in one context, left "
+               "from earlier phases\nor not, and each thread of the back end "
+               "has its own; growth is over what\nwas live as the phase "
+               "began, at most)\n");
+}
+
+static void writeString(FILE *f, string s) {
+  putc('"', f);
+  for (; *s; s++)
+    if (*s == '"' || *s == '\\')
+      fprintf(f, "\\%c", *s);
+    else if ((unsigned char)*s < ' ')
+      fprintf(f, "\\u%04x", *s);
+    else
+      putc(*s, f);
+  putc('"', f);
+}
+
+/* A complete event, leaving its arguments open */
+static void writeEvent(FILE *f, string name, string category, double start,
+                       double wall, int thread) {
+  fprintf(f, ",\n{\"name\": ");
+  writeString(f, name);
+  fprintf(f, ", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+             "\"pid\": %d, \"tid\": %d, \"args\": {",
+          category, start, wall, (int)getpid(), thread);
+}
+
+bool PF_writeTrace(string fname) {
+  state *st = current();
+  FILE *f = fopen(fname, "w");
+  int i, threads = 1;
+  if (!f)
+    return FALSE;
+  for (i = 0; i < st->functionCount; i++)
+    if (st->functions[i].thread >= threads)
+      threads = st->functions[i].thread + 1;
+  /* Times are from the start of profiling. */
+  fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  fprintf(f, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, "
+             "\"args\": {\"name\": \"tiger\"}}",
+          (int)getpid());
+  for (i = 0; i < threads; i++)
+    fprintf(f, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, "
+               "\"tid\": %d, \"args\": {\"name\": \"worker %d\"}}",
+            (int)getpid(), i, i);
+  for (i = 0; i < st->functionCount; i++) {
+    function *fn = &st->functions[i];
+    writeEvent(f, fn->name, "function", fn->start - st->start, fn->wall,
+               fn->thread);
+    fprintf(f, "\"instructions\": %ld, \"spills\": %ld}}", fn->instructions,
+            fn->spills);
+  }
+  for (i = 0; i < st->eventCount; i++) {
+    event *e = &st->events[i];
+    writeEvent(f, phaseNames[e->phase], "phase", e->start - st->start,
+               e->wall, e->thread);
+    if (e->function >= 0) {
+      fprintf(f, "\"function\": ");
+      writeString(f, st->functions[e->function].name);
+    }
+    fprintf(f, "}}");
+  }
+  fprintf(f, "\n], \"otherData\": {");
+  for (i = 0; i < PF_numCounters; i++)
+    fprintf(f, "%s\"%s\": %ld", i ? ", " : "", counterNames[i],
+            st->counters[i]);
+  fprintf(f, "}}\n");
+  return fclose(f) == 0;
+}
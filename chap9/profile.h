@@ -0,0 +1,75 @@
+/*
+ * profile.h - Time the phases of a compilation and count what they make.
+ *
+ * Once profiling is enabled in a context, the time spent in each phase is
+ * added up there, both on the clock and in CPU time of the thread, and so
+ * is each function's back end, for a report in the manner of
+ * -ftime-report. The peak resident size of the process is taken at the end
+ * of every phase too, so that the phase that grew it shows, and so are the
+ * most bytes each arena (arena.h) held during the phase. With tracing,
+ * every phase also leaves an event behind, and the events are written out
+ * in the trace format of chrome://tracing and Perfetto. The back end
+ * runs on several threads, each in a context of its own; what those
+ * contexts gathered is merged into the driver's when they are done, so the
+ * times of the back-end phases are summed over the threads.
+ */
+
+typedef enum {
+  PF_parse,
+  PF_escape,
+  PF_semant,
+  PF_rewrite, /* rewriting functions for the back end (fncache.h) */
+  PF_cache,   /* looking up and storing results (cache.h) */
+  PF_linearize,
+  PF_basicBlocks,
+  PF_traceSchedule,
+  PF_codegen,
+  PF_regalloc,
+  PF_emit,
+  PF_numPhases
+} PF_phase;
+
+typedef enum {
+  PF_astNodes, /* abstract syntax nodes, list cells included */
+  PF_irNodes,  /* IR tree nodes made by the front end, likewise */
+  PF_temps,
+  PF_labels,
+  PF_fragments,
+  PF_instructions, /* after register allocation */
+  PF_spills,
+  PF_numCounters
+} PF_counter;
+
+/* Start profiling in the current context, and tracing too if "tracing".
+ *  Until then, the other functions do nothing. */
+void PF_enable(bool tracing);
+bool PF_enabled(void);
+
+/* Tag the events of the current context with "thread" */
+void PF_setThread(int thread);
+
+/* Mark the start and the end of "phase" on the calling thread */
+void PF_begin(PF_phase phase);
+void PF_end(PF_phase phase);
+
+/* Mark the start and the end of the back end of function "name". The
+ *  instructions and spills counted in between are the function's. */
+void PF_beginFunction(string name);
+void PF_endFunction(void);
+
+void PF_count(PF_counter counter, long n);
+
+/* Add what context "from" gathered to the current context. No other thread
+ *  may be using "from". */
+void PF_merge(CX_context from);
+
+/* Write the table of times and counters to "out": the phases, then the
+ *  functions that took longest. */
+void PF_report(FILE *out);
+
+/* Write what the arenas handed out to "out": for each, how much in all and
+ *  the most at once, and for each phase the most they held together. */
+void PF_memoryReport(FILE *out);
+
+/* Write the events to "fname"; tell if it worked. */
+bool PF_writeTrace(string fname);
@@ -0,0 +1,328 @@
+/*
+ * scalebench.c - See how the compiler's phases grow with the program.
+ *
+ * Programs of one shape but for one dimension, which doubles from -from to
+ * -to, are made by tiggen (tiggen.c) and compiled by tiger -time-report.
+ * The time of each phase, and the peak resident size of the process by
+ * the end of it, are printed for every size, with the rate at which each
+ * grows: the slope of its logarithm against that of the length of the
+ * source, fitted over the sizes. A slope near 1 is linear; a slope well
+ * over it, marked, is a phase that scales worse than it should.
+ *
+ *   scalebench [-tiger path] [-gen path] [-vary dimension] [-from n]
+ *     [-to n] [-runs n] [-threads n] [-linear] [tiggen options]
+ *
+ * The dimension is one of functions, depth, lets, types and size, as named
+ * by the options of tiggen, which also set the dimensions that stay put.
+ * Each program is compiled -runs times and the least of each time kept.
+ *
+ *   cc -O2 -o scalebench scalebench.c -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define MAX_SIZES 32
+#define MAX_PHASES 32
+#define MAX_ARGS 32
+#define STEEP 1.25 /* a slope over this is marked */
+
+typedef struct {
+  long param, bytes, lines;
+  double wall[MAX_PHASES], all, elapsed; /* milliseconds */
+  long rss[MAX_PHASES], peak;            /* kilobytes */
+} result;
+
+static char *phases[MAX_PHASES];
+static int phaseCount;
+static result results[MAX_SIZES];
+static int resultCount;
+
+static void fail(const char *what) {
+  perror(what);
+  exit(1);
+}
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+/* Run "argv" with its output going to "out" and its errors to "errors",
+ * either of which may be -1 to leave it be. Return its exit status and set
+ * "*usage". */
+static int run(char **argv, int out, int errors, struct rusage *usage) {
+  int status;
+  pid_t pid = fork();
+  if (pid < 0)
+    fail("fork");
+  if (pid == 0) {
+    if (out >= 0)
+      dup2(out, 1);
+    if (errors >= 0)
+      dup2(errors, 2);
+    execv(argv[0], argv);
+    perror(argv[0]);
+    _exit(127);
+  }
+  if (wait4(pid, &status, 0, usage) < 0)
+    fail("wait4");
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+static char *readAll(FILE *f) {
+  char *text = NULL;
+  size_t size = 0;
+  FILE *out = open_memstream(&text, &size);
+  int c;
+  rewind(f);
+  while ((c = getc(f)) != EOF)
+    putc(c, out);
+  fclose(out);
+  return text;
+}
+
+static int phaseIndex(const char *name) {
+  int i;
+  for (i = 0; i < phaseCount; i++)
+    if (!strcmp(phases[i], name))
+      return i;
+  if (phaseCount == MAX_PHASES)
+    return -1;
+  phases[phaseCount] = strdup(name);
+  return phaseCount++;
+}
+
+/* Take the table of phases out of the report of tiger -time-report,
+ * keeping the least of each time in "r". */
+static void parseReport(char *report, result *r, int first) {
+  char *line, *next;
+  int inTable = 0;
+  for (line = report; line && *line; line = next) {
+    char name[25];
+    double wall, cpu;
+    long rss;
+    int len, i;
+    next = strchr(line, '\n');
+    if (next)
+      *next++ = '\0';
+    if (!strncmp(line, "phase ", 6)) {
+      inTable = 1;
+      continue;
+    }
+    if (!inTable || strlen(line) < 24)
+      continue;
+    memcpy(name, line, 24);
+    for (len = 24; len > 0 && name[len - 1] == ' '; len--)
+      ;
+    name[len] = '\0';
+    if (!strcmp(name, "all phases")) {
+      if (sscanf(line + 24, "%lf", &wall) == 1 && (first || wall < r->all))
+        r->all = wall;
+      break;
+    }
+    if (sscanf(line + 24, "%lf %lf %ld", &wall, &cpu, &rss) != 3 ||
+        (i = phaseIndex(name)) < 0)
+      continue;
+    if (first || wall < r->wall[i])
+      r->wall[i] = wall;
+    if (rss > r->rss[i])
+      r->rss[i] = rss;
+  }
+}
+
+/* The slope of log y against log x, by least squares over the results */
+static double slope(double (*y)(result *, int), int i) {
+  double sx = 0, sy = 0, sxx = 0, sxy = 0;
+  int k, n = 0;
+  for (k = 0; k < resultCount; k++) {
+    double a = log((double)results[k].bytes), b = y(&results[k], i);
+    if (b <= 0)
+      continue;
+    b = log(b);
+    sx += a;
+    sy += b;
+    sxx += a * a;
+    sxy += a * b;
+    n++;
+  }
+  if (n < 2 || n * sxx == sx * sx)
+    return NAN;
+  return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+static double phaseWall(result *r, int i) { return r->wall[i]; }
+static double phaseRss(result *r, int i) { return r->rss[i] / 1024.0; }
+static double allWall(result *r, int i) { return r->all; }
+static double elapsed(result *r, int i) { return r->elapsed; }
+static double peak(result *r, int i) { return r->peak / 1024.0; }
+static double lines(result *r, int i) { return r->lines; }
+
+static void row(const char *name, double (*y)(result *, int), int i,
+                const char *format) {
+  double s = slope(y, i);
+  int k;
+  printf("%-20s", name);
+  for (k = 0; k < resultCount; k++)
+    printf(format, y(&results[k], i));
+  if (isnan(s))
+    printf("%9s\n", "-");
+  else
+    printf("%8.2f%s\n", s, s > STEEP ? "*" : " ");
+}
+
+static void header(const char *title) {
+  int k;
+  printf("\n%-20s", title);
+  for (k = 0; k < resultCount; k++)
+    printf("%10ld", results[k].param);
+  printf("%9s\n", "slope");
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "usage: scalebench [-tiger path] [-gen path] [-vary dimension] "
+          "[-from n] [-to n]\n"
+          "  [-runs n] [-threads n] [-linear] [-functions n] [-depth n] "
+          "[-lets n]\n  [-types n] [-size n] [-seed n]\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  char *tiger = "./tiger", *gen = "./tiggen", *vary = "functions";
+  char *genArgs[MAX_ARGS], *tigerArgs[MAX_ARGS];
+  char source[] = "/tmp/scalebenchXXXXXX", output[64], value[16];
+  int genCount = 1, tigerCount = 1, varied, runs = 1, i, fd, devNull;
+  long from = 250, to = 4000, param;
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-linear")) {
+      tigerArgs[tigerCount++] = argv[i];
+      continue;
+    }
+    if (i + 1 == argc || genCount + 2 >= MAX_ARGS)
+      usage();
+    if (!strcmp(argv[i], "-tiger"))
+      tiger = argv[++i];
+    else if (!strcmp(argv[i], "-gen"))
+      gen = argv[++i];
+    else if (!strcmp(argv[i], "-vary"))
+      vary = argv[++i];
+    else if (!strcmp(argv[i], "-from"))
+      from = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-to"))
+      to = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-runs"))
+      runs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-threads")) {
+      tigerArgs[tigerCount++] = argv[i];
+      tigerArgs[tigerCount++] = argv[++i];
+    } else if (!strcmp(argv[i], "-functions") || !strcmp(argv[i], "-depth") ||
+               !strcmp(argv[i], "-lets") || !strcmp(argv[i], "-types") ||
+               !strcmp(argv[i], "-size") || !strcmp(argv[i], "-seed")) {
+      genArgs[genCount++] = argv[i];
+      genArgs[genCount++] = argv[++i];
+    } else
+      usage();
+  }
+  if (from < 1 || to < from || runs < 1)
+    usage();
+  /* The varied dimension goes last, to override any given. */
+  genArgs[0] = gen;
+  genArgs[genCount++] = malloc(strlen(vary) + 2);
+  sprintf(genArgs[genCount - 1], "-%s", vary);
+  varied = genCount++;
+  genArgs[genCount] = NULL;
+  tigerArgs[0] = tiger;
+  tigerArgs[tigerCount++] = "-time-report";
+  tigerArgs[tigerCount++] = source;
+  tigerArgs[tigerCount] = NULL;
+
+  if ((fd = mkstemp(source)) < 0)
+    fail("mkstemp");
+  if ((devNull = open("/dev/null", O_WRONLY)) < 0)
+    fail("/dev/null");
+  snprintf(output, sizeof(output), "%s.s", source);
+  for (param = from; param <= to && resultCount < MAX_SIZES; param *= 2) {
+    result *r = &results[resultCount];
+    struct rusage usage;
+    struct stat st;
+    FILE *report = tmpfile(), *text;
+    char *reportText;
+    int k, c;
+    memset(r, 0, sizeof(*r));
+    r->param = param;
+    snprintf(value, sizeof(value), "%ld", param);
+    genArgs[varied] = value;
+    if (ftruncate(fd, 0) < 0 || lseek(fd, 0, SEEK_SET) < 0)
+      fail(source);
+    if (run(genArgs, fd, -1, &usage)) {
+      fprintf(stderr, "%s failed\n", gen);
+      return 1;
+    }
+    if (fstat(fd, &st) < 0)
+      fail(source);
+    r->bytes = st.st_size;
+    text = fopen(source, "r");
+    while ((c = getc(text)) != EOF)
+      r->lines += c == '\n';
+    fclose(text);
+    if (!report)
+      fail("tmpfile");
+    for (k = 0; k < runs; k++) {
+      double start = now(), wall;
+      int status;
+      if (ftruncate(fileno(report), 0) < 0)
+        fail("tmpfile");
+      rewind(report);
+      status = run(tigerArgs, devNull, fileno(report), &usage);
+      wall = now() - start;
+      if (status) {
+        reportText = readAll(report);
+        fprintf(stderr, "%s -%s %ld: tiger failed (%d)\n%s", gen, vary, param,
+                status, reportText);
+        free(reportText);
+        unlink(source);
+        return 1;
+      }
+      reportText = readAll(report);
+      parseReport(reportText, r, k == 0);
+      free(reportText);
+      if (k == 0 || wall < r->elapsed)
+        r->elapsed = wall;
+      if (usage.ru_maxrss > r->peak)
+        r->peak = usage.ru_maxrss;
+    }
+    fclose(report);
+    unlink(output);
+    fprintf(stderr, "-%s %ld: %ld lines, %.1f ms\n", vary, param, r->lines,
+            r->elapsed);
+    resultCount++;
+  }
+  close(fd);
+  close(devNull);
+  unlink(source);
+
+  header(vary);
+  row("source lines", lines, 0, "%10.0f");
+  header("wall (ms)");
+  for (i = 0; i < phaseCount; i++)
+    row(phases[i], phaseWall, i, "%10.1f");
+  row("all phases", allWall, 0, "%10.1f");
+  row("elapsed", elapsed, 0, "%10.1f");
+  header("peak rss (MB)");
+  for (i = 0; i < phaseCount; i++)
+    row(phases[i], phaseRss, i, "%10.1f");
+  row("process", peak, 0, "%10.1f");
+  printf("\nslope: of the log of each against that of the source length; "
+         "* marks over %.2f\n", STEEP);
+  return 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * server.c - Compile programs for clients that connect to a Unix socket.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "util.h"
+#include "symbol.h"
+#include "arena.h"
+#include "context.h"
+#include "server.h"
+
+#define MAX_FIELDS 64
+
+/* The bound on a cache, in megabytes, if none is given */
+#define CACHE_MEGABYTES 256
+
+/* Children waiting for a connection, at least */
+#define MIN_SPARES 4
+
+/* A child whose intern table grows past this makes way for a fresh one, so
+ * that a server fed many different programs does not grow without bound. */
+#define MAX_SYMBOLS (1 << 20)
+
+/* Forget the compilation just done, keeping what makes the next one fast:
+ * the interned symbols and the arenas' chunks. */
+static void forget(void) {
+  CX_context c = CX_current();
+  int m;
+  for (m = 0; m < CX_numModules; m++)
+    if (m != CX_symbol && m != CX_arena)
+      CX_drop(c, m);
+  AR_resetAll();
+}
+
+bool SV_parseArgs(SV_request *r, int argc, string *argv) {
+  int i;
+  memset(r, 0, sizeof(*r));
+  r->threads = sysconf(_SC_NPROCESSORS_ONLN);
+  r->cacheSize = CACHE_MEGABYTES << 20;
+  for (i = 0; i < argc - 1; i++)
+    if (!strcmp(argv[i], "-linear"))
+      r->linear = TRUE;
+    else if (!strcmp(argv[i], "-threads") && i + 2 < argc)
+      r->threads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-cache") && i + 2 < argc)
+      r->cacheDir = argv[++i];
+    else if (!strcmp(argv[i], "-cache-size") && i + 2 < argc)
+      r->cacheSize = atol(argv[++i]) << 20;
+    else if (!strcmp(argv[i], "-v"))
+      r->verbose = TRUE;
+    else if (!strcmp(argv[i], "-time-report"))
+      r->timeReport = TRUE;
+    else if (!strcmp(argv[i], "-mem-report"))
+      r->memReport = TRUE;
+    else if (!strcmp(argv[i], "-trace") && i + 2 < argc)
+      r->traceFile = argv[++i];
+    else if (!strcmp(argv[i], "-source") && i + 2 < argc) {
+      r->text = argv[++i];
+      r->len = strlen(r->text);
+    } else if (!strcmp(argv[i], "-C") && i + 2 < argc)
+      r->path = argv[++i];
+    else
+      return FALSE;
+  if (i != argc - 1)
+    return FALSE;
+  if (r->threads < 1)
+    r->threads = 1;
+  r->name = argv[i];
+  if (!r->path || r->name[0] == '/')
+    r->path = r->name;
+  else {
+    string dir = r->path;
+    r->path = checked_malloc(strlen(dir) + strlen(r->name) + 2);
+    sprintf(r->path, "%s/%s", dir, r->name);
+  }
+  return TRUE;
+}
+
+string SV_defaultSocket(void) {
+  static char path[64];
+  string s = getenv("TIGER_SOCKET");
+  if (s)
+    return s;
+  sprintf(path, "/tmp/tiger-%d.sock", (int)getuid());
+  return path;
+}
+
+/* Read one field; NULL at the end of the batch or on garbage. */
+static string readField(FILE *in, int *len) {
+  string s;
+  if (fscanf(in, "%d:", len) != 1 || *len < 0)
+    return NULL;
+  s = checked_malloc(*len + 1);
+  if (fread(s, 1, *len, in) != (size_t)*len) {
+    free(s);
+    return NULL;
+  }
+  s[*len] = 0;
+  return s;
+}
+
+/* Answer one request; return FALSE when the batch is over. */
+static bool serveRequest(FILE *in, FILE *reply, SV_compiler compile) {
+  string fields[MAX_FIELDS];
+  int lens[MAX_FIELDS];
+  int count, i, status = 1;
+  char *asmText = NULL, *errText = NULL;
+  size_t asmSize = 0, errSize = 0;
+  FILE *out, *errors;
+  SV_request r;
+  if (fscanf(in, "%d", &count) != 1 || count < 1 || count > MAX_FIELDS)
+    return FALSE;
+  for (i = 0; i < count; i++)
+    if (!(fields[i] = readField(in, &lens[i]))) {
+      while (i-- > 0)
+        free(fields[i]);
+      return FALSE;
+    }
+  out = open_memstream(&asmText, &asmSize);
+  errors = open_memstream(&errText, &errSize);
+  if (SV_parseArgs(&r, count, fields)) {
+    if (r.text) /* the source may hold null characters */
+      for (i = 0; i < count; i++)
+        if (fields[i] == r.text)
+          r.len = lens[i];
+    status = compile(&r, out, errors);
+    if (r.path != r.name)
+      free(r.path);
+  } else
+    fprintf(errors, "usage: tiger [-linear] [-threads n] [-cache dir] [-v] "
+                    "[-time-report] [-mem-report] [-trace file] file.tig\n");
+  fclose(out);
+  fclose(errors);
+  fprintf(reply, "%d %lu %lu\n", status, (unsigned long)asmSize,
+          (unsigned long)errSize);
+  fwrite(asmText, 1, asmSize, reply);
+  fwrite(errText, 1, errSize, reply);
+  fflush(reply);
+  free(asmText);
+  free(errText);
+  for (i = 0; i < count; i++)
+    free(fields[i]);
+  return !ferror(reply);
+}
+
+/* A small program to compile before serving anybody, so that what every
+ * compilation needs is set up once, in the server, for all of them. */
+static char warmUp[] = "let function f(n: int): int = n * 2 + 1 in f(20) end";
+
+static void serveConnection(int fd, SV_compiler compile) {
+  FILE *in = fdopen(fd, "r"), *reply = fdopen(dup(fd), "w");
+  while (serveRequest(in, reply, compile))
+    forget();
+  fclose(in);
+  fclose(reply);
+}
+
+/* Fork a child that serves connections on "fd", one at a time. */
+static void spawn(int fd, SV_compiler compile) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    while (S_stats().symbols < MAX_SYMBOLS) {
+      int client = accept(fd, NULL, NULL);
+      if (client >= 0)
+        serveConnection(client, compile);
+    }
+    exit(0);
+  }
+  if (pid < 0)
+    sleep(1); /* try again once some memory has been freed */
+}
+
+void SV_serve(string socketPath, SV_compiler compile) {
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0), spares, i;
+  SV_request r;
+  FILE *sink = fopen("/dev/null", "w");
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (fd < 0 || strlen(socketPath) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "%s: cannot make a socket\n", socketPath);
+    exit(1);
+  }
+  strcpy(addr.sun_path, socketPath);
+  unlink(socketPath);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(fd, 64) < 0) {
+    perror(socketPath);
+    exit(1);
+  }
+  memset(&r, 0, sizeof(r));
+  r.name = r.path = "warm-up";
+  r.text = warmUp;
+  r.len = strlen(warmUp);
+  r.threads = 1;
+  compile(&r, sink, sink);
+  forget();
+  fclose(sink);
+  /* A client that goes away should not take the server with it. */
+  signal(SIGPIPE, SIG_IGN);
+  /* Each connection is served by a child of the warmed-up server, so that
+   * a compilation that crashes takes nothing else down with it. The
+   * children are forked ahead of time and wait for connections themselves;
+   * whenever one is gone, another takes its place. */
+  spares = sysconf(_SC_NPROCESSORS_ONLN) * 2;
+  if (spares < MIN_SPARES)
+    spares = MIN_SPARES;
+  for (i = 0; i < spares; i++)
+    spawn(fd, compile);
+  for (;;)
+    if (wait(NULL) > 0)
+      spawn(fd, compile);
+}
@@ -0,0 +1,56 @@
+/*
+ * server.h - Compile programs for clients that connect to a Unix socket.
+ *
+ * A client sends a batch of requests over one connection, and gets one
+ * response for each, in order. Every request is a list of fields, each of
+ * them the decimal length of a string, a colon and the string itself. The
+ * request starts with the number of fields on a line of its own, and the
+ * fields are the arguments the compiler would have been run with:
+ *
+ *   [-C dir] [-linear] [-threads n] [-cache dir] [-cache-size mb] [-v]
+ *   [-time-report] [-mem-report] [-trace file] [-source text] file.tig
+ *
+ * "-C dir" is where a relative file name is to be found. "-source text" is
+ * the program itself, in which case the file name is only used to report
+ * errors. The response is a line holding the exit status, the length of
+ * the assembly and the length of the error messages, followed by both.
+ *
+ * The server compiles a small program before it starts listening, and
+ * serves connections in child processes forked from it ahead of time. So a
+ * request finds the keyword and intern tables filled and the arenas'
+ * chunks allocated, without the start-up of a fresh compiler, and a
+ * compilation that crashes loses only its own child. Between requests,
+ * only the interned symbols and the arenas' chunks are kept, so the output
+ * is the same as that of a fresh compiler.
+ */
+
+/* What a request asks for */
+typedef struct {
+  string name;      /* the file name to report errors under */
+  string path;      /* where the file is, if the source was not sent */
+  char *text;       /* the source, if it was sent */
+  int len;          /* and its length */
+  bool linear;      /* allocate registers by linear scan */
+  int threads;      /* threads for the back end */
+  string cacheDir;  /* where results are kept, if anywhere (cache.h) */
+  long cacheSize;   /* the most bytes the cache may hold */
+  bool verbose;     /* report how the cache did */
+  bool timeReport;  /* report where the time went (profile.h) */
+  bool memReport;   /* report what the arenas held, likewise */
+  string traceFile; /* where to write a trace of the phases, if anywhere */
+} SV_request;
+
+/* Compile what "r" asks for, in the current context, writing the assembly
+ *  to "out" and the error messages to "errors"; return the exit status. */
+typedef int (*SV_compiler)(SV_request *r, FILE *out, FILE *errors);
+
+/* Serve clients at "socketPath" until killed. */
+void SV_serve(string socketPath, SV_compiler compile);
+
+/* Read the arguments of a request from "argv", stopping at the file name,
+ *  which must be last; return FALSE if they are not understood. The
+ *  command line is read the same way, without "-C". */
+bool SV_parseArgs(SV_request *r, int argc, string *argv);
+
+/* The socket of the compile server, if none is given */
+string SV_defaultSocket(void);
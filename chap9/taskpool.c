@@ -0,0 +1,107 @@
+/*
+ * taskpool.c - Run independent tasks on a pool of threads.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "util.h"
+#include "taskpool.h"
+
+/* The tasks a worker has yet to run: those from next up to limit. The owner
+ * takes them from the front, thieves from the back. */
+typedef struct {
+  pthread_mutex_t lock;
+  int next, limit;
+} share;
+
+typedef struct {
+  share *shares;
+  int workers;
+  TP_task task;
+  void *arg;
+} pool;
+
+typedef struct {
+  pool *p;
+  int self;
+  pthread_t thread;
+} worker;
+
+static bool take(share *s, int *index) {
+  bool found;
+  pthread_mutex_lock(&s->lock);
+  found = s->next < s->limit;
+  if (found)
+    *index = s->next++;
+  pthread_mutex_unlock(&s->lock);
+  return found;
+}
+
+/* Move the back half of the first share found that is not empty into the
+ * share of "self", which is. Nobody adds tasks once the pool is running,
+ * so when every share is empty the work is done. */
+static bool steal(pool *p, int self) {
+  int i;
+  for (i = 1; i < p->workers; i++) {
+    share *victim = &p->shares[(self + i) % p->workers];
+    int from = 0, to = 0;
+    pthread_mutex_lock(&victim->lock);
+    if (victim->next < victim->limit) {
+      to = victim->limit;
+      from = victim->limit -= (victim->limit - victim->next + 1) / 2;
+    }
+    pthread_mutex_unlock(&victim->lock);
+    if (from < to) {
+      share *mine = &p->shares[self];
+      pthread_mutex_lock(&mine->lock);
+      mine->next = from;
+      mine->limit = to;
+      pthread_mutex_unlock(&mine->lock);
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+static void *work(void *arg) {
+  worker *w = arg;
+  pool *p = w->p;
+  int index;
+  do
+    while (take(&p->shares[w->self], &index))
+      p->task(p->arg, index, w->self);
+  while (steal(p, w->self));
+  return NULL;
+}
+
+void TP_run(int threads, int count, TP_task task, void *arg) {
+  pool p;
+  worker *workers;
+  int i;
+  if (threads > count)
+    threads = count;
+  if (threads < 1)
+    threads = 1;
+  p.workers = threads;
+  p.task = task;
+  p.arg = arg;
+  p.shares = checked_malloc(threads * sizeof(share));
+  workers = checked_malloc(threads * sizeof(worker));
+  for (i = 0; i < threads; i++) {
+    pthread_mutex_init(&p.shares[i].lock, NULL);
+    p.shares[i].next = (long)count * i / threads;
+    p.shares[i].limit = (long)count * (i + 1) / threads;
+    workers[i].p = &p;
+    workers[i].self = i;
+  }
+  for (i = 1; i < threads; i++)
+    pthread_create(&workers[i].thread, NULL, work, &workers[i]);
+  work(&workers[0]);
+  for (i = 1; i < threads; i++)
+    pthread_join(workers[i].thread, NULL);
+  for (i = 0; i < threads; i++)
+    pthread_mutex_destroy(&p.shares[i].lock);
+  free(p.shares);
+  free(workers);
+}
@@ -0,0 +1,16 @@
+/*
+ * taskpool.h - Run independent tasks on a pool of threads.
+ *
+ * The tasks are numbered from 0. Each worker starts out with an equal run of
+ * the numbers; a worker that has run all of its own steals the back half of
+ * what another one has left, so that a few long tasks do not keep one thread
+ * busy while the others wait.
+ */
+
+/* Run task "index" on worker "worker", which is below the number of threads
+ *  TP_run was given. A worker runs one task at a time. */
+typedef void (*TP_task)(void *arg, int index, int worker);
+
+/* Run "task" for every index below "count" on "threads" threads, one of them
+ *  the calling thread, and return when all have finished. */
+void TP_run(int threads, int count, TP_task task, void *arg);
@@ -0,0 +1,313 @@
+/*
+ * tiggen.c - Write out a made-up Tiger program of a given shape.
+ *
+ * The programs in testcases are too small for the compiler to show how it
+ * scales, so this makes programs as large as needed, to feed to scalebench
+ * (scalebench.c) or to the compiler by hand. The shape is set by
+ *
+ *   -functions n  functions declared at the top level
+ *   -depth n      functions nested inside each of them, one in the next
+ *   -lets n       variables declared by the let of each function
+ *   -types n      record types declared, and as many array types
+ *   -size n       operators in each expression, about
+ *   -seed n       for the choices made at random
+ *
+ * and the program goes to standard output. It is valid Tiger and it stops:
+ * a function only calls the functions declared before it, and the nested
+ * ones inside it, and every call passes on one less fuel, which is checked
+ * first. Divisions are by constants other than zero, and subscripts are
+ * within bounds. The same options make the same program.
+ *
+ *   cc -O2 -o tiggen tiggen.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIELDS 3       /* the most fields a record type has */
+#define ARRAY_LENGTH 8 /* of the arrays made */
+#define FUEL 3         /* passed to the last function by the main program */
+
+typedef enum { intName, recordName, arrayName, functionName } kind;
+
+/* A name in scope; "type" is the record type of a record, and "arity" the
+ * number of parameters of a function other than the fuel. */
+typedef struct {
+  char name[32];
+  kind kind;
+  int type, arity;
+} name;
+
+static struct {
+  int functions, depth, lets, types, size;
+} shape = {10, 2, 4, 2, 8};
+
+static unsigned long seed = 1;
+static name *scope;
+static int scopeCount, scopeCapacity;
+static int fields[1 + 64]; /* of each record type, up to -types 64 */
+
+static int randInt(int n) {
+  seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+  return (int)((seed >> 33) % n);
+}
+
+static void declare(kind k, int type, int arity, const char *id) {
+  name *n;
+  if (scopeCount == scopeCapacity) {
+    scopeCapacity = scopeCapacity ? 2 * scopeCapacity : 256;
+    scope = realloc(scope, scopeCapacity * sizeof(name));
+    if (!scope) {
+      perror("tiggen");
+      exit(1);
+    }
+  }
+  n = &scope[scopeCount++];
+  snprintf(n->name, sizeof(n->name), "%s", id);
+  n->kind = k;
+  n->type = type;
+  n->arity = arity;
+}
+
+/* A name of kind "k" in scope, chosen at random, or NULL */
+static name *pick(kind k) {
+  int i, count = 0, chosen;
+  for (i = 0; i < scopeCount; i++)
+    if (scope[i].kind == k)
+      count++;
+  if (!count)
+    return NULL;
+  chosen = randInt(count);
+  for (i = 0; i < scopeCount; i++)
+    if (scope[i].kind == k && chosen-- == 0)
+      return &scope[i];
+  return NULL;
+}
+
+static void indent(int level) { printf("%*s", 2 * level, ""); }
+
+static void expression(int size);
+
+/* A value that takes no operators to make */
+static void leaf(void) {
+  name *n;
+  switch (randInt(5)) {
+  case 0:
+    if ((n = pick(recordName))) {
+      printf("%s.f%d", n->name, randInt(fields[n->type]));
+      return;
+    }
+    break;
+  case 1:
+    if ((n = pick(arrayName))) {
+      printf("%s[%d]", n->name, randInt(ARRAY_LENGTH));
+      return;
+    }
+    break;
+  case 2:
+    printf("%d", randInt(100));
+    return;
+  }
+  if ((n = pick(intName)))
+    printf("%s", n->name);
+  else
+    printf("%d", randInt(100));
+}
+
+static void call(name *f, int size) {
+  int i;
+  printf("%s(fuel - 1", f->name);
+  for (i = 0; i < f->arity; i++) {
+    printf(", ");
+    expression(size / (f->arity + 1));
+  }
+  printf(")");
+}
+
+/* An integer expression of about "size" operators */
+static void expression(int size) {
+  static const char *arith[] = {"+", "-", "*"};
+  static const char *rel[] = {"<", "<=", ">", ">=", "=", "<>"};
+  name *n;
+  int left;
+  if (size <= 0) {
+    leaf();
+    return;
+  }
+  size--;
+  left = randInt(size + 1);
+  switch (randInt(10)) {
+  case 0:
+    printf("(if ");
+    expression(left / 2);
+    printf(" %s ", rel[randInt(6)]);
+    expression(left / 2);
+    printf(" then ");
+    expression((size - left) / 2);
+    printf(" else ");
+    expression((size - left) / 2);
+    printf(")");
+    return;
+  case 1:
+    if ((n = pick(functionName))) {
+      call(n, size);
+      return;
+    }
+    break;
+  case 2:
+    printf("(");
+    expression(left);
+    printf(" / %d)", 1 + randInt(9));
+    return;
+  case 3:
+    if ((n = pick(intName))) {
+      printf("(%s := ", n->name);
+      expression(left);
+      printf("; ");
+      expression(size - left);
+      printf(")");
+      return;
+    }
+    break;
+  }
+  printf("(");
+  expression(left);
+  printf(" %s ", arith[randInt(3)]);
+  expression(size - left);
+  printf(")");
+}
+
+static void function(int level, int top, int nesting);
+
+/* The declarations of the let of function "fname", at nesting "nesting" in
+ * top-level function "top": its variables, then the next function in. */
+static void letBody(int level, const char *fname, int top, int nesting) {
+  char id[40];
+  int i;
+  for (i = 0; i < shape.lets; i++) {
+    indent(level);
+    switch (shape.types ? randInt(4) : 0) {
+    case 1: {
+      int t = randInt(shape.types), f;
+      snprintf(id, sizeof(id), "%s_r%d", fname, i);
+      printf("var %s := rec%d {", id, t);
+      for (f = 0; f < fields[t]; f++) {
+        printf("%sf%d = ", f ? ", " : "", f);
+        expression(shape.size / fields[t]);
+      }
+      printf("}\n");
+      declare(recordName, t, 0, id);
+      break;
+    }
+    case 2:
+      snprintf(id, sizeof(id), "%s_a%d", fname, i);
+      printf("var %s := arr%d [%d] of ", id, randInt(shape.types),
+             ARRAY_LENGTH);
+      expression(shape.size);
+      printf("\n");
+      declare(arrayName, 0, 0, id);
+      break;
+    default:
+      snprintf(id, sizeof(id), "%s_x%d", fname, i);
+      printf("var %s := ", id);
+      expression(shape.size);
+      printf("\n");
+      declare(intName, 0, 0, id);
+    }
+  }
+  if (nesting < shape.depth)
+    function(level, top, nesting + 1);
+}
+
+/* Top-level function "top" is fN, and the functions nested in it fN_1,
+ * fN_2 and so on. */
+static void function(int level, int top, int nesting) {
+  int saved, i, arity = 1 + randInt(2);
+  char fname[24], id[40];
+  if (nesting)
+    snprintf(fname, sizeof(fname), "f%d_%d", top, nesting);
+  else
+    snprintf(fname, sizeof(fname), "f%d", top);
+  indent(level);
+  printf("function %s(fuel: int", fname);
+  for (i = 0; i < arity; i++)
+    printf(", %s_p%d: int", fname, i);
+  printf("): int =\n");
+  saved = scopeCount;
+  for (i = 0; i < arity; i++) {
+    snprintf(id, sizeof(id), "%s_p%d", fname, i);
+    declare(intName, 0, 0, id);
+  }
+  indent(level + 1);
+  printf("if fuel < 1 then 0 else\n");
+  indent(level + 1);
+  printf("let\n");
+  letBody(level + 2, fname, top, nesting);
+  indent(level + 1);
+  printf("in\n");
+  indent(level + 2);
+  expression(shape.size);
+  printf("\n");
+  indent(level + 1);
+  printf("end\n");
+  scopeCount = saved;
+  /* The caller may call it from now on. */
+  declare(functionName, 0, arity, fname);
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: tiggen [-functions n] [-depth n] [-lets n] "
+                  "[-types n] [-size n] [-seed n]\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  int i, t, last;
+  for (i = 1; i < argc; i++) {
+    int *option = NULL;
+    if (!strcmp(argv[i], "-functions"))
+      option = &shape.functions;
+    else if (!strcmp(argv[i], "-depth"))
+      option = &shape.depth;
+    else if (!strcmp(argv[i], "-lets"))
+      option = &shape.lets;
+    else if (!strcmp(argv[i], "-types"))
+      option = &shape.types;
+    else if (!strcmp(argv[i], "-size"))
+      option = &shape.size;
+    else if (!strcmp(argv[i], "-seed") && i + 1 < argc)
+      seed = strtoul(argv[++i], NULL, 10);
+    else
+      usage();
+    if (option) {
+      if (i + 1 == argc || (*option = atoi(argv[++i])) < 0)
+        usage();
+    }
+  }
+  if (shape.functions < 1 || shape.types > 64)
+    usage();
+
+  printf("/* tiggen -functions %d -depth %d -lets %d -types %d -size %d */\n",
+         shape.functions, shape.depth, shape.lets, shape.types, shape.size);
+  printf("let\n");
+  for (t = 0; t < shape.types; t++) {
+    int f;
+    fields[t] = 1 + randInt(FIELDS);
+    printf("  type rec%d = {", t);
+    for (f = 0; f < fields[t]; f++)
+      printf("%sf%d: int", f ? ", " : "", f);
+    printf("}\n");
+    printf("  type arr%d = array of int\n", t);
+  }
+  /* The top-level functions go in one group, as Tiger needs for calls
+   * between functions declared apart; none calls a later one. */
+  for (i = 0; i < shape.functions; i++)
+    function(1, i, 0);
+  last = scopeCount - 1;
+  printf("in\n  f%d(%d", shape.functions - 1, FUEL);
+  for (i = 0; i < scope[last].arity; i++)
+    printf(", %d", i + 1);
+  printf(")\nend\n");
+  return 0;
+}